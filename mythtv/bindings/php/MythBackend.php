@@ -11,8 +11,8 @@ class MythBackend {
 
 // MYTH_PROTO_VERSION is defined in libmyth in mythtv/libs/libmyth/mythcontext.h
 // and should be the current MythTV protocol version.
-    static $protocol_version        = '91';
-    static $protocol_token          = 'BuzzOff';
+    static $protocol_version        = '92';
+    static $protocol_token          = 'WindyPier';
 
 // The character string used by the backend to separate records
     static $backend_separator       = '[]:[]';
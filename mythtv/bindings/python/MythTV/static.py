@@ -5,11 +5,11 @@ Contains any static and global variables for MythTV Python Bindings
 """
 
 OWN_VERSION = (32,0,-1,0)
-SCHEMA_VERSION = 1361
+SCHEMA_VERSION = 1363
 NVSCHEMA_VERSION = 1007
 MUSICSCHEMA_VERSION = 1024
-PROTO_VERSION = '91'
-PROTO_TOKEN = 'BuzzOff'
+PROTO_VERSION = '92'
+PROTO_TOKEN = 'WindyPier'
 BACKEND_SEP = '[]:[]'
 INSTALL_PREFIX = '/usr/local'
 
@@ -17,6 +17,7 @@ using std::min;
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
+#include <QDataStream>
 
 // MythTV headers
 #include "programinfoupdater.h"
@@ -49,6 +50,8 @@ bool ProgramInfo::s_usingProgIDAuth = true;
 
 const static uint kInvalidDateTime = UINT_MAX;
 
+const char *kProgramListStreamToken = "PROGRAMINFO_STREAM";
+
 
 const QString ProgramInfo::kFromRecordedQuery =
     "SELECT r.title,            r.subtitle,     r.description,     "// 0-2
@@ -1476,6 +1479,157 @@ bool ProgramInfo::FromStringList(QStringList::const_iterator &it,
     return true;
 }
 
+/** \brief Serializes ProgramInfo into a QDataStream using native types.
+ *
+ *  This is the typed counterpart of ToStringList(), it avoids the
+ *  number to string conversions and is used for program lists sent
+ *  where both ends of a connection have negotiated binary framing.
+ *  The caller is responsible for using the same QDataStream::version()
+ *  on both ends, see kProgramInfoQtStreamVersion.
+ *  \sa FromDataStream(QDataStream&), ProgramListToStringList()
+ */
+void ProgramInfo::ToDataStream(QDataStream &stream) const
+{
+    stream << (quint8) kProgramInfoStreamVersion;
+
+    stream << m_title << m_subtitle << m_description
+           << (quint32) m_season << (quint32) m_episode
+           << (quint32) m_totalEpisodes
+           << m_syndicatedEpisode << m_category
+           << (quint32) m_chanId << m_chanStr << m_chanSign << m_chanName
+           << m_pathname << (quint64) m_fileSize
+           << m_startTs << m_endTs
+           << (quint32) m_findId << m_hostname
+           << (quint32) m_sourceId << (quint32) m_inputId
+           << (qint32) m_recPriority << (qint8) m_recStatus
+           << (quint32) m_recordId
+           << (quint8) m_recType << (quint8) m_dupIn << (quint8) m_dupMethod
+           << m_recStartTs << m_recEndTs
+           << (quint32) m_programFlags
+           << (!m_recGroup.isEmpty() ? m_recGroup : QString("Default"))
+           << m_chanPlaybackFilters
+           << m_seriesId << m_programId << m_inetRef
+           << m_lastModified << m_stars << m_originalAirDate
+           << ((!m_playGroup.isEmpty()) ? m_playGroup : QString("Default"))
+           << (qint32) m_recPriority2 << (quint32) m_parentId
+           << ((!m_storageGroup.isEmpty()) ?
+               m_storageGroup : QString("Default"))
+           << (quint16) m_properties
+           << (quint16) m_year << (quint16) m_partNumber
+           << (quint16) m_partTotal << (quint8) m_catType
+           << (quint32) m_recordedId << m_inputName << m_bookmarkUpdate;
+}
+
+/** \brief Uses a QDataStream written by ToDataStream() to initialize
+ *         this ProgramInfo instance.
+ *  \return true if it succeeds, false if it fails, the stream's status
+ *          is no longer QDataStream::Ok then.
+ */
+bool ProgramInfo::FromDataStream(QDataStream &stream)
+{
+    uint      origChanid     = m_chanId;
+    QDateTime origRecstartts = m_recStartTs;
+
+    quint8 version = 0;
+    stream >> version;
+    if (version != kProgramInfoStreamVersion)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("FromDataStream, unsupported version %1").arg(version));
+        stream.setStatus(QDataStream::ReadCorruptData);
+        clear();
+        return false;
+    }
+
+    quint32 season = 0;
+    quint32 episode = 0;
+    quint32 totalEpisodes = 0;
+    quint32 chanId = 0;
+    quint64 fileSize = 0;
+    quint32 findId = 0;
+    quint32 sourceId = 0;
+    quint32 inputId = 0;
+    qint32  recPriority = 0;
+    qint8   recStatus = 0;
+    quint32 recordId = 0;
+    quint8  recType = 0;
+    quint8  dupIn = 0;
+    quint8  dupMethod = 0;
+    quint32 programFlags = 0;
+    qint32  recPriority2 = 0;
+    quint32 parentId = 0;
+    quint16 properties = 0;
+    quint16 year = 0;
+    quint16 partNumber = 0;
+    quint16 partTotal = 0;
+    quint8  catType = 0;
+    quint32 recordedId = 0;
+
+    stream >> m_title >> m_subtitle >> m_description
+           >> season >> episode >> totalEpisodes
+           >> m_syndicatedEpisode >> m_category
+           >> chanId >> m_chanStr >> m_chanSign >> m_chanName
+           >> m_pathname >> fileSize
+           >> m_startTs >> m_endTs
+           >> findId >> m_hostname
+           >> sourceId >> inputId
+           >> recPriority >> recStatus >> recordId
+           >> recType >> dupIn >> dupMethod
+           >> m_recStartTs >> m_recEndTs
+           >> programFlags >> m_recGroup >> m_chanPlaybackFilters
+           >> m_seriesId >> m_programId >> m_inetRef
+           >> m_lastModified >> m_stars >> m_originalAirDate
+           >> m_playGroup >> recPriority2 >> parentId
+           >> m_storageGroup >> properties
+           >> year >> partNumber >> partTotal >> catType
+           >> recordedId >> m_inputName >> m_bookmarkUpdate;
+
+    if (stream.status() != QDataStream::Ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "FromDataStream, truncated stream.");
+        clear();
+        return false;
+    }
+
+    m_season        = season;
+    m_episode       = episode;
+    m_totalEpisodes = totalEpisodes;
+    m_chanId        = chanId;
+    m_fileSize      = fileSize;
+    m_findId        = findId;
+    m_sourceId      = sourceId;
+    m_inputId       = inputId;
+    m_recPriority   = recPriority;
+    m_recStatus     = recStatus;
+    m_recordId      = recordId;
+    m_recType       = recType;
+    m_dupIn         = dupIn;
+    m_dupMethod     = dupMethod;
+    m_programFlags  = programFlags;
+    m_recPriority2  = recPriority2;
+    m_parentId      = parentId;
+    m_properties    = properties;
+    m_year          = year;
+    m_partNumber    = partNumber;
+    m_partTotal     = partTotal;
+    m_catType       = (CategoryType) catType;
+    m_recordedId    = recordedId;
+
+    if (!origChanid || !origRecstartts.isValid() ||
+        (origChanid != m_chanId) || (origRecstartts != m_recStartTs))
+    {
+        m_availableStatus = asAvailable;
+        m_spread = -1;
+        m_startCol = -1;
+        m_inUseForWhat = QString();
+        m_positionMapDBReplacement = nullptr;
+    }
+
+    ensureSortFields();
+
+    return true;
+}
+
 /** \brief Converts ProgramInfo into QString QHash containing each field
  *         in ProgramInfo converted into localized strings.
  */
@@ -10,6 +10,7 @@
 
 #include <QStringList>
 #include <QDateTime>
+#include <QDataStream>
 
 // MythTV headers
 #include "autodeletedeque.h"
@@ -19,6 +20,7 @@
 #include "mythexp.h"
 #include "mythdate.h"
 #include "mythtypes.h"
+#include "mythsocketframing.h"
 #include "enums/recStatus.h"
 
 /* If NUMPROGRAMLINES gets updated, then MYTH_PROTO_VERSION and MYTH_PROTO_TOKEN
@@ -27,6 +29,16 @@
 */
 #define NUMPROGRAMLINES 52
 
+/* Version of the typed ProgramInfo::ToDataStream() encoding, bump it
+   whenever a field is added or its type changes.
+*/
+static const quint8 kProgramInfoStreamVersion = 1;
+
+/* QDataStream::version() both ends use for program lists sent with
+   ProgramInfo::ToDataStream(), so they agree on how Qt types are encoded.
+*/
+static const int kProgramInfoQtStreamVersion = QDataStream::Qt_5_6;
+
 class ProgramInfo;
 using ProgramList = AutoDeleteDeque<ProgramInfo*>;
 
@@ -290,6 +302,10 @@ class MPUBLIC ProgramInfo
         if (!FromStringList(it, list.end()))
             ProgramInfo::clear();
     }
+    explicit ProgramInfo(QDataStream &stream)
+    {
+        FromDataStream(stream);
+    }
 
     bool operator==(const ProgramInfo& rhs);
     ProgramInfo &operator=(const ProgramInfo &other);
@@ -304,6 +320,8 @@ class MPUBLIC ProgramInfo
 
     // Serializers
     void ToStringList(QStringList &list) const;
+    void ToDataStream(QDataStream &stream) const;
+    bool FromDataStream(QDataStream &stream);
     virtual void ToMap(InfoMap &progMap,
                        bool showrerecord = false,
                        uint star_range = 10) const;
@@ -873,6 +891,87 @@ MPUBLIC bool LoadFromRecorded(
     const QString      &sortBy = "");
 
 
+/// Replaces the count at the start of a program list that
+/// ProgramListToStringList() sent as ProgramInfo::ToDataStream() data.
+extern MPUBLIC const char *kProgramListStreamToken;
+
+/** \brief Appends the number of programs and the programs to list.
+ *
+ *  The programs are appended as their ToStringList() fields, or if typed
+ *  is set, kProgramListStreamToken and the count are followed by a single
+ *  field with the ToDataStream() encoding of all of them. Only set typed
+ *  for a list sent over a socket using binary framing.
+ *  \sa ProgramListFromStringList()
+ */
+template<typename LIST>
+void ProgramListToStringList(const LIST &programs, QStringList &list,
+                             bool typed)
+{
+    if (!typed)
+    {
+        list << QString::number(programs.size());
+        for (const auto *pginfo : programs)
+            pginfo->ToStringList(list);
+        return;
+    }
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(kProgramInfoQtStreamVersion);
+    for (const auto *pginfo : programs)
+        pginfo->ToDataStream(out);
+
+    list << kProgramListStreamToken << QString::number(programs.size())
+         << MythSocketFraming::BytesToField(data);
+}
+
+/** \brief Reads a program list written by ProgramListToStringList()
+ *         starting at it, and appends its programs to destination.
+ *  \return false, leaving destination unchanged, if the list is malformed.
+ */
+template<typename TYPE, typename LIST>
+bool ProgramListFromStringList(QStringList::const_iterator it,
+                               const QStringList::const_iterator &end,
+                               LIST &destination)
+{
+    if (it == end)
+        return false;
+
+    bool typed = (*it == kProgramListStreamToken);
+    if (typed && ++it == end)
+        return false;
+
+    int count = (it++)->toInt();
+    std::vector<TYPE*> programs;
+    bool ok = false;
+
+    if (typed && it != end)
+    {
+        QByteArray data = MythSocketFraming::FieldToBytes(*it);
+        QDataStream in(data);
+        in.setVersion(kProgramInfoQtStreamVersion);
+        for (int i = 0; i < count && in.status() == QDataStream::Ok; i++)
+            programs.push_back(new TYPE(in));
+        ok = (in.status() == QDataStream::Ok);
+    }
+    else if (!typed && (qint64)count * NUMPROGRAMLINES <= end - it)
+    {
+        for (int i = 0; i < count; i++)
+            programs.push_back(new TYPE(it, end));
+        ok = true;
+    }
+
+    for (auto *pginfo : programs)
+    {
+        if (ok)
+            destination.push_back(pginfo);
+        else
+            delete pginfo;
+    }
+
+    return ok;
+}
+
 template<typename TYPE>
 bool LoadFromScheduler(
     AutoDeleteDeque<TYPE*> &destination,
@@ -889,26 +988,19 @@ bool LoadFromScheduler(
 
     hasConflicts = slist[0].toInt();
 
-    QStringList::const_iterator sit = slist.begin()+2;
-    while (sit != slist.end())
-    {
-        TYPE *p = new TYPE(sit, slist.end());
-        destination.push_back(p);
+    if (!ProgramListFromStringList<TYPE>(slist.cbegin() + 1, slist.cend(),
+                                         destination))
+        return false;
 
+    for (auto *p : destination)
+    {
         if (!p->HasPathname() && !p->GetChanID())
         {
-            delete p;
             destination.clear();
             return false;
         }
     }
 
-    if (destination.size() != slist[1].toUInt())
-    {
-        destination.clear();
-        return false;
-    }
-
     return true;
 }
 
@@ -7,6 +7,7 @@
 #include "programtypes.h"
 #include "mythdate.h"
 
+#include <algorithm>
 #include <deque>
 using std::deque;
 
@@ -60,6 +61,127 @@ QString toString(MarkTypes type)
     return "unknown";
 }
 
+/** \brief Returns the frame ranges a cutlist keeps.
+ *
+ *  A cut runs from its MARK_CUT_START frame up to, but not including, its
+ *  MARK_CUT_END frame. A MARK_CUT_END without a start cuts from the
+ *  beginning of the recording, marks repeated within a cut or outside one
+ *  are ignored. Other marks in the map are ignored too.
+ *
+ *  \param cutlist   Cut marks, as from ProgramInfo::QueryCutList()
+ *  \param lastFrame End of the last range if the cutlist doesn't cut to the
+ *                   end of the recording
+ */
+frm_range_list_t CutListKeptRanges(const frm_dir_map_t &cutlist,
+                                   uint64_t lastFrame)
+{
+    frm_range_list_t kept;
+    uint64_t keepStart = 0;
+    bool inCut = false;
+    bool first = true;
+    for (auto it = cutlist.cbegin(); it != cutlist.cend(); ++it)
+    {
+        if (*it == MARK_CUT_START && !inCut)
+        {
+            if (it.key() > keepStart)
+                kept.push_back(qMakePair(keepStart, it.key()));
+            inCut = true;
+        }
+        else if (*it == MARK_CUT_END && (inCut || first))
+        {
+            keepStart = it.key();
+            inCut = false;
+        }
+        if (*it == MARK_CUT_START || *it == MARK_CUT_END)
+            first = false;
+    }
+    if (!inCut && keepStart < lastFrame)
+        kept.push_back(qMakePair(keepStart, lastFrame));
+    return kept;
+}
+
+/// Returns the number of frames from start up to, not including, end that
+/// are in the kept ranges.
+uint64_t CountKeptFrames(const frm_range_list_t &kept,
+                         uint64_t start, uint64_t end)
+{
+    uint64_t frames = 0;
+    for (const auto &range : kept)
+    {
+        uint64_t s = std::max(range.first, start);
+        uint64_t e = std::min(range.second, end);
+        if (s < e)
+            frames += e - s;
+    }
+    return frames;
+}
+
+/** \brief Splits a recording at keyframes into parts that keep about the
+ *         same number of frames.
+ *
+ *  A part starts at the first keyframe by which its share of the kept
+ *  frames has been reached, so a part that starts in a long cut just gets
+ *  longer. There are fewer parts if the keyframes run out.
+ *
+ *  \param kept        Kept ranges, from CutListKeptRanges()
+ *  \param keyframes   Keyframe numbers, in order
+ *  \param totalFrames Frames in the recording
+ *  \param parts       Number of parts wanted
+ *  \returns The first frame of each part, starting with 0, or an empty
+ *           list if nothing is kept
+ */
+QList<uint64_t> CutListSplitPoints(const frm_range_list_t &kept,
+                                   const QList<uint64_t> &keyframes,
+                                   uint64_t totalFrames, int parts)
+{
+    QList<uint64_t> splits;
+    uint64_t totalKept = CountKeptFrames(kept, 0, totalFrames);
+    if (!totalKept)
+        return splits;
+
+    splits.push_back(0);
+    int k = 0;
+    for (int i = 1; i < parts; i++)
+    {
+        uint64_t target = totalKept * i / parts;
+        while (k < keyframes.size() &&
+               (keyframes[k] <= splits.last() ||
+                CountKeptFrames(kept, 0, keyframes[k]) < target))
+            k++;
+        if (k >= keyframes.size())
+            break;
+        splits.push_back(keyframes[k]);
+    }
+    return splits;
+}
+
+/** \brief Returns the cuts that remove everything from 0 to lastFrame
+ *         except the kept frames from start up to, not including, end.
+ *
+ *  The cuts are in the same form as the kept ranges, from their first
+ *  frame up to, not including, their second.
+ */
+frm_range_list_t CutListForRange(const frm_range_list_t &kept,
+                                 uint64_t start, uint64_t end,
+                                 uint64_t lastFrame)
+{
+    frm_range_list_t cuts;
+    uint64_t pos = 0;
+    for (const auto &range : kept)
+    {
+        uint64_t s = std::max(range.first, start);
+        uint64_t e = std::min(range.second, end);
+        if (s >= e)
+            continue;
+        if (s > pos)
+            cuts.push_back(qMakePair(pos, s));
+        pos = e;
+    }
+    if (pos < lastFrame)
+        cuts.push_back(qMakePair(pos, lastFrame));
+    return cuts;
+}
+
 QString toString(AvailableStatusType status)
 {
     switch (status)
@@ -80,6 +80,19 @@ MPUBLIC QString toString(MarkTypes type);
 /// Frame # -> Mark map
 using frm_dir_map_t = QMap<uint64_t, MarkTypes>;
 
+/// Frame ranges, each from its first frame up to, not including, its second
+using frm_range_list_t = QList<QPair<uint64_t, uint64_t> >;
+MPUBLIC frm_range_list_t CutListKeptRanges(const frm_dir_map_t &cutlist,
+                                           uint64_t lastFrame);
+MPUBLIC uint64_t CountKeptFrames(const frm_range_list_t &kept,
+                                 uint64_t start, uint64_t end);
+MPUBLIC QList<uint64_t> CutListSplitPoints(const frm_range_list_t &kept,
+                                           const QList<uint64_t> &keyframes,
+                                           uint64_t totalFrames, int parts);
+MPUBLIC frm_range_list_t CutListForRange(const frm_range_list_t &kept,
+                                         uint64_t start, uint64_t end,
+                                         uint64_t lastFrame);
+
 enum CommFlagStatus {
     COMM_FLAG_NOT_FLAGGED = 0,
     COMM_FLAG_DONE = 1,
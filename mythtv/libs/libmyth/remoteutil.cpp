@@ -177,25 +177,15 @@ uint RemoteGetRecordingList(
     if (!gCoreContext->SendReceiveStringList(strList) || strList.isEmpty())
         return 0;
 
-    int numrecordings = strList[0].toInt();
-    if (numrecordings <= 0)
-        return 0;
-
-    if (numrecordings * NUMPROGRAMLINES + 1 > strList.size())
+    uint reclist_initial_size = (uint) reclist.size();
+    if (!ProgramListFromStringList<ProgramInfo>(
+            strList.cbegin(), strList.cend(), reclist))
     {
         LOG(VB_GENERAL, LOG_ERR,
                  "RemoteGetRecordingList() list size appears to be incorrect.");
         return 0;
     }
 
-    uint reclist_initial_size = (uint) reclist.size();
-    QStringList::const_iterator it = strList.begin() + 1;
-    for (int i = 0; i < numrecordings; i++)
-    {
-        auto *pginfo = new ProgramInfo(it, strList.end());
-        reclist.push_back(pginfo);
-    }
-
     return ((uint) reclist.size()) - reclist_initial_size;
 }
 
@@ -22,6 +22,7 @@
 
 #include "programinfo.h"
 #include "programtypes.h"
+#include "mythsocketframing.h"
 
 class TestProgramInfo : public QObject
 {
@@ -283,6 +284,159 @@ class TestProgramInfo : public QObject
         QVERIFY(m_supergirl23 == lrigrepus23c);
     }
 
+    void programToDataStream_test(void)
+    {
+        QByteArray buf;
+        {
+            QDataStream out(&buf, QIODevice::WriteOnly);
+            m_dracula.ToDataStream(out);
+            m_flash34.ToDataStream(out);
+            m_supergirl23.ToDataStream(out);
+        }
+
+        QDataStream in(buf);
+        ProgramInfo alucard;
+        ProgramInfo hsalf34;
+        ProgramInfo lrigrepus23;
+        QVERIFY(alucard.FromDataStream(in));
+        QVERIFY(hsalf34.FromDataStream(in));
+        QVERIFY(lrigrepus23.FromDataStream(in));
+        QVERIFY(m_dracula == alucard);
+        QVERIFY(m_flash34 == hsalf34);
+        QVERIFY(m_supergirl23 == lrigrepus23);
+
+        // A typed record must survive the same round trip as the
+        // string list encoding.
+        QStringList a;
+        QStringList b;
+        m_flash34.ToStringList(a);
+        hsalf34.ToStringList(b);
+        QCOMPARE(a, b);
+
+        // Truncated input is rejected rather than half parsed
+        QByteArray single;
+        {
+            QDataStream out(&single, QIODevice::WriteOnly);
+            m_flash34.ToDataStream(out);
+        }
+        single.chop(10);
+        QDataStream truncated(single);
+        ProgramInfo broken;
+        QVERIFY(!broken.FromDataStream(truncated));
+    }
+
+    void programListStream_test(void)
+    {
+        std::vector<ProgramInfo*> programs { &m_dracula, &m_flash34,
+                                             &m_supergirl23 };
+
+        for (int typed = 0; typed < 2; typed++)
+        {
+            QStringList list;
+            ProgramListToStringList(programs, list, typed != 0);
+            QCOMPARE(list.size(), typed ? 3 : 1 + 3 * NUMPROGRAMLINES);
+
+            // Send it the way the socket would
+            auto fmode = typed ? MythSocketFraming::kBinary
+                               : MythSocketFraming::kLegacy;
+            int hdr = MythSocketFraming::HeaderSize(fmode);
+            QStringList decoded;
+            QVERIFY(MythSocketFraming::Decode(
+                        fmode, MythSocketFraming::Encode(fmode, list).mid(hdr),
+                        decoded));
+
+            ProgramList received;
+            QVERIFY(ProgramListFromStringList<ProgramInfo>(
+                        decoded.cbegin(), decoded.cend(), received));
+            QCOMPARE((int)received.size(), 3);
+            QVERIFY(m_dracula == *received[0]);
+            QVERIFY(m_flash34 == *received[1]);
+            QVERIFY(m_supergirl23 == *received[2]);
+
+            // A short list leaves the destination alone
+            decoded.removeLast();
+            QVERIFY(!ProgramListFromStringList<ProgramInfo>(
+                        decoded.cbegin(), decoded.cend(), received));
+            QCOMPARE((int)received.size(), 3);
+        }
+    }
+
+    void socketFraming_test(void)
+    {
+        QStringList list;
+        m_flash34.ToStringList(list);
+        list << "embedded [][]:[] separator" << "" << QString::fromUtf8("\u00e9t\u00e9");
+
+        QByteArray frame = MythSocketFraming::Encode(
+            MythSocketFraming::kBinary, list);
+        int hdr = MythSocketFraming::HeaderSize(MythSocketFraming::kBinary);
+        QCOMPARE(MythSocketFraming::ParseHeader(
+                     MythSocketFraming::kBinary, frame.left(hdr)),
+                 (qint64)(frame.size() - hdr));
+
+        QStringList decoded;
+        QVERIFY(MythSocketFraming::Decode(
+                    MythSocketFraming::kBinary, frame.mid(hdr), decoded));
+        QCOMPARE(decoded, list);
+
+        // Corrupt field counts and lengths must not be trusted
+        QVERIFY(!MythSocketFraming::Decode(
+                    MythSocketFraming::kBinary, frame.mid(hdr, 20), decoded));
+
+        list.removeLast();
+        list.removeLast();
+        list.removeLast();
+        frame = MythSocketFraming::Encode(MythSocketFraming::kLegacy, list);
+        hdr = MythSocketFraming::HeaderSize(MythSocketFraming::kLegacy);
+        QCOMPARE(MythSocketFraming::ParseHeader(
+                     MythSocketFraming::kLegacy, frame.left(hdr)),
+                 (qint64)(frame.size() - hdr));
+        QVERIFY(MythSocketFraming::Decode(
+                    MythSocketFraming::kLegacy, frame.mid(hdr), decoded));
+        QCOMPARE(decoded, list);
+    }
+
+    /**
+     * Encode/decode throughput for a QUERY_RECORDINGS sized reply
+     */
+    void programListFraming_bench_data(void)
+    {
+        QTest::addColumn<int>("mode");
+        QTest::newRow("legacy") << 0;
+        QTest::newRow("binary") << 1;
+        QTest::newRow("typed")  << 2;
+    }
+
+    void programListFraming_bench(void)
+    {
+        QFETCH(int, mode);
+        static const int kPrograms = 10000;
+
+        std::vector<ProgramInfo*> sent;
+        for (int i = 0; i < kPrograms; i++)
+            sent.push_back((i & 1) ? &m_flash34 : &m_supergirl23);
+
+        QBENCHMARK
+        {
+            // Everything QUERY_RECORDINGS does with the list after
+            // loading it, on both ends of the connection
+            QStringList list;
+            ProgramListToStringList(sent, list, mode == 2);
+
+            auto fmode = (mode == 0) ? MythSocketFraming::kLegacy
+                                     : MythSocketFraming::kBinary;
+            QByteArray frame = MythSocketFraming::Encode(fmode, list);
+            int hdr = MythSocketFraming::HeaderSize(fmode);
+
+            QStringList decoded;
+            MythSocketFraming::Decode(fmode, frame.mid(hdr), decoded);
+            ProgramList programs;
+            ProgramListFromStringList<ProgramInfo>(
+                decoded.cbegin(), decoded.cend(), programs);
+            QCOMPARE((int)programs.size(), kPrograms);
+        }
+    }
+
     void programSorting_test(void)
     {
         QStringList program_list;
@@ -307,4 +461,134 @@ class TestProgramInfo : public QObject
         QCOMPARE (m_flash34.GetSortSubtitle(), QString("new rogues"));
         QVERIFY (m_flash34.GetSortTitle() < m_supergirl23.GetSortTitle());
     }
+
+    static void cutListKeptRanges_test(void)
+    {
+        const uint64_t last = 1000;
+        frm_dir_map_t cutlist;
+
+        // No cuts keeps everything
+        frm_range_list_t kept = CutListKeptRanges(cutlist, last);
+        QCOMPARE (kept.size(), 1);
+        QCOMPARE (kept[0], qMakePair(uint64_t(0), last));
+
+        // A cut in the middle, and one running to the end
+        cutlist[100] = MARK_CUT_START;
+        cutlist[200] = MARK_CUT_END;
+        cutlist[900] = MARK_CUT_START;
+        kept = CutListKeptRanges(cutlist, last);
+        QCOMPARE (kept.size(), 2);
+        QCOMPARE (kept[0], qMakePair(uint64_t(0), uint64_t(100)));
+        QCOMPARE (kept[1], qMakePair(uint64_t(200), uint64_t(900)));
+        QCOMPARE (CountKeptFrames(kept, 0, last), uint64_t(800));
+        QCOMPARE (CountKeptFrames(kept, 150, 300), uint64_t(100));
+        QCOMPARE (CountKeptFrames(kept, 900, last), uint64_t(0));
+
+        // An end without a start cuts from the beginning, repeated
+        // marks are ignored
+        cutlist.clear();
+        cutlist[50]  = MARK_CUT_END;
+        cutlist[300] = MARK_CUT_START;
+        cutlist[350] = MARK_CUT_START;
+        cutlist[400] = MARK_CUT_END;
+        cutlist[450] = MARK_CUT_END;
+        kept = CutListKeptRanges(cutlist, last);
+        QCOMPARE (kept.size(), 2);
+        QCOMPARE (kept[0], qMakePair(uint64_t(50), uint64_t(300)));
+        QCOMPARE (kept[1], qMakePair(uint64_t(400), last));
+
+        // A cut from the start keeps nothing before it
+        cutlist.clear();
+        cutlist[0]   = MARK_CUT_START;
+        cutlist[10]  = MARK_CUT_END;
+        kept = CutListKeptRanges(cutlist, last);
+        QCOMPARE (kept.size(), 1);
+        QCOMPARE (kept[0], qMakePair(uint64_t(10), last));
+
+        // Cutting everything keeps nothing
+        cutlist.clear();
+        cutlist[0] = MARK_CUT_START;
+        kept = CutListKeptRanges(cutlist, last);
+        QVERIFY (kept.isEmpty());
+        QCOMPARE (CountKeptFrames(kept, 0, last), uint64_t(0));
+    }
+
+    static void cutListSplitPoints_test(void)
+    {
+        // The end of the recording in mythtranscode cutlists
+        const uint64_t last = 999999999;
+        frm_dir_map_t cutlist;
+        QList<uint64_t> keyframes;
+        for (uint64_t frame = 0; frame < 1000; frame += 100)
+            keyframes << frame;
+
+        // Without cuts the parts are about the same length
+        frm_range_list_t kept = CutListKeptRanges(cutlist, last);
+        QList<uint64_t> splits = CutListSplitPoints(kept, keyframes, 1000, 4);
+        QCOMPARE (splits, QList<uint64_t>() << 0 << 300 << 500 << 800);
+
+        // Fewer parts when the keyframes run out
+        keyframes.clear();
+        keyframes << 0 << 100 << 200;
+        splits = CutListSplitPoints(kept, keyframes, 1000, 4);
+        QCOMPARE (splits, QList<uint64_t>() << 0);
+        keyframes.clear();
+        keyframes << 0 << 300 << 600;
+        splits = CutListSplitPoints(kept, keyframes, 1000, 4);
+        QCOMPARE (splits, QList<uint64_t>() << 0 << 300 << 600);
+
+        // A part can start inside a cut
+        cutlist[100] = MARK_CUT_START;
+        cutlist[300] = MARK_CUT_END;
+        kept = CutListKeptRanges(cutlist, last);
+        keyframes.clear();
+        for (uint64_t frame = 0; frame < 400; frame += 60)
+            keyframes << frame;
+        splits = CutListSplitPoints(kept, keyframes, 400, 2);
+        QCOMPARE (splits, QList<uint64_t>() << 0 << 120);
+        QCOMPARE (CountKeptFrames(kept, 0, 120), uint64_t(100));
+        QCOMPARE (CountKeptFrames(kept, 120, 400), uint64_t(100));
+
+        // Cutting everything leaves nothing to split
+        cutlist.clear();
+        cutlist[0] = MARK_CUT_START;
+        kept = CutListKeptRanges(cutlist, last);
+        QVERIFY (CutListSplitPoints(kept, keyframes, 400, 2).isEmpty());
+    }
+
+    static void cutListForRange_test(void)
+    {
+        const uint64_t last = 999999999;
+        frm_dir_map_t cutlist;
+        cutlist[100] = MARK_CUT_START;
+        cutlist[300] = MARK_CUT_END;
+        frm_range_list_t kept = CutListKeptRanges(cutlist, last);
+
+        // The first part is cut from the end of its kept frames
+        frm_range_list_t cuts = CutListForRange(kept, 0, 120, last);
+        QCOMPARE (cuts.size(), 1);
+        QCOMPARE (cuts[0], qMakePair(uint64_t(100), last));
+
+        // A part starting inside a cut is cut up to the next kept frame,
+        // and kept to the end of the recording without a cut at last
+        cuts = CutListForRange(kept, 120, last, last);
+        QCOMPARE (cuts.size(), 1);
+        QCOMPARE (cuts[0], qMakePair(uint64_t(0), uint64_t(300)));
+
+        // A cut to the end of the recording runs to last
+        cutlist[900] = MARK_CUT_START;
+        kept = CutListKeptRanges(cutlist, last);
+        cuts = CutListForRange(kept, 500, last, last);
+        QCOMPARE (cuts.size(), 2);
+        QCOMPARE (cuts[0], qMakePair(uint64_t(0), uint64_t(500)));
+        QCOMPARE (cuts[1], qMakePair(uint64_t(900), last));
+
+        // Cutting everything cuts the whole part
+        cutlist.clear();
+        cutlist[0] = MARK_CUT_START;
+        kept = CutListKeptRanges(cutlist, last);
+        cuts = CutListForRange(kept, 0, last, last);
+        QCOMPARE (cuts.size(), 1);
+        QCOMPARE (cuts[0], qMakePair(uint64_t(0), last));
+    }
 };
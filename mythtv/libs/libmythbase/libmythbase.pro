@@ -11,12 +11,13 @@ QMAKE_CLEAN += $(TARGET) $(TARGETA) $(TARGETD) $(TARGET0) $(TARGET1) $(TARGET2)
 
 # Input
 HEADERS += mthread.h mthreadpool.h
-HEADERS += mythsocket.h mythsocket_cb.h
+HEADERS += mythsocket.h mythsocket_cb.h mythsocketframing.h
 HEADERS += mythbaseexp.h mythdbcon.h mythdb.h mythdbparams.h
 HEADERS += verbosedefs.h mythversion.h compat.h mythconfig.h
 HEADERS += mythobservable.h mythevent.h
 HEADERS += mythtimer.h mythsignalingtimer.h mythdirs.h exitcodes.h
 HEADERS += lcddevice.h mythstorage.h remotefile.h logging.h loggingserver.h
+HEADERS += logring.h
 HEADERS += mythcorecontext.h mythsystem.h mythsystemprivate.h
 HEADERS += mythlocale.h storagegroup.h
 HEADERS += mythcoreutil.h mythdownloadmanager.h mythtranslation.h
@@ -36,9 +37,10 @@ HEADERS += ../../external/qjsonwrapper/qjsonwrapper/Json.h
 HEADERS += cleanupguard.h portchecker.h
 HEADERS += mythsorthelper.h
 HEADERS += mythpower.h
+HEADERS += mythtimingstats.h
 
 SOURCES += mthread.cpp mthreadpool.cpp
-SOURCES += mythsocket.cpp
+SOURCES += mythsocket.cpp mythsocketframing.cpp
 SOURCES += mythdbcon.cpp mythdb.cpp mythdbparams.cpp
 SOURCES += mythobservable.cpp mythevent.cpp
 SOURCES += mythtimer.cpp mythsignalingtimer.cpp mythdirs.cpp
@@ -47,7 +49,7 @@ SOURCES += mythcorecontext.cpp mythsystem.cpp mythlocale.cpp storagegroup.cpp
 SOURCES += mythcoreutil.cpp mythdownloadmanager.cpp mythtranslation.cpp
 SOURCES += unzip.cpp iso639.cpp iso3166.cpp mythmedia.cpp mythmiscutil.cpp
 SOURCES += mythhdd.cpp mythcdrom.cpp dbutil.cpp
-SOURCES += logging.cpp loggingserver.cpp
+SOURCES += logging.cpp loggingserver.cpp logring.cpp
 SOURCES += referencecounter.cpp mythcommandlineparser.cpp
 SOURCES += filesysteminfo.cpp hardwareprofile.cpp serverpool.cpp
 SOURCES += plist.cpp signalhandling.cpp mythtimezone.cpp mythdate.cpp
@@ -58,6 +60,7 @@ SOURCES += mythsession.cpp
 SOURCES += ../../external/qjsonwrapper/qjsonwrapper/Json.cpp
 SOURCES += cleanupguard.cpp portchecker.cpp
 SOURCES += mythsorthelper.cpp
+SOURCES += mythtimingstats.cpp
 SOURCES += mythpower.cpp
 
 using_qtdbus {
@@ -83,7 +86,7 @@ inc.files += mythdbcon.h mythdbparams.h mythbaseexp.h mythdb.h
 inc.files += compat.h mythversion.h mythconfig.h mythconfig.mak version.h
 inc.files += mythobservable.h mythevent.h verbosedefs.h
 inc.files += mythtimer.h lcddevice.h exitcodes.h mythdirs.h mythstorage.h
-inc.files += mythsocket.h mythsocket_cb.h mythlogging.h
+inc.files += mythsocket.h mythsocket_cb.h mythsocketframing.h mythlogging.h
 inc.files += mythcorecontext.h mythsystem.h storagegroup.h loggingserver.h
 inc.files += mythcoreutil.h mythlocale.h mythdownloadmanager.h
 inc.files += mythtranslation.h iso639.h iso3166.h mythmedia.h mythmiscutil.h
@@ -95,7 +98,7 @@ inc.files += plist.h bswap.h signalhandling.h ffmpeg-mmx.h mythdate.h
 inc.files += mythplugin.h mythpluginapi.h mythqtcompat.h
 inc.files += remotefile.h mythsystemlegacy.h mythtypes.h
 inc.files += threadedfilewriter.h mythsingledownload.h mythsession.h
-inc.files += mythsorthelper.h
+inc.files += mythsorthelper.h mythtimingstats.h
 
 # Allow both #include <blah.h> and #include <libmythbase/blah.h>
 inc2.path  = $${PREFIX}/include/mythtv/libmythbase
@@ -9,8 +9,12 @@
 #include <QStringList>
 #include <QMap>
 #include <QRegExp>
+#include <QThreadStorage>
 #include <QVariantMap>
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <vector>
 
 using namespace std;
 
@@ -63,9 +67,35 @@ extern "C" {
 #include <android/log.h>
 #endif
 
+/// The LOG() fast path of a thread that has logged something
+class LogThreadRing
+{
+  public:
+    LogRing           m_ring;
+    qulonglong        m_threadId {0};
+    qlonglong         m_tid      {0};
+    std::atomic<bool> m_exited   {false};
+};
+
+/// Thread local reference to a LogThreadRing, the ring itself is only
+/// freed by the logger thread once everything on it has been handled.
+class LogThreadRingRef
+{
+  public:
+    explicit LogThreadRingRef(LogThreadRing *ring) : m_ring(ring) {}
+    ~LogThreadRingRef() { m_ring->m_exited = true; }
+
+    LogThreadRing *m_ring;
+};
+
 static QMutex                  logQueueMutex;
-static QQueue<LoggingItem *>   logQueue;
-static QRegExp                 logRegExp = QRegExp("[%]{1,2}");
+static QMutex                  logRingsMutex;
+static QList<LogThreadRing *>  logRings;         ///< Protected by logRingsMutex
+static uint64_t                logRingsDropped = 0; ///< Drops on freed rings,
+                                                 ///  protected by logRingsMutex
+static QMutex                  logDrainMutex;    ///< Held while consuming rings
+static std::atomic<uint64_t>   logSequence {0};
+static std::atomic<bool>       logThreadWaiting {false};
 
 static LoggerThread           *logThread = nullptr;
 static QMutex                  logThreadMutex;
@@ -137,6 +167,127 @@ void loggingGetTimeStamp(qlonglong *epoch, uint *usec)
 #endif
 }
 
+/// \brief Get the OS thread ID of the calling thread
+static int64_t get_thread_tid(void)
+{
+    int64_t tid = 0;
+
+#if defined(Q_OS_ANDROID)
+    tid = (int64_t)gettid();
+#elif defined(linux)
+    tid = syscall(SYS_gettid);
+#elif defined(__FreeBSD__)
+    long lwpid;
+    int dummy = thr_self( &lwpid );
+    (void)dummy;
+    tid = (int64_t)lwpid;
+#elif CONFIG_DARWIN
+    tid = (int64_t)mach_thread_self();
+#endif
+
+    return tid;
+}
+
+/// \brief Get the calling thread's ring, creating and registering it the
+///        first time the thread logs something.
+static LogThreadRing *get_thread_ring(void)
+{
+    static auto *s_storage = new QThreadStorage<LogThreadRingRef *>;
+
+    LogThreadRingRef *ref = s_storage->localData();
+    if (ref)
+        return ref->m_ring;
+
+    auto *ring = new LogThreadRing;
+    ring->m_threadId = (qulonglong)(QThread::currentThreadId());
+    ring->m_tid = get_thread_tid();
+
+    {
+        QMutexLocker locker(&logThreadTidMutex);
+        logThreadTidHash[ring->m_threadId] = ring->m_tid;
+    }
+
+    {
+        QMutexLocker locker(&logRingsMutex);
+        logRings.push_back(ring);
+    }
+
+    s_storage->setLocalData(new LogThreadRingRef(ring));
+    return ring;
+}
+
+/// \brief Check whether everything logged has been handled
+static bool log_rings_empty(void)
+{
+    QMutexLocker locker(&logRingsMutex);
+    return std::all_of(logRings.cbegin(), logRings.cend(),
+                       [](const LogThreadRing *ring)
+                       { return ring->m_ring.IsEmpty(); });
+}
+
+/// \brief  Put a message on the calling thread's ring.  The message is
+///         copied as is, unless arguments is given in which case it is a
+///         printf format string.  Nothing else is formatted until the
+///         logger thread gets to it.
+/// \return false if the ring was full and the message was dropped
+static bool log_ring_push(int type, LogLevel_t level, const char *file,
+                          int line, const char *function,
+                          const char *message, va_list *arguments)
+{
+    LogThreadRing *ring = get_thread_ring();
+
+    LogRing::Record *record = ring->m_ring.Reserve(LOGLINE_MAX);
+    if (!record)
+    {
+        ring->m_ring.CountDrop();
+        return false;
+    }
+
+    size_t len = 0;
+    if (arguments)
+    {
+        int ret = vsnprintf(record->Message(), LOGLINE_MAX, message,
+                            *arguments);
+        if (ret < 0)
+            record->Message()[0] = '\0';
+        else
+            len = std::min<size_t>(ret, LOGLINE_MAX - 1);
+    }
+    else
+    {
+        len = strnlen(message, LOGLINE_MAX - 1);
+        memcpy(record->Message(), message, len);
+        record->Message()[len] = '\0';
+    }
+
+    record->m_type     = type;
+    record->m_seq      = logSequence.fetch_add(1, std::memory_order_relaxed);
+    record->m_line     = line;
+    record->m_level    = level;
+    record->m_file     = file;
+    record->m_function = function;
+    loggingGetTimeStamp(&record->m_epoch, &record->m_usec);
+
+#if defined( _MSC_VER ) && defined( _DEBUG )
+    OutputDebugStringA( record->Message() );
+    OutputDebugStringA( "\n" );
+#endif
+
+    ring->m_ring.Commit(record, len);
+
+    // Pairs with the fence in LoggerThread::run(), either the logger sees
+    // this message before it goes to sleep or we see that it is asleep.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (logThreadWaiting.load(std::memory_order_relaxed))
+    {
+        QMutexLocker qLock(&logQueueMutex);
+        if (logThread)
+            logThread->wakeUp();
+    }
+
+    return true;
+}
+
 LoggingItem::LoggingItem(const char *_file, const char *_function,
                          int _line, LogLevel_t _level, LoggingType _type) :
         ReferenceCounter("LoggingItem", false),
@@ -148,6 +299,22 @@ LoggingItem::LoggingItem(const char *_file, const char *_function,
     setThreadTid();
 }
 
+LoggingItem::LoggingItem(const LogRing::Record &record,
+                         qulonglong threadId, qlonglong tid) :
+        ReferenceCounter("LoggingItem", false),
+        m_tid(tid), m_threadId(threadId),
+        m_usec(record.m_usec), m_line(record.m_line),
+        m_type((LoggingType)record.m_type),
+        m_level((LogLevel_t)record.m_level), m_epoch(record.m_epoch),
+        m_file(strdup(record.m_file)), m_function(strdup(record.m_function))
+{
+    // Registration carries the thread name instead of a message
+    if (m_type & kRegistering)
+        m_threadName = strdup(record.Message());
+    else
+        qstrncpy(m_message, record.Message(), sizeof(m_message));
+}
+
 LoggingItem::~LoggingItem()
 {
     free(m_file);
@@ -211,20 +378,7 @@ void LoggingItem::setThreadTid(void)
     m_tid = logThreadTidHash.value(m_threadId, -1);
     if (m_tid == -1)
     {
-        m_tid = 0;
-
-#if defined(Q_OS_ANDROID)
-        m_tid = (int64_t)gettid();
-#elif defined(linux)
-        m_tid = syscall(SYS_gettid);
-#elif defined(__FreeBSD__)
-        long lwpid;
-        int dummy = thr_self( &lwpid );
-        (void)dummy;
-        m_tid = (int64_t)lwpid;
-#elif CONFIG_DARWIN
-        m_tid = (int64_t)mach_thread_self();
-#endif
+        m_tid = get_thread_tid();
         logThreadTidHash[m_threadId] = m_tid;
     }
 }
@@ -283,29 +437,27 @@ void LoggerThread::run(void)
 
     QMutexLocker qLock(&logQueueMutex);
 
-    while (!m_aborted || !logQueue.isEmpty())
+    while (!m_aborted || !log_rings_empty())
     {
         qLock.unlock();
         qApp->processEvents(QEventLoop::AllEvents, 10);
         qApp->sendPostedEvents(nullptr, QEvent::DeferredDelete);
 
+        bool handled = drainRings();
+
         qLock.relock();
-        if (logQueue.isEmpty())
+        if (handled)
+            continue;
+
+        logThreadWaiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (log_rings_empty())
         {
             m_waitEmpty->wakeAll();
-            m_waitNotEmpty->wait(qLock.mutex(), 100);
-            continue;
+            if (!m_aborted)
+                m_waitNotEmpty->wait(qLock.mutex(), 100);
         }
-
-        LoggingItem *item = logQueue.dequeue();
-        qLock.unlock();
-
-        fillItem(item);
-        handleItem(item);
-        logConsole(item);
-        item->DecrRef();
-
-        qLock.relock();
+        logThreadWaiting = false;
     }
 
     qLock.unlock();
@@ -323,6 +475,94 @@ void LoggerThread::run(void)
     }
 }
 
+/// \brief  Handles the messages waiting on the per-thread rings.  The rings
+///         are merged by sequence number so messages from different threads
+///         come out in the order they were logged.  Rings of threads that
+///         have exited are freed once they are empty, and messages dropped
+///         since the last call are reported.
+/// \return true if any message was handled
+bool LoggerThread::drainRings(void)
+{
+    QMutexLocker drainLock(&logDrainMutex);
+
+    QList<LogThreadRing *> rings;
+    {
+        QMutexLocker locker(&logRingsMutex);
+        rings = logRings;
+    }
+
+    std::vector<std::pair<LogThreadRing *, const LogRing::Record *> > fronts;
+    for (auto *ring : rings)
+    {
+        const LogRing::Record *record = ring->m_ring.Front();
+        if (record)
+            fronts.emplace_back(ring, record);
+    }
+
+    bool handled = !fronts.empty();
+    while (!fronts.empty())
+    {
+        auto oldest = std::min_element(
+            fronts.begin(), fronts.end(),
+            [](const std::pair<LogThreadRing *, const LogRing::Record *> &a,
+               const std::pair<LogThreadRing *, const LogRing::Record *> &b)
+            { return a.second->m_seq < b.second->m_seq; });
+
+        LogThreadRing *ring = oldest->first;
+        LoggingItem *item = LoggingItem::create(*oldest->second,
+                                                ring->m_threadId,
+                                                ring->m_tid);
+        ring->m_ring.Pop();
+
+        fillItem(item);
+        handleItem(item);
+        logConsole(item);
+        item->DecrRef();
+
+        oldest->second = ring->m_ring.Front();
+        if (!oldest->second)
+            fronts.erase(oldest);
+    }
+
+    uint64_t dropped = 0;
+    {
+        QMutexLocker locker(&logRingsMutex);
+        for (auto it = logRings.begin(); it != logRings.end(); )
+        {
+            LogThreadRing *ring = *it;
+            if (ring->m_exited && ring->m_ring.IsEmpty())
+            {
+                logRingsDropped += ring->m_ring.Dropped();
+                it = logRings.erase(it);
+                delete ring;
+                continue;
+            }
+            dropped += ring->m_ring.Dropped();
+            ++it;
+        }
+        dropped += logRingsDropped;
+    }
+
+    if (dropped > m_reportedDrops)
+    {
+        LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__,
+                                                __LINE__, LOG_WARNING,
+                                                kMessage);
+        snprintf(item->m_message, LOGLINE_MAX,
+                 "Dropped %" PREFIX64 "u log messages, the logging "
+                 "thread could not keep up",
+                 (unsigned long long)(dropped - m_reportedDrops));
+        m_reportedDrops = dropped;
+
+        fillItem(item);
+        handleItem(item);
+        logConsole(item);
+        item->DecrRef();
+    }
+
+    return handled;
+}
+
 /// \brief  Handles each LoggingItem.  There is a special case for
 ///         thread registration and deregistration which are also included in
 ///         the logging queue to keep the thread names in sync with the log
@@ -517,14 +757,14 @@ bool LoggerThread::flush(int timeoutMS)
 {
     QElapsedTimer t;
     t.start();
-    while (!m_aborted && !logQueue.isEmpty() && !t.hasExpired(timeoutMS))
+    while (!m_aborted && !log_rings_empty() && !t.hasExpired(timeoutMS))
     {
         m_waitNotEmpty->wakeAll();
         int left = timeoutMS - t.elapsed();
         if (left > 0)
             m_waitEmpty->wait(&logQueueMutex, left);
     }
-    return logQueue.isEmpty();
+    return log_rings_empty();
 }
 
 void LoggerThread::fillItem(LoggingItem *item)
@@ -558,6 +798,17 @@ LoggingItem *LoggingItem::create(const char *_file,
     return item;
 }
 
+/// \brief  Create a LoggingItem from a message taken off a thread's ring
+/// \param  record  the message
+/// \param  threadId Qt thread ID of the thread that logged it
+/// \param  tid     OS thread ID of the thread that logged it
+/// \return LoggingItem that was created
+LoggingItem *LoggingItem::create(const LogRing::Record &record,
+                                 qulonglong threadId, qlonglong tid)
+{
+    return new LoggingItem(record, threadId, tid);
+}
+
 LoggingItem *LoggingItem::create(QByteArray &buf)
 {
     // Deserialize buffer
@@ -570,11 +821,14 @@ LoggingItem *LoggingItem::create(QByteArray &buf)
 }
 
 
-/// \brief  Format and send a log message into the queue.  This is called from
-///         the LOG() macro.  The intention is minimal blocking of the caller.
+/// \brief  Format and put a log message on the calling thread's ring.  This
+///         is called from the LOG() macro.  It takes no locks and allocates
+///         nothing once the thread has logged its first message, if the
+///         ring is full the message is dropped and counted instead.
 /// \param  mask    Verbosity mask of the message (VB_*)
 /// \param  level   Log level of this message (LOG_* - matching syslog levels)
-/// \param  file    Filename of source code logging the message
+/// \param  file    Filename of source code logging the message, this and
+///                 function must be string literals
 /// \param  line    Line number within the source of log message source
 /// \param  function    Function name of the log message source
 /// \param  fromQString true if this message originated from QString
@@ -585,55 +839,29 @@ void LogPrintLine( uint64_t mask, LogLevel_t level, const char *file, int line,
                    const char *function, int fromQString,
                    const char *format, ... )
 {
-    va_list         arguments;
-
     int type = kMessage;
     type |= (mask & VB_FLUSH) ? kFlush : 0;
     type |= (mask & VB_STDIO) ? kStandardIO : 0;
-    LoggingItem *item = LoggingItem::create(file, function, line, level,
-                                            (LoggingType)type);
-    if (!item)
-        return;
 
-    char *formatcopy = nullptr;
-    if( fromQString && strchr(format, '%') )
+    if (fromQString)
     {
-        QString string(format);
-        format = strdup(string.replace(logRegExp, "%%").toLocal8Bit()
-                              .constData());
-        formatcopy = (char *)format;
+        log_ring_push(type, level, file, line, function, format, nullptr);
+    }
+    else
+    {
+        va_list arguments;
+        va_start(arguments, format);
+        log_ring_push(type, level, file, line, function, format, &arguments);
+        va_end(arguments);
     }
-
-    va_start(arguments, format);
-    vsnprintf(item->m_message, LOGLINE_MAX, format, arguments);
-    va_end(arguments);
-
-    if (formatcopy)
-        free(formatcopy);
-
-    QMutexLocker qLock(&logQueueMutex);
-
-#if defined( _MSC_VER ) && defined( _DEBUG )
-        OutputDebugStringA( item->m_message );
-        OutputDebugStringA( "\n" );
-#endif
-
-    logQueue.enqueue(item);
 
     if (logThread && logThreadFinished && !logThread->isRunning())
     {
-        while (!logQueue.isEmpty())
-        {
-            item = logQueue.dequeue();
-            qLock.unlock();
-            logThread->handleItem(item);
-            logThread->logConsole(item);
-            item->DecrRef();
-            qLock.relock();
-        }
+        logThread->drainRings();
     }
     else if (logThread && !logThreadFinished && (type & kFlush))
     {
+        QMutexLocker qLock(&logQueueMutex);
         logThread->flush();
     }
 }
@@ -767,16 +995,9 @@ void loggingRegisterThread(const QString &name)
     if (logThreadFinished)
         return;
 
-    QMutexLocker qLock(&logQueueMutex);
-
-    LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__,
-                                            __LINE__, LOG_DEBUG,
-                                            kRegistering);
-    if (item)
-    {
-        item->setThreadName((char *)name.toLocal8Bit().constData());
-        logQueue.enqueue(item);
-    }
+    QByteArray ba = name.toLocal8Bit();
+    log_ring_push(kRegistering, LOG_DEBUG, __FILE__, __LINE__, __FUNCTION__,
+                  ba.constData(), nullptr);
 }
 
 /// \brief  Deregister the current thread's name.  This is triggered by the
@@ -786,13 +1007,19 @@ void loggingDeregisterThread(void)
     if (logThreadFinished)
         return;
 
-    QMutexLocker qLock(&logQueueMutex);
+    log_ring_push(kDeregistering, LOG_DEBUG, __FILE__, __LINE__, __FUNCTION__,
+                  "", nullptr);
+}
 
-    LoggingItem *item = LoggingItem::create(__FILE__, __FUNCTION__, __LINE__,
-                                            LOG_DEBUG,
-                                            kDeregistering);
-    if (item)
-        logQueue.enqueue(item);
+/// \brief  Get the number of log messages dropped because a thread's ring
+///         was full
+uint64_t logDroppedCount(void)
+{
+    QMutexLocker locker(&logRingsMutex);
+    uint64_t dropped = logRingsDropped;
+    for (const auto *ring : logRings)
+        dropped += ring->m_ring.Dropped();
+    return dropped;
 }
 
 
@@ -16,6 +16,7 @@
 #include "mythsignalingtimer.h"
 #include "mthread.h"
 #include "referencecounter.h"
+#include "logring.h"
 #include "compat.h"
 
 #ifdef _MSC_VER
@@ -89,6 +90,8 @@ class LoggingItem: public QObject, public ReferenceCounter
     void setThreadTid(void);
     static LoggingItem *create(const char *_file, const char *_function, int _line, LogLevel_t _level,
                                LoggingType _type);
+    static LoggingItem *create(const LogRing::Record &record,
+                               qulonglong threadId, qlonglong tid);
     static LoggingItem *create(QByteArray &buf);
     QByteArray toByteArray(void);
 
@@ -161,12 +164,14 @@ class LoggingItem: public QObject, public ReferenceCounter
         : ReferenceCounter("LoggingItem", false) {};
     LoggingItem(const char *_file, const char *_function,
                 int _line, LogLevel_t _level, LoggingType _type);
+    LoggingItem(const LogRing::Record &record,
+                qulonglong threadId, qlonglong tid);
     ~LoggingItem() override;
     Q_DISABLE_COPY(LoggingItem);
 };
 
-/// \brief The logging thread that consumes the logging queue and dispatches
-///        each LoggingItem
+/// \brief The logging thread that consumes the per-thread logging rings and
+///        dispatches each LoggingItem
 class LoggerThread : public QObject, public MThread
 {
     Q_OBJECT
@@ -180,6 +185,10 @@ class LoggerThread : public QObject, public MThread
     void run(void) override; // MThread
     void stop(void);
     bool flush(int timeoutMS = 200000);
+    bool drainRings(void);
+    /// Wakes the thread if it is waiting for messages, the caller
+    /// must hold logQueueMutex.
+    void wakeUp(void) { m_waitNotEmpty->wakeAll(); }
     static void handleItem(LoggingItem *item);
     void fillItem(LoggingItem *item);
   private:
@@ -202,6 +211,8 @@ class LoggerThread : public QObject, public MThread
     QString m_tablename;   ///< Cached table name for db logging
     int     m_facility;    ///< Cached syslog facility (or -1 to disable)
     pid_t   m_pid;         ///< Cached pid value
+    uint64_t m_reportedDrops {0}; ///< Dropped messages already reported.
+                                  ///  Protected by logDrainMutex
 
   protected:
     bool logConsole(LoggingItem *item);
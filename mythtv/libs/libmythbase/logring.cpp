@@ -0,0 +1,75 @@
+// MythTV headers
+#include "logring.h"
+
+LogRing::LogRing(size_t size) :
+    m_buffer(Align(size) / sizeof(uint64_t))
+{
+}
+
+LogRing::Record *LogRing::Reserve(size_t maxMessage)
+{
+    size_t   size = Size();
+    size_t   need = Align(sizeof(Record) + maxMessage + 1);
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    uint64_t tail = m_tail.load(std::memory_order_acquire);
+
+    // Records are never split, if this one doesn't fit before the end of
+    // the buffer the rest of the buffer is skipped. A gap too small for a
+    // header is skipped by the consumer without being marked.
+    size_t contiguous = size - (head % size);
+    size_t skip = (contiguous < need) ? contiguous : 0;
+
+    if (need > size || size - (head - tail) < skip + need)
+        return nullptr;
+
+    if (skip >= sizeof(Record))
+    {
+        auto *pad = reinterpret_cast<Record*>(At(head));
+        pad->m_size = skip;
+        pad->m_type = 0;
+    }
+
+    m_reserved = head + skip;
+    return reinterpret_cast<Record*>(At(m_reserved));
+}
+
+void LogRing::Commit(Record *record, size_t msgLen)
+{
+    record->m_size = Align(sizeof(Record) + msgLen + 1);
+    m_head.store(m_reserved + record->m_size, std::memory_order_release);
+}
+
+const LogRing::Record *LogRing::Front(void)
+{
+    size_t   size = Size();
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    uint64_t head = m_head.load(std::memory_order_acquire);
+    const Record *record = nullptr;
+
+    while (tail != head)
+    {
+        size_t contiguous = size - (tail % size);
+        if (contiguous < sizeof(Record))
+        {
+            tail += contiguous;
+            continue;
+        }
+
+        record = reinterpret_cast<const Record*>(At(tail));
+        if (record->m_type != 0)
+            break;
+
+        tail += record->m_size;
+        record = nullptr;
+    }
+
+    m_tail.store(tail, std::memory_order_release);
+    return record;
+}
+
+void LogRing::Pop(void)
+{
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    const auto *record = reinterpret_cast<const Record*>(At(tail));
+    m_tail.store(tail + record->m_size, std::memory_order_release);
+}
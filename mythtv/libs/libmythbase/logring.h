@@ -0,0 +1,85 @@
+#ifndef LOGRING_H_
+#define LOGRING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <QtGlobal>
+
+#include "mythbaseexp.h"  //  MBASE_PUBLIC , etc.
+
+/** \brief Single producer, single consumer ring of log records.
+ *
+ *  Every thread that logs gets its own ring, so putting a message on it
+ *  takes no lock and allocates nothing. The records are variable length,
+ *  a fixed header followed by the formatted message, so a ring of a few
+ *  tens of KB holds hundreds of typical lines. When the ring is full the
+ *  message is dropped and counted rather than blocking the caller.
+ *
+ *  Only the owning thread may call Reserve(), Commit() and CountDrop(),
+ *  and only one thread at a time may call Front() and Pop().
+ */
+class MBASE_PUBLIC LogRing
+{
+  public:
+    class Record
+    {
+      public:
+        uint32_t    m_size;     ///< bytes used in the ring, header included
+        int32_t     m_type;     ///< LoggingType, 0 for padding at the end
+        uint64_t    m_seq;      ///< orders records from different rings
+        qlonglong   m_epoch;
+        uint32_t    m_usec;
+        int32_t     m_line;
+        int32_t     m_level;
+        const char *m_file;     ///< must be a string literal
+        const char *m_function; ///< must be a string literal
+
+        char *Message(void)
+            { return reinterpret_cast<char*>(this + 1); }
+        const char *Message(void) const
+            { return reinterpret_cast<const char*>(this + 1); }
+    };
+
+    static const size_t kDefaultSize = 64 * 1024;
+
+    explicit LogRing(size_t size = kDefaultSize);
+
+    /// Returns a record with room for a message of up to maxMessage
+    /// bytes plus the terminating NUL, or nullptr if the ring is full.
+    Record *Reserve(size_t maxMessage);
+    /// Makes the last reserved record, with a message of msgLen bytes
+    /// (not counting the NUL), visible to the consumer.
+    void Commit(Record *record, size_t msgLen);
+    void CountDrop(void)
+        { m_dropped.fetch_add(1, std::memory_order_relaxed); }
+
+    /// Returns the oldest record, or nullptr if the ring is empty.
+    const Record *Front(void);
+    /// Releases the record returned by Front().
+    void Pop(void);
+
+    bool IsEmpty(void) const
+        { return m_tail.load(std::memory_order_acquire) ==
+                 m_head.load(std::memory_order_acquire); }
+    uint64_t Dropped(void) const
+        { return m_dropped.load(std::memory_order_relaxed); }
+    size_t Size(void) const { return m_buffer.size() * sizeof(uint64_t); }
+
+  private:
+    Q_DISABLE_COPY(LogRing)
+
+    static size_t Align(size_t size) { return (size + 7) & ~size_t(7); }
+    char *At(uint64_t pos)
+        { return reinterpret_cast<char*>(m_buffer.data()) + (pos % Size()); }
+
+    std::vector<uint64_t>  m_buffer;      // uint64_t keeps records aligned
+    std::atomic<uint64_t>  m_head    {0}; ///< written by the producer
+    std::atomic<uint64_t>  m_tail    {0}; ///< written by the consumer
+    uint64_t               m_reserved {0}; ///< producer only
+    std::atomic<uint64_t>  m_dropped {0}; ///< written by the producer
+};
+
+#endif
@@ -306,18 +306,20 @@ MythCoreContext::~MythCoreContext()
 bool MythCoreContext::SetupCommandSocket(MythSocket *serverSock,
                                          const QString &announcement,
                                          uint timeout_in_ms,
-                                         bool &proto_mismatch)
+                                         bool &proto_mismatch,
+                                         bool pipeline)
 {
     proto_mismatch = false;
 
 #ifndef IGNORE_PROTO_VER_MISMATCH
-    if (!CheckProtoVersion(serverSock, timeout_in_ms, true))
+    if (!CheckProtoVersion(serverSock, timeout_in_ms, true, pipeline))
     {
         proto_mismatch = true;
         return false;
     }
 #else
     Q_UNUSED(timeout_in_ms);
+    Q_UNUSED(pipeline);
 #endif
 
     QStringList strlist(announcement);
@@ -393,8 +395,10 @@ bool MythCoreContext::ConnectToMasterServer(bool blockingClient,
         QString ann = QString("ANN %1 %2 %3")
             .arg(type)
             .arg(d->m_localHostname).arg(false);
+        // Requests from all threads go over this socket, let them
+        // overlap if the backend supports it.
         d->m_serverSock = ConnectCommandSocket(
-            server, port, ann, &proto_mismatch);
+            server, port, ann, &proto_mismatch, -1, -1, true);
     }
 
     if (!d->m_serverSock)
@@ -433,7 +437,7 @@ bool MythCoreContext::ConnectToMasterServer(bool blockingClient,
 
 MythSocket *MythCoreContext::ConnectCommandSocket(
     const QString &hostname, int port, const QString &announce,
-    bool *p_proto_mismatch, int maxConnTry, int setup_timeout)
+    bool *p_proto_mismatch, int maxConnTry, int setup_timeout, bool pipeline)
 {
     MythSocket *serverSock = nullptr;
 
@@ -475,8 +479,8 @@ MythSocket *MythCoreContext::ConnectCommandSocket(
         int sleepms = 0;
         if (serverSock->ConnectToHost(hostname, port))
         {
-            if (SetupCommandSocket(
-                    serverSock, announce, setup_timeout, proto_mismatch))
+            if (SetupCommandSocket(serverSock, announce, setup_timeout,
+                                   proto_mismatch, pipeline))
             {
                 break;
             }
@@ -1338,6 +1342,10 @@ bool MythCoreContext::IsUIThread(void)
 /**
  *  \brief Send a message to the backend and wait for a response.
  *
+ *  If the backend supports pipelining, requests from several threads
+ *  share the connection without waiting for each other's responses.
+ *  Otherwise they are sent one at a time.
+ *
  *  \param strlist      A QStringList used for both sending commands
  *                      to the backend and receiving responses from
  *                      the backend.
@@ -1386,9 +1394,24 @@ bool MythCoreContext::SendReceiveStringList(
         QStringList sendstrlist = strlist;
         uint timeout = quickTimeout ?
             MythSocket::kShortTimeout : MythSocket::kLongTimeout;
-        ok = d->m_serverSock->SendReceiveStringList(strlist, 0, timeout);
 
-        if (!ok)
+        MythSocket *sock = d->m_serverSock;
+        bool pipelined = sock->IsPipelined();
+        if (pipelined)
+        {
+            // The backend matches up requests and replies, so other
+            // threads can use the socket while we wait for ours.
+            sock->IncrRef();
+            locker.unlock();
+            ok = sock->SendReceiveStringList(strlist, 0, timeout);
+            locker.relock();
+        }
+        else
+        {
+            ok = sock->SendReceiveStringList(strlist, 0, timeout);
+        }
+
+        if (!ok && sock == d->m_serverSock)
         {
             LOG(VB_GENERAL, LOG_NOTICE, LOC +
                 QString("Connection to backend server lost"));
@@ -1400,21 +1423,28 @@ bool MythCoreContext::SendReceiveStringList(
                 d->m_eventSock->DecrRef();
                 d->m_eventSock = nullptr;
             }
+        }
 
-            if (block)
-            {
+        if (!ok && block)
+        {
+            // Another thread may have reconnected already
+            if (!d->m_serverSock)
                 ConnectToMasterServer(d->m_blockingClient);
 
-                if (d->m_serverSock)
-                {
-                    ok = d->m_serverSock->SendReceiveStringList(
-                        strlist, 0, timeout);
-                }
+            if (d->m_serverSock)
+            {
+                strlist = sendstrlist;
+                ok = d->m_serverSock->SendReceiveStringList(
+                    strlist, 0, timeout);
             }
         }
 
+        if (pipelined)
+            sock->DecrRef();
+
         // this should not happen
-        while (ok && strlist[0] == "BACKEND_MESSAGE")
+        while (ok && d->m_serverSock && !d->m_serverSock->IsPipelined() &&
+               strlist[0] == "BACKEND_MESSAGE")
         {
             // oops, not for us
             LOG(VB_GENERAL, LOG_EMERG, LOC + "SRSL you shouldn't see this!!");
@@ -1647,14 +1677,19 @@ void MythCoreContext::connectionClosed(MythSocket *sock)
 }
 
 bool MythCoreContext::CheckProtoVersion(MythSocket *socket, uint timeout_ms,
-                                        bool error_dialog_desired)
+                                        bool error_dialog_desired,
+                                        bool pipeline)
 {
     if (!socket)
         return false;
 
-    QStringList strlist(QString("MYTH_PROTO_VERSION %1 %2")
-                        .arg(MYTH_PROTO_VERSION)
-                        .arg(QString::fromUtf8(MYTH_PROTO_TOKEN)));
+    QString version = QString("MYTH_PROTO_VERSION %1 %2 %3")
+        .arg(MYTH_PROTO_VERSION)
+        .arg(QString::fromUtf8(MYTH_PROTO_TOKEN))
+        .arg(MythSocketFraming::kBinaryToken);
+    if (pipeline)
+        version += QString(" ") + MythSocketFraming::kPipelineToken;
+    QStringList strlist(version);
     socket->WriteStringList(strlist);
 
     if (!socket->ReadStringList(strlist, timeout_ms) || strlist.empty())
@@ -1694,6 +1729,16 @@ bool MythCoreContext::CheckProtoVersion(MythSocket *socket, uint timeout_ms,
                                 .arg(QString::fromUtf8(MYTH_PROTO_TOKEN)));
         }
 
+        // Older backends ignore the framing and pipeline tokens and reply
+        // with a plain ACCEPT, in which case we keep the legacy framing
+        // and send one request at a time.
+        if (strlist.size() >= 3 &&
+            strlist[2] == MythSocketFraming::kBinaryToken)
+            socket->SetFramingMode(MythSocketFraming::kBinary);
+        if (pipeline &&
+            strlist.mid(2).contains(MythSocketFraming::kPipelineToken))
+            socket->SetPipelineMode(MythSocket::kPipelineClient);
+
         return true;
     }
 
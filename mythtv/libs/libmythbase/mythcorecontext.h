@@ -72,16 +72,19 @@ class MBASE_PUBLIC MythCoreContext : public QObject, public MythObservable, publ
                                      const QString &announcement,
                                      bool *proto_mismatch = nullptr,
                                      int maxConnTry = -1,
-                                     int setup_timeout = -1);
+                                     int setup_timeout = -1,
+                                     bool pipeline = false);
 
     MythSocket *ConnectEventSocket(const QString &hostname, int port);
 
     bool SetupCommandSocket(MythSocket *serverSock, const QString &announcement,
-                            uint timeout_in_ms, bool &proto_mismatch);
+                            uint timeout_in_ms, bool &proto_mismatch,
+                            bool pipeline = false);
 
     bool CheckProtoVersion(MythSocket *socket,
                            uint timeout_ms = kMythSocketLongTimeout,
-                           bool error_dialog_desired = false);
+                           bool error_dialog_desired = false,
+                           bool pipeline = false);
 
     static QString GenMythURL(const QString& host = QString(), int port = 0,
                               QString path = QString(),
@@ -1,7 +1,9 @@
+#include <atomic>
+#include <memory>
 #include <vector>
 using namespace std;
 
-#include <QReadWriteLock>
+#include <QElapsedTimer>
 #include <QTextStream>
 #include <QSqlError>
 #include <QMutex>
@@ -14,12 +16,12 @@ using namespace std;
 #include "mythlogging.h"
 #include "mythdirs.h"
 #include "mythcorecontext.h"
+#include "mythtimingstats.h"
 
 static MythDB *mythdb = nullptr;
 static QMutex dbLock;
 
 // For thread safety reasons this is not a QString
-const char *kSentinelValue = "<settings_sentinel_value>";
 const char *kClearSettingValue = "<clear_setting_value>";
 
 MythDB *MythDB::getMythDB(void)
@@ -60,7 +62,25 @@ struct SingleSetting
     QString m_host;
 };
 
-using SettingsMap = QHash<QString,QString>;
+/// A setting as held in the settings cache. The numeric forms are parsed
+/// once when the value is cached rather than on every lookup.
+class CachedSetting
+{
+  public:
+    CachedSetting() = default;
+    explicit CachedSetting(const QString &value) :
+        m_value(value), m_int(value.toInt()), m_double(value.toDouble()),
+        m_exists(true) { m_value.squeeze(); }
+
+    QString m_value;
+    int     m_int    {0};
+    double  m_double {0.0};
+    bool    m_exists {false}; ///< false caches that the setting isn't set
+};
+
+using SettingsMap = QHash<QString,CachedSetting>;
+using SettingsSnapshot = std::shared_ptr<const SettingsMap>;
+using OverrideMap = QHash<QString,QString>;
 
 class MythDBPrivate
 {
@@ -68,6 +88,13 @@ class MythDBPrivate
     MythDBPrivate();
    ~MythDBPrivate();
 
+    SettingsSnapshot GetSettingsSnapshot(void);
+    void SetSettingsSnapshot(SettingsMap map);
+    SettingsMap CopySettingsSnapshot(void);
+    uint GetSettingsGeneration(void);
+    bool FindPendingSetting(const QString &cacheKey, CachedSetting &setting);
+    void CacheSettings(const SettingsMap &settings, uint generation);
+
     DatabaseParams  m_dbParams;  ///< Current database host & WOL details
     QString m_localhostname;
     MDBManager m_dbmanager;
@@ -75,12 +102,30 @@ class MythDBPrivate
     bool m_ignoreDatabase {false};
     bool m_suppressDBMessages {true};
 
-    QReadWriteLock m_settingsCacheLock;
-    volatile bool m_useSettingsCache {false};
-    /// Permanent settings in the DB and overridden settings
-    SettingsMap m_settingsCache;
-    /// Overridden this session only
-    SettingsMap m_overriddenSettings;
+    /// Permanent settings in the DB and overridden settings. Writers copy
+    /// the current snapshot, change the copy and swap it in while holding
+    /// m_settingsCacheLock. Each swap gets a new m_snapshotVersion; readers
+    /// keep a per thread reference to the snapshot they last used and only
+    /// take m_snapshotLock to pick up a newer one. Only access it through
+    /// GetSettingsSnapshot() and SetSettingsSnapshot().
+    SettingsSnapshot m_settingsCache;
+    QMutex m_snapshotLock;
+    std::atomic<uint64_t> m_snapshotVersion {0};
+    QMutex m_settingsCacheLock;
+    /// Settings read from the database that aren't in the snapshot yet,
+    /// protected by m_settingsCacheLock. Published in batches so a run of
+    /// misses doesn't copy the whole cache for each of them.
+    SettingsMap m_pendingSettings;
+    QElapsedTimer m_pendingAge;
+    /// Incremented whenever cached settings are removed or overridden, a
+    /// value read from the database is only cached if this didn't change
+    /// while it was being read.
+    uint m_settingsGeneration {0};
+    std::atomic<bool> m_useSettingsCache {false};
+    /// Number of settings read from the database since the cache was cleared
+    std::atomic<uint64_t> m_settingsLoads {0};
+    /// Overridden this session only, protected by m_settingsCacheLock
+    OverrideMap m_overriddenSettings;
     /// Settings which should be written to the database as soon as it becomes
     /// available
     QList<SingleSetting> m_delayedSettings;
@@ -89,12 +134,20 @@ class MythDBPrivate
     bool m_haveSchema {false};
 };
 
-static const int settings_reserve = 61;
+// Versions are unique across MythDBPrivate instances, so a thread's cached
+// snapshot can't be mistaken for another instance's.
+static std::atomic<uint64_t> s_snapshotVersions {0};
+
+// Settings read from the database are published once this many are
+// pending, or once the oldest has waited kPendingSettingsMs
+static const int    kPendingSettingsMax = 64;
+static const qint64 kPendingSettingsMs  = 1000;
 
 MythDBPrivate::MythDBPrivate()
+  : m_settingsCache(std::make_shared<const SettingsMap>()),
+    m_snapshotVersion(++s_snapshotVersions)
 {
     m_localhostname.clear();
-    m_settingsCache.reserve(settings_reserve);
 }
 
 MythDBPrivate::~MythDBPrivate()
@@ -102,6 +155,97 @@ MythDBPrivate::~MythDBPrivate()
     LOG(VB_DATABASE, LOG_INFO, "Destroying MythDBPrivate");
 }
 
+/// Returns the current settings snapshot. Lock free unless the snapshot
+/// has been replaced since this thread last looked.
+SettingsSnapshot MythDBPrivate::GetSettingsSnapshot(void)
+{
+    static thread_local uint64_t t_version = 0;
+    static thread_local SettingsSnapshot t_snapshot;
+
+    if (t_version != m_snapshotVersion.load(std::memory_order_acquire))
+    {
+        QMutexLocker locker(&m_snapshotLock);
+        t_snapshot = m_settingsCache;
+        t_version  = m_snapshotVersion.load(std::memory_order_relaxed);
+    }
+    return t_snapshot;
+}
+
+/// Replaces the settings snapshot. m_settingsCacheLock must be held.
+void MythDBPrivate::SetSettingsSnapshot(SettingsMap map)
+{
+    SettingsSnapshot snapshot =
+        std::make_shared<const SettingsMap>(std::move(map));
+
+    QMutexLocker locker(&m_snapshotLock);
+    m_settingsCache.swap(snapshot);
+    m_snapshotVersion.store(++s_snapshotVersions, std::memory_order_release);
+    // the old snapshot is released after the lock, by the last thread
+    // still holding it
+}
+
+/// Returns a copy of the settings snapshot with the pending settings
+/// merged in, for a writer to change. m_settingsCacheLock must be held.
+SettingsMap MythDBPrivate::CopySettingsSnapshot(void)
+{
+    SettingsMap map = *GetSettingsSnapshot();
+    // another thread may have inserted a value into the cache
+    // while we did not have the lock, keep that one
+    for (auto it = m_pendingSettings.cbegin();
+         it != m_pendingSettings.cend(); ++it)
+    {
+        if (!map.contains(it.key()))
+            map.insert(it.key(), *it);
+    }
+    m_pendingSettings.clear();
+    return map;
+}
+
+uint MythDBPrivate::GetSettingsGeneration(void)
+{
+    QMutexLocker locker(&m_settingsCacheLock);
+    return m_settingsGeneration;
+}
+
+/// Looks up a setting that has been read from the database but not yet
+/// published in the snapshot.
+bool MythDBPrivate::FindPendingSetting(const QString &cacheKey,
+                                       CachedSetting &setting)
+{
+    QMutexLocker locker(&m_settingsCacheLock);
+    SettingsMap::const_iterator it = m_pendingSettings.constFind(cacheKey);
+    if (it == m_pendingSettings.cend())
+        return false;
+    setting = *it;
+
+    // Don't leave a setting that is read repeatedly behind the lock
+    if (m_pendingAge.elapsed() >= kPendingSettingsMs)
+        SetSettingsSnapshot(CopySettingsSnapshot());
+    return true;
+}
+
+/// Adds settings read from the database to the cache, unless the cache
+/// was changed since generation was taken.
+void MythDBPrivate::CacheSettings(const SettingsMap &settings, uint generation)
+{
+    QMutexLocker locker(&m_settingsCacheLock);
+    if (!m_useSettingsCache || generation != m_settingsGeneration)
+        return;
+
+    if (m_pendingSettings.isEmpty())
+        m_pendingAge.start();
+    for (auto it = settings.cbegin(); it != settings.cend(); ++it)
+    {
+        if (!m_pendingSettings.contains(it.key()))
+            m_pendingSettings.insert(it.key(), *it);
+    }
+
+    if (settings.size() > 1 ||
+        m_pendingSettings.size() >= kPendingSettingsMax ||
+        m_pendingAge.elapsed() >= kPendingSettingsMs)
+        SetSettingsSnapshot(CopySettingsSnapshot());
+}
+
 MythDB::MythDB()
 {
     d = new MythDBPrivate();
@@ -367,144 +511,137 @@ bool MythDB::ClearSettingOnHost(const QString &key, const QString &host)
     return SaveSettingOnHost(key, kClearSettingValue, host);
 }
 
-QString MythDB::GetSetting(const QString &_key, const QString &defaultval)
+/** \brief Looks up a setting, in the cache if possible.
+ *
+ *  If hostOnly is false the value for host is returned, falling back to
+ *  the global value, and it is cached under key. Otherwise only the value
+ *  for host is looked up, and it is cached under "host key". Both key and
+ *  host must be lower case.
+ *
+ *  A setting that isn't set is cached too, and returned with m_exists
+ *  false. Returns false if the database couldn't be read.
+ */
+bool MythDB::FindSetting(const QString &key, const QString &host,
+                         bool hostOnly, CachedSetting &setting)
 {
-    QString key = _key.toLower();
-    QString value = defaultval;
+    QString cacheKey = hostOnly ? host + ' ' + key : key;
 
-    d->m_settingsCacheLock.lockForRead();
-    if (d->m_useSettingsCache)
-    {
-        SettingsMap::const_iterator it = d->m_settingsCache.find(key);
-        if (it != d->m_settingsCache.end())
-        {
-            value = *it;
-            d->m_settingsCacheLock.unlock();
-            return value;
-        }
-    }
-    SettingsMap::const_iterator it = d->m_overriddenSettings.find(key);
-    if (it != d->m_overriddenSettings.end())
+    SettingsSnapshot snapshot = d->GetSettingsSnapshot();
+    SettingsMap::const_iterator it = snapshot->constFind(cacheKey);
+    if (it != snapshot->cend())
     {
-        value = *it;
-        d->m_settingsCacheLock.unlock();
-        return value;
+        setting = *it;
+        return true;
     }
-    d->m_settingsCacheLock.unlock();
+    snapshot.reset();
 
-    if (d->m_ignoreDatabase || !HaveValidDatabase())
-        return value;
+    if (d->FindPendingSetting(cacheKey, setting))
+        return true;
+
+    if (d->m_ignoreDatabase || (!hostOnly && !HaveValidDatabase()))
+        return false;
 
     MSqlQuery query(MSqlQuery::InitCon());
     if (!query.isConnected())
-        return value;
+    {
+        if (hostOnly && !d->m_suppressDBMessages)
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Database not open while trying to "
+                        "load setting: %1").arg(key));
+        }
+        return false;
+    }
+
+    uint generation = d->GetSettingsGeneration();
+    QElapsedTimer timer;
+    timer.start();
 
     query.prepare(
         "SELECT data "
         "FROM settings "
         "WHERE value = :KEY AND hostname = :HOSTNAME");
     query.bindValue(":KEY", key);
-    query.bindValue(":HOSTNAME", d->m_localhostname);
+    query.bindValue(":HOSTNAME", host);
+    if (!query.exec())
+        return false;
+    bool found = query.next();
 
-    if (query.exec() && query.next())
-    {
-        value = query.value(0).toString();
-    }
-    else
+    if (!found && !hostOnly)
     {
         query.prepare(
             "SELECT data "
             "FROM settings "
             "WHERE value = :KEY AND hostname IS NULL");
         query.bindValue(":KEY", key);
-
-        if (query.exec() && query.next())
-        {
-            value = query.value(0).toString();
-        }
+        if (!query.exec())
+            return false;
+        found = query.next();
     }
 
-    if (d->m_useSettingsCache && value != kSentinelValue)
+    setting = found ? CachedSetting(query.value(0).toString())
+                    : CachedSetting();
+
+    d->m_settingsLoads++;
+    static MythTimingStats *s_stats = MythTimingStats::Get("settings");
+    s_stats->Record(cacheKey, timer.nsecsElapsed() / 1000, found ? 1 : 0);
+
+    if (d->m_useSettingsCache)
     {
-        key.squeeze();
-        value.squeeze();
-        d->m_settingsCacheLock.lockForWrite();
-        // another thread may have inserted a value into the cache
-        // while we did not have the lock, check first then save
-        if (d->m_settingsCache.find(key) == d->m_settingsCache.end())
-            d->m_settingsCache[key] = value;
-        d->m_settingsCacheLock.unlock();
+        SettingsMap loaded;
+        cacheKey.squeeze();
+        loaded.insert(cacheKey, setting);
+        d->CacheSettings(loaded, generation);
     }
 
-    return value;
+    return true;
 }
 
-bool MythDB::GetSettings(QMap<QString,QString> &_key_value_pairs)
+QString MythDB::GetSetting(const QString &key, const QString &defaultval)
 {
-    QMap<QString,bool> done;
-    using KVIt = QMap<QString,QString>::iterator;
-    KVIt kvit = _key_value_pairs.begin();
-    for (; kvit != _key_value_pairs.end(); ++kvit)
-        done[kvit.key().toLower()] = false;
-
-    QMap<QString,bool>::iterator dit = done.begin();
-    kvit = _key_value_pairs.begin();
+    CachedSetting setting;
+    if (FindSetting(key.toLower(), d->m_localhostname, false, setting) &&
+        setting.m_exists)
+        return setting.m_value;
+    return defaultval;
+}
 
+bool MythDB::GetSettings(QMap<QString,QString> &_key_value_pairs)
+{
+    // Keys that aren't cached, lower case, and where their value goes
+    QMap<QString,QString*> keymap;
     {
-        uint done_cnt = 0;
-        d->m_settingsCacheLock.lockForRead();
-        if (d->m_useSettingsCache)
-        {
-            for (; kvit != _key_value_pairs.end(); ++dit, ++kvit)
-            {
-                SettingsMap::const_iterator it = d->m_settingsCache.find(dit.key());
-                if (it != d->m_settingsCache.end())
-                {
-                    *kvit = *it;
-                    *dit = true;
-                    done_cnt++;
-                }
-            }
-        }
-        for (; kvit != _key_value_pairs.end(); ++dit, ++kvit)
+        SettingsSnapshot snapshot = d->GetSettingsSnapshot();
+        for (auto kvit = _key_value_pairs.begin();
+             kvit != _key_value_pairs.end(); ++kvit)
         {
-            SettingsMap::const_iterator it =
-                d->m_overriddenSettings.find(dit.key());
-            if (it != d->m_overriddenSettings.end())
-            {
-                *kvit = *it;
-                *dit = true;
-                done_cnt++;
-            }
+            QString key = kvit.key().toLower();
+            SettingsMap::const_iterator it = snapshot->constFind(key);
+            if (it == snapshot->cend())
+                keymap[key] = &(*kvit);
+            else if (it->m_exists)
+                *kvit = it->m_value;
         }
-        d->m_settingsCacheLock.unlock();
-
-        // Avoid extra work if everything was in the caches and
-        // also don't try to access the DB if m_ignoreDatabase is set
-        if (((uint)done.size()) == done_cnt || d->m_ignoreDatabase)
-            return true;
     }
 
-    dit = done.begin();
-    kvit = _key_value_pairs.begin();
+    // Avoid extra work if everything was in the cache and
+    // also don't try to access the DB if m_ignoreDatabase is set
+    if (keymap.isEmpty() || d->m_ignoreDatabase)
+        return true;
 
     QString keylist("");
-    QMap<QString,KVIt> keymap;
-    for (; kvit != _key_value_pairs.end(); ++dit, ++kvit)
+    for (auto it = keymap.begin(); it != keymap.end(); )
     {
-        if (*dit)
-            continue;
-
-        const QString& key = dit.key();
-        if (!key.contains("'"))
+        if (!it.key().contains("'"))
         {
-            keylist += QString("'%1',").arg(key);
-            keymap[key] = kvit;
+            keylist += QString("'%1',").arg(it.key());
+            ++it;
         }
         else
         {   // hopefully no one actually uses quotes for in a settings key.
             // but in case they do, just get that value inefficiently..
-            *kvit = GetSetting(key, *kvit);
+            **it = GetSetting(it.key(), **it);
+            it = keymap.erase(it);
         }
     }
 
@@ -513,14 +650,17 @@ bool MythDB::GetSettings(QMap<QString,QString> &_key_value_pairs)
 
     keylist = keylist.left(keylist.length() - 1);
 
+    uint generation = d->GetSettingsGeneration();
+    QElapsedTimer timer;
+    timer.start();
+
     MSqlQuery query(MSqlQuery::InitCon());
     if (!query.exec(
             QString(
                 "SELECT value, data, hostname "
                 "FROM settings "
                 "WHERE (hostname = '%1' OR hostname IS NULL) AND "
-                "      value IN (%2) "
-                "ORDER BY hostname DESC")
+                "      value IN (%2) ")
             .arg(d->m_localhostname).arg(keylist)))
     {
         if (!d->m_suppressDBMessages)
@@ -528,198 +668,128 @@ bool MythDB::GetSettings(QMap<QString,QString> &_key_value_pairs)
         return false;
     }
 
+    // The host's own value wins over the global one, as in GetSetting()
+    SettingsMap loaded;
     while (query.next())
     {
         QString key = query.value(0).toString().toLower();
-        QMap<QString,KVIt>::const_iterator it = keymap.find(key);
-        if (it != keymap.end())
-            **it = query.value(1).toString();
+        if (!keymap.contains(key))
+            continue;
+        if (query.value(2).isNull() && loaded.contains(key))
+            continue;
+        loaded[key] = CachedSetting(query.value(1).toString());
     }
 
-    if (d->m_useSettingsCache)
+    for (auto it = keymap.cbegin(); it != keymap.cend(); ++it)
     {
-        d->m_settingsCacheLock.lockForWrite();
-        QMap<QString,KVIt>::const_iterator it = keymap.begin();
-        for (; it != keymap.end(); ++it)
-        {
-            QString key = it.key();
-            QString value = **it;
-
-            // another thread may have inserted a value into the cache
-            // while we did not have the lock, check first then save
-            if (d->m_settingsCache.find(key) == d->m_settingsCache.end())
-            {
-                key.squeeze();
-                value.squeeze();
-                d->m_settingsCache[key] = value;
-            }
-        }
-        d->m_settingsCacheLock.unlock();
+        SettingsMap::iterator lit = loaded.find(it.key());
+        if (lit == loaded.end())
+            loaded.insert(it.key(), CachedSetting());
+        else
+            **it = lit->m_value;
     }
 
+    d->m_settingsLoads += keymap.size();
+    static MythTimingStats *s_stats = MythTimingStats::Get("settings");
+    s_stats->Record("GetSettings", timer.nsecsElapsed() / 1000, keymap.size());
+
+    if (d->m_useSettingsCache)
+        d->CacheSettings(loaded, generation);
+
     return true;
 }
 
 
 bool MythDB::GetBoolSetting(const QString &key, bool defaultval)
 {
-    QString val = QString::number(defaultval);
-    QString retval = GetSetting(key, val);
-
-    return retval.toInt() > 0;
+    CachedSetting setting;
+    if (FindSetting(key.toLower(), d->m_localhostname, false, setting) &&
+        setting.m_exists)
+        return setting.m_int > 0;
+    return defaultval;
 }
 
 int MythDB::GetNumSetting(const QString &key, int defaultval)
 {
-    QString val = QString::number(defaultval);
-    QString retval = GetSetting(key, val);
-
-    return retval.toInt();
+    CachedSetting setting;
+    if (FindSetting(key.toLower(), d->m_localhostname, false, setting) &&
+        setting.m_exists)
+        return setting.m_int;
+    return defaultval;
 }
 
 double MythDB::GetFloatSetting(const QString &key, double defaultval)
 {
-    QString val = QString::number(defaultval);
-    QString retval = GetSetting(key, val);
-
-    return retval.toDouble();
+    CachedSetting setting;
+    if (FindSetting(key.toLower(), d->m_localhostname, false, setting) &&
+        setting.m_exists)
+        return setting.m_double;
+    return defaultval;
 }
 
 QString MythDB::GetSetting(const QString &key)
 {
-    QString sentinel = QString(kSentinelValue);
-    QString retval = GetSetting(key, sentinel);
-    return (retval == sentinel) ? "" : retval;
+    return GetSetting(key, QString(""));
 }
 
 bool MythDB::GetBoolSetting(const QString &key)
 {
-    QString sentinel = QString(kSentinelValue);
-    QString retval = GetSetting(key, sentinel);
-    if (retval == sentinel)
-        return false;
-    return retval.toInt() > 0;
+    return GetBoolSetting(key, false);
 }
 
 int MythDB::GetNumSetting(const QString &key)
 {
-    QString sentinel = QString(kSentinelValue);
-    QString retval = GetSetting(key, sentinel);
-    return (retval == sentinel) ? 0 : retval.toInt();
+    return GetNumSetting(key, 0);
 }
 
 double MythDB::GetFloatSetting(const QString &key)
 {
-    QString sentinel = QString(kSentinelValue);
-    QString retval = GetSetting(key, sentinel);
-    return (retval == sentinel) ? 0.0 : retval.toDouble();
+    return GetFloatSetting(key, 0.0);
 }
 
-QString MythDB::GetSettingOnHost(const QString &_key, const QString &_host,
+QString MythDB::GetSettingOnHost(const QString &key, const QString &host,
                                  const QString &defaultval)
 {
-    QString key   = _key.toLower();
-    QString host  = _host.toLower();
-    QString value = defaultval;
-    QString myKey = host + ' ' + key;
-
-    d->m_settingsCacheLock.lockForRead();
-    if (d->m_useSettingsCache)
-    {
-        SettingsMap::const_iterator it = d->m_settingsCache.find(myKey);
-        if (it != d->m_settingsCache.end())
-        {
-            value = *it;
-            d->m_settingsCacheLock.unlock();
-            return value;
-        }
-    }
-    SettingsMap::const_iterator it = d->m_overriddenSettings.find(myKey);
-    if (it != d->m_overriddenSettings.end())
-    {
-        value = *it;
-        d->m_settingsCacheLock.unlock();
-        return value;
-    }
-    d->m_settingsCacheLock.unlock();
-
-    if (d->m_ignoreDatabase)
-        return value;
-
-    MSqlQuery query(MSqlQuery::InitCon());
-    if (!query.isConnected())
-    {
-        if (!d->m_suppressDBMessages)
-        {
-            LOG(VB_GENERAL, LOG_ERR,
-                QString("Database not open while trying to "
-                        "load setting: %1").arg(key));
-        }
-        return value;
-    }
-
-    query.prepare(
-        "SELECT data "
-        "FROM settings "
-        "WHERE value = :VALUE AND hostname = :HOSTNAME");
-    query.bindValue(":VALUE", key);
-    query.bindValue(":HOSTNAME", host);
-
-    if (query.exec() && query.next())
-    {
-        value = query.value(0).toString();
-    }
-
-    if (d->m_useSettingsCache && value != kSentinelValue)
-    {
-        myKey.squeeze();
-        value.squeeze();
-        d->m_settingsCacheLock.lockForWrite();
-        if (d->m_settingsCache.find(myKey) == d->m_settingsCache.end())
-            d->m_settingsCache[myKey] = value;
-        d->m_settingsCacheLock.unlock();
-    }
-
-    return value;
+    CachedSetting setting;
+    if (FindSetting(key.toLower(), host.toLower(), true, setting) &&
+        setting.m_exists)
+        return setting.m_value;
+    return defaultval;
 }
 
 int MythDB::GetNumSettingOnHost(const QString &key, const QString &host,
                                      int defaultval)
 {
-    QString val = QString::number(defaultval);
-    QString retval = GetSettingOnHost(key, host, val);
-
-    return retval.toInt();
+    CachedSetting setting;
+    if (FindSetting(key.toLower(), host.toLower(), true, setting) &&
+        setting.m_exists)
+        return setting.m_int;
+    return defaultval;
 }
 
 double MythDB::GetFloatSettingOnHost(
     const QString &key, const QString &host, double defaultval)
 {
-    QString val = QString::number(defaultval);
-    QString retval = GetSettingOnHost(key, host, val);
-
-    return retval.toDouble();
+    CachedSetting setting;
+    if (FindSetting(key.toLower(), host.toLower(), true, setting) &&
+        setting.m_exists)
+        return setting.m_double;
+    return defaultval;
 }
 
 QString MythDB::GetSettingOnHost(const QString &key, const QString &host)
 {
-    QString sentinel = QString(kSentinelValue);
-    QString retval = GetSettingOnHost(key, host, sentinel);
-    return (retval == sentinel) ? "" : retval;
+    return GetSettingOnHost(key, host, QString(""));
 }
 
 int MythDB::GetNumSettingOnHost(const QString &key, const QString &host)
 {
-    QString sentinel = QString(kSentinelValue);
-    QString retval = GetSettingOnHost(key, host, sentinel);
-    return (retval == sentinel) ? 0 : retval.toInt();
+    return GetNumSettingOnHost(key, host, 0);
 }
 
 double MythDB::GetFloatSettingOnHost(const QString &key, const QString &host)
 {
-    QString sentinel = QString(kSentinelValue);
-    QString retval = GetSettingOnHost(key, host, sentinel);
-    return (retval == sentinel) ? 0.0 : retval.toDouble();
+    return GetFloatSettingOnHost(key, host, 0.0);
 }
 
 void MythDB::GetResolutionSetting(const QString &type,
@@ -813,11 +883,14 @@ void MythDB::OverrideSettingForSession(
     mk2.squeeze();
     mv.squeeze();
 
-    d->m_settingsCacheLock.lockForWrite();
+    QMutexLocker locker(&d->m_settingsCacheLock);
     d->m_overriddenSettings[mk] = mv;
-    d->m_settingsCache[mk]      = mv;
-    d->m_settingsCache[mk2]     = mv;
-    d->m_settingsCacheLock.unlock();
+    d->m_settingsGeneration++;
+
+    SettingsMap map = d->CopySettingsSnapshot();
+    map[mk]  = CachedSetting(mv);
+    map[mk2] = CachedSetting(mv);
+    d->SetSettingsSnapshot(std::move(map));
 }
 
 /// \brief Clears session Overrides for the given setting.
@@ -826,31 +899,24 @@ void MythDB::ClearOverrideSettingForSession(const QString &key)
     QString mk = key.toLower();
     QString mk2 = d->m_localhostname + ' ' + mk;
 
-    d->m_settingsCacheLock.lockForWrite();
-
-    SettingsMap::iterator oit = d->m_overriddenSettings.find(mk);
-    if (oit != d->m_overriddenSettings.end())
-        d->m_overriddenSettings.erase(oit);
+    QMutexLocker locker(&d->m_settingsCacheLock);
+    d->m_overriddenSettings.remove(mk);
+    d->m_settingsGeneration++;
 
-    SettingsMap::iterator sit = d->m_settingsCache.find(mk);
-    if (sit != d->m_settingsCache.end())
-        d->m_settingsCache.erase(sit);
-
-    sit = d->m_settingsCache.find(mk2);
-    if (sit != d->m_settingsCache.end())
-        d->m_settingsCache.erase(sit);
-
-    d->m_settingsCacheLock.unlock();
+    SettingsMap map = d->CopySettingsSnapshot();
+    map.remove(mk);
+    map.remove(mk2);
+    d->SetSettingsSnapshot(std::move(map));
 }
 
 static void clear(
-    SettingsMap &cache, SettingsMap &overrides, const QString &myKey)
+    SettingsMap &cache, const OverrideMap &overrides, const QString &myKey)
 {
     // Do the actual clearing..
     SettingsMap::iterator it = cache.find(myKey);
     if (it != cache.end())
     {
-        SettingsMap::const_iterator oit = overrides.find(myKey);
+        OverrideMap::const_iterator oit = overrides.find(myKey);
         if (oit == overrides.end())
         {
             LOG(VB_DATABASE, LOG_INFO,
@@ -868,36 +934,42 @@ static void clear(
 
 void MythDB::ClearSettingsCache(const QString &_key)
 {
-    d->m_settingsCacheLock.lockForWrite();
+    QMutexLocker locker(&d->m_settingsCacheLock);
+    d->m_settingsGeneration++;
 
+    SettingsMap map;
     if (_key.isEmpty())
     {
-        LOG(VB_DATABASE, LOG_INFO, "Clearing Settings Cache.");
-        d->m_settingsCache.clear();
-        d->m_settingsCache.reserve(settings_reserve);
-
-        SettingsMap::const_iterator it = d->m_overriddenSettings.begin();
-        for (; it != d->m_overriddenSettings.end(); ++it)
+        LOG(VB_DATABASE, LOG_INFO,
+            QString("Clearing Settings Cache, %1 settings were read from "
+                    "the database since it was last cleared.")
+                .arg(d->m_settingsLoads.exchange(0)));
+        d->m_pendingSettings.clear();
+
+        OverrideMap::const_iterator it = d->m_overriddenSettings.cbegin();
+        for (; it != d->m_overriddenSettings.cend(); ++it)
         {
             QString mk2 = d->m_localhostname + ' ' + it.key();
             mk2.squeeze();
 
-            d->m_settingsCache[it.key()] = *it;
-            d->m_settingsCache[mk2] = *it;
+            map[it.key()] = CachedSetting(*it);
+            map[mk2] = CachedSetting(*it);
         }
     }
     else
     {
+        map = d->CopySettingsSnapshot();
+
         QString myKey = _key.toLower();
-        clear(d->m_settingsCache, d->m_overriddenSettings, myKey);
+        clear(map, d->m_overriddenSettings, myKey);
 
         // To be safe always clear any local[ized] version too
         QString mkl = myKey.section(QChar(' '), 1);
         if (!mkl.isEmpty())
-            clear(d->m_settingsCache, d->m_overriddenSettings, mkl);
+            clear(map, d->m_overriddenSettings, mkl);
     }
 
-    d->m_settingsCacheLock.unlock();
+    d->SetSettingsSnapshot(std::move(map));
 }
 
 void MythDB::ActivateSettingsCache(bool activate)
@@ -10,6 +10,7 @@
 
 class MythDBPrivate;
 class MDBManager;
+class CachedSetting;
 
 class MBASE_PUBLIC MythDB
 {
@@ -94,6 +95,9 @@ class MBASE_PUBLIC MythDB
    ~MythDB();
 
   private:
+    bool FindSetting(const QString &key, const QString &host, bool hostOnly,
+                     CachedSetting &setting);
+
     MythDBPrivate *d {nullptr}; // NOLINT(readability-identifier-naming)
 };
 
@@ -3,9 +3,13 @@
 // ANSI C
 #include <cstdlib>
 
+// C++
+#include <algorithm>
+
 // Qt
 #include <QCoreApplication>
 #include <QElapsedTimer>
+#include <QRegularExpression>
 #include <QSemaphore>
 #include <QSqlDriver>
 #include <QSqlError>
@@ -26,6 +30,7 @@
 #include "mythdate.h"
 #include "portchecker.h"
 #include "mythmiscutil.h"
+#include "mythtimingstats.h"
 
 #define DEBUG_RECONNECT 0
 #if DEBUG_RECONNECT
@@ -33,6 +38,15 @@
 #endif
 
 static const uint kPurgeTimeout = 60 * 60;
+/// Prepared statements kept per connection.
+static const int  kStatementCacheSize = 32;
+/// Normalized query templates kept per connection, for the query profile.
+static const int  kTemplateCacheSize = 256;
+/// Seconds between VB_DATABASE statistics summaries.
+static const uint kStatisticsInterval = 10 * 60;
+
+std::atomic<uint64_t> MDBManager::s_statementHits     {0};
+std::atomic<uint64_t> MDBManager::s_statementPrepares {0};
 
 bool TestDatabase(const QString& dbHostName,
                   const QString& dbUserName,
@@ -93,10 +107,15 @@ MSqlDatabase::MSqlDatabase(QString name)
         //return;
     }
     m_lastDBKick = MythDate::current().addSecs(-60);
+    m_statements.setMaxCost(kStatementCacheSize);
+    m_templates.setMaxCost(kTemplateCacheSize);
 }
 
 MSqlDatabase::~MSqlDatabase()
 {
+    // The cached statements have to go before the connection does
+    ClearStatements();
+
     if (m_db.isOpen())
     {
         m_db.close();
@@ -131,6 +150,8 @@ bool MSqlDatabase::OpenDatabase(bool skipdb)
 
     if (!m_db.isOpen())
     {
+        ClearStatements();
+
         if (!skipdb)
             m_dbparms = GetMythDB()->GetDatabaseParams();
         m_db.setDatabaseName(m_dbparms.m_dbName);
@@ -244,13 +265,17 @@ bool MSqlDatabase::KickDatabase(void)
     m_lastDBKick = MythDate::current().addSecs(-60);
 
     if (!m_db.isOpen())
+    {
+        ClearStatements();
         m_db.open();
+    }
 
     return m_db.isOpen();
 }
 
 bool MSqlDatabase::Reconnect()
 {
+    ClearStatements();
     m_db.close();
     m_db.open();
 
@@ -272,6 +297,48 @@ void MSqlDatabase::InitSessionVars()
     m_db.exec("SET @@session.sql_mode=''");
 }
 
+/// Removes the statement prepared for query from the cache and returns it,
+/// or returns nullptr if there is none. The caller owns the statement.
+QSqlQuery *MSqlDatabase::TakeStatement(const QString &query)
+{
+    QSqlQuery *statement = m_statements.take(query);
+    if (statement)
+        m_statementHits++;
+    else
+        m_statementPrepares++;
+    return statement;
+}
+
+void MSqlDatabase::ReturnStatement(const QString &query, uint generation,
+                                   const QSqlQuery &statement)
+{
+    // Prepared on a connection that has since been closed
+    if (generation != m_statementGeneration || !m_db.isOpen())
+        return;
+
+    // If a nested query prepared the same text, the newer copy replaces it
+    m_statements.insert(query, new QSqlQuery(statement));
+}
+
+/// Returns MSqlQuery::NormalizeQuery() of query, only working it out the
+/// first time the connection sees the query.
+QString MSqlDatabase::QueryTemplate(const QString &query)
+{
+    QString *cached = m_templates.object(query);
+    if (cached)
+        return *cached;
+
+    QString normalized = MSqlQuery::NormalizeQuery(query);
+    m_templates.insert(query, new QString(normalized));
+    return normalized;
+}
+
+void MSqlDatabase::ClearStatements(void)
+{
+    m_statements.clear();
+    m_statementGeneration++;
+}
+
 // -----------------------------------------------------------------------
 
 
@@ -323,8 +390,11 @@ MSqlDatabase *MDBManager::popConnection(bool reuse)
     }
     else
     {
-        db = list.back();
-        list.pop_back();
+        // Take the most recently returned connection, it is the most
+        // likely to have this thread's statements cached. The ones at the
+        // back go idle and are purged.
+        db = list.front();
+        list.pop_front();
     }
 
 #if REUSE_CONNECTION
@@ -434,6 +504,41 @@ void MDBManager::PurgeIdleConnections(bool leaveOne)
                 QString("Purged %1 idle of %2 total DB connections.")
                 .arg(purgedConnections).arg(totalConnections));
     }
+
+    if (VERBOSE_LEVEL_CHECK(VB_DATABASE, LOG_INFO) &&
+        (!m_lastStatistics.isValid() ||
+         m_lastStatistics.secsTo(now) >= (int)kStatisticsInterval))
+    {
+        m_lastStatistics = now;
+        LogStatistics();
+    }
+}
+
+void MDBManager::LogStatistics(void)
+{
+    uint64_t hits     = s_statementHits;
+    uint64_t prepares = s_statementPrepares;
+    uint64_t total    = hits + prepares;
+    if (!total)
+        return;
+
+    LOG(VB_DATABASE, LOG_INFO,
+        QString("Statement cache: %1 hits, %2 prepares (%3% reused)")
+            .arg(hits).arg(prepares)
+            .arg(100.0 * hits / total, 0, 'f', 1));
+
+    QList<MythTimingStats::Entry> entries =
+        MythTimingStats::Get("database")->Snapshot();
+    for (int i = 0; i < entries.size() && i < 10; i++)
+    {
+        const MythTimingStats::Entry &entry = entries[i];
+        LOG(VB_DATABASE, LOG_INFO,
+            QString("  %1 execs, %2 ms total, p50 %3 us, p99 %4 us, "
+                    "%5 rows in %6: %7")
+                .arg(entry.m_count).arg(entry.m_totalUsecs / 1000)
+                .arg(entry.m_p50Usecs).arg(entry.m_p99Usecs)
+                .arg(entry.m_rows).arg(entry.m_detail).arg(entry.m_name));
+    }
 }
 
 MSqlDatabase *MDBManager::getStaticCon(MSqlDatabase **dbcon, const QString& name)
@@ -475,7 +580,11 @@ void MDBManager::CloseDatabases()
     foreach (auto & conn, list)
     {
         LOG(VB_DATABASE, LOG_INFO,
-            "Closing DB connection named '" + conn->m_name + "'");
+            QString("Closing DB connection named '%1' "
+                    "(%2 statement cache hits, %3 prepares)")
+                .arg(conn->m_name).arg(conn->m_statementHits)
+                .arg(conn->m_statementPrepares));
+        conn->ClearStatements();
         conn->m_db.close();
         delete conn;
         m_connCount--;
@@ -487,7 +596,11 @@ void MDBManager::CloseDatabases()
     {
         MSqlDatabase *db = slist.takeFirst();
         LOG(VB_DATABASE, LOG_INFO,
-            "Closing DB connection named '" + db->m_name + "'");
+            QString("Closing DB connection named '%1' "
+                    "(%2 statement cache hits, %3 prepares)")
+                .arg(db->m_name).arg(db->m_statementHits)
+                .arg(db->m_statementPrepares));
+        db->ClearStatements();
         db->m_db.close();
         delete db;
 
@@ -521,6 +634,8 @@ MSqlQuery::MSqlQuery(const MSqlQueryInfo &qi)
 
 MSqlQuery::~MSqlQuery()
 {
+    ReleaseStatement();
+
     if (m_returnConnection)
     {
         MDBManager *dbmanager = GetMythDB()->GetDBManager();
@@ -636,7 +751,7 @@ bool MSqlQuery::exec()
     timer.start();
 
     bool result = QSqlQuery::exec();
-    qint64 elapsed = timer.elapsed();
+    qint64 elapsed = timer.nsecsElapsed();
 
     // if the query failed with "MySQL server has gone away"
     // Close and reopen the database connection and retry the query if it
@@ -667,7 +782,7 @@ bool MSqlQuery::exec()
             bindValues(tmp);
             timer.restart();
             result = QSqlQuery::exec();
-            elapsed = timer.elapsed();
+            elapsed = timer.nsecsElapsed();
         }
         if (result)
         {
@@ -678,6 +793,14 @@ bool MSqlQuery::exec()
         }
     }
 
+    if (result)
+    {
+        static MythTimingStats *s_stats = MythTimingStats::Get("database");
+        int rows = isSelect() ? size() : numRowsAffected();
+        s_stats->Record(m_queryTemplate, elapsed / 1000, std::max(rows, 0),
+                        m_callerName);
+    }
+
     if (VERBOSE_LEVEL_CHECK(VB_DATABASE, LOG_INFO))
     {
         QString str = lastQuery();
@@ -700,7 +823,7 @@ bool MSqlQuery::exec()
             LOG(VB_DATABASE, LOG_INFO,
                 QString("MSqlQuery::exec(%1) %2%3%4")
                         .arg(m_db->MSqlDatabase::GetConnectionName()).arg(str)
-                        .arg(QString(" <<<< Took %1ms").arg(QString::number(elapsed)))
+                        .arg(QString(" <<<< Took %1ms").arg(QString::number(elapsed / 1000000)))
                         .arg(isSelect() ? QString(", Returned %1 row(s)")
                                               .arg(size()) : QString()));
         }
@@ -709,7 +832,7 @@ bool MSqlQuery::exec()
     return result;
 }
 
-bool MSqlQuery::exec(const QString &query)
+bool MSqlQuery::exec(const QString &query, const char *caller)
 {
     if (!m_db)
     {
@@ -725,6 +848,12 @@ bool MSqlQuery::exec(const QString &query)
         return false;
     }
 
+    // QSqlQuery::exec() replaces the prepared statement, keep it for later
+    ReleaseStatement();
+
+    QElapsedTimer timer;
+    timer.start();
+
     bool result = QSqlQuery::exec(query);
 
     // if the query failed with "MySQL server has gone away"
@@ -735,6 +864,14 @@ bool MSqlQuery::exec(const QString &query)
         && Reconnect())
         result = QSqlQuery::exec(query);
 
+    if (result)
+    {
+        static MythTimingStats *s_stats = MythTimingStats::Get("database");
+        int rows = isSelect() ? size() : numRowsAffected();
+        s_stats->Record(NormalizeQuery(query), timer.nsecsElapsed() / 1000,
+                        std::max(rows, 0), QString::fromLatin1(caller));
+    }
+
     LOG(VB_DATABASE, LOG_INFO,
             QString("MSqlQuery::exec(%1) %2%3")
                     .arg(m_db->MSqlDatabase::GetConnectionName()).arg(query)
@@ -805,7 +942,7 @@ bool MSqlQuery::seek(int where, bool relative)
     return seekDebug("seek", QSqlQuery::seek(where, relative), where, relative);
 }
 
-bool MSqlQuery::prepare(const QString& query)
+bool MSqlQuery::prepare(const QString& query, const char *caller)
 {
     if (!m_db)
     {
@@ -813,7 +950,14 @@ bool MSqlQuery::prepare(const QString& query)
         return false;
     }
 
+    if (query != m_lastPreparedQuery)
+        m_queryTemplate = m_db->QueryTemplate(query);
     m_lastPreparedQuery = query;
+    if (caller != m_caller)
+    {
+        m_caller = caller;
+        m_callerName = QString::fromLatin1(caller);
+    }
 
     if (!m_db->isOpen() && !Reconnect())
     {
@@ -821,6 +965,21 @@ bool MSqlQuery::prepare(const QString& query)
         return false;
     }
 
+    ReleaseStatement();
+
+    QSqlQuery *statement = m_db->TakeStatement(query);
+    if (statement)
+    {
+        QSqlQuery::operator=(*statement);
+        delete statement;
+        setForwardOnly(true);
+        m_statementKey = query;
+        m_statementGeneration = m_db->m_statementGeneration;
+        MDBManager::s_statementHits++;
+        return true;
+    }
+    MDBManager::s_statementPrepares++;
+
     // QT docs indicate that there are significant speed ups and a reduction
     // in memory usage by enabling forward-only cursors
     //
@@ -838,6 +997,12 @@ bool MSqlQuery::prepare(const QString& query)
         && Reconnect())
         ok = true;
 
+    if (ok)
+    {
+        m_statementKey = query;
+        m_statementGeneration = m_db->m_statementGeneration;
+    }
+
     if (!ok && !(GetMythDB()->SuppressDBMessages()))
     {
         LOG(VB_GENERAL, LOG_ERR,
@@ -849,6 +1014,115 @@ bool MSqlQuery::prepare(const QString& query)
     return ok;
 }
 
+/// Appends a '?' for a literal or placeholder, or folds it into the list of
+/// values it follows, so "IN (1, 2, 3)" becomes "IN (?...)".
+static void add_query_value(QString &out)
+{
+    int len = out.size();
+    while (len > 0 && out[len - 1] == ' ')
+        len--;
+    if (len > 0 && out[len - 1] == ',')
+    {
+        int prev = len - 1;
+        while (prev > 0 && out[prev - 1] == ' ')
+            prev--;
+        if (out.leftRef(prev).endsWith("?..."))
+        {
+            out.truncate(prev);
+            return;
+        }
+        if (prev > 0 && out[prev - 1] == '?')
+        {
+            out.truncate(prev);
+            out += "...";
+            return;
+        }
+    }
+    out += '?';
+}
+
+static inline bool is_identifier_char(QChar c)
+{
+    return c.isLetterOrNumber() || c == '_';
+}
+
+QString MSqlQuery::NormalizeQuery(const QString &query)
+{
+    QString out;
+    out.reserve(query.size());
+
+    const QChar *begin = query.constData();
+    const QChar *end   = begin + query.size();
+    const QChar *p     = begin;
+    while (p < end)
+    {
+        QChar c = *p;
+        if (c == '\'' || c == '"')
+        {
+            // Quotes are escaped either with a backslash or by doubling them
+            for (++p; p < end; ++p)
+            {
+                if (*p == '\\')
+                    ++p;
+                else if (*p == c && p + 1 < end && p[1] == c)
+                    ++p;
+                else if (*p == c)
+                    break;
+            }
+            p = std::min(p + 1, end);
+            add_query_value(out);
+        }
+        else if (c == '`')
+        {
+            const QChar *start = p;
+            for (++p; p < end && *p != '`'; ++p)
+                ;
+            p = std::min(p + 1, end);
+            out.append(start, p - start);
+        }
+        else if (c == ':' && p + 1 < end &&
+                 (p[1].isLetter() || p[1] == '_') &&
+                 (p == begin || !is_identifier_char(p[-1])))
+        {
+            for (++p; p < end && is_identifier_char(*p); ++p)
+                ;
+            add_query_value(out);
+        }
+        else if (c.isDigit() && (p == begin || !is_identifier_char(p[-1])))
+        {
+            // Also swallows hex, decimals and exponents
+            for (++p; p < end && (is_identifier_char(*p) || *p == '.'); ++p)
+                ;
+            add_query_value(out);
+        }
+        else if (c.isSpace())
+        {
+            for (++p; p < end && p->isSpace(); ++p)
+                ;
+            if (!out.isEmpty() && !out.endsWith(' '))
+                out += ' ';
+        }
+        else
+        {
+            out += c;
+            ++p;
+        }
+    }
+
+    if (out.endsWith(' '))
+        out.chop(1);
+
+    // Multi-row inserts, "VALUES (?...), (?...), (?...)"
+    if (out.contains("),"))
+    {
+        static const QRegularExpression kRepeatedRows
+            { R"((\([^()]*\))(?:\s*,\s*\1)+)" };
+        out.replace(kRepeatedRows, "\\1...");
+    }
+
+    return out;
+}
+
 bool MSqlQuery::testDBConnection()
 {
     MSqlDatabase *db = GetMythDB()->GetDBManager()->popConnection(true);
@@ -892,6 +1166,7 @@ QVariant MSqlQuery::lastInsertId()
 
 bool MSqlQuery::Reconnect(void)
 {
+    m_statementKey.clear();
     if (!m_db->Reconnect())
         return false;
     if (!m_lastPreparedQuery.isEmpty())
@@ -900,10 +1175,31 @@ bool MSqlQuery::Reconnect(void)
         if (!QSqlQuery::prepare(m_lastPreparedQuery))
             return false;
         bindValues(tmp);
+        m_statementKey = m_lastPreparedQuery;
+        m_statementGeneration = m_db->m_statementGeneration;
     }
     return true;
 }
 
+void MSqlQuery::ReleaseStatement(void)
+{
+    if (m_statementKey.isEmpty() || !m_db)
+        return;
+
+    // Drop any pending results and the bound values, so the next user of
+    // the statement starts from the same state as after a fresh prepare.
+    QSqlQuery::finish();
+    QMapIterator<QString, QVariant> b = QSqlQuery::boundValues();
+    while (b.hasNext())
+    {
+        b.next();
+        QSqlQuery::bindValue(b.key(), QVariant(), QSql::In);
+    }
+
+    m_db->ReturnStatement(m_statementKey, m_statementGeneration, *this);
+    m_statementKey.clear();
+}
+
 void MSqlAddMoreBindings(MSqlBindings &output, MSqlBindings &addfrom)
 {
     MSqlBindings::Iterator it;
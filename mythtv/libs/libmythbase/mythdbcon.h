@@ -1,6 +1,9 @@
 #ifndef MYTHDBCON_H_
 #define MYTHDBCON_H_
 
+#include <atomic>
+
+#include <QCache>
 #include <QSqlDatabase>
 #include <QSqlRecord>
 #include <QSqlError>
@@ -16,13 +19,36 @@
 
 #define REUSE_CONNECTION 1
 
+// Name of the function calling MSqlQuery::prepare() or exec(), recorded in
+// the query profile where the compiler can provide it.
+#if defined(__clang__)
+#  if __has_builtin(__builtin_FUNCTION)
+#    define MSQLQUERY_CALLER __builtin_FUNCTION()
+#  endif
+#elif defined(__GNUC__)
+#  define MSQLQUERY_CALLER __builtin_FUNCTION()
+#endif
+#ifndef MSQLQUERY_CALLER
+#  define MSQLQUERY_CALLER nullptr
+#endif
+
 MBASE_PUBLIC bool TestDatabase(const QString& dbHostName,
                                const QString& dbUserName,
                                QString dbPassword,
                                QString dbName = "mythconverg",
                                int     dbPort = 3306);
 
-/// \brief QSqlDatabase wrapper, used by MSqlQuery. Do not use directly.
+/** \brief QSqlDatabase wrapper, used by MSqlQuery. Do not use directly.
+ *
+ *  Each connection keeps the most recently used prepared statements, keyed
+ *  by their query text, so that MSqlQuery::prepare() of a query the
+ *  connection has already seen doesn't cost a round trip to the server.
+ *  A statement is taken out of the cache while an MSqlQuery uses it and
+ *  handed back when the MSqlQuery prepares something else or is destroyed,
+ *  so nested queries on a reused connection never share a statement.
+ *  Like the connection itself, the cache is only used by the thread that
+ *  currently holds the connection.
+ */
 class MSqlDatabase
 {
   friend class MDBManager;
@@ -42,11 +68,25 @@ class MSqlDatabase
     bool Reconnect(void);
     void InitSessionVars(void);
 
+    QSqlQuery *TakeStatement(const QString &query);
+    void ReturnStatement(const QString &query, uint generation,
+                         const QSqlQuery &statement);
+    void ClearStatements(void);
+    QString QueryTemplate(const QString &query);
+
   private:
     QString m_name;
     QSqlDatabase m_db;
     QDateTime m_lastDBKick;
     DatabaseParams m_dbparms;
+
+    QCache<QString, QSqlQuery> m_statements;
+    QCache<QString, QString>   m_templates;
+    /// Incremented whenever the connection is (re)opened, statements
+    /// prepared on an earlier generation are not returned to the cache.
+    uint m_statementGeneration {0};
+    uint64_t m_statementHits {0};
+    uint64_t m_statementPrepares {0};
 };
 
 /// \brief DB connection pool, used by MSqlQuery. Do not use directly.
@@ -60,6 +100,10 @@ class MBASE_PUBLIC MDBManager
     void CloseDatabases(void);
     void PurgeIdleConnections(bool leaveOne = false);
 
+    /// Logs the statement cache totals and the most expensive queries
+    /// under VB_DATABASE.
+    static void LogStatistics(void);
+
   protected:
     MSqlDatabase *popConnection(bool reuse);
     void pushConnection(MSqlDatabase *db);
@@ -84,6 +128,11 @@ class MBASE_PUBLIC MDBManager
     MSqlDatabase *m_schedCon {nullptr};
     MSqlDatabase *m_channelCon {nullptr};
     QHash<QThread*, DBList> m_staticPool;
+
+    QDateTime m_lastStatistics; // protected by m_lock
+
+    static std::atomic<uint64_t> s_statementHits;
+    static std::atomic<uint64_t> s_statementPrepares;
 };
 
 /// \brief MSqlDatabase Info, used by MSqlQuery. Do not use directly.
@@ -104,6 +153,10 @@ using MSqlBindings = QMap<QString, QVariant>;
  MBASE_PUBLIC  void MSqlEscapeAsAQuery(QString &query, MSqlBindings &bindings);
 
 /** \brief QSqlQuery wrapper that fetches a DB connection from the connection pool.
+ *
+ *   The time taken and the rows returned or changed by every query are
+ *   recorded in the "database" MythTimingStats group, keyed by the
+ *   NormalizeQuery() template and the calling function.
  *
  *   Myth & database connections
  *   Rule #1: Never use QSqlQuery or QSqlDatabase directly.
@@ -154,10 +207,10 @@ class MBASE_PUBLIC MSqlQuery : private QSqlQuery
     bool seek(int where, bool relative = false);
 
     /// \brief Wrap QSqlQuery::exec(const QString &query) so we can display SQL
-    bool exec(const QString &query);
+    bool exec(const QString &query, const char *caller = MSQLQUERY_CALLER);
 
     /// \brief QSqlQuery::prepare() is not thread safe in Qt <= 3.3.2
-    bool prepare(const QString &query);
+    bool prepare(const QString &query, const char *caller = MSQLQUERY_CALLER);
 
     /// \brief Add a single binding
     void bindValue(const QString &placeholder, const QVariant &val);
@@ -212,6 +265,11 @@ class MBASE_PUBLIC MSqlQuery : private QSqlQuery
     /// \brief Checks DB connection + login (login info via Mythcontext)
     static bool testDBConnection();
 
+    /// \brief Returns the template of a query, with string and numeric
+    ///        literals and placeholders replaced by '?', lists of values
+    ///        and repeated rows folded and whitespace simplified.
+    static QString NormalizeQuery(const QString &query);
+
     enum ConnectionReuse
     {
         kDedicatedConnection,
@@ -235,10 +293,18 @@ class MBASE_PUBLIC MSqlQuery : private QSqlQuery
     bool seekDebug(const char *type, bool result,
                    int where, bool relative) const;
 
+    /// Hands the prepared statement back to the connection's cache.
+    void ReleaseStatement(void);
+
     MSqlDatabase *m_db               {nullptr};
     bool          m_isConnected      {false};
     bool          m_returnConnection {false};
     QString       m_lastPreparedQuery; // holds a copy of the last prepared query
+    QString       m_queryTemplate;     // m_lastPreparedQuery, normalized
+    const char   *m_caller           {nullptr};
+    QString       m_callerName;        // m_caller as a QString
+    QString       m_statementKey;      // query of the statement we hold
+    uint          m_statementGeneration {0};
 };
 
 #endif
@@ -35,8 +35,8 @@ extern "C" {
 // There are two LOG macros now.  One for use with Qt/C++, one for use
 // without Qt.
 //
-// Neither of them will lock the calling thread other than momentarily to put
-// the log message onto a queue.
+// Neither of them will lock the calling thread, the log message is put on a
+// ring owned by the calling thread and dropped if that ring is full.
 #ifdef __cplusplus
 #define LOG(_MASK_, _LEVEL_, _STRING_)                                  \
     do {                                                                \
@@ -82,6 +82,7 @@ MBASE_PUBLIC void logStart(const QString& logfile, int progress = 0, int quiet =
 MBASE_PUBLIC void logStop(void);
 MBASE_PUBLIC void logPropagateCalc(void);
 MBASE_PUBLIC bool logPropagateQuiet(void);
+MBASE_PUBLIC uint64_t logDroppedCount(void);
 
 MBASE_PUBLIC int  syslogGetFacility(const QString& facility);
 MBASE_PUBLIC LogLevel_t logLevelGet(const QString& level);
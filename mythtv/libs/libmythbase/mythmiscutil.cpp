@@ -13,6 +13,7 @@ using namespace std;
 #include <unistd.h>
 #include <fcntl.h>
 #include <sched.h>
+#include <sys/stat.h>
 
 // System specific C headers
 #include "compat.h"
@@ -35,6 +36,8 @@ using namespace std;
 
 // Qt headers
 #include <QReadWriteLock>
+#include <QMutex>
+#include <QHash>
 #include <QNetworkProxy>
 #include <QStringList>
 #include <QDataStream>
@@ -48,6 +51,7 @@ using namespace std;
 
 // Myth headers
 #include "mythcorecontext.h"
+#include "mythdb.h"
 #include "exitcodes.h"
 #include "mythlogging.h"
 #include "mythsocket.h"
@@ -613,6 +617,164 @@ QString FileHash(const QString& filename)
     return output;
 }
 
+/// Identifies the contents of a file, the hash stays valid for as long
+/// as none of these change.
+struct FileHashKey
+{
+    quint64 device {0};
+    quint64 inode  {0};
+    qint64  size   {0};
+    qint64  mtime  {0};
+};
+
+struct CachedHash
+{
+    FileHashKey key;
+    QString     hash;
+};
+
+/// Most recent hashes by file name, in front of the filehash table
+static QMutex                     s_fileHashLock;
+static QHash<QString, CachedHash> s_fileHashCache;
+static const int                  kFileHashCacheSize = 1024;
+
+static bool SameFileHashKey(const FileHashKey &a, const FileHashKey &b)
+{
+    return a.device == b.device && a.inode == b.inode &&
+           a.size == b.size && a.mtime == b.mtime;
+}
+
+static void CacheFileHash(const QString& filename, const FileHashKey &key,
+                          const QString& hash)
+{
+    QMutexLocker locker(&s_fileHashLock);
+    // Files are looked up again soon after they are hashed if at all, so
+    // starting over when full is good enough
+    if (s_fileHashCache.size() >= kFileHashCacheSize)
+        s_fileHashCache.clear();
+    s_fileHashCache.insert(filename, CachedHash {key, hash});
+}
+
+static bool GetFileHashKey(const QString& filename, FileHashKey &key)
+{
+    struct stat st {};
+    if (stat(filename.toLocal8Bit().constData(), &st) < 0 || st.st_ino == 0)
+        return false;
+
+    key.device = st.st_dev;
+    key.inode  = st.st_ino;
+    key.size   = st.st_size;
+    key.mtime  = st.st_mtime;
+    return true;
+}
+
+/** \brief Returns FileHash() of a local file, using the hash saved in
+ *         the database if the file hasn't changed since.
+ *
+ *  The saved hashes are found by device, inode, size and modification
+ *  time, so a file that was renamed or moved within its filesystem
+ *  doesn't have to be read again either.
+ */
+QString CachedFileHash(const QString& filename)
+{
+    FileHashKey key;
+    if (!GetFileHashKey(filename, key))
+        return FileHash(filename);
+
+    {
+        QMutexLocker locker(&s_fileHashLock);
+        auto it = s_fileHashCache.constFind(filename);
+        if (it != s_fileHashCache.constEnd() && SameFileHashKey(it->key, key))
+            return it->hash;
+    }
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    if (!query.isConnected())
+        return FileHash(filename);
+
+    query.prepare("SELECT hash FROM filehash "
+                  "WHERE hostname = :HOST AND device = :DEVICE AND "
+                  "      inode = :INODE AND filesize = :SIZE AND "
+                  "      mtime = :MTIME");
+    query.bindValue(":HOST",   gCoreContext->GetHostName());
+    query.bindValue(":DEVICE", key.device);
+    query.bindValue(":INODE",  key.inode);
+    query.bindValue(":SIZE",   key.size);
+    query.bindValue(":MTIME",  key.mtime);
+    if (query.exec() && query.next())
+    {
+        LOG(VB_FILE, LOG_DEBUG,
+            QString("CachedFileHash: Saved hash for %1").arg(filename));
+        QString hash = query.value(0).toString();
+        CacheFileHash(filename, key, hash);
+        return hash;
+    }
+
+    QString hash = FileHash(filename);
+    if (hash != "NULL")
+        SaveFileHash(filename, hash);
+    return hash;
+}
+
+/** \brief Saves the FileHash() of a local file, for CachedFileHash().
+ *
+ *  Any hash saved before for the same file name is replaced.
+ */
+void SaveFileHash(const QString& filename, const QString& hash)
+{
+    FileHashKey key;
+    if (hash.isEmpty() || !GetFileHashKey(filename, key))
+        return;
+
+    CacheFileHash(filename, key, hash);
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    if (!query.isConnected())
+        return;
+
+    query.prepare("DELETE FROM filehash "
+                  "WHERE hostname = :HOST AND filename = :FILENAME");
+    query.bindValue(":HOST",     gCoreContext->GetHostName());
+    query.bindValue(":FILENAME", filename);
+    if (!query.exec())
+        MythDB::DBError("SaveFileHash -- delete", query);
+
+    query.prepare("REPLACE INTO filehash "
+                  "  (hostname, filename, device, inode, filesize, mtime, "
+                  "   hash) "
+                  "VALUES (:HOST, :FILENAME, :DEVICE, :INODE, :SIZE, "
+                  "        :MTIME, :HASH)");
+    query.bindValue(":HOST",     gCoreContext->GetHostName());
+    query.bindValue(":FILENAME", filename);
+    query.bindValue(":DEVICE",   key.device);
+    query.bindValue(":INODE",    key.inode);
+    query.bindValue(":SIZE",     key.size);
+    query.bindValue(":MTIME",    key.mtime);
+    query.bindValue(":HASH",     hash);
+    if (!query.exec())
+        MythDB::DBError("SaveFileHash -- insert", query);
+}
+
+/// Forgets the saved hash of a local file that is being deleted.
+void RemoveFileHash(const QString& filename)
+{
+    {
+        QMutexLocker locker(&s_fileHashLock);
+        s_fileHashCache.remove(filename);
+    }
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    if (!query.isConnected())
+        return;
+
+    query.prepare("DELETE FROM filehash "
+                  "WHERE hostname = :HOST AND filename = :FILENAME");
+    query.bindValue(":HOST",     gCoreContext->GetHostName());
+    query.bindValue(":FILENAME", filename);
+    if (!query.exec())
+        MythDB::DBError("RemoveFileHash", query);
+}
+
 bool WakeOnLAN(const QString& MAC)
 {
     char msg[1024] = "\xFF\xFF\xFF\xFF\xFF\xFF";
@@ -70,6 +70,9 @@ MBASE_PUBLIC bool MythWakeup(const QString &wakeUpCommand,
     uint flags = kMSNone, uint timeout = 0);
 
 MBASE_PUBLIC QString FileHash(const QString& filename);
+MBASE_PUBLIC QString CachedFileHash(const QString& filename);
+MBASE_PUBLIC void SaveFileHash(const QString& filename, const QString& hash);
+MBASE_PUBLIC void RemoveFileHash(const QString& filename);
 
 /// Is A/V Sync destruction daemon is running on this host?
 MBASE_PUBLIC bool IsPulseAudioRunning(void);
@@ -25,6 +25,7 @@ using std::vector;
 
 // MythTV
 #include "mythsocket.h"
+#include "mythsocketframing.h"
 #include "mythtimer.h"
 #include "mythevent.h"
 #include "mythversion.h"
@@ -258,6 +259,14 @@ void MythSocket::DisconnectHandler(void)
         m_peerPort = -1;
     }
 
+    if (IsPipelined())
+    {
+        // Nothing more is coming for the threads waiting for replies
+        QMutexLocker locker(&m_pipelineLock);
+        m_pipelineBroken = true;
+        m_pipelineWait.wakeAll();
+    }
+
     if (m_callback)
     {
         LOG(VB_SOCKET, LOG_DEBUG, LOC +
@@ -274,6 +283,11 @@ void MythSocket::AboutToCloseHandler(void)
 void MythSocket::ReadyReadHandler(void)
 {
     m_dataAvailable.fetchAndStoreOrdered(1);
+    if (IsPipelined())
+    {
+        QMutexLocker locker(&m_pipelineLock);
+        m_pipelineWait.wakeAll();
+    }
     if (m_callback && m_disableReadyReadCallback.testAndSetOrdered(0,0))
     {
         emit CallReadyRead();
@@ -309,6 +323,40 @@ bool MythSocket::ConnectToHost(
 }
 
 bool MythSocket::WriteStringList(const QStringList &list)
+{
+    PipelineMode mode = (PipelineMode) m_pipelineMode.loadAcquire();
+    if (kNotPipelined == mode)
+        return WriteStringListRaw(list);
+
+    QStringList tagged(list);
+    {
+        QMutexLocker locker(&m_pipelineLock);
+        if (kPipelineClient == mode)
+        {
+            // A request nobody read the reply to is simply replaced,
+            // its reply is dropped when it arrives.
+            QString id = QString::number(++m_nextRequestId);
+            m_requestIds[QThread::currentThread()] = id;
+            tagged.prepend(id);
+        }
+        else
+        {
+            QString id = m_requestIds.take(QThread::currentThread());
+            if (id.isEmpty())
+            {
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    "WriteStringList: No request to reply to on this "
+                    "thread, the client will drop the reply.");
+                id = "0";
+            }
+            tagged.prepend(id);
+        }
+    }
+
+    return WriteStringListRaw(tagged);
+}
+
+bool MythSocket::WriteStringListRaw(const QStringList &list)
 {
     bool ret = false;
     QMetaObject::invokeMethod(
@@ -320,7 +368,138 @@ bool MythSocket::WriteStringList(const QStringList &list)
     return ret;
 }
 
+/** \brief Writes list in the current modes, then switches to the given
+ *         framing and pipeline modes.
+ *
+ *  Used by servers to accept the modes a client asked for. The write and
+ *  the switch both run on the socket's thread, where every read and write
+ *  happens, so the client's first request in the new modes can't be read
+ *  in the old ones.
+ */
+bool MythSocket::WriteStringListAndSwitch(
+    const QStringList &list, MythSocketFraming::Mode framing,
+    PipelineMode pipeline)
+{
+    bool ret = false;
+    QMetaObject::invokeMethod(
+        this, "WriteStringListAndSwitchReal",
+        (QThread::currentThread() != m_thread->qthread()) ?
+        Qt::BlockingQueuedConnection : Qt::DirectConnection,
+        Q_ARG(const QStringList*, &list),
+        Q_ARG(int, framing),
+        Q_ARG(int, pipeline),
+        Q_ARG(bool*, &ret));
+    return ret;
+}
+
 bool MythSocket::ReadStringList(QStringList &list, uint timeoutMS)
+{
+    PipelineMode mode = (PipelineMode) m_pipelineMode.loadAcquire();
+    if (kPipelineClient == mode)
+        return ReadPipelinedReply(list, timeoutMS);
+
+    if (!ReadStringListRaw(list, timeoutMS))
+        return false;
+
+    if (kPipelineServer == mode && !list.isEmpty())
+    {
+        QMutexLocker locker(&m_pipelineLock);
+        m_requestIds[QThread::currentThread()] = list.takeFirst();
+    }
+
+    return true;
+}
+
+/** \brief Waits for the reply to the last request written by this thread.
+ *
+ *  There is no reader thread, whichever waiting thread finds data on the
+ *  socket first reads one reply and hands it to the thread it belongs to.
+ *  The socket's own thread is blocked while a reply is read, so that only
+ *  happens once data has arrived, letting other threads keep writing their
+ *  requests in the meantime.
+ */
+bool MythSocket::ReadPipelinedReply(QStringList &list, uint timeoutMS)
+{
+    list.clear();
+
+    QThread *thread = QThread::currentThread();
+    MythTimer timer(MythTimer::kStartRunning);
+
+    QMutexLocker locker(&m_pipelineLock);
+    QString id = m_requestIds.value(thread);
+    if (id.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            "ReadStringList: No request written on this thread.");
+        return false;
+    }
+
+    bool ok = false;
+    while (!m_pipelineBroken)
+    {
+        auto it = m_replies.find(id);
+        if (it != m_replies.end())
+        {
+            list = *it;
+            m_replies.erase(it);
+            ok = true;
+            break;
+        }
+
+        int remaining = (int)timeoutMS - timer.elapsed();
+        if (remaining <= 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + "ReadStringList: " +
+                QString("Error, timed out after %1 ms.").arg(timeoutMS));
+            break;
+        }
+
+        if (m_pipelineReading || !m_dataAvailable.loadAcquire())
+        {
+            // Woken by ReadyReadHandler() or by the thread reading
+            m_pipelineWait.wait(&m_pipelineLock, remaining);
+            continue;
+        }
+
+        m_pipelineReading = true;
+        locker.unlock();
+
+        // Once started a reply has to be read whole, whatever is left of
+        // this thread's own timeout, or the stream is out of step. A
+        // thread whose request times out only fails that request.
+        QStringList reply;
+        bool available = IsDataAvailable();
+        bool read = available && ReadStringListRaw(reply, kLongTimeout);
+
+        locker.relock();
+        m_pipelineReading = false;
+
+        if (available && !read)
+        {
+            m_pipelineBroken = true;
+        }
+        else if (read && !reply.isEmpty())
+        {
+            QString replyId = reply.takeFirst();
+            if (m_requestIds.key(replyId))
+            {
+                m_replies[replyId] = reply;
+            }
+            else
+            {
+                LOG(VB_NETWORK, LOG_WARNING, LOC +
+                    QString("ReadStringList: Dropping reply to "
+                            "abandoned request %1").arg(replyId));
+            }
+        }
+        m_pipelineWait.wakeAll();
+    }
+
+    m_requestIds.remove(thread);
+    return ok;
+}
+
+bool MythSocket::ReadStringListRaw(QStringList &list, uint timeoutMS)
 {
     bool ret = false;
     QMetaObject::invokeMethod(
@@ -415,9 +594,10 @@ bool MythSocket::Validate(uint timeout_ms, bool error_dialog_desired)
     if (m_isValidated)
         return true;
 
-    QStringList strlist(QString("MYTH_PROTO_VERSION %1 %2")
+    QStringList strlist(QString("MYTH_PROTO_VERSION %1 %2 %3")
                         .arg(MYTH_PROTO_VERSION)
-                        .arg(QString::fromUtf8(MYTH_PROTO_TOKEN)));
+                        .arg(QString::fromUtf8(MYTH_PROTO_TOKEN))
+                        .arg(MythSocketFraming::kBinaryToken));
 
     WriteStringList(strlist);
 
@@ -452,6 +632,12 @@ bool MythSocket::Validate(uint timeout_ms, bool error_dialog_desired)
         LOG(VB_GENERAL, LOG_NOTICE, QString("Using protocol version %1 %2")
             .arg(MYTH_PROTO_VERSION).arg(QString::fromUtf8(MYTH_PROTO_TOKEN)));
         m_isValidated = true;
+
+        // Backends that predate binary framing ignore the extra token
+        // and reply with a plain ACCEPT, so we stay in legacy mode.
+        if (strlist.size() >= 3 &&
+            strlist[2] == MythSocketFraming::kBinaryToken)
+            SetFramingMode(MythSocketFraming::kBinary);
     }
     else
     {
@@ -714,8 +900,9 @@ void MythSocket::WriteStringListReal(const QStringList *list, bool *ret)
         return;
     }
 
-    QString str = list->join("[]:[]");
-    if (str.isEmpty())
+    MythSocketFraming::Mode mode = GetFramingMode();
+    QByteArray payload = MythSocketFraming::Encode(mode, *list);
+    if (payload.isEmpty())
     {
         LOG(VB_GENERAL, LOG_ERR, LOC +
             "WriteStringList: Error, joined null string.");
@@ -723,22 +910,18 @@ void MythSocket::WriteStringListReal(const QStringList *list, bool *ret)
         return;
     }
 
-    QByteArray utf8 = str.toUtf8();
-    int size = utf8.length();
+    int size = payload.length();
     int written = 0;
     int written_since_timer_restart = 0;
 
-    QByteArray payload;
-    payload = payload.setNum(size);
-    payload += "        ";
-    payload.truncate(8);
-    payload += utf8;
-    size = payload.length();
-
     if (VERBOSE_LEVEL_CHECK(VB_NETWORK, LOG_INFO))
     {
         QString msg = QString("write -> %1 %2")
-            .arg(m_tcpSocket->socketDescriptor(), 2).arg(payload.data());
+            .arg(m_tcpSocket->socketDescriptor(), 2)
+            .arg((MythSocketFraming::kBinary == mode) ?
+                 QString("%1 %2").arg(payload.size() - 4)
+                     .arg(list->join("[]:[]")) :
+                 QString(payload.data()));
 
         if (logLevel < LOG_DEBUG && msg.length() > 128)
         {
@@ -797,6 +980,17 @@ void MythSocket::WriteStringListReal(const QStringList *list, bool *ret)
     *ret = true;
 }
 
+void MythSocket::WriteStringListAndSwitchReal(
+    const QStringList *list, int framing, int pipeline, bool *ret)
+{
+    WriteStringListReal(list, ret);
+    if (!*ret)
+        return;
+
+    SetFramingMode((MythSocketFraming::Mode) framing);
+    SetPipelineMode((PipelineMode) pipeline);
+}
+
 void MythSocket::ReadStringListReal(
     QStringList *list, uint timeoutMS, bool *ret)
 {
@@ -807,7 +1001,10 @@ void MythSocket::ReadStringListReal(
     timer.start();
     int elapsed = 0;
 
-    while (m_tcpSocket->bytesAvailable() < 8)
+    MythSocketFraming::Mode mode = GetFramingMode();
+    int headerSize = MythSocketFraming::HeaderSize(mode);
+
+    while (m_tcpSocket->bytesAvailable() < headerSize)
     {
         elapsed = timer.elapsed();
         if (elapsed >= (int)timeoutMS)
@@ -829,8 +1026,8 @@ void MythSocket::ReadStringListReal(
         m_tcpSocket->waitForReadyRead(50);
     }
 
-    QByteArray sizestr(8 + 1, '\0');
-    if (m_tcpSocket->read(sizestr.data(), 8) < 0)
+    QByteArray sizestr(headerSize, '\0');
+    if (m_tcpSocket->read(sizestr.data(), headerSize) < 0)
     {
         LOG(VB_GENERAL, LOG_ERR, LOC +
             QString("ReadStringList: Error, read return error (%1)")
@@ -840,8 +1037,7 @@ void MythSocket::ReadStringListReal(
         return;
     }
 
-    QString sizes = sizestr;
-    qint64 btr = sizes.trimmed().toInt();
+    qint64 btr = MythSocketFraming::ParseHeader(mode, sizestr);
 
     if (btr < 1)
     {
@@ -849,12 +1045,14 @@ void MythSocket::ReadStringListReal(
         LOG(VB_GENERAL, LOG_ERR, LOC +
             QString("Protocol error: '%1' is not a valid size "
                     "prefix. %2 bytes pending.")
-                .arg(sizestr.data()).arg(pending));
+                .arg((MythSocketFraming::kBinary == mode) ?
+                     QString(sizestr.toHex()) : QString(sizestr))
+                .arg(pending));
         ResetReal();
         return;
     }
 
-    QByteArray utf8(btr + 1, 0);
+    QByteArray utf8(btr, 0);
 
     qint64 readoffset = 0;
     int errmsgtime = 0;
@@ -926,15 +1124,24 @@ void MythSocket::ReadStringListReal(
         }
     }
 
-    QString str = QString::fromUtf8(utf8.data());
+    if (!MythSocketFraming::Decode(mode, utf8, *list))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Protocol error: malformed %1 byte binary frame.")
+                .arg(utf8.size()));
+        list->clear();
+        ResetReal();
+        return;
+    }
 
     if (VERBOSE_LEVEL_CHECK(VB_NETWORK, LOG_INFO))
     {
+        QString str = list->join("[]:[]");
         QByteArray payload;
         payload = payload.setNum(str.length());
         payload += "        ";
         payload.truncate(8);
-        payload += utf8.data();
+        payload += str.toUtf8();
 
         QString msg = QString("read  <- %1 %2")
             .arg(m_tcpSocket->socketDescriptor(), 2)
@@ -948,8 +1155,6 @@ void MythSocket::ReadStringListReal(
         LOG(VB_NETWORK, LOG_INFO, LOC + msg);
     }
 
-    *list = str.split("[]:[]");
-
     m_dataAvailable.fetchAndStoreOrdered(
         (m_tcpSocket->bytesAvailable() > 0) ? 1 : 0);
 
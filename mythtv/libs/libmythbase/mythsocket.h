@@ -7,9 +7,11 @@
 #include <QAtomicInt>
 #include <QMutex>
 #include <QHash>
+#include <QWaitCondition>
 
 #include "referencecounter.h"
 #include "mythsocket_cb.h"
+#include "mythsocketframing.h"
 #include "mythqtcompat.h"
 #include "mythbaseexp.h"
 #include "mthread.h"
@@ -20,7 +22,8 @@ class QTcpSocket;
  *
  *  \note Access to the methods of MythSocket must be externally
  *  serialized (i.e. the MythSocket must only be available to one
- *  thread at a time).
+ *  thread at a time), unless the socket is pipelined. Several threads
+ *  may then each write a request and read its reply at the same time.
  *
  */
 class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
@@ -56,6 +59,35 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     bool ReadStringList(QStringList &list, uint timeoutMS = kShortTimeout);
     bool WriteStringList(const QStringList &list);
 
+    /// Switches the string list wire format, only call this once the
+    /// peer has agreed to the new mode during protocol validation.
+    void SetFramingMode(MythSocketFraming::Mode mode)
+        { m_framingMode.fetchAndStoreOrdered(mode); }
+    MythSocketFraming::Mode GetFramingMode(void) const
+        { return (MythSocketFraming::Mode) m_framingMode.loadAcquire(); }
+
+    enum PipelineMode
+    {
+        kNotPipelined = 0,
+        /// Every string list written gets a request ID in front of it and
+        /// ReadStringList() returns the reply carrying the ID of the last
+        /// request written by the calling thread, whatever order the
+        /// replies arrive in.
+        kPipelineClient,
+        /// The request ID is taken off every string list read, and put in
+        /// front of the next string list the same thread writes.
+        kPipelineServer,
+    };
+    /// Switches request pipelining on, only call this once the peer has
+    /// agreed to it during protocol validation.
+    void SetPipelineMode(PipelineMode mode)
+        { m_pipelineMode.fetchAndStoreOrdered(mode); }
+    bool IsPipelined(void) const
+        { return m_pipelineMode.loadAcquire() != kNotPipelined; }
+    bool WriteStringListAndSwitch(const QStringList &list,
+                                  MythSocketFraming::Mode framing,
+                                  PipelineMode pipeline);
+
     bool IsConnected(void) const;
     bool IsDataAvailable(void);
 
@@ -84,6 +116,8 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
 
     void ReadStringListReal(QStringList *list, uint timeoutMS, bool *ret);
     void WriteStringListReal(const QStringList *list, bool *ret);
+    void WriteStringListAndSwitchReal(const QStringList *list, int framing,
+                                      int pipeline, bool *ret);
     void ConnectToHostReal(const QHostAddress& addr, quint16 port, bool *ret);
     void DisconnectFromHostReal(void);
 
@@ -96,6 +130,10 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
   protected:
     ~MythSocket() override; // force reference counting
 
+    bool ReadStringListRaw(QStringList &list, uint timeoutMS);
+    bool WriteStringListRaw(const QStringList &list);
+    bool ReadPipelinedReply(QStringList &list, uint timeoutMS);
+
     QTcpSocket     *m_tcpSocket        {nullptr}; // only set in ctor
     MThread        *m_thread           {nullptr}; // only set in ctor
     mutable QMutex  m_lock;
@@ -105,6 +143,8 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     MythSocketCBs  *m_callback         {nullptr}; // only set in ctor
     bool            m_useSharedThread;            // only set in ctor
     QAtomicInt      m_disableReadyReadCallback {false};
+    QAtomicInt      m_framingMode {MythSocketFraming::kLegacy};
+    QAtomicInt      m_pipelineMode {kNotPipelined};
     bool            m_connected        {false};   // protected by m_lock
     /// This is used internally as a hint that there might be
     /// data available for reading.
@@ -113,6 +153,16 @@ class MBASE_PUBLIC MythSocket : public QObject, public ReferenceCounter
     bool            m_isAnnounced      {false}; // only set in thread using MythSocket
     QStringList     m_announce; // only set in thread using MythSocket
 
+    QMutex          m_pipelineLock;
+    QWaitCondition  m_pipelineWait;
+    uint            m_nextRequestId    {0};      // protected by m_pipelineLock
+    /// Client: the request each thread is waiting for.
+    /// Server: the request each thread is handling.
+    QHash<QThread*, QString> m_requestIds;       // protected by m_pipelineLock
+    QHash<QString, QStringList> m_replies;       // protected by m_pipelineLock
+    bool            m_pipelineReading  {false};  // protected by m_pipelineLock
+    bool            m_pipelineBroken   {false};  // protected by m_pipelineLock
+
     static const int kSocketReceiveBufferSize;
 
     static QMutex s_loopbackCacheLock;
@@ -0,0 +1,115 @@
+// Qt
+#include <QtEndian>
+
+// MythTV
+#include "mythsocketframing.h"
+
+namespace MythSocketFraming
+{
+
+const char *kBinaryToken   = "BINARY";
+const char *kPipelineToken = "PIPELINE";
+
+static inline void append_uint32(QByteArray &buf, quint32 value)
+{
+    uchar tmp[4];
+    qToBigEndian(value, tmp);
+    buf.append(reinterpret_cast<const char*>(tmp), 4);
+}
+
+static inline quint32 read_uint32(const char *data)
+{
+    return qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(data));
+}
+
+qint64 ParseHeader(Mode mode, const QByteArray &header)
+{
+    if (header.size() < HeaderSize(mode))
+        return -1;
+
+    if (kBinary == mode)
+    {
+        qint64 size = read_uint32(header.constData());
+        return (size > kMaxPayloadSize) ? -1 : size;
+    }
+
+    bool ok = false;
+    qint64 size = header.left(8).trimmed().toLongLong(&ok);
+    return (!ok || size < 1) ? -1 : size;
+}
+
+QByteArray Encode(Mode mode, const QStringList &list)
+{
+    QByteArray frame;
+
+    if (kBinary != mode)
+    {
+        QByteArray utf8 = list.join("[]:[]").toUtf8();
+        if (utf8.isEmpty())
+            return frame;
+
+        frame.reserve(8 + utf8.size());
+        frame.setNum(utf8.size());
+        frame += "        ";
+        frame.truncate(8);
+        frame += utf8;
+        return frame;
+    }
+
+    // Field sizes are not known until each string has been converted,
+    // so reserve a rough guess and back-patch the payload length.
+    frame.reserve(8 + list.size() * 24);
+    append_uint32(frame, 0);
+    append_uint32(frame, list.size());
+    for (const auto & item : list)
+    {
+        QByteArray utf8 = item.toUtf8();
+        append_uint32(frame, utf8.size());
+        frame.append(utf8);
+    }
+    qToBigEndian<quint32>(frame.size() - 4,
+                          reinterpret_cast<uchar*>(frame.data()));
+
+    return frame;
+}
+
+bool Decode(Mode mode, const QByteArray &payload, QStringList &list)
+{
+    list.clear();
+
+    if (kBinary != mode)
+    {
+        list = QString::fromUtf8(payload.constData()).split("[]:[]");
+        return true;
+    }
+
+    const char *data = payload.constData();
+    const char *end  = data + payload.size();
+
+    if (end - data < 4)
+        return false;
+    quint32 count = read_uint32(data);
+    data += 4;
+
+    // Each field needs at least its 4 byte length, so a count that
+    // cannot fit in the payload means the frame is corrupt.
+    if (count > (quint32)((end - data) / 4))
+        return false;
+
+    list.reserve(count);
+    for (quint32 i = 0; i < count; i++)
+    {
+        if (end - data < 4)
+            return false;
+        quint32 len = read_uint32(data);
+        data += 4;
+        if (len > (quint32)(end - data))
+            return false;
+        list.push_back(QString::fromUtf8(data, len));
+        data += len;
+    }
+
+    return data == end;
+}
+
+} // namespace MythSocketFraming
@@ -0,0 +1,70 @@
+/** -*- Mode: c++ -*- */
+#ifndef MYTH_SOCKET_FRAMING_H
+#define MYTH_SOCKET_FRAMING_H
+
+#include <QByteArray>
+#include <QStringList>
+
+#include "mythbaseexp.h"
+
+/** \brief Wire formats used by MythSocket for string list messages.
+ *
+ *  The legacy format joins the list with "[]:[]", converts it to UTF-8
+ *  and prefixes it with an 8 character ASCII length.
+ *
+ *  The binary format is only used once both ends have agreed on it by
+ *  appending kBinaryToken to the MYTH_PROTO_VERSION command and getting
+ *  it echoed back in the ACCEPT reply. A binary frame is a 32 bit big
+ *  endian payload length followed by the payload, which is a 32 bit big
+ *  endian field count followed by each field as a 32 bit big endian byte
+ *  count and the UTF-8 bytes of the field. Fields never need to be
+ *  searched for a separator, and may themselves contain "[]:[]".
+ */
+namespace MythSocketFraming
+{
+
+enum Mode
+{
+    kLegacy = 0,
+    kBinary = 1,
+};
+
+/// Token appended to MYTH_PROTO_VERSION to request binary framing.
+extern MBASE_PUBLIC const char *kBinaryToken;
+
+/// Token appended to MYTH_PROTO_VERSION to request pipelined requests,
+/// see MythSocket::SetPipelineMode().
+extern MBASE_PUBLIC const char *kPipelineToken;
+
+/// Largest payload we will accept in a binary frame. Legacy frames are
+/// only limited by their 8 character length, as they always were.
+static const qint64 kMaxPayloadSize = 256 * 1024 * 1024;
+
+/// Size of the frame header that precedes the payload.
+inline int HeaderSize(Mode mode) { return (kBinary == mode) ? 4 : 8; }
+
+/// Returns the payload length encoded in a frame header,
+/// or -1 if the header is not valid.
+MBASE_PUBLIC qint64 ParseHeader(Mode mode, const QByteArray &header);
+
+/// Returns a complete frame (header and payload) for the list.
+MBASE_PUBLIC QByteArray Encode(Mode mode, const QStringList &list);
+
+/// Decodes a payload (without the header) into list.
+/// \return false if the payload is malformed.
+MBASE_PUBLIC bool Decode(Mode mode, const QByteArray &payload,
+                         QStringList &list);
+
+/// Returns a field that carries data unchanged, one character per byte.
+/// Only use it for lists sent with binary framing, where fields are not
+/// searched for "[]:[]".
+inline QString BytesToField(const QByteArray &data)
+    { return QString::fromLatin1(data); }
+
+/// Returns the data in a field made by BytesToField().
+inline QByteArray FieldToBytes(const QString &field)
+    { return field.toLatin1(); }
+
+} // namespace MythSocketFraming
+
+#endif /* MYTH_SOCKET_FRAMING_H */
@@ -151,6 +151,16 @@ class MBASE_PUBLIC MythSystemLegacy : public QObject
     int GetNice(void)                { return m_nice; }
     int GetIOPrio(void)              { return m_ioprio; }
 
+    /// CPU time used by the command and any children it waited for, in
+    /// microseconds. Only known on Unix, once the command has exited.
+    uint64_t GetCPUUsecs(void) const { return m_cpuUsecs; }
+    /// Bytes read from and written to storage by the command, as counted
+    /// by the kernel in 512 byte blocks. Only known on Unix, once the
+    /// command has exited.
+    uint64_t GetIOBytes(void) const  { return m_ioBytes; }
+    void SetResourceUsage(uint64_t cpuUsecs, uint64_t ioBytes)
+        { m_cpuUsecs = cpuUsecs; m_ioBytes = ioBytes; }
+
     // FIXME: We should not return a pointer to a QBuffer
     QBuffer *GetBuffer(int index)    { return &m_stdbuff[index]; }
 
@@ -191,6 +201,9 @@ class MBASE_PUBLIC MythSystemLegacy : public QObject
     int         m_nice   {0};
     int         m_ioprio {0};
 
+    uint64_t    m_cpuUsecs {0};
+    uint64_t    m_ioBytes  {0};
+
     Setting     m_settings;
     QBuffer     m_stdbuff[3];
 };
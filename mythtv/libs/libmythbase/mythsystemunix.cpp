@@ -15,6 +15,7 @@
 #include <ctime>
 #include <fcntl.h>
 #include <iostream> // for cerr()
+#include <sys/resource.h>
 #include <sys/select.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -279,10 +280,11 @@ void MythSystemLegacyManager::run(void)
 
         pid_t pid = 0;
         int   status = 0;
+        struct rusage usage {};
 
         // check for any newly exited processes
         listLock.lock();
-        while( (pid = waitpid(-1, &status, WNOHANG)) > 0 )
+        while( (pid = wait4(-1, &status, WNOHANG, &usage)) > 0 )
         {
             m_mapLock.lock();
             // unmanaged process has exited
@@ -312,6 +314,11 @@ void MythSystemLegacyManager::run(void)
 
             msList.append(ms);
 
+            ms->m_parent->SetResourceUsage(
+                (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ULL +
+                usage.ru_utime.tv_usec + usage.ru_stime.tv_usec,
+                (usage.ru_inblock + usage.ru_oublock) * 512ULL);
+
             // Deal with (primarily) Ubuntu which seems to consistently be
             // screwing up and reporting the signalled case as an exit.  This
             // workaround will limit the valid exit value to 0 - 127.  As all
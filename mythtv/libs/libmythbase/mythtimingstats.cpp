@@ -0,0 +1,112 @@
+// C++ headers
+#include <algorithm>
+#include <cmath>
+
+// MythTV headers
+#include "mythtimingstats.h"
+
+QMutex                           MythTimingStats::s_registryLock;
+QHash<QString, MythTimingStats*> MythTimingStats::s_registry;
+
+static inline int bucket_for(uint64_t usecs)
+{
+    int bucket = 0;
+    while (usecs > 1 && bucket < MythTimingStats::kNumBuckets - 1)
+    {
+        usecs >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/** \brief Returns an estimate of the given percentile in microseconds.
+ *
+ *  The upper bound of the bucket containing the percentile is used,
+ *  clamped to the largest sample seen, so the estimate is never low.
+ */
+uint64_t MythTimingStats::Histogram::Percentile(double fraction) const
+{
+    if (!m_count)
+        return 0;
+
+    auto target = static_cast<uint64_t>(std::ceil(fraction * m_count));
+    target = std::max<uint64_t>(target, 1);
+
+    uint64_t seen = 0;
+    for (int i = 0; i < kNumBuckets; i++)
+    {
+        seen += m_buckets[i];
+        if (seen >= target)
+            return std::min<uint64_t>((2ULL << i) - 1, m_maxUsecs);
+    }
+    return m_maxUsecs;
+}
+
+void MythTimingStats::Record(const QString &name, uint64_t usecs,
+                             uint64_t rows, const QString &detail)
+{
+    QMutexLocker locker(&m_lock);
+    Histogram &hist = m_histograms[Key(name, detail)];
+    hist.m_count++;
+    hist.m_totalUsecs += usecs;
+    hist.m_maxUsecs = std::max(hist.m_maxUsecs, usecs);
+    hist.m_rows += rows;
+    hist.m_buckets[bucket_for(usecs)]++;
+}
+
+QList<MythTimingStats::Entry> MythTimingStats::Snapshot(void) const
+{
+    QList<Entry> list;
+
+    QMutexLocker locker(&m_lock);
+    list.reserve(m_histograms.size());
+    for (auto it = m_histograms.cbegin(); it != m_histograms.cend(); ++it)
+    {
+        Entry entry;
+        entry.m_name       = it.key().first;
+        entry.m_detail     = it.key().second;
+        entry.m_count      = it->m_count;
+        entry.m_totalUsecs = it->m_totalUsecs;
+        entry.m_maxUsecs   = it->m_maxUsecs;
+        entry.m_p50Usecs   = it->Percentile(0.50);
+        entry.m_p99Usecs   = it->Percentile(0.99);
+        entry.m_rows       = it->m_rows;
+        list.push_back(entry);
+    }
+    locker.unlock();
+
+    // Most expensive first, that is what anyone reading this wants to see.
+    std::sort(list.begin(), list.end(),
+              [](const Entry &a, const Entry &b)
+              { return a.m_totalUsecs > b.m_totalUsecs; });
+
+    return list;
+}
+
+void MythTimingStats::Reset(void)
+{
+    QMutexLocker locker(&m_lock);
+    m_histograms.clear();
+    m_startTime = QDateTime::currentDateTimeUtc();
+}
+
+QDateTime MythTimingStats::GetStartTime(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_startTime;
+}
+
+MythTimingStats *MythTimingStats::Get(const QString &group)
+{
+    QMutexLocker locker(&s_registryLock);
+    MythTimingStats *&stats = s_registry[group];
+    if (!stats)
+        stats = new MythTimingStats(group);
+    return stats;
+}
+
+MythTimingStats *MythTimingStats::Find(const QString &group)
+{
+    QMutexLocker locker(&s_registryLock);
+    return s_registry.value(group, nullptr);
+}
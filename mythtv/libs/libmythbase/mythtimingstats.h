@@ -0,0 +1,97 @@
+// -*- Mode: c++ -*-
+
+#ifndef MYTH_TIMING_STATS_H
+#define MYTH_TIMING_STATS_H
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include <QDateTime>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+#include "mythbaseexp.h"
+
+/** \brief Thread-safe latency histograms keyed by a name and an optional
+ *         detail string (e.g. a protocol command, or a query template and
+ *         the function that ran it).
+ *
+ *  Samples are stored in power of two microsecond buckets so recording a
+ *  sample is a hash lookup and a few increments, percentiles are estimated
+ *  from the bucket boundaries when a snapshot is taken.
+ *
+ *  Named process-wide instances are available through Get() so that
+ *  different subsystems can publish their statistics without knowing
+ *  who will read them.
+ */
+class MBASE_PUBLIC MythTimingStats
+{
+  public:
+    class MBASE_PUBLIC Entry
+    {
+      public:
+        QString  m_name;
+        QString  m_detail;
+        uint64_t m_count      {0};
+        uint64_t m_totalUsecs {0};
+        uint64_t m_maxUsecs   {0};
+        uint64_t m_p50Usecs   {0};
+        uint64_t m_p99Usecs   {0};
+        uint64_t m_rows       {0};
+
+        double MeanUsecs(void) const
+            { return m_count ? double(m_totalUsecs) / m_count : 0.0; }
+    };
+
+    explicit MythTimingStats(QString name) :
+        m_name(std::move(name)), m_startTime(QDateTime::currentDateTimeUtc()) {}
+    ~MythTimingStats() = default;
+
+    void Record(const QString &name, uint64_t usecs,
+                uint64_t rows = 0, const QString &detail = QString());
+
+    QList<Entry> Snapshot(void) const;
+    void Reset(void);
+
+    QString GetName(void) const { return m_name; }
+    QDateTime GetStartTime(void) const;
+
+    /// Returns the process-wide instance for group, creating it if needed.
+    static MythTimingStats *Get(const QString &group);
+    /// Returns the process-wide instance for group, or nullptr if nothing
+    /// has used it yet.
+    static MythTimingStats *Find(const QString &group);
+
+    static const int kNumBuckets = 40;
+
+  private:
+    Q_DISABLE_COPY(MythTimingStats)
+
+    class Histogram
+    {
+      public:
+        uint64_t m_count      {0};
+        uint64_t m_totalUsecs {0};
+        uint64_t m_maxUsecs   {0};
+        uint64_t m_rows       {0};
+        std::array<uint64_t,kNumBuckets> m_buckets {};
+
+        uint64_t Percentile(double fraction) const;
+    };
+
+    using Key = QPair<QString,QString>;
+
+    QString                m_name;
+    mutable QMutex         m_lock;
+    QDateTime              m_startTime;  // protected by m_lock
+    QHash<Key, Histogram>  m_histograms; // protected by m_lock
+
+    static QMutex                            s_registryLock;
+    static QHash<QString, MythTimingStats*>  s_registry;
+};
+
+#endif // MYTH_TIMING_STATS_H
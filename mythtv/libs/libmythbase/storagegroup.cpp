@@ -1,6 +1,11 @@
+#include <algorithm>
+
+#include <QDateTime>
 #include <QDir>
+#include <QDirIterator>
 #include <QFile>
 #include <QRegExp>
+#include <QRunnable>
 #include <QUrl>
 
 #include "storagegroup.h"
@@ -9,6 +14,7 @@
 #include "mythlogging.h"
 #include "mythcoreutil.h"
 #include "mythdirs.h"
+#include "mthreadpool.h"
 
 #define LOC QString("SG(%1): ").arg(m_groupname)
 
@@ -20,6 +26,31 @@ QMap<QString, QString> StorageGroup::m_builtinGroups;
 QMutex                 StorageGroup::s_groupToUseLock;
 QHash<QString,QString> StorageGroup::s_groupToUseCache;
 
+QMutex                 StorageGroup::s_fileCacheLock;
+QHash<QString, QHash<int, StorageGroup::FileLocation> >
+                       StorageGroup::s_fileCache;
+QHash<QString, int>    StorageGroup::s_fileCacheGroupIds;
+QVector<QStringList>   StorageGroup::s_fileCacheGroupDirs;
+QVector<bool>          StorageGroup::s_fileCacheScanned;
+uint                   StorageGroup::s_fileCacheGeneration   = 0;
+qint64                 StorageGroup::s_fileCachePruneTime    = 0;
+uint64_t               StorageGroup::s_fileCacheHits         = 0;
+uint64_t               StorageGroup::s_fileCacheNegativeHits = 0;
+uint64_t               StorageGroup::s_fileCacheMisses       = 0;
+uint64_t               StorageGroup::s_fileCacheStale        = 0;
+qint64                 StorageGroup::s_fileCacheStatsTime    = 0;
+
+// How long a file that wasn't found is reported as missing without
+// probing the directories again, for files created by other processes.
+static const qint64 kFileCacheNegativeMs = 10 * 1000;
+// How often the file location cache statistics are logged
+static const qint64 kFileCacheStatsMs = 10 * 60 * 1000;
+// How often expired entries are dropped from the file location cache
+static const qint64 kFileCachePruneMs = 60 * 1000;
+// How many files the file location cache holds before the least recently
+// used are dropped
+static const int kFileCacheMaxFiles = 200000;
+
 const QStringList StorageGroup::kSpecialGroups = QStringList()
     << QT_TRANSLATE_NOOP("(StorageGroups)", "LiveTV")
 //    << "Thumbnails"
@@ -621,7 +652,126 @@ QString StorageGroup::FindFile(const QString &filename)
     return result;
 }
 
+/// Lists a storage group's directories into the file location cache
+class StorageGroupScanner : public QRunnable
+{
+  public:
+    StorageGroupScanner(int group, QStringList dirs, uint generation) :
+        m_group(group), m_dirs(std::move(dirs)), m_generation(generation) { }
+
+    void run(void) override // QRunnable
+    {
+        StorageGroup::ScanFileCacheGroup(m_group, m_dirs, m_generation);
+    }
+
+  private:
+    int         m_group;
+    QStringList m_dirs;
+    uint        m_generation;
+};
+
+/**
+ *  \brief Finds the directory a file is in, using the file location cache
+ *
+ *  Lookups are cached process wide for every storage group directory list.
+ *  The first lookup in a group starts a background listing of its
+ *  directories to fill in the files they hold, so later lookups only need to
+ *  stat the file in the directory it was found in to check it is still there.
+ *  Files that weren't found are remembered for kFileCacheNegativeMs so lists
+ *  of recordings with missing files don't probe every directory for each of
+ *  them. FileAdded() and FileRemoved() keep the cache up to date for files
+ *  this process creates and deletes. The cache holds at most
+ *  kFileCacheMaxFiles files, see PruneFileCache().
+ */
 QString StorageGroup::FindFileDir(const QString &filename)
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QString dir;
+    bool logStats = false;
+    int group = 0;
+
+    {
+        QMutexLocker locker(&s_fileCacheLock);
+        group = FileCacheGroup();
+        if (!s_fileCacheScanned[group])
+        {
+            // List the directories in the background, a slow network mount
+            // shouldn't hold up this request. It is probed directly below.
+            s_fileCacheScanned[group] = true;
+            MThreadPool::globalInstance()->start(
+                new StorageGroupScanner(group, m_dirlist,
+                                        s_fileCacheGeneration),
+                "StorageGroupScan");
+        }
+
+        if (now - s_fileCacheStatsTime >= kFileCacheStatsMs)
+        {
+            logStats = s_fileCacheStatsTime != 0;
+            s_fileCacheStatsTime = now;
+        }
+
+        if (now - s_fileCachePruneTime >= kFileCachePruneMs ||
+            s_fileCache.size() > kFileCacheMaxFiles)
+            PruneFileCache(now);
+
+        auto files = s_fileCache.find(filename);
+        if (files != s_fileCache.end())
+        {
+            auto location = files->find(group);
+            if (location != files->end())
+            {
+                location->m_used = now;
+                if (!location->m_dir.isEmpty())
+                {
+                    dir = location->m_dir;
+                }
+                else if (now >= location->m_checked &&
+                         now - location->m_checked < kFileCacheNegativeMs)
+                {
+                    ++s_fileCacheNegativeHits;
+                    locker.unlock();
+                    if (logStats)
+                        LogFileCacheStats();
+                    return "";
+                }
+            }
+        }
+    }
+
+    if (logStats)
+        LogFileCacheStats();
+
+    if (!dir.isEmpty())
+    {
+        QFileInfo checkFile(dir + "/" + filename);
+        if (checkFile.exists() || checkFile.isSymLink())
+        {
+            QMutexLocker locker(&s_fileCacheLock);
+            ++s_fileCacheHits;
+            return dir;
+        }
+
+        LOG(VB_FILE, LOG_DEBUG, LOC +
+            QString("FindFileDir: '%1' is no longer in '%2'")
+                .arg(filename).arg(dir));
+    }
+
+    QString result = FindFileDirUncached(filename);
+
+    QMutexLocker locker(&s_fileCacheLock);
+    if (dir.isEmpty())
+        ++s_fileCacheMisses;
+    else
+        ++s_fileCacheStale;
+    FileLocation &location = s_fileCache[filename][group];
+    location.m_dir = result;
+    location.m_checked = now;
+    location.m_used = now;
+
+    return result;
+}
+
+QString StorageGroup::FindFileDirUncached(const QString &filename)
 {
     QString result = "";
     QFileInfo checkFile("");
@@ -649,18 +799,20 @@ QString StorageGroup::FindFileDir(const QString &filename)
         if (checkFile.exists() || checkFile.isSymLink())
             result = tmpFile;
     }
+    // The result is cached for this group, so the fallback groups don't
+    // need cache entries of their own.
     else if (m_groupname != "Default")
     {
         // Not found in current group so try Default
         StorageGroup sgroup("Default");
-        QString tmpFile = sgroup.FindFileDir(filename);
+        QString tmpFile = sgroup.FindFileDirUncached(filename);
         result = (tmpFile.isEmpty()) ? result : tmpFile;
     }
     else
     {
         // Not found in Default so try any dir
         StorageGroup sgroup;
-        QString tmpFile = sgroup.FindFileDir(filename);
+        QString tmpFile = sgroup.FindFileDirUncached(filename);
         result = (tmpFile.isEmpty()) ? result : tmpFile;
     }
 
@@ -863,6 +1015,223 @@ void StorageGroup::ClearGroupToUseCache(void)
 {
     QMutexLocker locker(&s_groupToUseLock);
     s_groupToUseCache.clear();
+    locker.unlock();
+
+    ClearFileCache();
+}
+
+/**
+ *  \brief Returns the file location cache id of this group's directory list
+ *
+ *  s_fileCacheLock must be held by the caller.
+ */
+int StorageGroup::FileCacheGroup(void)
+{
+    QString key = QString("%1:%2:%3:%4").arg(m_groupname).arg(m_hostname)
+        .arg(m_allowFallback).arg(m_dirlist.join(":"));
+
+    auto it = s_fileCacheGroupIds.constFind(key);
+    if (it != s_fileCacheGroupIds.constEnd())
+        return *it;
+
+    int group = s_fileCacheGroupDirs.size();
+    s_fileCacheGroupIds[key] = group;
+    s_fileCacheGroupDirs.push_back(m_dirlist);
+    s_fileCacheScanned.push_back(false);
+    return group;
+}
+
+/**
+ *  \brief Fills in the file location cache with the files in a group's
+ *         directories
+ *
+ *  Run in the background by the first FindFileDir() in the group. The
+ *  listing is dropped if the cache has been cleared since it was started.
+ */
+void StorageGroup::ScanFileCacheGroup(int group, const QStringList &dirs,
+                                      uint generation)
+{
+    QHash<QString, QString> found;
+    foreach (auto & groupDir, dirs)
+    {
+        QDirIterator it(groupDir, QDir::AllEntries | QDir::Hidden |
+                                  QDir::System | QDir::NoDotAndDotDot);
+        while (it.hasNext())
+        {
+            it.next();
+            if (!found.contains(it.fileName()))
+                found.insert(it.fileName(), groupDir);
+        }
+    }
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QMutexLocker locker(&s_fileCacheLock);
+    if (generation != s_fileCacheGeneration)
+        return;
+
+    for (auto it = found.cbegin(); it != found.cend(); ++it)
+    {
+        FileLocation &location = s_fileCache[it.key()][group];
+        if (location.m_dir.isEmpty())
+        {
+            location.m_dir = it.value();
+            location.m_used = now;
+        }
+    }
+
+    LOG(VB_FILE, LOG_INFO, QString("SG: File location cache: Cached %1 "
+                                   "files from %2 directories")
+        .arg(found.size()).arg(dirs.size()));
+
+    if (s_fileCache.size() > kFileCacheMaxFiles)
+        PruneFileCache(now);
+}
+
+/**
+ *  \brief Drops expired entries from the file location cache
+ *
+ *  Files that weren't found are dropped once kFileCacheNegativeMs has
+ *  passed. If the cache still holds more than kFileCacheMaxFiles files the
+ *  least recently used half of them are dropped too; they will be probed
+ *  for again if they are looked up. s_fileCacheLock must be held by the
+ *  caller.
+ */
+void StorageGroup::PruneFileCache(qint64 now)
+{
+    s_fileCachePruneTime = now;
+
+    QVector<qint64> used;
+    for (auto files = s_fileCache.begin(); files != s_fileCache.end(); )
+    {
+        qint64 lastUsed = 0;
+        for (auto location = files->begin(); location != files->end(); )
+        {
+            if (location->m_dir.isEmpty() &&
+                (now < location->m_checked ||
+                 now - location->m_checked >= kFileCacheNegativeMs))
+            {
+                location = files->erase(location);
+                continue;
+            }
+            lastUsed = std::max(lastUsed, location->m_used);
+            ++location;
+        }
+
+        if (files->isEmpty())
+        {
+            files = s_fileCache.erase(files);
+            continue;
+        }
+        used.push_back(lastUsed);
+        ++files;
+    }
+
+    if (s_fileCache.size() <= kFileCacheMaxFiles)
+        return;
+
+    auto median = used.begin() + used.size() / 2;
+    std::nth_element(used.begin(), median, used.end());
+    qint64 cutoff = *median;
+
+    int before = s_fileCache.size();
+    for (auto files = s_fileCache.begin(); files != s_fileCache.end(); )
+    {
+        qint64 lastUsed = 0;
+        foreach (const auto & location, *files)
+            lastUsed = std::max(lastUsed, location.m_used);
+        if (lastUsed <= cutoff)
+            files = s_fileCache.erase(files);
+        else
+            ++files;
+    }
+
+    LOG(VB_FILE, LOG_INFO, QString("SG: File location cache: Dropped %1 "
+                                   "least recently used files")
+        .arg(before - s_fileCache.size()));
+}
+
+/**
+ *  \brief Tells the file location cache a file has been created
+ *
+ *  Groups that had looked for the file without finding it, or that have
+ *  already listed their directories, will find it without probing.
+ */
+void StorageGroup::FileAdded(const QString &path)
+{
+    QString cleanPath = QDir::cleanPath(path);
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QMutexLocker locker(&s_fileCacheLock);
+
+    for (int group = 0; group < s_fileCacheGroupDirs.size(); ++group)
+    {
+        foreach (auto & dir, s_fileCacheGroupDirs[group])
+        {
+            if (!cleanPath.startsWith(dir + "/"))
+                continue;
+
+            QString filename = cleanPath.mid(dir.length() + 1);
+            QHash<int, FileLocation> &locations = s_fileCache[filename];
+            auto location = locations.find(group);
+            if (location != locations.end())
+            {
+                if (location->m_dir.isEmpty())
+                    location->m_dir = dir;
+            }
+            else if (s_fileCacheScanned[group])
+            {
+                FileLocation &added = locations[group];
+                added.m_dir = dir;
+                added.m_used = now;
+            }
+            break;
+        }
+    }
+}
+
+/**
+ *  \brief Tells the file location cache a file has been deleted
+ */
+void StorageGroup::FileRemoved(const QString &path)
+{
+    QString cleanPath = QDir::cleanPath(path);
+    QMutexLocker locker(&s_fileCacheLock);
+
+    foreach (auto & dirs, s_fileCacheGroupDirs)
+    {
+        foreach (auto & dir, dirs)
+        {
+            if (cleanPath.startsWith(dir + "/"))
+                s_fileCache.remove(cleanPath.mid(dir.length() + 1));
+        }
+    }
+}
+
+void StorageGroup::ClearFileCache(void)
+{
+    QMutexLocker locker(&s_fileCacheLock);
+    s_fileCache.clear();
+    // Keep the group ids, lookups in progress may still be using them
+    s_fileCacheScanned.fill(false);
+    ++s_fileCacheGeneration;
+}
+
+void StorageGroup::LogFileCacheStats(void)
+{
+    QMutexLocker locker(&s_fileCacheLock);
+
+    uint64_t lookups = s_fileCacheHits + s_fileCacheNegativeHits +
+        s_fileCacheMisses + s_fileCacheStale;
+    if (!lookups)
+        return;
+
+    LOG(VB_FILE, LOG_INFO, QString("SG: File location cache: %1 lookups, "
+                                   "%2% found, %3% not found, %4 misses, "
+                                   "%5 moved or deleted, %6 files")
+        .arg(lookups)
+        .arg(100.0 * s_fileCacheHits / lookups, 0, 'f', 1)
+        .arg(100.0 * s_fileCacheNegativeHits / lookups, 0, 'f', 1)
+        .arg(s_fileCacheMisses).arg(s_fileCacheStale)
+        .arg(s_fileCache.size()));
 }
 
 QString StorageGroup::GetGroupToUse(
@@ -1,10 +1,13 @@
 #ifndef _STORAGEGROUP_H
 #define _STORAGEGROUP_H
 
+#include <cstdint>
+
 #include <QStringList>
 #include <QMutex>
 #include <QHash>
 #include <QMap>
+#include <QVector>
 
 #include "mythbaseexp.h"
 
@@ -53,7 +56,20 @@ class MBASE_PUBLIC StorageGroup
     static QString GetGroupToUse(
         const QString &host, const QString &sgroup);
 
+    static void FileAdded(const QString &path);
+    static void FileRemoved(const QString &path);
+    static void ClearFileCache(void);
+    static void LogFileCacheStats(void);
+
   private:
+    friend class StorageGroupScanner;
+
+    QString FindFileDirUncached(const QString &filename);
+    int     FileCacheGroup(void);
+    static void ScanFileCacheGroup(int group, const QStringList &dirs,
+                                   uint generation);
+    static void PruneFileCache(qint64 now);
+
     static void    StaticInit(void);
     static bool    m_staticInitDone;
     static QMutex  m_staticInitLock;
@@ -67,6 +83,28 @@ class MBASE_PUBLIC StorageGroup
 
     static QMutex                 s_groupToUseLock;
     static QHash<QString,QString> s_groupToUseCache;
+
+    /// Result of a FindFileDir() lookup, an empty m_dir means not found
+    struct FileLocation
+    {
+        QString m_dir;
+        qint64  m_checked {0};  ///< when a negative entry was last probed
+        qint64  m_used    {0};  ///< when the entry was last looked up
+    };
+
+    // filename to FileCacheGroup() id to location
+    static QMutex                                       s_fileCacheLock;
+    static QHash<QString, QHash<int, FileLocation> >    s_fileCache;
+    static QHash<QString, int>                          s_fileCacheGroupIds;
+    static QVector<QStringList>                         s_fileCacheGroupDirs;
+    static QVector<bool>                                s_fileCacheScanned;
+    static uint     s_fileCacheGeneration;  ///< bumped by ClearFileCache()
+    static qint64   s_fileCachePruneTime;
+    static uint64_t s_fileCacheHits;
+    static uint64_t s_fileCacheNegativeHits;
+    static uint64_t s_fileCacheMisses;
+    static uint64_t s_fileCacheStale;
+    static qint64   s_fileCacheStatsTime;
 };
 
 #endif
@@ -0,0 +1,3 @@
+#include "test_logring.h"
+
+QTEST_APPLESS_MAIN(TestLogRing)
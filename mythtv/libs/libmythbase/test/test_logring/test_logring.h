@@ -0,0 +1,304 @@
+/*
+ *  Class TestLogRing
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <QtTest/QtTest>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+
+#include "logging.h"
+#include "logring.h"
+
+/// What LogPrintLine() did before the rings, kept for comparison: a heap
+/// allocated item per line on a queue shared by every thread.
+class LockedLogQueue
+{
+  public:
+    class Item
+    {
+      public:
+        char *m_file     {nullptr};
+        char *m_function {nullptr};
+        char  m_message[LOGLINE_MAX+1] {0};
+    };
+
+    ~LockedLogQueue()
+    {
+        while (Pop())
+            ;
+    }
+
+    void Push(const char *file, const char *function, int value)
+    {
+        auto *item = new Item;
+        item->m_file = strdup(file);
+        item->m_function = strdup(function);
+        snprintf(item->m_message, LOGLINE_MAX, "Processed event %d", value);
+
+        QMutexLocker locker(&m_lock);
+        m_queue.enqueue(item);
+    }
+
+    bool Pop(void)
+    {
+        Item *item = nullptr;
+        {
+            QMutexLocker locker(&m_lock);
+            if (m_queue.isEmpty())
+                return false;
+            item = m_queue.dequeue();
+        }
+        free(item->m_file);
+        free(item->m_function);
+        delete item;
+        return true;
+    }
+
+  private:
+    QMutex         m_lock;
+    QQueue<Item*>  m_queue;
+};
+
+static void push_record(LogRing &ring, uint64_t seq, const char *message)
+{
+    LogRing::Record *record = ring.Reserve(LOGLINE_MAX);
+    if (!record)
+    {
+        ring.CountDrop();
+        return;
+    }
+    size_t len = strlen(message);
+    memcpy(record->Message(), message, len + 1);
+    record->m_type = 1;
+    record->m_seq = seq;
+    record->m_file = __FILE__;
+    record->m_function = __FUNCTION__;
+    ring.Commit(record, len);
+}
+
+/// Plays the logger thread during the benchmark.
+class LogConsumer : public QThread
+{
+  public:
+    LogConsumer(LogRing *ring, LockedLogQueue *queue) :
+        m_ring(ring), m_queue(queue) {}
+
+    void run(void) override
+    {
+        while (!m_stop)
+        {
+            bool handled = false;
+            if (m_ring)
+            {
+                while (m_ring->Front())
+                {
+                    m_ring->Pop();
+                    m_consumed++;
+                    handled = true;
+                }
+            }
+            else
+            {
+                while (m_queue->Pop())
+                {
+                    m_consumed++;
+                    handled = true;
+                }
+            }
+            if (!handled)
+                QThread::yieldCurrentThread();
+        }
+    }
+
+    std::atomic<bool> m_stop {false};
+    uint64_t m_consumed {0}; ///< only read once the thread has finished
+
+  private:
+    LogRing        *m_ring;
+    LockedLogQueue *m_queue;
+};
+
+class TestLogRing: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    static void StartsEmpty(void)
+    {
+        LogRing ring;
+        QVERIFY(ring.IsEmpty());
+        QVERIFY(ring.Front() == nullptr);
+        QCOMPARE(ring.Dropped(), (uint64_t)0);
+    }
+
+    static void KeepsOrderAndContent(void)
+    {
+        LogRing ring;
+        push_record(ring, 1, "first");
+        push_record(ring, 2, "");
+        push_record(ring, 3, "third");
+        QVERIFY(!ring.IsEmpty());
+
+        const LogRing::Record *record = ring.Front();
+        QVERIFY(record != nullptr);
+        QCOMPARE(record->m_seq, (uint64_t)1);
+        QCOMPARE(QString(record->Message()), QString("first"));
+        QCOMPARE(QString(record->m_file), QString(__FILE__));
+        ring.Pop();
+
+        record = ring.Front();
+        QCOMPARE(record->m_seq, (uint64_t)2);
+        QCOMPARE(QString(record->Message()), QString());
+        ring.Pop();
+
+        record = ring.Front();
+        QCOMPARE(record->m_seq, (uint64_t)3);
+        QCOMPARE(QString(record->Message()), QString("third"));
+        ring.Pop();
+
+        QVERIFY(ring.IsEmpty());
+        QVERIFY(ring.Front() == nullptr);
+    }
+
+    static void WrapsAround(void)
+    {
+        // Small enough that the records wrap many times, and message
+        // lengths that leave every size of gap at the end of the buffer.
+        LogRing ring(4 * 1024);
+        QByteArray message;
+        for (uint64_t seq = 0; seq < 2000; seq++)
+        {
+            message.fill('a' + (seq % 26), (seq * 37) % 200);
+            push_record(ring, seq, message.constData());
+
+            const LogRing::Record *record = ring.Front();
+            QVERIFY(record != nullptr);
+            QCOMPARE(record->m_seq, seq);
+            QCOMPARE(QByteArray(record->Message()), message);
+            ring.Pop();
+            QVERIFY(ring.IsEmpty());
+        }
+        QCOMPARE(ring.Dropped(), (uint64_t)0);
+    }
+
+    static void DropsWhenFull(void)
+    {
+        LogRing ring(8 * 1024);
+        uint64_t seq = 0;
+        while (ring.Reserve(LOGLINE_MAX))
+            push_record(ring, seq++, "message");
+        QVERIFY(seq > 0);
+
+        push_record(ring, seq, "dropped");
+        push_record(ring, seq + 1, "dropped");
+        QCOMPARE(ring.Dropped(), (uint64_t)2);
+
+        // Nothing that was accepted is lost
+        for (uint64_t i = 0; i < seq; i++)
+        {
+            const LogRing::Record *record = ring.Front();
+            QVERIFY(record != nullptr);
+            QCOMPARE(record->m_seq, i);
+            ring.Pop();
+        }
+        QVERIFY(ring.Front() == nullptr);
+
+        // and there is room again once the consumer has caught up
+        push_record(ring, seq + 2, "message");
+        QCOMPARE(ring.Dropped(), (uint64_t)2);
+        QVERIFY(ring.Front() != nullptr);
+    }
+
+    static void RefusesRecordsLargerThanTheRing(void)
+    {
+        LogRing ring(1024);
+        QVERIFY(ring.Reserve(LOGLINE_MAX) == nullptr);
+        QVERIFY(ring.Reserve(100) != nullptr);
+    }
+
+    /// Caller latency of a log line, with a consumer thread draining
+    /// concurrently as the logger thread would. Lines per second is the
+    /// inverse of the time per iteration.
+    static void PushBenchmark_data(void)
+    {
+        QTest::addColumn<bool>("useRing");
+        QTest::newRow("per-thread ring") << true;
+        QTest::newRow("locked queue") << false;
+    }
+
+    static void PushBenchmark(void)
+    {
+        QFETCH(bool, useRing);
+
+        LogRing ring;
+        LockedLogQueue queue;
+        LogConsumer consumer(useRing ? &ring : nullptr, &queue);
+        consumer.start();
+
+        uint64_t seq = 0;
+        QBENCHMARK
+        {
+            if (useRing)
+            {
+                LogRing::Record *record = ring.Reserve(LOGLINE_MAX);
+                if (record)
+                {
+                    int len = snprintf(record->Message(), LOGLINE_MAX,
+                                       "Processed event %d", (int)seq);
+                    record->m_type = 1;
+                    record->m_seq = seq;
+                    record->m_file = __FILE__;
+                    record->m_function = __FUNCTION__;
+                    ring.Commit(record, len);
+                }
+                else
+                {
+                    ring.CountDrop();
+                }
+            }
+            else
+            {
+                queue.Push(__FILE__, __FUNCTION__, (int)seq);
+            }
+            seq++;
+        }
+
+        consumer.m_stop = true;
+        consumer.wait();
+
+        // Every message is either consumed or counted as dropped
+        uint64_t consumed = consumer.m_consumed;
+        if (useRing)
+        {
+            for (; ring.Front(); consumed++)
+                ring.Pop();
+            QCOMPARE(consumed + ring.Dropped(), seq);
+        }
+        else
+        {
+            while (queue.Pop())
+                consumed++;
+            QCOMPARE(consumed, seq);
+        }
+    }
+};
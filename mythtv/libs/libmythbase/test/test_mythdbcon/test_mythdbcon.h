@@ -0,0 +1,72 @@
+/*
+ *  Class TestMythDBCon
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "mythdbcon.h"
+
+class TestMythDBCon: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    static void NormalizeQuery_data(void)
+    {
+        QTest::addColumn<QString>("query");
+        QTest::addColumn<QString>("normalized");
+
+        QTest::newRow("placeholders")
+            << "SELECT title FROM program WHERE chanid = :CHANID"
+            << "SELECT title FROM program WHERE chanid = ?";
+        QTest::newRow("strings")
+            << "SELECT 'it''s', \"a\\\"b\" FROM t WHERE a = 'x'"
+            << "SELECT ?... FROM t WHERE a = ?";
+        QTest::newRow("numbers")
+            << "SELECT x1 FROM t2 WHERE a > 0x1F AND b < 1.5e3 LIMIT 10"
+            << "SELECT x1 FROM t2 WHERE a > ? AND b < ? LIMIT ?";
+        QTest::newRow("quoted identifiers")
+            << "SELECT `key`, `1st` FROM `t` WHERE `a:b` = 1"
+            << "SELECT `key`, `1st` FROM `t` WHERE `a:b` = ?";
+        QTest::newRow("whitespace")
+            << "  SELECT *\n   FROM recorded\tWHERE  a = 1 "
+            << "SELECT * FROM recorded WHERE a = ?";
+        QTest::newRow("lists")
+            << "DELETE FROM t WHERE id IN (1, 2,3, :ID4)"
+            << "DELETE FROM t WHERE id IN (?...)";
+        QTest::newRow("rows")
+            << "INSERT INTO t (a, b) VALUES (:A0, :B0), (:A1, :B1),(2, 'x')"
+            << "INSERT INTO t (a, b) VALUES (?...)...";
+    }
+
+    static void NormalizeQuery(void)
+    {
+        QFETCH(QString, query);
+        QFETCH(QString, normalized);
+
+        QCOMPARE(MSqlQuery::NormalizeQuery(query), normalized);
+    }
+
+    static void NormalizeQueryIsStable(void)
+    {
+        // Queries that only differ in their values share a template
+        QCOMPARE(MSqlQuery::NormalizeQuery(
+                     "SELECT * FROM t WHERE id IN (1, 2) AND s = 'a'"),
+                 MSqlQuery::NormalizeQuery(
+                     "SELECT * FROM t WHERE id IN (7, 8, 9) AND s = 'bc'"));
+    }
+};
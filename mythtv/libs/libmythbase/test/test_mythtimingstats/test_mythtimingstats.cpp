@@ -0,0 +1,3 @@
+#include "test_mythtimingstats.h"
+
+QTEST_APPLESS_MAIN(TestMythTimingStats)
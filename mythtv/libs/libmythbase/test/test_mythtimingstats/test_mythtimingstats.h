@@ -0,0 +1,100 @@
+/*
+ *  Class TestMythTimingStats
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
+ */
+
+#include <QtTest/QtTest>
+
+#include "mythtimingstats.h"
+
+class TestMythTimingStats: public QObject
+{
+    Q_OBJECT
+
+  private slots:
+    static void StartsEmpty(void)
+    {
+        MythTimingStats stats("test");
+        QVERIFY(stats.Snapshot().isEmpty());
+    }
+
+    static void AggregatesByNameAndDetail(void)
+    {
+        MythTimingStats stats("test");
+        stats.Record("QUERY_FILETRANSFER", 100, 0, "REQUEST_BLOCK");
+        stats.Record("QUERY_FILETRANSFER", 300, 0, "REQUEST_BLOCK");
+        stats.Record("QUERY_FILETRANSFER", 50, 0, "SEEK");
+        stats.Record("QUERY_RECORDINGS", 10000, 42);
+
+        QList<MythTimingStats::Entry> list = stats.Snapshot();
+        QCOMPARE(list.size(), 3);
+
+        // sorted by total time, most expensive first
+        QCOMPARE(list[0].m_name, QString("QUERY_RECORDINGS"));
+        QCOMPARE(list[0].m_rows, (uint64_t)42);
+        QCOMPARE(list[1].m_detail, QString("REQUEST_BLOCK"));
+        QCOMPARE(list[1].m_count, (uint64_t)2);
+        QCOMPARE(list[1].m_totalUsecs, (uint64_t)400);
+        QCOMPARE(list[1].m_maxUsecs, (uint64_t)300);
+        QCOMPARE(list[1].MeanUsecs(), 200.0);
+    }
+
+    static void PercentilesAreUpperBounds(void)
+    {
+        MythTimingStats stats("test");
+        for (int i = 0; i < 99; i++)
+            stats.Record("cmd", 10);
+        stats.Record("cmd", 5000);
+
+        QList<MythTimingStats::Entry> list = stats.Snapshot();
+        QCOMPARE(list.size(), 1);
+        QVERIFY(list[0].m_p50Usecs >= 10);
+        QVERIFY(list[0].m_p50Usecs < 16);
+        QVERIFY(list[0].m_p99Usecs < 16);
+        QCOMPARE(list[0].m_maxUsecs, (uint64_t)5000);
+
+        stats.Record("cmd", 5000);
+        list = stats.Snapshot();
+        QCOMPARE(list[0].m_p99Usecs, (uint64_t)5000);
+    }
+
+    static void ResetClears(void)
+    {
+        MythTimingStats stats("test");
+        stats.Record("cmd", 10);
+        stats.Reset();
+        QVERIFY(stats.Snapshot().isEmpty());
+    }
+
+    static void RegistryReturnsSameInstance(void)
+    {
+        MythTimingStats *a = MythTimingStats::Get("protocol");
+        MythTimingStats *b = MythTimingStats::Get("protocol");
+        QCOMPARE(a, b);
+        QVERIFY(a != MythTimingStats::Get("database"));
+        QCOMPARE(a->GetName(), QString("protocol"));
+    }
+
+    static void RecordBenchmark(void)
+    {
+        MythTimingStats stats("test");
+        QBENCHMARK
+        {
+            for (uint i = 0; i < 1000; i++)
+                stats.Record("QUERY_FILETRANSFER", i, 0, "REQUEST_BLOCK");
+        }
+    }
+};
@@ -11,6 +11,7 @@
 
 // Qt headers
 #include <QString>
+#include <QtEndian>
 
 // MythTV headers
 #include "threadedfilewriter.h"
@@ -20,6 +21,7 @@
 #include "mythtimer.h"
 #include "compat.h"
 #include "mythdate.h"
+#include "storagegroup.h"
 
 #define LOC QString("TFW(%1:%2): ").arg(m_filename).arg(m_fd)
 
@@ -42,6 +44,7 @@ void TFWSyncThread::run(void)
 const uint ThreadedFileWriter::kMaxBufferSize   = 8 * 1024 * 1024;
 const uint ThreadedFileWriter::kMinWriteSize    = 64 * 1024;
 const uint ThreadedFileWriter::kMaxBlockSize    = 1 * 1024 * 1024;
+const uint ThreadedFileWriter::kHashBlockSize   = 64 * 1024;
 
 /** \class ThreadedFileWriter
  *  \brief This class supports the writing of recordings to disk.
@@ -78,7 +81,17 @@ bool ThreadedFileWriter::ReOpen(const QString& newFilename)
     }
 
     if (!newFilename.isEmpty())
+    {
         m_filename = newFilename;
+        m_hashValid = true;
+        m_hashSize = 0;
+        m_hashHead.clear();
+    }
+    else
+    {
+        // We can't tell what is already in the file
+        m_hashValid = false;
+    }
 
     m_bufLock.unlock();
 
@@ -111,6 +124,9 @@ bool ThreadedFileWriter::Open(void)
     gCoreContext->RegisterFileForWrite(m_filename);
     m_registered = true;
 
+    if (m_filename != "-")
+        StorageGroup::FileAdded(m_filename);
+
     LOG(VB_FILE, LOG_INFO, LOC + "Open() successful");
 
 #ifdef _WIN32
@@ -216,6 +232,7 @@ int ThreadedFileWriter::Write(const void *data, uint count)
                     "\n\t\t\tis insufficient to deal with the number of on-going "
                     "\n\t\t\trecordings, or you have a disk failure.");
                 m_ignoreWrites = true;
+                m_hashValid = false;
                 return -1;
             }
             if (!m_warned)
@@ -277,12 +294,81 @@ int ThreadedFileWriter::Write(const void *data, uint count)
         left    -= towrite;
     }
 
+    if (m_hashValid)
+        HashData((const char*) data, count);
+
     LOG(VB_FILE, LOG_DEBUG, LOC + QString("Write(*, %1) total %2 cnt %3")
             .arg(count,4).arg(m_totalBufferUse).arg(m_writeBuffers.size()));
 
     return count;
 }
 
+/** \brief Keeps the parts of the file FileHash() reads, the first and
+ *         last kHashBlockSize bytes written.
+ */
+void ThreadedFileWriter::HashData(const char *data, uint count)
+{
+    if (m_hashSize < kHashBlockSize)
+    {
+        uint head = min<uint64_t>(count, kHashBlockSize - m_hashSize);
+        m_hashHead.insert(m_hashHead.end(), data, data + head);
+    }
+
+    // The tail is a ring, byte N of the file is at N % kHashBlockSize
+    if (m_hashTail.size() != kHashBlockSize)
+        m_hashTail.resize(kHashBlockSize);
+    uint i = (count > kHashBlockSize) ? count - kHashBlockSize : 0;
+    uint64_t pos = m_hashSize + i;
+    while (i < count)
+    {
+        uint off = pos % kHashBlockSize;
+        uint len = min(count - i, kHashBlockSize - off);
+        memcpy(&m_hashTail[off], data + i, len);
+        i   += len;
+        pos += len;
+    }
+
+    m_hashSize += count;
+}
+
+/** \brief Returns the FileHash() of the file as written so far, without
+ *         reading it back.
+ *
+ *  The buffers are flushed first, so the file on disk matches the hash
+ *  when this returns. An empty string is returned if the file was seeked
+ *  in, reopened without a new name, or truncated by failing writes, as
+ *  what was written then isn't what is in the file.
+ */
+QString ThreadedFileWriter::GetFileHash(void)
+{
+    Flush();
+
+    QMutexLocker locker(&m_bufLock);
+
+    if (!m_hashValid || m_hashSize == 0)
+        return QString();
+
+    // Same as FileHash(), which sums the first and last kHashBlockSize
+    // bytes as little endian 64 bit words and only reads whole words.
+    quint64 hash = m_hashSize;
+    for (size_t i = 0; i + sizeof(quint64) <= m_hashHead.size();
+         i += sizeof(quint64))
+        hash += qFromLittleEndian<quint64>(
+            reinterpret_cast<const uchar*>(&m_hashHead[i]));
+
+    if (m_hashSize >= kHashBlockSize)
+    {
+        uint start = (m_hashSize - kHashBlockSize) % kHashBlockSize;
+        vector<char> tail(m_hashTail.begin() + start, m_hashTail.end());
+        tail.insert(tail.end(), m_hashTail.begin(), m_hashTail.begin() + start);
+        for (size_t i = 0; i < tail.size(); i += sizeof(quint64))
+            hash += qFromLittleEndian<quint64>(
+                reinterpret_cast<const uchar*>(&tail[i]));
+    }
+
+    return QString("%1").arg(hash, 0, 16);
+}
+
 /** \fn ThreadedFileWriter::Seek(long long pos, int whence)
  *  \brief Seek to a position within stream; May be unsafe.
  *
@@ -309,7 +395,10 @@ long long ThreadedFileWriter::Seek(long long pos, int whence)
         }
     }
     m_flush = false;
-    return lseek(m_fd, pos, whence);
+    long long ret = lseek(m_fd, pos, whence);
+    if (ret < 0 || static_cast<uint64_t>(ret) != m_hashSize)
+        m_hashValid = false;
+    return ret;
 }
 
 /** \fn ThreadedFileWriter::Flush(void)
@@ -64,11 +64,13 @@ class MBASE_PUBLIC ThreadedFileWriter
     void Flush(void);
     bool SetBlocking(bool block = true);
     bool WritesFailing(void) const { return m_ignoreWrites; }
+    QString GetFileHash(void);
 
   protected:
     void DiskLoop(void);
     void SyncLoop(void);
     void TrimEmptyBuffers(void);
+    void HashData(const char *data, uint count);
 
   private:
     // file info
@@ -84,6 +86,12 @@ class MBASE_PUBLIC ThreadedFileWriter
     uint            m_tfwMinWriteSize    {kMinWriteSize}; // protected by buflock
     uint            m_totalBufferUse     {0};             // protected by buflock
 
+    // FileHash() of what has been written, kept as it is written
+    bool            m_hashValid          {true};          // protected by buflock
+    uint64_t        m_hashSize           {0};             // protected by buflock
+    vector<char>    m_hashHead;                           // protected by buflock
+    vector<char>    m_hashTail;                           // protected by buflock
+
     // buffers
     class TFWBuffer
     {
@@ -111,6 +119,8 @@ class MBASE_PUBLIC ThreadedFileWriter
     static const uint kMinWriteSize;
     /// Maximum block size to write at a time
     static const uint kMaxBlockSize;
+    /// Bytes at each end of the file that FileHash() reads
+    static const uint kHashBlockSize;
 
     bool m_warned                        {false};
     bool m_blocking                      {false};
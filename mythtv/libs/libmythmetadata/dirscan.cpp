@@ -11,6 +11,7 @@
 #include "mythlogging.h"
 #include "videoutils.h"
 #include "storagegroup.h"
+#include "filechangetracker.h"
 
 namespace
 {
@@ -43,14 +44,32 @@ namespace
     };
 
     bool scan_dir(const QString &start_path, DirectoryHandler *handler,
-                  const ext_lookup &ext_settings)
+                  const ext_lookup &ext_settings, FileChangeTracker *tracker)
     {
         QDir d(start_path);
 
         // Return a fail if directory doesn't exist.
         if (!d.exists())
             return false;
-        
+
+        // The files of an unchanged directory were handled by an earlier
+        // scan, only its subdirectories need to be looked at
+        if (tracker && !tracker->IsChanged(start_path))
+        {
+            foreach (const QString &subdir, tracker->SubDirs(start_path))
+            {
+                // DVD and Blu-ray folders are files
+                if (QDir(subdir + "/VIDEO_TS").exists() ||
+                    QDir(subdir + "/BDMV").exists())
+                    continue;
+
+                DirectoryHandler *dh =
+                        handler->newDir(QFileInfo(subdir).fileName(), subdir);
+                (void) scan_dir(subdir, dh, ext_settings, tracker);
+            }
+            return true;
+        }
+
         d.setFilter(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
         QFileInfoList list = d.entryInfoList();
         // An empty directory is fine
@@ -92,7 +111,8 @@ namespace
 
                     // Since we are dealing with a subdirectory failure is fine,
                     // so we'll just ignore the failue and continue
-                    (void) scan_dir(entry.absoluteFilePath(), dh, ext_settings);
+                    (void) scan_dir(entry.absoluteFilePath(), dh, ext_settings,
+                                    tracker);
                 }
             }
 
@@ -225,7 +245,7 @@ namespace
 
 bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
         const FileAssociations::ext_ignore_list &ext_disposition,
-        bool list_unknown_extensions)
+        bool list_unknown_extensions, FileChangeTracker *tracker)
 {
     ext_lookup extlookup(ext_disposition, list_unknown_extensions);
 
@@ -237,7 +257,7 @@ bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
             QString("MythVideo::ScanVideoDirectory Scanning (%1)")
                 .arg(start_path));
 
-        if (!scan_dir(start_path, handler, extlookup))
+        if (!scan_dir(start_path, handler, extlookup, tracker))
         {
             LOG(VB_GENERAL, LOG_ERR,
                 QString("MythVideo::ScanVideoDirectory failed to scan %1")
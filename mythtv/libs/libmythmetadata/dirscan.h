@@ -15,8 +15,12 @@ class META_PUBLIC DirectoryHandler
                             const QString &host) = 0;
 };
 
+class FileChangeTracker;
+
+/// Local directories the tracker reports as unchanged aren't listed, only
+/// their subdirectories are scanned.
 META_PUBLIC bool ScanVideoDirectory(const QString &start_path, DirectoryHandler *handler,
         const FileAssociations::ext_ignore_list &ext_disposition,
-        bool list_unknown_extensions);
+        bool list_unknown_extensions, FileChangeTracker *tracker = nullptr);
 
 #endif // DIRSCAN_H_
@@ -0,0 +1,609 @@
+// POSIX headers
+#include <cerrno>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#endif
+
+// C++ headers
+#include <algorithm>
+#include <functional>
+#include <utility>
+
+// Qt headers
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QPair>
+#include <QRunnable>
+#include <QVector>
+
+// MythTV headers
+#include "mythcorecontext.h"
+#include "mythdb.h"
+#include "filesysteminfo.h"
+#include "mythlogging.h"
+#include "mthreadpool.h"
+#include "filechangetracker.h"
+
+#define LOC QString("FileChangeTracker(%1): ").arg(m_scanner)
+
+/// Number of directories stat'ed at the same time by Update()
+static const int kStatThreads = 8;
+/// Rows written by each INSERT in Save()
+static const int kInsertBatch = 500;
+
+#ifdef __linux__
+static const uint32_t kWatchEvents = IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE |
+                                     IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                     IN_DELETE_SELF | IN_MOVE_SELF;
+#endif
+
+QMutex                            FileChangeTracker::s_trackersLock;
+QMap<QString, FileChangeTracker*> FileChangeTracker::s_trackers;
+
+namespace
+{
+    class StatRunnable : public QRunnable
+    {
+      public:
+        explicit StatRunnable(std::function<void()> func)
+            : m_func(std::move(func)) {}
+        void run(void) override { m_func(); } // QRunnable
+      private:
+        std::function<void()> m_func;
+    };
+}
+
+/** \brief Returns the tracker for the named scanner, creating it if needed.
+ *
+ *  Each scanner has its own snapshot, so a scan by one scanner doesn't
+ *  hide changes from another one scanning the same directories.
+ */
+FileChangeTracker *FileChangeTracker::GetTracker(const QString &scanner)
+{
+    QMutexLocker locker(&s_trackersLock);
+
+    FileChangeTracker *tracker = s_trackers.value(scanner);
+    if (!tracker)
+    {
+        static bool s_connected = false;
+        if (!s_connected && QCoreApplication::instance())
+        {
+            QObject::connect(QCoreApplication::instance(),
+                             &QCoreApplication::aboutToQuit,
+                             &FileChangeTracker::StopAll);
+            s_connected = true;
+        }
+
+        tracker = new FileChangeTracker(scanner);
+        s_trackers.insert(scanner, tracker);
+    }
+    return tracker;
+}
+
+/// Stops watching for changes and deletes all the trackers.
+void FileChangeTracker::StopAll(void)
+{
+    QMutexLocker locker(&s_trackersLock);
+
+    for (auto *tracker : qAsConst(s_trackers))
+    {
+        tracker->m_lock.lock();
+        tracker->m_stop = true;
+        tracker->m_lock.unlock();
+        tracker->wait();
+        delete tracker;
+    }
+    s_trackers.clear();
+}
+
+FileChangeTracker::FileChangeTracker(QString scanner)
+  : MThread("FileChangeTracker"), m_scanner(std::move(scanner))
+{
+}
+
+FileChangeTracker::~FileChangeTracker()
+{
+    wait();
+
+#ifdef __linux__
+    if (m_inotifyFd >= 0)
+        close(m_inotifyFd);
+#endif
+}
+
+FileChangeTracker::DirState FileChangeTracker::StatDir(const QString &path)
+{
+    DirState state;
+    struct stat st {};
+    if (stat(path.toLocal8Bit().constData(), &st) == 0 && S_ISDIR(st.st_mode))
+    {
+        state.m_exists = true;
+        state.m_mtime  = st.st_mtime;
+        state.m_inode  = st.st_ino;
+        state.m_device = st.st_dev;
+    }
+    return state;
+}
+
+/// Stats the directories in parallel, on network filesystems each stat
+/// is a round trip to the server.
+void FileChangeTracker::StatAll(const QStringList &paths, DirMap &results)
+{
+    QVector<DirState> states(paths.size());
+
+    MThreadPool pool("FileChangeTrackerStat");
+    pool.setMaxThreadCount(kStatThreads);
+
+    int slice = (paths.size() + kStatThreads - 1) / kStatThreads;
+    for (int start = 0; start < paths.size(); start += slice)
+    {
+        int end = std::min(start + slice, paths.size());
+        pool.start(new StatRunnable([&paths, &states, start, end]()
+        {
+            for (int i = start; i < end; i++)
+                states[i] = StatDir(paths[i]);
+        }), "FileChangeTrackerStat");
+    }
+    pool.waitForDone();
+
+    for (int i = 0; i < paths.size(); i++)
+        results.insert(paths[i], states[i]);
+}
+
+/// Fills in the subdirectories of each directory, from their paths.
+void FileChangeTracker::AddChildren(const DirMap &dirs,
+                                    QMultiHash<QString,QString> &children)
+{
+    children.clear();
+    for (auto it = dirs.cbegin(); it != dirs.cend(); ++it)
+    {
+        int slash = it.key().lastIndexOf('/');
+        if (slash > 0)
+            children.insert(it.key().left(slash), it.key());
+    }
+}
+
+bool FileChangeTracker::UnderRoots(const QString &path) const
+{
+    for (const auto &root : m_roots)
+    {
+        if (path == root || path.startsWith(root + "/"))
+            return true;
+    }
+    return false;
+}
+
+void FileChangeTracker::LoadSnapshot(void)
+{
+    m_loaded = true;
+    m_settingsHash = gCoreContext->GetSettingOnHost(
+        "ScannerSettings" + m_scanner, gCoreContext->GetHostName());
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT path, mtime, inode FROM scannerdirs "
+                  "WHERE hostname = :HOST AND scanner = :SCANNER");
+    query.bindValue(":HOST",    gCoreContext->GetHostName());
+    query.bindValue(":SCANNER", m_scanner);
+    if (!query.exec())
+    {
+        MythDB::DBError("FileChangeTracker::LoadSnapshot", query);
+        return;
+    }
+
+    while (query.next())
+    {
+        DirState state;
+        state.m_exists = true;
+        state.m_mtime  = query.value(1).toLongLong();
+        state.m_inode  = query.value(2).toULongLong();
+        m_snapshot.insert(query.value(0).toString(), state);
+    }
+    AddChildren(m_snapshot, m_snapshotChildren);
+
+    LOG(VB_FILE, LOG_INFO, LOC + QString("Loaded %1 directories")
+        .arg(m_snapshot.size()));
+}
+
+/** \brief Finds the directories under the roots that changed since the
+ *         last Save().
+ *
+ *  Directories that are new, were replaced, have a new modification time
+ *  or were reported by inotify are changed, and are listed to find their
+ *  subdirectories. The subdirectories of the others are taken from the
+ *  snapshot.
+ *
+ *  \param roots Directories to scan
+ *  \param settings The scanner's settings that decide which files it
+ *         keeps, such as file types and exclusions. All directories are
+ *         changed if these differ from the last Save().
+ *  \param fullScan Report all directories as changed, for a full rescan
+ */
+void FileChangeTracker::Update(const QStringList &roots,
+                               const QString &settings, bool fullScan)
+{
+    QMutexLocker locker(&m_lock);
+
+    if (!m_loaded)
+        LoadSnapshot();
+
+    m_treeSettingsHash = QString(QCryptographicHash::hash(
+        settings.toUtf8(), QCryptographicHash::Md5).toHex());
+    bool settingsChanged = m_treeSettingsHash != m_settingsHash;
+    if (fullScan)
+        LOG(VB_GENERAL, LOG_INFO, LOC + "Full scan, checking all directories");
+    else if (settingsChanged)
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            "Scanner settings changed, checking all directories");
+    bool allChanged = fullScan || settingsChanged;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    m_roots.clear();
+    for (const auto &root : roots)
+        m_roots << QDir(root).absolutePath();
+
+    QStringList known = m_roots;
+    for (auto it = m_snapshot.cbegin(); it != m_snapshot.cend(); ++it)
+    {
+        if (UnderRoots(it.key()) && !m_roots.contains(it.key()))
+            known << it.key();
+    }
+
+    DirMap stats;
+    StatAll(known, stats);
+
+    DirMap tree;
+    QMultiHash<QString,QString> children;
+    QSet<QString> changed;
+    QSet<QString> watched;
+    QSet<QPair<uint64_t,uint64_t> > seen;
+    QStringList queue = m_roots;
+
+    while (!queue.isEmpty())
+    {
+        QString path = queue.takeFirst();
+        if (tree.contains(path))
+            continue;
+
+        DirState state = stats.contains(path) ? stats.value(path)
+                                              : StatDir(path);
+        if (!state.m_exists)
+            continue;
+
+        // Don't follow links back into the tree
+        QPair<uint64_t,uint64_t> id(state.m_device, state.m_inode);
+        if (seen.contains(id))
+            continue;
+        seen.insert(id);
+
+        tree.insert(path, state);
+
+        auto old = m_snapshot.constFind(path);
+        bool same = !allChanged &&
+                    old != m_snapshot.constEnd() &&
+                    old->m_mtime == state.m_mtime &&
+                    old->m_inode == state.m_inode &&
+                    !m_dirty.contains(path);
+
+        QStringList subdirs;
+        if (same)
+        {
+            subdirs = m_snapshotChildren.values(path);
+            if (m_watchedSinceSnapshot.contains(path))
+                watched.insert(path);
+        }
+        else
+        {
+            changed.insert(path);
+
+            QDir dir(path);
+            dir.setFilter(QDir::Dirs | QDir::NoDotAndDotDot);
+            foreach (const QFileInfo &fi, dir.entryInfoList())
+                subdirs << fi.absoluteFilePath();
+        }
+
+        for (const auto &subdir : subdirs)
+        {
+            children.insert(path, subdir);
+            queue << subdir;
+        }
+    }
+
+    m_tree.swap(tree);
+    m_treeChildren.swap(children);
+    m_changed.swap(changed);
+    m_treeWatched.swap(watched);
+    m_dirtySeen = m_dirty;
+
+    // Only directories already watched while they were stat'ed can be
+    // trusted once this tree becomes the snapshot
+    m_watchedSinceTree.clear();
+    for (const auto &path : qAsConst(m_watches))
+    {
+        if (!m_remoteWatches.contains(path))
+            m_watchedSinceTree.insert(path);
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("%1 of %2 directories changed since the last scan, "
+                "%3 unchanged ones watched, checked in %4 ms")
+            .arg(m_changed.size()).arg(m_tree.size())
+            .arg(m_treeWatched.size()).arg(timer.elapsed()));
+}
+
+/** \brief Returns true if the directory needs to be listed, as files may
+ *         have been added to or removed from it.
+ *
+ *  Directories Update() didn't find are always changed.
+ */
+bool FileChangeTracker::IsChanged(const QString &dir) const
+{
+    QMutexLocker locker(&m_lock);
+
+    QString path = QDir::cleanPath(dir);
+    return !m_tree.contains(path) || m_changed.contains(path);
+}
+
+/** \brief Returns true if the directory is unchanged and inotify has
+ *         watched it since the snapshot it was compared against.
+ *
+ *  None of its files can have been written then, so a scanner doesn't need
+ *  to check them. Otherwise an unchanged directory still has the same
+ *  entries, but a file may have been rewritten in place.
+ */
+bool FileChangeTracker::IsWatched(const QString &dir) const
+{
+    QMutexLocker locker(&m_lock);
+
+    return m_treeWatched.contains(QDir::cleanPath(dir));
+}
+
+/// Returns the subdirectories found by Update(), as absolute paths.
+QStringList FileChangeTracker::SubDirs(const QString &dir) const
+{
+    QMutexLocker locker(&m_lock);
+
+    QStringList subdirs = m_treeChildren.values(QDir::cleanPath(dir));
+    subdirs.sort();
+    return subdirs;
+}
+
+/// Keeps the tree from the last Update() as the snapshot the next one
+/// compares against, and watches its directories for changes.
+void FileChangeTracker::Save(void)
+{
+    QMutexLocker locker(&m_lock);
+
+    // Directories scanned from other roots stay as they were
+    DirMap snapshot = m_tree;
+    for (auto it = m_snapshot.cbegin(); it != m_snapshot.cend(); ++it)
+    {
+        if (!UnderRoots(it.key()))
+            snapshot.insert(it.key(), it.value());
+    }
+
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("DELETE FROM scannerdirs "
+                  "WHERE hostname = :HOST AND scanner = :SCANNER");
+    query.bindValue(":HOST",    gCoreContext->GetHostName());
+    query.bindValue(":SCANNER", m_scanner);
+    if (!query.exec())
+    {
+        MythDB::DBError("FileChangeTracker::Save -- delete", query);
+        return;
+    }
+
+    QStringList paths = snapshot.keys();
+    for (int start = 0; start < paths.size(); start += kInsertBatch)
+    {
+        int end = std::min(start + kInsertBatch, paths.size());
+
+        QStringList rows;
+        for (int i = start; i < end; i++)
+        {
+            rows << QString("(:HOST%1, :SCANNER%1, :PATH%1, :MTIME%1, "
+                            ":INODE%1)").arg(i - start);
+        }
+        query.prepare("INSERT INTO scannerdirs "
+                      "  (hostname, scanner, path, mtime, inode) "
+                      "VALUES " + rows.join(", "));
+        for (int i = start; i < end; i++)
+        {
+            const DirState &state = snapshot[paths[i]];
+            QString n = QString::number(i - start);
+            query.bindValue(":HOST" + n,    gCoreContext->GetHostName());
+            query.bindValue(":SCANNER" + n, m_scanner);
+            query.bindValue(":PATH" + n,    paths[i]);
+            query.bindValue(":MTIME" + n,   static_cast<qint64>(state.m_mtime));
+            query.bindValue(":INODE" + n,   static_cast<quint64>(state.m_inode));
+        }
+        if (!query.exec())
+        {
+            MythDB::DBError("FileChangeTracker::Save -- insert", query);
+            return;
+        }
+    }
+
+    if (m_treeSettingsHash != m_settingsHash)
+    {
+        gCoreContext->SaveSettingOnHost("ScannerSettings" + m_scanner,
+                                        m_treeSettingsHash,
+                                        gCoreContext->GetHostName());
+        m_settingsHash = m_treeSettingsHash;
+    }
+
+    m_snapshot.swap(snapshot);
+    AddChildren(m_snapshot, m_snapshotChildren);
+    m_dirty.subtract(m_dirtySeen);
+    m_dirtySeen.clear();
+
+    // Directories from other roots keep the watches they had, the ones
+    // in the new tree only count if they were watched when it was taken
+    QSet<QString> watched;
+    for (const auto &path : qAsConst(m_watchedSinceSnapshot))
+    {
+        if (!UnderRoots(path))
+            watched.insert(path);
+    }
+    for (const auto &path : qAsConst(m_watchedSinceTree))
+    {
+        if (m_tree.contains(path))
+            watched.insert(path);
+    }
+    m_watchedSinceSnapshot.swap(watched);
+    m_watchedSinceTree.clear();
+
+    UpdateWatches();
+}
+
+/// Watches every directory in the snapshot with inotify, m_lock must be held.
+void FileChangeTracker::UpdateWatches(void)
+{
+#ifdef __linux__
+    if (m_inotifyFd < 0)
+    {
+        m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_inotifyFd < 0)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                "Can't watch for changes between scans" + ENO);
+            return;
+        }
+    }
+
+    // Directories may have been removed, or the limit raised, since
+    // watches last ran out
+    m_watchesFull = false;
+
+    QSet<QString> watched;
+    for (auto it = m_watches.begin(); it != m_watches.end(); )
+    {
+        if (m_snapshot.contains(it.value()))
+        {
+            watched.insert(it.value());
+            ++it;
+        }
+        else
+        {
+            inotify_rm_watch(m_inotifyFd, it.key());
+            m_remoteWatches.remove(it.value());
+            it = m_watches.erase(it);
+        }
+    }
+
+    for (auto it = m_snapshot.cbegin();
+         it != m_snapshot.cend() && !m_watchesFull; ++it)
+    {
+        if (watched.contains(it.key()))
+            continue;
+
+        int wd = inotify_add_watch(m_inotifyFd,
+                                   it.key().toLocal8Bit().constData(),
+                                   kWatchEvents);
+        if (wd >= 0)
+        {
+            m_watches.insert(wd, it.key());
+
+            FileSystemInfo fsInfo;
+            fsInfo.setPath(it.key());
+            fsInfo.setLocal();
+            fsInfo.PopulateFSProp();
+            if (!fsInfo.isLocal())
+                m_remoteWatches.insert(it.key());
+        }
+        else if (errno == ENOSPC)
+        {
+            LOG(VB_GENERAL, LOG_WARNING, LOC +
+                QString("Ran out of inotify watches after %1 directories, "
+                        "increase fs.inotify.max_user_watches to watch "
+                        "them all").arg(m_watches.size()));
+            m_watchesFull = true;
+        }
+    }
+
+    if (!isRunning())
+        start();
+#endif
+}
+
+void FileChangeTracker::run(void)
+{
+    RunProlog();
+
+#ifdef __linux__
+    while (true)
+    {
+        m_lock.lock();
+        bool stop = m_stop;
+        m_lock.unlock();
+        if (stop)
+            break;
+
+        struct pollfd pfd {};
+        pfd.fd     = m_inotifyFd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, 500) > 0)
+            ReadEvents();
+    }
+#endif
+
+    RunEpilog();
+}
+
+/// Marks the directories inotify reports changes in as dirty.
+void FileChangeTracker::ReadEvents(void)
+{
+#ifdef __linux__
+    alignas(struct inotify_event) char buf[4096];
+
+    while (true)
+    {
+        ssize_t len = read(m_inotifyFd, buf, sizeof(buf));
+        if (len <= 0)
+            break;
+
+        QMutexLocker locker(&m_lock);
+
+        const struct inotify_event *event = nullptr;
+        for (char *ptr = buf; ptr < buf + len;
+             ptr += sizeof(struct inotify_event) + event->len)
+        {
+            event = reinterpret_cast<const struct inotify_event *>(ptr);
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                // Events were lost, anything could have changed
+                LOG(VB_FILE, LOG_INFO, LOC + "inotify queue overflowed");
+                for (auto it = m_snapshot.cbegin(); it != m_snapshot.cend(); ++it)
+                    m_dirty.insert(it.key());
+                continue;
+            }
+
+            auto watch = m_watches.find(event->wd);
+            if (watch == m_watches.end())
+                continue;
+
+            if (event->mask & IN_IGNORED)
+            {
+                // Changes are no longer seen, so the directory's files
+                // must be checked again
+                m_watchedSinceSnapshot.remove(watch.value());
+                m_watchedSinceTree.remove(watch.value());
+                m_remoteWatches.remove(watch.value());
+                m_watches.erase(watch);
+                continue;
+            }
+
+            LOG(VB_FILE, LOG_DEBUG, LOC + QString("Change in %1")
+                .arg(watch.value()));
+            m_dirty.insert(watch.value());
+        }
+    }
+#endif
+}
@@ -0,0 +1,121 @@
+#ifndef FILECHANGETRACKER_H
+#define FILECHANGETRACKER_H
+
+#include <cstdint>
+
+// Qt headers
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+// MythTV headers
+#include "mythmetaexp.h"
+#include "mthread.h"
+
+/** \class FileChangeTracker
+ *  \brief Tells library scanners which directories may have changed
+ *         since their last scan.
+ *
+ *  A snapshot of the directory tree under the scanned roots, the path,
+ *  modification time and inode of every directory, is kept in the
+ *  database for each scanner. Update() stats all the known directories in
+ *  parallel and only lists the ones that are new or whose modification
+ *  time or inode changed, to find their subdirectories. A scanner then
+ *  only needs to list the directories IsChanged() returns true for, and
+ *  can take the subdirectories of the others from SubDirs().
+ *
+ *  A directory's modification time only changes when entries are added,
+ *  removed or renamed in it, not when a file in it is rewritten, so a
+ *  scanner must still check the files it knows of in an unchanged
+ *  directory against the database. Where inotify is available the
+ *  directories are watched between scans, and any directory with a file
+ *  written, created, deleted or moved in it is reported as changed by the
+ *  next Update(). Once a directory has been watched since the snapshot it
+ *  is compared against was taken, IsWatched() returns true and even that
+ *  check can be skipped. This only happens in a process that stays up
+ *  between scans, and never on network filesystems, where inotify doesn't
+ *  see changes made by other hosts.
+ *
+ *  Save() keeps the tree from the last Update() as the new snapshot, it
+ *  should only be called once a scan has completed. The snapshot is only
+ *  valid for the scanner settings that were passed to Update(), if they
+ *  change every directory is reported as changed.
+ */
+class META_PUBLIC FileChangeTracker : public MThread
+{
+  public:
+    static FileChangeTracker *GetTracker(const QString &scanner);
+    static void StopAll(void);
+
+    void Update(const QStringList &roots,
+                const QString &settings = QString(), bool fullScan = false);
+    void Save(void);
+
+    bool IsChanged(const QString &dir) const;
+    bool IsWatched(const QString &dir) const;
+    QStringList SubDirs(const QString &dir) const;
+
+  protected:
+    void run(void) override; // MThread
+
+  private:
+    explicit FileChangeTracker(QString scanner);
+    ~FileChangeTracker() override;
+    Q_DISABLE_COPY(FileChangeTracker)
+
+    class DirState
+    {
+      public:
+        bool     m_exists {false};
+        int64_t  m_mtime  {0};
+        uint64_t m_inode  {0};
+        uint64_t m_device {0};  ///< not saved, for finding loops
+    };
+    using DirMap = QHash<QString, DirState>;
+
+    static DirState StatDir(const QString &path);
+    void LoadSnapshot(void);
+    static void StatAll(const QStringList &paths, DirMap &results);
+    static void AddChildren(const DirMap &dirs,
+                            QMultiHash<QString,QString> &children);
+    bool UnderRoots(const QString &path) const;
+    void UpdateWatches(void);
+    void ReadEvents(void);
+
+    QString                     m_scanner;
+    mutable QMutex              m_lock;
+    bool                        m_loaded   {false};
+    QString                     m_settingsHash;  ///< as of the last Save()
+    QString                     m_treeSettingsHash; ///< as of the last Update()
+
+    QStringList                 m_roots;
+    DirMap                      m_snapshot;  ///< as of the last Save()
+    QMultiHash<QString,QString> m_snapshotChildren;
+    DirMap                      m_tree;      ///< as of the last Update()
+    QMultiHash<QString,QString> m_treeChildren;
+    QSet<QString>               m_changed;
+    /// Directories watched since m_snapshot was taken
+    QSet<QString>               m_watchedSinceSnapshot;
+    /// Directories watched when m_tree was taken
+    QSet<QString>               m_watchedSinceTree;
+    /// Unchanged directories in m_tree that were watched since m_snapshot
+    QSet<QString>               m_treeWatched;
+    QSet<QString>               m_dirty;     ///< reported by inotify
+    QSet<QString>               m_dirtySeen; ///< m_dirty at Update()
+
+    int                         m_inotifyFd {-1};
+    QHash<int,QString>          m_watches;   ///< watch descriptor to path
+    /// Watched directories on network filesystems, where other hosts'
+    /// changes aren't reported
+    QSet<QString>               m_remoteWatches;
+    bool                        m_watchesFull {false};
+    bool                        m_stop      {false};
+
+    static QMutex                            s_trackersLock;
+    static QMap<QString, FileChangeTracker*> s_trackers;
+};
+
+#endif // FILECHANGETRACKER_H
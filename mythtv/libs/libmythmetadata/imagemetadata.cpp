@@ -269,6 +269,7 @@ public:
     int         GetOrientation(bool *exists = nullptr) override; // ImageMetaData
     QDateTime   GetOriginalDateTime(bool *exists = nullptr) override; // ImageMetaData
     QString     GetComment(bool *exists = nullptr) override; // ImageMetaData
+    QByteArray  GetThumbnail() override; // ImageMetaData
 
 protected:
     static QString DecodeComment(std::string rawValue);
@@ -290,6 +291,11 @@ protected:
 PictureMetaData::PictureMetaData(const QString &filePath)
     : ImageMetaData(filePath), m_image(nullptr)
 {
+    // Exiv2's XMP parser isn't thread-safe until it has been initialised.
+    // Thumbnail workers read pictures concurrently so do it once, up front.
+    static const bool s_xmpReady = Exiv2::XmpParser::initialize();
+    Q_UNUSED(s_xmpReady);
+
     try
     {
         m_image = Exiv2::ImageFactory::open(filePath.toStdString());
@@ -464,6 +470,29 @@ QString PictureMetaData::GetComment(bool *exists)
 }
 
 
+/*!
+   \brief Reads the thumbnail embedded in the Exif metadata
+   \return Encoded thumbnail (usually a JPEG), or empty if there is none
+ */
+QByteArray PictureMetaData::GetThumbnail()
+{
+    if (!IsValid())
+        return QByteArray();
+
+    try
+    {
+        Exiv2::ExifThumbC thumb(m_exifData);
+        Exiv2::DataBuf buf = thumb.copy();
+        return QByteArray(reinterpret_cast<const char *>(buf.pData_), buf.size_);
+    }
+    catch (Exiv2::Error &e)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Exiv2 exception %1").arg(e.what()));
+    }
+    return QByteArray();
+}
+
+
 /*!
    \brief Decodes charset of UserComment
    \param rawValue Metadata value with optional "[charset=...]" prefix
@@ -496,6 +525,8 @@ public:
     int         GetOrientation(bool *exists = nullptr) override; // ImageMetaData
     QDateTime   GetOriginalDateTime(bool *exists = nullptr) override; // ImageMetaData
     QString     GetComment(bool *exists = nullptr) override; // ImageMetaData
+    QByteArray  GetThumbnail() override // ImageMetaData
+        { return QByteArray(); }
 
 protected:
     QString GetTag(const QString &key, bool *exists = nullptr);
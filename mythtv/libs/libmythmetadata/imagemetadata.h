@@ -124,6 +124,7 @@ public:
     virtual int         GetOrientation(bool *exists = nullptr)      = 0;
     virtual QDateTime   GetOriginalDateTime(bool *exists = nullptr) = 0;
     virtual QString     GetComment(bool *exists = nullptr)          = 0;
+    virtual QByteArray  GetThumbnail()                           = 0;
 
 protected:
     explicit ImageMetaData(QString filePath)
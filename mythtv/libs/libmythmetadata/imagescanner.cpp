@@ -4,6 +4,7 @@
 #include "mythcorecontext.h"  // for events
 
 #include "imagemetadata.h"
+#include "filechangetracker.h"
 
 /*!
  \brief Constructor
@@ -171,6 +172,27 @@ void ImageScanThread<DBFS>::run()
             // Adapter determines list of dirs to scan
             StringMap paths = m_dbfs.GetScanDirs();
 
+            // Only list directories that changed since the last scan. Clones
+            // from several SG dirs share Db dirs, so they must all be listed.
+            m_tracker = nullptr;
+            m_dbFilesByDir.clear();
+            if (paths.size() == 1 || !gCoreContext->IsBackend())
+            {
+                // Which files are kept depends on the supported types and
+                // the exclusions
+                QStringList scanSettings =
+                    m_dbfs.GetImageFilters().nameFilters();
+                scanSettings << gCoreContext->GetSetting("GalleryIgnoreFilter", "");
+
+                m_tracker = FileChangeTracker::GetTracker(
+                    gCoreContext->IsBackend() ? "Gallery" : "GalleryLocal");
+                m_tracker->Update(paths.values(), scanSettings.join(","));
+
+                ImageHash::const_iterator f = m_dbFileMap.constBegin();
+                for (; f != m_dbFileMap.constEnd(); ++f)
+                    m_dbFilesByDir.insert(f.value()->m_parentId, f.key());
+            }
+
             CountFiles(paths.values());
 
             // Now start the actual syncronization
@@ -186,6 +208,9 @@ void ImageScanThread<DBFS>::run()
             // Release thumb generator asap
             m_thumb.PauseBackground(false);
 
+            if (m_tracker && IsScanning())
+                m_tracker->Save();
+
             // Adding or updating directories has been completed.
             // The maps now only contain old directories & files that are not
             // in the filesystem anymore. Remove them from the database
@@ -260,6 +285,54 @@ void ImageScanThread<DBFS>::SyncSubTree(const QFileInfo &dirInfo, int parentId,
     // Create directory node
     int id = SyncDirectory(dirInfo, devId, base, parentId);
 
+    // An unchanged dir doesn't need listing, its files are known from an
+    // earlier scan. Unless the tracker has watched the dir since then, the
+    // known files must still be checked as editing one in place doesn't
+    // change the dir.
+    QString absDirPath = dirInfo.absoluteFilePath();
+    if (m_tracker && !m_tracker->IsChanged(absDirPath))
+    {
+        bool watched = m_tracker->IsWatched(absDirPath);
+
+        foreach(const QString &filePath, m_dbFilesByDir.values(id))
+        {
+            QString absFilePath = absDirPath + "/" +
+                    QFileInfo(filePath).fileName();
+
+            if (!watched)
+            {
+                if (!IsScanning())
+                {
+                    LOG(VB_GENERAL, LOG_INFO,
+                        QString("Scan interrupted in %1").arg(absDirPath));
+                    return;
+                }
+
+                // A missing file stays in the removed list
+                QFileInfo fileInfo(absFilePath);
+                if (fileInfo.exists())
+                    SyncFile(fileInfo, devId, base, id);
+                continue;
+            }
+
+            // Detect duplicates
+            m_seenFile.insert(filePath, absFilePath);
+            m_dbFileMap.remove(filePath);
+        }
+
+        foreach(const QString &subDir, m_tracker->SubDirs(absDirPath))
+        {
+            if (!IsScanning())
+            {
+                LOG(VB_GENERAL, LOG_INFO,
+                    QString("Scan interrupted in %1").arg(absDirPath));
+                return;
+            }
+            SyncSubTree(QFileInfo(subDir), id, devId, base);
+        }
+        return;
+    }
+
     // Sync its contents
     QFileInfoList list = dir.entryInfoList();
     foreach(const QFileInfo &fileInfo, list)
@@ -538,6 +611,23 @@ void ImageScanThread<DBFS>::SyncFile(const QFileInfo &fileInfo, int devId,
 template <class DBFS>
 void ImageScanThread<DBFS>::CountTree(QDir &dir)
 {
+    // Files of unchanged dirs aren't scanned
+    if (m_tracker && !m_tracker->IsChanged(dir.absolutePath()))
+    {
+        foreach(const QString &subDir, m_tracker->SubDirs(dir.absolutePath()))
+        {
+            if (MATCHES(m_exclusions, QFileInfo(subDir).fileName()))
+                continue;
+
+            if (dir.cd(subDir))
+            {
+                CountTree(dir);
+                dir.cdUp();
+            }
+        }
+        return;
+    }
+
     QFileInfoList files = dir.entryInfoList();
 
     foreach(const QFileInfo &fileInfo, files)
@@ -22,6 +22,8 @@
 
 #include "imagethumbs.h"
 
+class FileChangeTracker;
+
 
 //! Image Scanner thread requires a database/filesystem adapter
 template <class DBFS>
@@ -80,6 +82,10 @@ private:
     NameHash    m_seenFile;
     //! Ids of dirs/files that have been updates/modified.
     QStringList m_changedImages;
+    //! Files in the Db from last scan, Map<Db dir id, Db filepath>
+    QMultiHash<int, QString> m_dbFilesByDir;
+    //! Finds dirs changed since the last scan, if clones can't occur
+    FileChangeTracker *m_tracker {nullptr};
 
     //! Elapsed time since last progress event generated
     QElapsedTimer m_bcastTimer;
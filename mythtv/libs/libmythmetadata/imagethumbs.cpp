@@ -1,7 +1,18 @@
 #include "imagethumbs.h"
 
+#include <algorithm>
+#include <unistd.h> // for link
+
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
+#include <QImageReader>
+#include <QPair>
+#include <QSaveFile>
+#include <QScopedPointer>
 #include <QStringList>
+#include <QThread>
+#include <QVector>
 
 #include "mythlogging.h"
 #include "mythcorecontext.h"  // for events
@@ -9,8 +20,305 @@
 #include "mythdirs.h"         // for previewgen
 #include "exitcodes.h"        // for previewgen
 #include "mythimage.h"
+#include "mythmiscutil.h"     // for CachedFileHash
 
 #include "imagemetadata.h"
+#include "imagemanager.h"     // for TEMP_SUBDIR
+
+//! Size thumbnails of pictures are scaled to fit
+static const QSize kThumbSize(240, 180);
+//! Cache size in MiB when not set by GalleryThumbnailCacheSize
+static const int kDefaultCacheMiB = 256;
+//! Identifies a thumbnail cache index file ("MTC1")
+static const quint32 kIndexMagic = 0x4d544331;
+//! Secs between progress reports of a busy generator
+static const int kReportInterval = 30;
+
+
+//! Links a file to a new name, or copies it where links aren't supported
+static bool link_or_copy(const QString &from, const QString &to)
+{
+#ifndef _WIN32
+    if (link(QFile::encodeName(from).constData(),
+             QFile::encodeName(to).constData()) == 0)
+        return true;
+#endif
+    return QFile::copy(from, to);
+}
+
+
+//! Number of threads creating picture thumbnails
+static int thumb_threads()
+{
+    int threads = gCoreContext->GetNumSetting("GalleryThumbnailThreads", 0);
+    return threads > 0 ? threads : std::max(QThread::idealThreadCount(), 1);
+}
+
+
+/*!
+ \brief Returns the cache, which is shared by all generators
+*/
+ThumbCache &ThumbCache::GetCache()
+{
+    static ThumbCache s_cache;
+    return s_cache;
+}
+
+
+/*!
+ \brief Constructor. Loads the index
+*/
+ThumbCache::ThumbCache()
+    : m_dir(QString("%1/" TEMP_SUBDIR "/ThumbCache").arg(GetConfDir()))
+{
+    int size = gCoreContext->GetNumSetting("GalleryThumbnailCacheSize",
+                                           kDefaultCacheMiB);
+    m_maxSize = quint64(std::max(size, 0)) * 1024 * 1024;
+    Load();
+}
+
+
+/*!
+ \brief Destructor
+ \details The index is saved whenever a generator finishes its tasks, which is
+ when it changes.
+*/
+ThumbCache::~ThumbCache() = default;
+
+
+/*!
+ \brief Determine the cache key of a picture thumbnail
+ \param imagePath Picture file
+ \param orientation Orientation that is applied to the thumbnail
+ \return quint64 Key, or 0 if the picture can't be read
+*/
+quint64 ThumbCache::Key(const QString &imagePath, int orientation)
+{
+    bool ok = false;
+    quint64 hash = CachedFileHash(imagePath).toULongLong(&ok, 16);
+    if (!ok || hash == 0)
+        return 0;
+
+    return hash ^ (quint64(orientation) << 56);
+}
+
+
+//! Get path of a cache entry
+QString ThumbCache::EntryPath(quint64 key, const QString &suffix) const
+{
+    return QString("%1/%2/%3.%4").arg(m_dir)
+            .arg(key & 0xff, 2, 16, QChar('0'))
+            .arg(key, 16, 16, QChar('0'))
+            .arg(suffix);
+}
+
+
+/*!
+ \brief Creates a thumbnail from the cache
+ \param key Cache key of the picture
+ \param thumbPath Thumbnail to create
+ \return bool True if the thumbnail was cached and has been created
+*/
+bool ThumbCache::Fetch(quint64 key, const QString &thumbPath)
+{
+    if (key == 0)
+        return false;
+
+    QString suffix = QFileInfo(thumbPath).suffix().toLower();
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_index.find(key);
+    if (it == m_index.end() || it->m_suffix != suffix)
+        return false;
+
+    if (!link_or_copy(EntryPath(key, suffix), thumbPath))
+    {
+        // Entry has gone
+        m_totalSize -= it->m_size;
+        m_index.erase(it);
+        m_dirty = true;
+        return false;
+    }
+
+    it->m_lastUsed = static_cast<quint32>(QDateTime::currentDateTimeUtc().toSecsSinceEpoch());
+    m_dirty = true;
+    return true;
+}
+
+
+/*!
+ \brief Adds a new thumbnail to the cache
+ \param key Cache key of the picture
+ \param thumbPath Thumbnail that has been created
+*/
+void ThumbCache::Store(quint64 key, const QString &thumbPath)
+{
+    if (key == 0 || m_maxSize == 0)
+        return;
+
+    QFileInfo fi(thumbPath);
+    Entry entry;
+    entry.m_size     = fi.size();
+    entry.m_lastUsed = static_cast<quint32>(QDateTime::currentDateTimeUtc().toSecsSinceEpoch());
+    entry.m_suffix   = fi.suffix().toLower();
+
+    QMutexLocker locker(&m_mutex);
+
+    // Replace any existing entry
+    auto old = m_index.find(key);
+    if (old != m_index.end())
+    {
+        QFile::remove(EntryPath(key, old->m_suffix));
+        m_totalSize -= old->m_size;
+        m_index.erase(old);
+        m_dirty = true;
+    }
+
+    QString path = EntryPath(key, entry.m_suffix);
+    QDir::root().mkpath(QFileInfo(path).path());
+    if (!link_or_copy(thumbPath, path))
+    {
+        LOG(VB_FILE, LOG_WARNING,
+            QString("Failed to cache thumbnail %1").arg(thumbPath));
+        return;
+    }
+
+    m_index.insert(key, entry);
+    m_totalSize += entry.m_size;
+    m_dirty = true;
+
+    if (m_totalSize > m_maxSize)
+        Evict();
+}
+
+
+/*!
+ \brief Removes least recently used entries until the cache is 90% of its
+ maximum size
+ \details Must be called with the cache locked
+*/
+void ThumbCache::Evict()
+{
+    QVector<QPair<quint32, quint64> > ages;
+    ages.reserve(m_index.size());
+    for (auto it = m_index.cbegin(); it != m_index.cend(); ++it)
+        ages.append(qMakePair(it->m_lastUsed, it.key()));
+    std::sort(ages.begin(), ages.end());
+
+    quint64 target = m_maxSize / 10 * 9;
+    int removed = 0;
+    for (const auto &age : ages)
+    {
+        if (m_totalSize <= target)
+            break;
+
+        auto it = m_index.find(age.second);
+        QFile::remove(EntryPath(it.key(), it->m_suffix));
+        m_totalSize -= it->m_size;
+        m_index.erase(it);
+        ++removed;
+    }
+
+    LOG(VB_FILE, LOG_INFO, QString("Removed %1 thumbnails from cache").arg(removed));
+}
+
+
+/*!
+ \brief Loads the cache index
+ \details Index is a list of (key, size, last use, suffix) records. Without an
+ index, any entries are unknown so are removed.
+*/
+void ThumbCache::Load()
+{
+    QFile file(m_dir + "/index");
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        QDir(m_dir).removeRecursively();
+        QDir::root().mkpath(m_dir);
+        return;
+    }
+
+    QDataStream in(&file);
+    quint32 magic = 0;
+    quint32 count = 0;
+    in >> magic >> count;
+    if (magic != kIndexMagic)
+    {
+        LOG(VB_GENERAL, LOG_WARNING,
+            QString("Ignoring invalid thumbnail cache index %1")
+            .arg(file.fileName()));
+        return;
+    }
+
+    for (quint32 i = 0; i < count; ++i)
+    {
+        quint64    key = 0;
+        Entry      entry;
+        QByteArray suffix;
+        in >> key >> entry.m_size >> entry.m_lastUsed >> suffix;
+        if (in.status() != QDataStream::Ok)
+            break;
+
+        entry.m_suffix = QString::fromLatin1(suffix);
+        m_index.insert(key, entry);
+        m_totalSize += entry.m_size;
+    }
+
+    LOG(VB_FILE, LOG_INFO, QString("Thumbnail cache has %1 entries (%2)")
+        .arg(m_index.size())
+        .arg(ImageAdapterBase::FormatSize(m_totalSize / 1024)));
+}
+
+
+/*!
+ \brief Saves the cache index, if it has changed
+*/
+void ThumbCache::Save()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_dirty)
+        return;
+
+    QSaveFile file(m_dir + "/index");
+    if (!file.open(QIODevice::WriteOnly))
+    {
+        LOG(VB_GENERAL, LOG_ERR, QString("Failed to write thumbnail cache index %1")
+            .arg(file.fileName()));
+        return;
+    }
+
+    QDataStream out(&file);
+    out << kIndexMagic << quint32(m_index.size());
+    for (auto it = m_index.cbegin(); it != m_index.cend(); ++it)
+        out << it.key() << it->m_size << it->m_lastUsed << it->m_suffix.toLatin1();
+
+    if (file.commit())
+        m_dirty = false;
+    else
+        LOG(VB_GENERAL, LOG_ERR, QString("Failed to write thumbnail cache index %1")
+            .arg(file.fileName()));
+}
+
+
+/*!
+ \brief Constructor
+ \param name Thread name
+ \param dbfs Filesystem/Database adapter
+ \param workers Number of worker threads
+*/
+template <class DBFS>
+ThumbThread<DBFS>::ThumbThread(const QString &name, DBFS *const dbfs,
+                               int workers)
+    : m_name(name), m_dbfs(*dbfs)
+{
+    workers = std::max(workers, 1);
+    for (int i = 0; i < workers; ++i)
+    {
+        QString thread = workers == 1 ? name : QString("%1%2").arg(name).arg(i + 1);
+        m_workers.append(new Worker(thread, this));
+    }
+}
+
 
 /*!
  \brief Destructor
@@ -19,12 +327,15 @@ template <class DBFS>
 ThumbThread<DBFS>::~ThumbThread()
 {
     cancel();
-    wait();
+
+    // Workers wait for their current task to finish
+    qDeleteAll(m_workers);
+    m_workers.clear();
 }
 
 
 /*!
- \brief Clears all queues so that the thread will terminate.
+ \brief Clears all queues so that the workers will terminate.
 */
 template <class DBFS>
 void ThumbThread<DBFS>::cancel()
@@ -53,9 +364,50 @@ void ThumbThread<DBFS>::Enqueue(const TaskPtr &task)
         else
             m_requestQ.insert(task->m_priority, task);
 
-        // restart if not already running
-        if ((m_doBackground || !background) && !this->isRunning())
-            this->start();
+        // start more workers if there are some idle
+        if (m_doBackground || !background)
+            StartWorkers();
+    }
+}
+
+
+/*!
+ \brief Starts idle workers, one for each queued task
+ \details Must be called with the queues locked. They are released whilst
+ waiting for a finishing worker to exit.
+*/
+template <class DBFS>
+void ThumbThread<DBFS>::StartWorkers()
+{
+    int queued = m_requestQ.size() + (m_doBackground ? m_backgroundQ.size() : 0);
+    int wanted = std::min(m_workers.size(), m_running + queued);
+
+    if (m_running == 0 && wanted > 0)
+    {
+        m_stats = ThumbStats();
+        m_stats.m_timer.start();
+        m_stats.m_lastReport.start();
+    }
+
+    foreach (Worker *worker, m_workers)
+    {
+        if (m_running >= wanted)
+            break;
+        if (worker->m_active)
+            continue;
+
+        worker->m_active = true;
+        ++m_running;
+
+        // A worker that has just run out of tasks may still be finishing
+        // (saving the cache index). Don't hold up the queues whilst it does.
+        if (worker->isRunning())
+        {
+            m_mutex.unlock();
+            worker->wait();
+            m_mutex.lock();
+        }
+        worker->start();
     }
 }
 
@@ -69,7 +421,7 @@ void ThumbThread<DBFS>::AbortDevice(int devId, const QString &action)
 {
     if (action == "DEVICE CLOSE ALL" || action == "DEVICE CLEAR ALL")
     {
-        if (isRunning())
+        if (m_running > 0)
             LOG(VB_FILE, LOG_INFO,
                 QString("Aborting all thumbnails %1").arg(action));
 
@@ -85,9 +437,12 @@ void ThumbThread<DBFS>::AbortDevice(int devId, const QString &action)
     QMutexLocker locker(&m_mutex);
     RemoveTasks(m_requestQ, devId);
     RemoveTasks(m_backgroundQ, devId);
-    if (isRunning())
-        // Wait until current task is complete - it may be using the device
-        m_taskDone.wait(&m_mutex, 3000);
+
+    // Wait until current tasks are complete - they may be using the device
+    QElapsedTimer timer;
+    timer.start();
+    while (m_busy > 0 && timer.elapsed() < 3000)
+        m_taskDone.wait(&m_mutex, 3000 - timer.elapsed());
 }
 
 
@@ -112,22 +467,15 @@ void ThumbThread<DBFS>::RemoveTasks(ThumbQueue &queue, int devId)
 
 /*!
  \brief  Handles thumbnail requests by priority
- \details Repeatedly processes next request from highest priority queue until all
-  queues are empty, then quits. For Create requests an event is broadcast once the
-  thumbnail exists. Dirs are only deleted if empty
+ \details Run by each worker. Repeatedly processes next request from highest
+  priority queue until all queues are empty, then quits.
+ \param worker Worker thread running this
 */
 template <class DBFS>
-void ThumbThread<DBFS>::run()
+void ThumbThread<DBFS>::Process(Worker *worker)
 {
-    RunProlog();
-
-    setPriority(QThread::LowestPriority);
-
     while (true)
     {
-        // Signal previous task is complete (its files have been closed)
-        m_taskDone.wakeAll();
-
         // Do all we can to run in background
         QThread::yieldCurrentThread();
 
@@ -140,89 +488,154 @@ void ThumbThread<DBFS>::run()
             else if (m_doBackground && !m_backgroundQ.isEmpty())
                 task = m_backgroundQ.take(m_backgroundQ.constBegin().key());
             else
+            {
                 // quit when both queues exhausted
+                worker->m_active = false;
+                if (--m_running == 0)
+                    ReportStats(true);
                 break;
+            }
+            ++m_busy;
         }
 
-        // Shouldn't receive empty requests
-        if (task->m_images.isEmpty())
-            continue;
+        DoTask(task);
 
-        if (task->m_action == "CREATE")
+        bool report = false;
         {
-            ImagePtrK im = task->m_images.at(0);
+            QMutexLocker locker(&m_mutex);
+            --m_busy;
+            report = ReportStats(false);
+        }
+
+        // Don't lose the cache index of a long scan if the backend dies
+        if (report)
+            ThumbCache::GetCache().Save();
+
+        // Signal task is complete (its files have been closed)
+        m_taskDone.wakeAll();
+    }
+
+    ThumbCache::GetCache().Save();
+}
+
 
-            QString err = CreateThumbnail(im, task->m_priority);
+/*!
+ \brief Handles a thumbnail request
+ \details For Create requests an event is broadcast once the thumbnail exists.
+  Dirs are only deleted if empty
+ \param task Request
+*/
+template <class DBFS>
+void ThumbThread<DBFS>::DoTask(const TaskPtr &task)
+{
+    // Shouldn't receive empty requests
+    if (task->m_images.isEmpty())
+        return;
 
+    if (task->m_action == "CREATE")
+    {
+        ImagePtrK im = task->m_images.at(0);
+
+        // Another worker may be creating the same thumbnail
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_creating.contains(im->m_thumbPath))
+                m_taskDone.wait(&m_mutex);
+            m_creating.insert(im->m_thumbPath);
+        }
+
+        QString err = CreateThumbnail(im, task->m_priority);
+
+        {
+            QMutexLocker locker(&m_mutex);
+            m_creating.remove(im->m_thumbPath);
             if (!err.isEmpty())
-            {
-                LOG(VB_GENERAL, LOG_ERR,  QString("%1").arg(err));
-            }
-            else if (task->m_notify)
-            {
-                // notify clients when done
-                m_dbfs.Notify("THUMB_AVAILABLE",
-                              QStringList(QString::number(im->m_id)));
-            }
+                ++m_stats.m_failed;
+        }
+        m_taskDone.wakeAll();
+
+        if (!err.isEmpty())
+        {
+            LOG(VB_GENERAL, LOG_ERR,  QString("%1").arg(err));
         }
-        else if (task->m_action == "DELETE")
+        else if (task->m_notify)
         {
-            foreach(ImagePtrK im, task->m_images)
+            // notify clients when done
+            m_dbfs.Notify("THUMB_AVAILABLE",
+                          QStringList(QString::number(im->m_id)));
+        }
+    }
+    else if (task->m_action == "DELETE")
+    {
+        foreach(ImagePtrK im, task->m_images)
+        {
+            QString thumbnail = im->m_thumbPath;
+            WaitForCreate(thumbnail);
+            if (!QDir::root().remove(thumbnail))
             {
-                QString thumbnail = im->m_thumbPath;
-                if (!QDir::root().remove(thumbnail))
-                {
-                    LOG(VB_FILE, LOG_WARNING,
-                        QString("Failed to delete thumbnail %1").arg(thumbnail));
-                    continue;
-                }
-                LOG(VB_FILE, LOG_DEBUG,
-                    QString("Deleted thumbnail %1").arg(thumbnail));
-
-                // Clean up empty dirs
-                QString path = QFileInfo(thumbnail).path();
-                if (QDir::root().rmpath(path))
-                    LOG(VB_FILE, LOG_DEBUG,
-                        QString("Cleaned up path %1").arg(path));
+                LOG(VB_FILE, LOG_WARNING,
+                    QString("Failed to delete thumbnail %1").arg(thumbnail));
+                continue;
             }
+            LOG(VB_FILE, LOG_DEBUG,
+                QString("Deleted thumbnail %1").arg(thumbnail));
+
+            // Clean up empty dirs
+            QString path = QFileInfo(thumbnail).path();
+            if (QDir::root().rmpath(path))
+                LOG(VB_FILE, LOG_DEBUG,
+                    QString("Cleaned up path %1").arg(path));
         }
-        else if (task->m_action == "MOVE")
+    }
+    else if (task->m_action == "MOVE")
+    {
+        foreach(ImagePtrK im, task->m_images)
         {
-            foreach(ImagePtrK im, task->m_images)
+            // Build new thumb path
+            QString newThumbPath =
+                    m_dbfs.GetAbsThumbPath(m_dbfs.ThumbDir(im->m_device),
+                                           m_dbfs.ThumbPath(*im.data()));
+
+            WaitForCreate(im->m_thumbPath);
+
+            // Ensure path exists
+            if (QDir::root().mkpath(QFileInfo(newThumbPath).path())
+                    && QFile::rename(im->m_thumbPath, newThumbPath))
             {
-                // Build new thumb path
-                QString newThumbPath =
-                        m_dbfs.GetAbsThumbPath(m_dbfs.ThumbDir(im->m_device),
-                                               m_dbfs.ThumbPath(*im.data()));
-
-                // Ensure path exists
-                if (QDir::root().mkpath(QFileInfo(newThumbPath).path())
-                        && QFile::rename(im->m_thumbPath, newThumbPath))
-                {
-                    LOG(VB_FILE, LOG_DEBUG, QString("Moved thumbnail %1 -> %2")
-                        .arg(im->m_thumbPath, newThumbPath));
-                }
-                else
-                {
-                    LOG(VB_FILE, LOG_WARNING,
-                        QString("Failed to rename thumbnail %1 -> %2")
-                        .arg(im->m_thumbPath, newThumbPath));
-                    continue;
-                }
-
-                // Clean up empty dirs
-                QString path = QFileInfo(im->m_thumbPath).path();
-                if (QDir::root().rmpath(path))
-                    LOG(VB_FILE, LOG_DEBUG,
-                        QString("Cleaned up path %1").arg(path));
+                LOG(VB_FILE, LOG_DEBUG, QString("Moved thumbnail %1 -> %2")
+                    .arg(im->m_thumbPath, newThumbPath));
             }
+            else
+            {
+                LOG(VB_FILE, LOG_WARNING,
+                    QString("Failed to rename thumbnail %1 -> %2")
+                    .arg(im->m_thumbPath, newThumbPath));
+                continue;
+            }
+
+            // Clean up empty dirs
+            QString path = QFileInfo(im->m_thumbPath).path();
+            if (QDir::root().rmpath(path))
+                LOG(VB_FILE, LOG_DEBUG,
+                    QString("Cleaned up path %1").arg(path));
         }
-        else
-            LOG(VB_GENERAL, LOG_ERR,
-                QString("Unknown task %1").arg(task->m_action));
     }
+    else
+        LOG(VB_GENERAL, LOG_ERR,
+            QString("Unknown task %1").arg(task->m_action));
+}
+
 
-    RunEpilog();
+/*!
+ \brief Waits until no worker is creating a thumbnail
+ \param thumbPath Thumbnail
+*/
+template <class DBFS>
+void ThumbThread<DBFS>::WaitForCreate(const QString &thumbPath)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_creating.contains(thumbPath))
+        m_taskDone.wait(&m_mutex);
 }
 
 
@@ -232,7 +645,7 @@ void ThumbThread<DBFS>::run()
  \param thumbPriority 
  */
 template <class DBFS>
-QString ThumbThread<DBFS>::CreateThumbnail(ImagePtrK im, int thumbPriority)
+QString ThumbThread<DBFS>::CreateThumbnail(const ImagePtrK &im, int thumbPriority)
 {
     if (QDir::root().exists(im->m_thumbPath))
     {
@@ -251,14 +664,33 @@ QString ThumbThread<DBFS>::CreateThumbnail(ImagePtrK im, int thumbPriority)
     // Ensure path exists
     QDir::root().mkpath(QFileInfo(im->m_thumbPath).path());
 
-    QImage image;
+    QElapsedTimer timer;
+    timer.start();
+
+    // Compensate for any Qt auto-orientation
+    int orientBy = Orientation(im->m_orientation)
+            .GetCurrent(im->m_type == kImageFile);
+
+    QImage  image;
+    bool    fromExif = false;
+    quint64 key      = 0;
     if (im->m_type == kImageFile)
     {
-        if (!image.load(imagePath))
-            return QString("Failed to open image %1").arg(imagePath);
+        key = ThumbCache::Key(imagePath, orientBy);
+        if (ThumbCache::GetCache().Fetch(key, im->m_thumbPath))
+        {
+            QMutexLocker locker(&m_mutex);
+            ++m_stats.m_cached;
+
+            LOG(VB_FILE, LOG_INFO,  QString("[%2] Cached %1")
+                .arg(im->m_thumbPath).arg(thumbPriority));
+            return QString();
+        }
 
         // Resize to optimise load/display time by FE's
-        image = image.scaled(QSize(240,180), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        image = LoadImage(imagePath, kThumbSize, fromExif);
+        if (image.isNull())
+            return QString("Failed to open image %1").arg(imagePath);
     }
     else if (im->m_type == kVideoFile)
     {
@@ -293,10 +725,6 @@ QString ThumbThread<DBFS>::CreateThumbnail(ImagePtrK im, int thumbPriority)
         return QString("Can't create thumbnail for type %1 (image %2)")
                 .arg(im->m_type).arg(imagePath);
 
-    // Compensate for any Qt auto-orientation
-    int orientBy = Orientation(im->m_orientation)
-            .GetCurrent(im->m_type == kImageFile);
-
     // Orientate now to optimise load/display time - no orientation
     // is required when displaying thumbnails
     image = MythImage::ApplyExifOrientation(image, orientBy);
@@ -305,12 +733,123 @@ QString ThumbThread<DBFS>::CreateThumbnail(ImagePtrK im, int thumbPriority)
     if (!image.save(im->m_thumbPath))
         return QString("Failed to create thumbnail %1").arg(im->m_thumbPath);
 
-    LOG(VB_FILE, LOG_INFO,  QString("[%2] Created %1")
-        .arg(im->m_thumbPath).arg(thumbPriority));
+    ThumbCache::GetCache().Store(key, im->m_thumbPath);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (fromExif)
+            ++m_stats.m_exif;
+        else
+            ++m_stats.m_created;
+        m_stats.m_decodeMs += timer.elapsed();
+    }
+
+    LOG(VB_FILE, LOG_INFO,  QString("[%2] Created %1%3")
+        .arg(im->m_thumbPath).arg(thumbPriority)
+        .arg(fromExif ? " from Exif thumbnail" : ""));
     return QString();
 }
 
 
+/*!
+ \brief Loads a picture scaled to fit a size
+ \details JPEGs are scaled by the decoder, which then only decodes as much of
+ the picture as it needs. A JPEG's Exif thumbnail is used instead if it is at
+ least as big as the scaled picture and has the same shape; some cameras pad
+ thumbnails to 4:3.
+ \param imagePath Picture file
+ \param size Size to fit
+ \param [out] fromExif Set if the Exif thumbnail was used
+ \return QImage The scaled picture, or a null image if it can't be read
+ */
+template <class DBFS>
+QImage ThumbThread<DBFS>::LoadImage(const QString &imagePath, const QSize &size,
+                                    bool &fromExif)
+{
+    QImageReader reader(imagePath);
+    // Orientation is applied to the thumbnail later
+    reader.setAutoTransform(false);
+
+    QSize fullSize = reader.size();
+    QSize scaled   = fullSize.scaled(size, Qt::KeepAspectRatio);
+
+    if (fullSize.isValid() && reader.format() == "jpeg")
+    {
+        QScopedPointer<ImageMetaData> meta(ImageMetaData::FromPicture(imagePath));
+        QImage exif;
+        if (meta && exif.loadFromData(meta->GetThumbnail())
+                && exif.width() >= scaled.width()
+                && exif.height() >= scaled.height())
+        {
+            // Aspect ratios within 2%
+            qint64 across = qint64(exif.width()) * fullSize.height();
+            qint64 down   = qint64(exif.height()) * fullSize.width();
+            if (qAbs(across - down) * 50 <= down)
+            {
+                fromExif = true;
+                return exif.scaled(scaled, Qt::IgnoreAspectRatio,
+                                   Qt::SmoothTransformation);
+            }
+        }
+    }
+
+    if (scaled.isValid())
+        reader.setScaledSize(scaled);
+
+    QImage image;
+    if (!reader.read(&image))
+    {
+        LOG(VB_FILE, LOG_DEBUG, QString("Failed to read %1: %2")
+            .arg(imagePath, reader.errorString()));
+        return QImage();
+    }
+    return image;
+}
+
+
+/*!
+ \brief Logs the throughput of the workers
+ \details Must be called with the queues locked
+ \param finished If true, the workers have emptied the queues. Otherwise
+ progress is only reported every kReportInterval secs
+ \return bool True if a report was due
+*/
+template <class DBFS>
+bool ThumbThread<DBFS>::ReportStats(bool finished)
+{
+    if (!m_stats.m_timer.isValid())
+        return false;
+
+    if (!finished && m_stats.m_lastReport.elapsed() < kReportInterval * 1000)
+        return false;
+
+    int decoded = m_stats.m_created + m_stats.m_exif;
+    int done    = decoded + m_stats.m_cached;
+    if (done + m_stats.m_failed > 0)
+    {
+        double secs = std::max(m_stats.m_timer.elapsed(), qint64(1)) / 1000.0;
+        LOG(VB_GENERAL, LOG_INFO,
+            QString("%1: %2 %3 thumbnails in %4s (%5/s) with %6 threads: "
+                    "%7 decoded, %8 from Exif, %9 cached, %10 failed, "
+                    "%11 ms per decode, %12 queued")
+            .arg(m_name)
+            .arg(finished ? "Created" : "Creating").arg(done)
+            .arg(secs, 0, 'f', 1).arg(done / secs, 0, 'f', 1)
+            .arg(m_workers.size())
+            .arg(m_stats.m_created).arg(m_stats.m_exif)
+            .arg(m_stats.m_cached).arg(m_stats.m_failed)
+            .arg(m_stats.m_decodeMs / std::max(decoded, 1))
+            .arg(m_requestQ.size() + m_backgroundQ.size()));
+    }
+
+    if (finished)
+        m_stats = ThumbStats();
+    else
+        m_stats.m_lastReport.restart();
+    return true;
+}
+
+
 /*!
   \brief Pauses or restarts processing of background tasks (scanner requests)
  */
@@ -321,8 +860,8 @@ void ThumbThread<DBFS>::PauseBackground(bool pause)
     m_doBackground = !pause;
 
     // restart if not already running
-    if (m_doBackground && !this->isRunning())
-        this->start();
+    if (m_doBackground)
+        StartWorkers();
 }
 
 
@@ -332,7 +871,7 @@ void ThumbThread<DBFS>::PauseBackground(bool pause)
 template <class DBFS>
 ImageThumb<DBFS>::ImageThumb(DBFS *const dbfs)
     : m_dbfs(*dbfs),
-      m_imageThread(new ThumbThread<DBFS>("ImageThumbs", dbfs)),
+      m_imageThread(new ThumbThread<DBFS>("ImageThumbs", dbfs, thumb_threads())),
       m_videoThread(new ThumbThread<DBFS>("VideoThumbs", dbfs))
 {}
 
@@ -1,10 +1,14 @@
 //! \file
 //! \brief Creates and manages thumbnails
-//! \details Uses two worker threads to process thumbnail requests that are queued
+//! \details Uses two generators to process thumbnail requests that are queued
 //! from the scanner and UI.
-//! One thread generates picture thumbs; the other video thumbs, which are delegated
-//! to previewgenerator and time-consuming.
-//! Both background threads are low-priority to avoid recording issues.
+//! One generates picture thumbs using a pool of worker threads (setting
+//! GalleryThumbnailThreads, default is one per CPU); the other video thumbs,
+//! which are delegated to previewgenerator and time-consuming, using a single
+//! thread.
+//! JPEGs are scaled whilst decoding or use their Exif thumbnail if it is big
+//! enough, and picture thumbnails are kept in a content addressed cache.
+//! All worker threads are low-priority to avoid recording issues.
 //! Requests are handled by client-assigned priority so that UI display requests
 //! are serviced before background scanner requests.
 //! When images are removed, their thumbnails are also deleted (thumbnail cache is
@@ -17,8 +21,12 @@
 #include <utility>
 
 // Qt headers
+#include <QElapsedTimer>
+#include <QHash>
+#include <QImage>
 #include <QMap>
 #include <QMutex>
+#include <QSet>
 #include <QWaitCondition>
 
 // MythTV headers
@@ -82,37 +90,117 @@ public:
 using TaskPtr = QSharedPointer<ThumbTask>;
 
 
-//! A generator worker thread
+//! \brief Content addressed store of picture thumbnails
+//! \details Thumbnails are kept by a hash of their picture's contents and
+//! orientation, so a picture that is moved, copied or seen again on a device
+//! that has been removed and re-inserted doesn't need decoding again.
+//! Entries are hard links to the device thumbnails where possible, copies
+//! otherwise. A compact index of their sizes and last use is kept in the
+//! cache dir so the least recently used can be removed when it grows too big.
+class ThumbCache
+{
+public:
+    static ThumbCache &GetCache();
+
+    static quint64 Key(const QString &imagePath, int orientation);
+    bool Fetch(quint64 key, const QString &thumbPath);
+    void Store(quint64 key, const QString &thumbPath);
+    void Save();
+
+private:
+    ThumbCache();
+    ~ThumbCache();
+    Q_DISABLE_COPY(ThumbCache)
+
+    //! An index record
+    struct Entry
+    {
+        quint32 m_size     {0}; //!< File size in bytes
+        quint32 m_lastUsed {0}; //!< Secs since epoch
+        QString m_suffix;       //!< Thumbnail format
+    };
+
+    QString EntryPath(quint64 key, const QString &suffix) const;
+    void    Load();
+    void    Evict();
+
+    QString               m_dir;
+    QHash<quint64, Entry> m_index;
+    quint64               m_totalSize {0};
+    quint64               m_maxSize   {0};
+    bool                  m_dirty     {false};
+    QMutex                m_mutex;
+};
+
+
+//! Throughput of a thumbnail generator, from its start until its queues empty
+struct ThumbStats
+{
+    QElapsedTimer m_timer;        //!< Started by first task
+    QElapsedTimer m_lastReport;   //!< Time since last progress report
+    int           m_created  {0}; //!< Thumbnails decoded from pictures/videos
+    int           m_exif     {0}; //!< Thumbnails made from Exif thumbnails
+    int           m_cached   {0}; //!< Thumbnails found in the cache
+    int           m_failed   {0}; //!< Thumbnails that couldn't be created
+    qint64        m_decodeMs {0}; //!< Total time spent creating thumbnails
+};
+
+
+//! \brief A generator queue, serviced by one or more worker threads
+//! \details Workers are started when tasks are queued and quit when all queues
+//! are empty.
 template <class DBFS>
-class ThumbThread : public MThread
+class ThumbThread
 {
 public:
-    /*!
-     \brief Constructor
-     \param name Thread name
-     \param dbfs Filesystem/Database adapter
-    */
-    ThumbThread(const QString &name, DBFS *const dbfs)
-        : MThread(name), m_dbfs(*dbfs) {}
-    ~ThumbThread() override;
+    ThumbThread(const QString &name, DBFS *dbfs, int workers = 1);
+    ~ThumbThread();
 
     void cancel();
     void Enqueue(const TaskPtr &task);
     void AbortDevice(int devId, const QString &action);
     void PauseBackground(bool pause);
 
-protected:
-    void run() override; // MThread
-
 private:
     Q_DISABLE_COPY(ThumbThread)
 
+    //! A worker thread
+    class Worker : public MThread
+    {
+    public:
+        Worker(const QString &name, ThumbThread *owner)
+            : MThread(name), m_owner(owner) {}
+        ~Worker() override { wait(); }
+
+        bool m_active {false}; //!< Set by owner when started, cleared by run()
+
+    protected:
+        void run() override // MThread
+        {
+            RunProlog();
+            setPriority(QThread::LowestPriority);
+            m_owner->Process(this);
+            RunEpilog();
+        }
+
+    private:
+        ThumbThread *m_owner;
+    };
+
     //! A priority queue where 0 is highest priority
     using ThumbQueue = QMultiMap<int, TaskPtr>;
 
-    QString CreateThumbnail(ImagePtrK im, int thumbPriority);
+    void    StartWorkers();
+    void    Process(Worker *worker);
+    void    DoTask(const TaskPtr &task);
+    void    WaitForCreate(const QString &thumbPath);
+    QString CreateThumbnail(const ImagePtrK &im, int thumbPriority);
+    static QImage LoadImage(const QString &imagePath, const QSize &size,
+                            bool &fromExif);
+    bool    ReportStats(bool finished);
     static void RemoveTasks(ThumbQueue &queue, int devId);
 
+    QString m_name;             //!< Generator name, for logging
     DBFS &m_dbfs;               //!< Database/filesystem adapter
     QWaitCondition m_taskDone;  //! Synchronises completed tasks
 
@@ -120,6 +208,12 @@ private:
     ThumbQueue m_backgroundQ;   //!< Priority queue of background tasks
     bool m_doBackground {true}; //!< Whether to process background tasks
     QMutex m_mutex;            //!< Queue protection
+
+    QList<Worker*> m_workers;       //!< Worker threads
+    int            m_running  {0};  //!< Number of active workers
+    int            m_busy     {0};  //!< Number of tasks being processed
+    QSet<QString>  m_creating;      //!< Thumbnails being created
+    ThumbStats     m_stats;         //!< Throughput since workers started
 };
 
 
@@ -150,7 +244,7 @@ private:
 
     //! Db/filesystem adapter
     DBFS              &m_dbfs;
-    //! Thread generating picture thumbnails
+    //! Threads generating picture thumbnails
     ThumbThread<DBFS> *m_imageThread;
     //! Thread generating video previews
     ThumbThread<DBFS> *m_videoThread;
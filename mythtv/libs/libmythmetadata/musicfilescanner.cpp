@@ -2,16 +2,87 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+// C++ headers
+#include <algorithm>
+#include <functional>
+#include <utility>
+
 // Qt headers
 #include <QDir>
+#include <QHash>
+#include <QRunnable>
+#include <QSet>
+#include <QThread>
 
 // MythTV headers
 #include <mythdate.h>
 #include <mythdb.h>
 #include <mythcontext.h>
+#include <mthreadpool.h>
 #include <musicmetadata.h>
 #include <metaio.h>
 #include <musicfilescanner.h>
+#include <filechangetracker.h>
+
+/// Tracks whose tags are read, and then written to the database, together
+static const int kTrackBatch = 250;
+/// Most rows written or looked up by a single statement
+static const int kBulkRows = 50;
+
+namespace
+{
+    class ReadRunnable : public QRunnable
+    {
+      public:
+        explicit ReadRunnable(std::function<void()> func)
+            : m_func(std::move(func)) {}
+        void run(void) override { m_func(); } // QRunnable
+      private:
+        std::function<void()> m_func;
+    };
+}
+
+/** \brief Runs a statement for count rows, kBulkRows at a time.
+ *
+ *  sql has %1 in place of the rows, each row is made from row with %1 in
+ *  place of the placeholder suffix. bind(i, suffix) binds the placeholders
+ *  for row i, and read() is called for each result row of a SELECT.
+ */
+template <typename Bind, typename Read>
+static void bulk_exec(MSqlQuery &query, const char *name,
+                      const QString &sql, const QString &row,
+                      int count, Bind bind, Read read)
+{
+    for (int first = 0; first < count; first += kBulkRows)
+    {
+        int last = std::min(first + kBulkRows, count);
+
+        QStringList rows;
+        for (int i = first; i < last; i++)
+            rows << row.arg(i - first);
+
+        query.prepare(sql.arg(rows.join(",")));
+        for (int i = first; i < last; i++)
+            bind(i, QString::number(i - first));
+
+        if (!query.exec())
+        {
+            MythDB::DBError(name, query);
+            continue;
+        }
+
+        while (query.next())
+            read();
+    }
+}
+
+template <typename Bind>
+static void bulk_exec(MSqlQuery &query, const char *name,
+                      const QString &sql, const QString &row,
+                      int count, Bind bind)
+{
+    bulk_exec(query, name, sql, row, count, bind, [](){});
+}
 
 MusicFileScanner::MusicFileScanner()
 {
@@ -77,6 +148,18 @@ void MusicFileScanner::BuildFileList(QString &directory, MusicLoadedMap &music_f
     if (!d.exists())
         return;
 
+    // The files of an unchanged directory are already in the database,
+    // only its subdirectories need to be looked at
+    if (!m_tracker->IsChanged(directory))
+    {
+        foreach (QString subdir, m_tracker->SubDirs(directory))
+        {
+            int newparentid = CachedDirectoryId(subdir, parentid);
+            BuildFileList(subdir, music_files, art_files, newparentid);
+        }
+        return;
+    }
+
     d.setFilter(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot);
 
     QFileInfoList list = d.entryInfoList();
@@ -86,7 +169,6 @@ void MusicFileScanner::BuildFileList(QString &directory, MusicLoadedMap &music_f
     QFileInfoList::const_iterator it = list.begin();
 
     // Recursively traverse directory
-    int newparentid = 0;
     while (it != list.end())
     {
         const QFileInfo *fi = &(*it);
@@ -94,29 +176,7 @@ void MusicFileScanner::BuildFileList(QString &directory, MusicLoadedMap &music_f
         QString filename = fi->absoluteFilePath();
         if (fi->isDir())
         {
-
-            QString dir(filename);
-            dir.remove(0, m_startDirs.last().length());
-
-            newparentid = m_directoryid[dir];
-
-            if (newparentid == 0)
-            {
-                int id = GetDirectoryId(dir, parentid);
-                m_directoryid[dir] = id;
-
-                if (id > 0)
-                {
-                    newparentid = id;
-                }
-                else
-                {
-                    LOG(VB_GENERAL, LOG_ERR,
-                        QString("Failed to get directory id for path %1")
-                            .arg(dir));
-                }
-            }
-
+            int newparentid = CachedDirectoryId(filename, parentid);
             BuildFileList(filename, music_files, art_files, newparentid);
         }
         else
@@ -145,6 +205,65 @@ void MusicFileScanner::BuildFileList(QString &directory, MusicLoadedMap &music_f
     }
 }
 
+/*!
+ * \brief Get the id of a directory, from the cache or the database.
+ *
+ * \param directory Full path to the directory
+ * \param parentid The id of the parent directory in the music_directories
+ *                 table. The root directory should have an id of 0
+ *
+ * \returns Directory id, or 0 if it couldn't be found or added
+ */
+int MusicFileScanner::CachedDirectoryId(const QString &directory, int parentid)
+{
+    QString dir(directory);
+    dir.remove(0, m_startDirs.last().length());
+
+    int newparentid = m_directoryid[dir];
+
+    if (newparentid == 0)
+    {
+        int id = GetDirectoryId(dir, parentid);
+        m_directoryid[dir] = id;
+
+        if (id > 0)
+        {
+            newparentid = id;
+        }
+        else
+        {
+            LOG(VB_GENERAL, LOG_ERR,
+                QString("Failed to get directory id for path %1")
+                    .arg(dir));
+        }
+    }
+
+    return newparentid;
+}
+
+/*!
+ * \brief Check if a file in the database is in a directory that hasn't
+ *        changed since the last scan, so wasn't listed by this one.
+ *
+ * \param filename Path to the file, relative to the storage directory
+ * \param startDir Set to the storage directory the file is in
+ *
+ * \returns True if the file's directory is unchanged
+ */
+bool MusicFileScanner::InUnchangedDir(const QString &filename,
+                                      QString &startDir) const
+{
+    foreach (const QString &dir, m_startDirs)
+    {
+        if (!m_tracker->IsChanged(QFileInfo(dir + filename).path()))
+        {
+            startDir = dir;
+            return true;
+        }
+    }
+    return false;
+}
+
 bool MusicFileScanner::IsArtFile(const QString &filename)
 {
     QFileInfo fi(filename);
@@ -237,12 +356,10 @@ bool MusicFileScanner::HasFileChanged(
 }
 
 /*!
- * \brief Insert file details into database.
- *        If it is an audio file, read the metadata and insert
- *        that information at the same time.
+ * \brief Insert an image file into the database.
  *
- *        If it is an image file, just insert the filename and
- *        type.
+ *        Music files are added by UpdateTracks(), along with the
+ *        metadata read from them.
  *
  * \param filename Full path to file.
  * \param startDir The starting directory fir the search. This will be
@@ -285,75 +402,7 @@ void MusicFileScanner::AddFileToDB(const QString &filename, const QString &start
         return;
     }
 
-    if (extension.isEmpty() || !MetaIO::kValidFileExtensions.contains(extension.toLower()))
-    {
-        LOG(VB_GENERAL, LOG_WARNING, QString("Ignoring filename with unsupported filename: '%1'").arg(filename));
-        return;
-    }
-
-    LOG(VB_FILE, LOG_INFO, QString("Reading metadata from %1").arg(filename));
-    MusicMetadata *data = MetaIO::readMetadata(filename);
-    if (data)
-    {
-        data->setFileSize((quint64)QFileInfo(filename).size());
-        data->setHostname(gCoreContext->GetHostName());
-
-        QString album_cache_string;
-
-        // Set values from cache
-        int did = m_directoryid[directory];
-        if (did >= 0)
-            data->setDirectoryId(did);
-
-        int aid = m_artistid[data->Artist().toLower()];
-        if (aid > 0)
-        {
-            data->setArtistId(aid);
-
-            // The album cache depends on the artist id
-            album_cache_string = QString::number(data->getArtistId()) + "#"
-                + data->Album().toLower();
-
-            if (m_albumid[album_cache_string] > 0)
-                data->setAlbumId(m_albumid[album_cache_string]);
-        }
-
-        int gid = m_genreid[data->Genre().toLower()];
-        if (gid > 0)
-            data->setGenreId(gid);
-
-        // Commit track info to database
-        data->dumpToDatabase();
-
-        // Update the cache
-        m_artistid[data->Artist().toLower()] =
-            data->getArtistId();
-
-        m_genreid[data->Genre().toLower()] =
-            data->getGenreId();
-
-        album_cache_string = QString::number(data->getArtistId()) + "#"
-            + data->Album().toLower();
-        m_albumid[album_cache_string] = data->getAlbumId();
-
-        // read any embedded images from the tag
-        MetaIO *tagger = MetaIO::createTagger(filename);
-
-        if (tagger)
-        {
-            if (tagger->supportsEmbeddedImages())
-            {
-                AlbumArtList artList = tagger->getAlbumArtList(data->Filename());
-                data->setEmbeddedAlbumArt(artList);
-                data->getAlbumArtImages()->dumpToDatabase();
-            }
-            delete tagger;
-        }
-
-        delete data;
-
-        ++m_tracksAdded;
-    }
+    LOG(VB_GENERAL, LOG_WARNING, QString("Ignoring filename with unsupported filename: '%1'").arg(filename));
 }
 
 /*!
@@ -541,87 +590,531 @@ void MusicFileScanner::RemoveFileFromDB(const QString &filename, const QString &
 }
 
 /*!
- * \brief Updates a file in the database.
+ * \brief Adds new music files to the database and updates changed ones.
  *
- * \param filename Full path to file.
- * \param startDir The starting directory fir the search. This will be
- *                 removed making the stored name relative to the
- *                 storage directory where it was found.
+ *        The tags of kTrackBatch files at a time are read by a pool of
+ *        threads, the next batch being read while the last one is written
+ *        to the database by WriteTracks().
+ *
+ * \param music_files The files found by the scan
  *
  * \returns Nothing.
  */
-void MusicFileScanner::UpdateFileInDB(const QString &filename, const QString &startDir)
+void MusicFileScanner::UpdateTracks(MusicLoadedMap &music_files)
 {
-    QString dbFilename = filename;
-    dbFilename.remove(0, startDir.length());
+    QList<TrackBatch> batches;
+    TrackBatch batch;
 
-    QString directory = filename;
-    directory.remove(0, startDir.length());
-    directory = directory.section( '/', 0, -2);
+    for (auto iter = music_files.begin(); iter != music_files.end(); iter++)
+    {
+        if ((*iter).location != MusicFileScanner::kFileSystem &&
+            (*iter).location != MusicFileScanner::kNeedUpdate)
+            continue;
 
-    MusicMetadata *db_meta   = MetaIO::getMetadata(dbFilename);
-    MusicMetadata *disk_meta = MetaIO::readMetadata(filename);
+        TrackData track;
+        track.filename = iter.key();
+        track.startDir = (*iter).startDir;
+        track.update = ((*iter).location == MusicFileScanner::kNeedUpdate);
+        batch.push_back(track);
 
-    if (db_meta && disk_meta)
-    {
-        if (db_meta->ID() <= 0)
+        if (batch.size() >= kTrackBatch)
         {
-            LOG(VB_GENERAL, LOG_ERR, QString("Asked to update track with "
-                                                "invalid ID - %1")
-                                            .arg(db_meta->ID()));
-            delete disk_meta;
-            delete db_meta;
-            return;
+            batches.push_back(batch);
+            batch.clear();
         }
+    }
+    if (!batch.isEmpty())
+        batches.push_back(batch);
 
-        disk_meta->setID(db_meta->ID());
-        disk_meta->setRating(db_meta->Rating());
-        if (db_meta->PlayCount() > disk_meta->PlayCount())
-            disk_meta->setPlaycount(db_meta->Playcount());
+    if (batches.isEmpty())
+        return;
+
+    MThreadPool pool("MusicFileScannerRead");
+    pool.setMaxThreadCount(std::max(2, QThread::idealThreadCount()));
 
-        QString album_cache_string;
+    ReadTracks(pool, batches[0]);
+    for (int i = 0; i < batches.size(); i++)
+    {
+        pool.waitForDone();
+        if (i + 1 < batches.size())
+            ReadTracks(pool, batches[i + 1]);
 
-        // Set values from cache
-        int did = m_directoryid[directory];
-        if (did > 0)
-            disk_meta->setDirectoryId(did);
+        WriteTracks(batches[i]);
+        batches[i].clear();
+    }
+}
 
-        int aid = m_artistid[disk_meta->Artist().toLower()];
-        if (aid > 0)
+/// Starts reading the tags of a batch of files, on all the pool's threads.
+void MusicFileScanner::ReadTracks(MThreadPool &pool, TrackBatch &batch)
+{
+    int threads = pool.maxThreadCount();
+    for (int t = 0; t < threads && t < batch.size(); t++)
+    {
+        pool.start(new ReadRunnable([&batch, t, threads]()
         {
-            disk_meta->setArtistId(aid);
+            for (int i = t; i < batch.size(); i += threads)
+                ReadTrack(batch[i]);
+        }), "MusicFileScannerRead");
+    }
+}
+
+/// Reads the metadata, and the embedded images of new files, from a file.
+void MusicFileScanner::ReadTrack(TrackData &track)
+{
+    LOG(VB_FILE, LOG_INFO, QString("Reading metadata from %1")
+        .arg(track.filename));
 
-            // The album cache depends on the artist id
-            album_cache_string = QString::number(disk_meta->getArtistId()) + "#" +
-                disk_meta->Album().toLower();
+    track.metadata = MetaIO::readMetadata(track.filename);
+    if (!track.metadata)
+        return;
+
+    track.metadata->setFileSize((quint64)QFileInfo(track.filename).size());
+
+    if (track.update)
+        return;
 
-            if (m_albumid[album_cache_string] > 0)
-                disk_meta->setAlbumId(m_albumid[album_cache_string]);
+    // read any embedded images from the tag
+    MetaIO *tagger = MetaIO::createTagger(track.filename);
+    if (tagger)
+    {
+        if (tagger->supportsEmbeddedImages())
+        {
+            track.embeddedArt = tagger->getAlbumArtList(track.filename);
+            track.readArt = true;
         }
+        delete tagger;
+    }
+}
+
+/*!
+ * \brief Adds artists or genres missing from a name to id cache to the
+ *        database, and caches their ids.
+ *
+ *        The tables have no unique key on the name, so names another
+ *        scanner or client added since the cache was loaded are looked up
+ *        before the rest are inserted.
+ *
+ * \param query      Query to use, so it is part of its transaction
+ * \param cache      Cache of ids by lower case name
+ * \param names      Names needed, the ones already cached are skipped
+ * \param table      Table to add the names to
+ * \param idColumn   Id column of the table
+ * \param nameColumn Name column of the table
+ *
+ * \returns Nothing.
+ */
+void MusicFileScanner::CacheNames(MSqlQuery &query, IdCache &cache,
+                                  const QStringList &names, const QString &table,
+                                  const QString &idColumn,
+                                  const QString &nameColumn)
+{
+    QStringList missing;
+    QSet<QString> seen;
+    foreach (const QString &name, names)
+    {
+        QString key = name.toLower();
+        if (cache.value(key) > 0 || seen.contains(key))
+            continue;
+        seen.insert(key);
+        missing << name;
+    }
+
+    auto bind = [&](int i, const QString &suffix)
+        { query.bindValueNoNull(":NAME" + suffix, missing[i]); };
+    auto select = [&]()
+    {
+        bulk_exec(query, "music select names",
+                  QString("SELECT %1, LOWER(%2) FROM %3 WHERE %2 IN (%4)")
+                      .arg(idColumn).arg(nameColumn).arg(table).arg("%1"),
+                  ":NAME%1", missing.size(), bind,
+                  [&]() { cache[query.value(1).toString()] =
+                              query.value(0).toInt(); });
+    };
+
+    if (missing.isEmpty())
+        return;
+
+    select();
+    QStringList found = missing;
+    missing.clear();
+    foreach (const QString &name, found)
+    {
+        if (cache.value(name.toLower()) <= 0)
+            missing << name;
+    }
+
+    if (missing.isEmpty())
+        return;
+
+    bulk_exec(query, "music insert names",
+              QString("INSERT INTO %1 (%2) VALUES %3")
+                  .arg(table).arg(nameColumn).arg("%1"),
+              "(:NAME%1)", missing.size(), bind);
+
+    select();
+}
+
+/*!
+ * \brief Adds the albums of a batch of tracks missing from the album cache
+ *        to the database, and caches their ids.
+ *
+ *        Albums are cached by the id of their compilation artist and their
+ *        lower case name, so the artists have to be cached first.
+ */
+void MusicFileScanner::CacheAlbums(MSqlQuery &query, const TrackBatch &batch)
+{
+    QList<MusicMetadata*> missing;
+    QSet<QString> seen;
+    foreach (const TrackData &track, batch)
+    {
+        MusicMetadata *data = track.metadata;
+        if (!data)
+            continue;
+
+        int artistId = m_artistid.value(data->CompilationArtist().toLower());
+        if (artistId <= 0)
+            continue;
+
+        QString key = QString::number(artistId) + "#" + data->Album().toLower();
+        if (m_albumid.value(key) > 0 || seen.contains(key))
+            continue;
+        seen.insert(key);
+        missing << data;
+    }
+
+    auto albumKey = [&](MusicMetadata *data)
+    {
+        return QString::number(
+            m_artistid.value(data->CompilationArtist().toLower())) + "#" +
+            data->Album().toLower();
+    };
+    auto select = [&]()
+    {
+        bulk_exec(query, "music select albums",
+                  "SELECT album_id, artist_id, LOWER(album_name) "
+                  "FROM music_albums WHERE (artist_id, album_name) IN (%1)",
+                  "(:COMP_ARTIST_ID%1, :ALBUM%1)", missing.size(),
+                  [&](int i, const QString &suffix)
+                  {
+                      MusicMetadata *data = missing[i];
+                      query.bindValueNoNull(":COMP_ARTIST_ID" + suffix,
+                          m_artistid.value(data->CompilationArtist().toLower()));
+                      query.bindValueNoNull(":ALBUM" + suffix, data->Album());
+                  },
+                  [&]()
+                  {
+                      m_albumid[query.value(1).toString() + "#" +
+                                query.value(2).toString()] =
+                          query.value(0).toInt();
+                  });
+    };
+
+    if (missing.isEmpty())
+        return;
+
+    // As for names, another scanner may have added some of them
+    select();
+    QList<MusicMetadata*> found = missing;
+    missing.clear();
+    foreach (MusicMetadata *data, found)
+    {
+        if (m_albumid.value(albumKey(data)) <= 0)
+            missing << data;
+    }
+
+    if (missing.isEmpty())
+        return;
+
+    bulk_exec(query, "music insert albums",
+              "INSERT INTO music_albums "
+              "(artist_id, album_name, compilation, year) VALUES %1",
+              "(:COMP_ARTIST_ID%1, :ALBUM%1, :COMPILATION%1, :YEAR%1)",
+              missing.size(),
+              [&](int i, const QString &suffix)
+              {
+                  MusicMetadata *data = missing[i];
+                  query.bindValueNoNull(":COMP_ARTIST_ID" + suffix,
+                      m_artistid.value(data->CompilationArtist().toLower()));
+                  query.bindValueNoNull(":ALBUM" + suffix, data->Album());
+                  query.bindValue(":COMPILATION" + suffix, data->Compilation());
+                  query.bindValue(":YEAR" + suffix, data->Year());
+              });
+
+    select();
+}
+
+/*!
+ * \brief Sets the artist, album and genre ids of a track from the caches.
+ *
+ *        Anything that couldn't be cached is looked up, or added, by the
+ *        track itself.
+ */
+void MusicFileScanner::SetTrackIds(MusicMetadata *data)
+{
+    int artistId = m_artistid.value(data->Artist().toLower());
+    int compArtistId = m_artistid.value(data->CompilationArtist().toLower());
+    QString albumKey = QString::number(compArtistId) + "#" +
+        data->Album().toLower();
+    int albumId = m_albumid.value(albumKey);
+
+    // The album lookup needs the compilation artist id, which is only
+    // set by getArtistId()
+    if (artistId > 0 && compArtistId > 0 && albumId > 0)
+    {
+        data->setArtistId(artistId);
+        data->setAlbumId(albumId);
+    }
+    else
+    {
+        data->getArtistId();
+        data->getAlbumId();
+    }
+
+    int genreId = m_genreid.value(data->Genre().toLower());
+    if (genreId > 0)
+        data->setGenreId(genreId);
+    else
+        data->getGenreId();
+}
+
+/*!
+ * \brief Writes a batch of tracks read by ReadTracks() to the database.
+ *
+ *        Missing artists, genres and albums are added with multi-row
+ *        statements, then the tracks are inserted or updated together. The
+ *        embedded images of new tracks are stored once they have an id.
+ *        The batch is written in one transaction, but the music tables are
+ *        MyISAM so that doesn't make it atomic or save any flushes; the
+ *        multi-row statements are what cut the round trips.
+ *
+ * \param batch Tracks to write, their metadata is deleted
+ *
+ * \returns Nothing.
+ */
+void MusicFileScanner::WriteTracks(TrackBatch &batch)
+{
+    QString host = gCoreContext->GetHostName();
 
-        int gid = m_genreid[disk_meta->Genre().toLower()];
-        if (gid > 0)
-            disk_meta->setGenreId(gid);
+    QStringList artists;
+    QStringList genres;
+    QSet<int> directories;
 
-        disk_meta->setFileSize((quint64)QFileInfo(filename).size());
+    for (auto & track : batch)
+    {
+        if (track.update)
+            ++m_tracksUpdated;
+
+        MusicMetadata *data = track.metadata;
+        if (!data)
+            continue;
+
+        QString directory = track.filename;
+        directory.remove(0, track.startDir.length());
+        directory = directory.section( '/', 0, -2);
+
+        data->setDirectoryId(m_directoryid.value(directory));
+        data->setHostname(host);
+        directories.insert(m_directoryid.value(directory));
+
+        artists << data->Artist() << data->CompilationArtist();
+        genres << data->Genre();
+    }
+
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    if (!query.exec("START TRANSACTION"))
+        MythDB::DBError("MusicFileScanner::WriteTracks start", query);
+
+    CacheNames(query, m_artistid, artists,
+               "music_artists", "artist_id", "artist_name");
+    CacheNames(query, m_genreid, genres,
+               "music_genres", "genre_id", "genre");
+    CacheAlbums(query, batch);
+
+    // The songs already in the directories of the batch, by directory id
+    // and filename, with what an update keeps of them
+    struct SongRow
+    {
+        int m_id        {0};
+        int m_rating    {0};
+        int m_playCount {0};
+    };
+    QHash<QString, SongRow> songs;
+    QList<int> dirIds = directories.values();
+    auto loadSongs = [&]()
+    {
+        songs.clear();
+        bulk_exec(query, "music select songs",
+                  "SELECT song_id, directory_id, filename, rating, numplays "
+                  "FROM music_songs "
+                  "WHERE hostname = :HOSTNAME AND directory_id IN (%1)",
+                  ":DIRECTORY%1", dirIds.size(),
+                  [&](int i, const QString &suffix)
+                  {
+                      query.bindValue(":HOSTNAME", host);
+                      query.bindValue(":DIRECTORY" + suffix, dirIds[i]);
+                  },
+                  [&]()
+                  {
+                      SongRow row;
+                      row.m_id = query.value(0).toInt();
+                      row.m_rating = query.value(3).toInt();
+                      row.m_playCount = query.value(4).toInt();
+                      songs[query.value(1).toString() + "/" +
+                            query.value(2).toString()] = row;
+                  });
+    };
+    auto songKey = [](MusicMetadata *data)
+    {
+        return QString::number(data->getDirectoryId()) + "/" +
+            data->Filename(false).section('/', -1);
+    };
+
+    loadSongs();
 
-        disk_meta->setHostname(gCoreContext->GetHostName());
+    QList<MusicMetadata*> tracks;
+    QMap<int, MusicMetadata*> albums;
+    bool newArt = false;
+    for (auto & track : batch)
+    {
+        MusicMetadata *data = track.metadata;
+        if (!data)
+            continue;
+
+        if (track.update)
+        {
+            auto row = songs.constFind(songKey(data));
+            if (row == songs.constEnd())
+            {
+                LOG(VB_GENERAL, LOG_ERR,
+                    QString("Asked to update track not in the database - %1")
+                        .arg(track.filename));
+                delete data;
+                track.metadata = nullptr;
+                continue;
+            }
+
+            data->setID((*row).m_id);
+            data->setRating((*row).m_rating);
+            if ((*row).m_playCount > data->PlayCount())
+                data->setPlaycount((*row).m_playCount);
+        }
 
-        // Commit track info to database
-        disk_meta->dumpToDatabase();
+        SetTrackIds(data);
+        tracks << data;
+        if (data->getAlbumId() > 0)
+            albums[data->getAlbumId()] = data;
+        if (track.readArt)
+            newArt = true;
+    }
 
-        // Update the cache
-        m_artistid[disk_meta->Artist().toLower()]
-            = disk_meta->getArtistId();
-        m_genreid[disk_meta->Genre().toLower()]
-            = disk_meta->getGenreId();
-        album_cache_string = QString::number(disk_meta->getArtistId()) + "#" +
-            disk_meta->Album().toLower();
-        m_albumid[album_cache_string] = disk_meta->getAlbumId();
+    QDateTime now = MythDate::current();
+    bulk_exec(query, "MusicFileScanner::WriteTracks - updating music_songs",
+              "INSERT INTO music_songs ( song_id, directory_id,"
+              " artist_id, album_id,    name,         genre_id,"
+              " year,      track,       length,       filename,"
+              " rating,    format,      date_entered, date_modified,"
+              " numplays,  track_count, disc_number,  disc_count,"
+              " size,      hostname) "
+              "VALUES %1 "
+              "ON DUPLICATE KEY UPDATE"
+              " directory_id = VALUES(directory_id)"
+              ", artist_id = VALUES(artist_id)"
+              ", album_id = VALUES(album_id)"
+              ", name = VALUES(name)"
+              ", genre_id = VALUES(genre_id)"
+              ", year = VALUES(year)"
+              ", track = VALUES(track)"
+              ", length = VALUES(length)"
+              ", filename = VALUES(filename)"
+              ", rating = VALUES(rating)"
+              ", format = VALUES(format)"
+              ", date_modified = VALUES(date_modified)"
+              ", numplays = VALUES(numplays)"
+              ", track_count = VALUES(track_count)"
+              ", disc_number = VALUES(disc_number)"
+              ", disc_count = VALUES(disc_count)"
+              ", size = VALUES(size)"
+              ", hostname = VALUES(hostname)",
+              "( :ID%1,     :DIRECTORY%1,"
+              " :ARTIST%1,   :ALBUM%1,      :TITLE%1,       :GENRE%1,"
+              " :YEAR%1,     :TRACKNUM%1,   :LENGTH%1,      :FILENAME%1,"
+              " :RATING%1,   :FORMAT%1,     :DATE_ADD%1,    :DATE_MOD%1,"
+              " :PLAYCOUNT%1,:TRACKCOUNT%1, :DISC_NUMBER%1, :DISC_COUNT%1,"
+              " :SIZE%1,     :HOSTNAME%1 )",
+              tracks.size(),
+              [&](int i, const QString &suffix)
+              {
+                  MusicMetadata *data = tracks[i];
+                  if (data->ID() > 0)
+                      query.bindValue(":ID" + suffix, data->ID());
+                  else
+                      query.bindValue(":ID" + suffix, QVariant(QVariant::UInt));
+                  query.bindValue(":DIRECTORY" + suffix, data->getDirectoryId());
+                  query.bindValue(":ARTIST" + suffix, data->getArtistId());
+                  query.bindValue(":ALBUM" + suffix, data->getAlbumId());
+                  query.bindValue(":TITLE" + suffix, data->Title());
+                  query.bindValue(":GENRE" + suffix, data->getGenreId());
+                  query.bindValue(":YEAR" + suffix, data->Year());
+                  query.bindValue(":TRACKNUM" + suffix, data->Track());
+                  query.bindValue(":LENGTH" + suffix, data->Length());
+                  query.bindValue(":FILENAME" + suffix,
+                                  data->Filename(false).section('/', -1));
+                  query.bindValue(":RATING" + suffix, data->Rating());
+                  query.bindValueNoNull(":FORMAT" + suffix, data->Format());
+                  query.bindValue(":DATE_ADD" + suffix, now);
+                  query.bindValue(":DATE_MOD" + suffix, now);
+                  query.bindValue(":PLAYCOUNT" + suffix, data->Playcount());
+                  query.bindValue(":TRACKCOUNT" + suffix, data->GetTrackCount());
+                  query.bindValue(":DISC_NUMBER" + suffix, data->DiscNumber());
+                  query.bindValue(":DISC_COUNT" + suffix, data->DiscCount());
+                  query.bindValue(":SIZE" + suffix, (quint64)data->FileSize());
+                  query.bindValue(":HOSTNAME" + suffix, host);
+              });
+
+    // make sure the compilation flags are updated, from the last track of
+    // each album as they would be one track at a time
+    for (auto it = albums.cbegin(); it != albums.cend(); ++it)
+    {
+        query.prepare("UPDATE music_albums SET compilation = :COMPILATION, year = :YEAR "
+                      "WHERE music_albums.album_id = :ALBUMID");
+        query.bindValue(":ALBUMID", it.key());
+        query.bindValue(":COMPILATION", (*it)->Compilation());
+        query.bindValue(":YEAR", (*it)->Year());
+
+        if (!query.exec() || !query.isActive())
+            MythDB::DBError("music compilation update", query);
     }
 
-    delete disk_meta;
-    delete db_meta;
+    if (!query.exec("COMMIT"))
+        MythDB::DBError("MusicFileScanner::WriteTracks commit", query);
+
+    // Embedded images are stored by song id, so need the new ids
+    if (newArt)
+        loadSongs();
+
+    for (auto & track : batch)
+    {
+        MusicMetadata *data = track.metadata;
+        if (data && !track.update)
+        {
+            ++m_tracksAdded;
+
+            auto row = songs.constFind(songKey(data));
+            if (track.readArt && row != songs.constEnd())
+            {
+                data->setID((*row).m_id);
+                data->setEmbeddedAlbumArt(track.embeddedArt);
+                data->getAlbumArtImages()->dumpToDatabase();
+                track.embeddedArt.clear();
+            }
+        }
+
+        qDeleteAll(track.embeddedArt);
+        track.embeddedArt.clear();
+        delete data;
+        track.metadata = nullptr;
+    }
 }
 
 /*!
@@ -630,10 +1123,11 @@ void MusicFileScanner::UpdateFileInDB(const QString &filename, const QString &st
  *        database.
  *
  * \param dirList List of directories to scan
+ * \param fullScan Check every file, even in directories that didn't change
  *
  * \returns Nothing.
  */
-void MusicFileScanner::SearchDirs(const QStringList &dirList)
+void MusicFileScanner::SearchDirs(const QStringList &dirList, bool fullScan)
 {
     QString host = gCoreContext->GetHostName();
 
@@ -681,6 +1175,13 @@ void MusicFileScanner::SearchDirs(const QStringList &dirList)
     MusicLoadedMap art_files;
     MusicLoadedMap::Iterator iter;
 
+    // Which files are kept depends on the music and album art types
+    m_tracker = FileChangeTracker::GetTracker("Music");
+    m_tracker->Update(dirList, MetaIO::kValidFileExtensions + "," +
+                      gCoreContext->GetSetting("AlbumArtFilter",
+                                               "*.png;*.jpg;*.jpeg;*.gif;*.bmp"),
+                      fullScan);
+
     for (int x = 0; x < dirList.count(); x++)
     {
         QString startDir = dirList[x];
@@ -698,43 +1199,21 @@ void MusicFileScanner::SearchDirs(const QStringList &dirList)
 
     LOG(VB_GENERAL, LOG_INFO, "Updating database");
 
-        /*
-        This can be optimised quite a bit by consolidating all commands
-        via a lot of refactoring.
-
-        1) group all files of the same decoder type, and don't
-        create/delete a Decoder pr. AddFileToDB. Or make Decoders be
-        singletons, it should be a fairly simple change.
-
-        2) RemoveFileFromDB should group the remove into one big SQL.
-
-        3) UpdateFileInDB, same as 1.
-        */
-
     for (iter = music_files.begin(); iter != music_files.end(); iter++)
     {
-        if ((*iter).location == MusicFileScanner::kFileSystem)
-            AddFileToDB(iter.key(), (*iter).startDir);
-        else if ((*iter).location == MusicFileScanner::kDatabase)
+        if ((*iter).location == MusicFileScanner::kDatabase)
             RemoveFileFromDB(iter.key(), (*iter).startDir);
-        else if ((*iter).location == MusicFileScanner::kNeedUpdate)
-        {
-            UpdateFileInDB(iter.key(), (*iter).startDir);
-            ++m_tracksUpdated;
-        }
     }
 
+    UpdateTracks(music_files);
+
+    // Artwork is never marked as needing an update by ScanArtwork()
     for (iter = art_files.begin(); iter != art_files.end(); iter++)
     {
         if ((*iter).location == MusicFileScanner::kFileSystem)
             AddFileToDB(iter.key(), (*iter).startDir);
         else if ((*iter).location == MusicFileScanner::kDatabase)
             RemoveFileFromDB(iter.key(), (*iter).startDir);
-        else if ((*iter).location == MusicFileScanner::kNeedUpdate)
-        {
-            UpdateFileInDB(iter.key(), (*iter).startDir);
-            ++m_coverartUpdated;
-        }
     }
 
     // Cleanup orphaned entries from the database
@@ -756,6 +1235,8 @@ void MusicFileScanner::SearchDirs(const QStringList &dirList)
                                       .arg(host).arg(m_tracksTotal).arg(m_tracksAdded)
                                       .arg(m_coverartTotal).arg(m_coverartAdded));
 
+    m_tracker->Save();
+
     updateLastRunEnd();
     status = QString("success - %1 - %2").arg(trackStatus).arg(coverartStatus);
     updateLastRunStatus(status);
@@ -787,6 +1268,7 @@ void MusicFileScanner::ScanMusic(MusicLoadedMap &music_files)
     LOG(VB_GENERAL, LOG_INFO, "Checking tracks");
 
     QString name;
+    QString startDir;
 
     if (query.isActive() && query.size() > 0)
     {
@@ -811,6 +1293,25 @@ void MusicFileScanner::ScanMusic(MusicLoadedMap &music_files)
                     music_files.erase(iter);
                 }
             }
+            else if (InUnchangedDir(query.value(0).toString(), startDir))
+            {
+                // Retagging a file doesn't change its directory, so the
+                // file itself must be checked unless it has been watched
+                ++m_tracksTotal;
+                name = startDir + query.value(0).toString();
+                if (!m_tracker->IsWatched(QFileInfo(name).path()) &&
+                    HasFileChanged(name, query.value(1).toString()))
+                {
+                    MusicFileData fdata;
+                    fdata.startDir = startDir;
+                    fdata.location = MusicFileScanner::kNeedUpdate;
+                    music_files[name] = fdata;
+                }
+                else
+                {
+                    ++m_tracksUnchanged;
+                }
+            }
             else
                 music_files[name].location = MusicFileScanner::kDatabase;
         }
@@ -843,6 +1344,7 @@ void MusicFileScanner::ScanArtwork(MusicLoadedMap &music_files)
     LOG(VB_GENERAL, LOG_INFO, "Checking artwork");
 
     QString name;
+    QString startDir;
 
     if (query.isActive() && query.size() > 0)
     {
@@ -862,6 +1364,11 @@ void MusicFileScanner::ScanArtwork(MusicLoadedMap &music_files)
                 ++m_coverartUnchanged;
                 music_files.erase(iter);
             }
+            else if (InUnchangedDir(query.value(0).toString(), startDir))
+            {
+                ++m_coverartTotal;
+                ++m_coverartUnchanged;
+            }
             else
             {
                 music_files[name].location = MusicFileScanner::kDatabase;
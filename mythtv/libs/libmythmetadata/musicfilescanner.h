@@ -6,9 +6,17 @@
 
 // Qt headers
 #include <QCoreApplication>
+#include <QVector>
+
+// MythTV
+#include "musicmetadata.h"
 
 using IdCache = QMap<QString, int>;
 
+class FileChangeTracker;
+class MSqlQuery;
+class MThreadPool;
+
 class META_PUBLIC MusicFileScanner
 {
     Q_DECLARE_TR_FUNCTIONS(MusicFileScanner)
@@ -28,21 +36,44 @@ class META_PUBLIC MusicFileScanner
     };
 
     using MusicLoadedMap = QMap <QString, MusicFileData>;
+
+    struct TrackData
+    {
+        QString        filename;
+        QString        startDir;
+        bool           update      {false};
+        MusicMetadata *metadata    {nullptr};
+        bool           readArt     {false};
+        AlbumArtList   embeddedArt;
+    };
+    using TrackBatch = QVector<TrackData>;
+
     public:
         MusicFileScanner(void);
         ~MusicFileScanner(void) = default;
 
-        void SearchDirs(const QStringList &dirList);
+        void SearchDirs(const QStringList &dirList, bool fullScan = false);
 
         static bool IsRunning(void);
 
     private:
         void BuildFileList(QString &directory, MusicLoadedMap &music_files, MusicLoadedMap &art_files, int parentid);
         static int  GetDirectoryId(const QString &directory, const int &parentid);
+        int  CachedDirectoryId(const QString &directory, int parentid);
+        bool InUnchangedDir(const QString &filename, QString &startDir) const;
         static bool HasFileChanged(const QString &filename, const QString &date_modified);
         void AddFileToDB(const QString &filename, const QString &startDir);
         void RemoveFileFromDB (const QString &filename, const QString &startDir);
-        void UpdateFileInDB(const QString &filename, const QString &startDir);
+        void UpdateTracks(MusicLoadedMap &music_files);
+        static void ReadTracks(MThreadPool &pool, TrackBatch &batch);
+        static void ReadTrack(TrackData &track);
+        void WriteTracks(TrackBatch &batch);
+        static void CacheNames(MSqlQuery &query, IdCache &cache,
+                               const QStringList &names, const QString &table,
+                               const QString &idColumn,
+                               const QString &nameColumn);
+        void CacheAlbums(MSqlQuery &query, const TrackBatch &batch);
+        void SetTrackIds(MusicMetadata *data);
         void ScanMusic(MusicLoadedMap &music_files);
         void ScanArtwork(MusicLoadedMap &music_files);
         static void cleanDB();
@@ -54,6 +85,7 @@ class META_PUBLIC MusicFileScanner
         static void updateLastRunStatus(QString &status);
 
         QStringList  m_startDirs;
+        FileChangeTracker *m_tracker {nullptr};
         IdCache  m_directoryid;
         IdCache  m_artistid;
         IdCache  m_genreid;
@@ -1054,14 +1054,14 @@ QString VideoMetadata::VideoFileHash(const QString &file_name,
                            const QString &host)
 {
     if (host.isEmpty())
-        return FileHash(file_name);
+        return CachedFileHash(file_name);
 
     if (gCoreContext->IsMasterBackend() && gCoreContext->IsThisHost(host))
     {
         StorageGroup sgroup("Videos", host);
         QString fullname = sgroup.FindFile(file_name);
 
-        return FileHash(fullname);
+        return CachedFileHash(fullname);
     }
 
     QString url = generate_file_url("Videos", host, file_name);
@@ -2,6 +2,7 @@
 #include "videoscan.h"
 
 #include <QApplication>
+#include <QFileInfo>
 #include <QImageReader>
 #include <QUrl>
 #include <utility>
@@ -27,6 +28,7 @@
 #include "globals.h"
 #include "dbaccess.h"
 #include "dirscan.h"
+#include "filechangetracker.h"
 
 QEvent::Type VideoScanChanges::kEventType =
     (QEvent::Type) QEvent::registerEventType();
@@ -180,6 +182,27 @@ void VideoScannerThread::run()
 
     LOG(VB_GENERAL, LOG_INFO, QString("Beginning Video Scan."));
 
+    // Only local directories are tracked, storage groups are listed by
+    // their backends
+    QStringList localDirs;
+    foreach (const QString &dir, m_directories)
+    {
+        if (!dir.startsWith("myth://"))
+            localDirs << dir;
+    }
+    // Which files are kept depends on the file associations, a directory
+    // that didn't change may still hold files of a newly added type
+    FileAssociations::ext_ignore_list ext_list;
+    FileAssociations::getFileAssociation().getExtensionIgnoreList(ext_list);
+    QStringList scanSettings = imageExtensions;
+    for (const auto &ext : ext_list)
+        scanSettings << QString("%1=%2").arg(ext.first.toLower()).arg(ext.second);
+    scanSettings.sort();
+    scanSettings << QString("unknown=%1").arg(m_listUnknown);
+
+    m_tracker = FileChangeTracker::GetTracker("Videos");
+    m_tracker->Update(localDirs, scanSettings.join(","));
+
     uint counter = 0;
     FileCheckList fs_files;
 
@@ -210,6 +233,7 @@ void VideoScannerThread::run()
     PurgeList db_remove;
     verifyFiles(fs_files, db_remove);
     m_dbDataChanged = updateDB(fs_files, db_remove);
+    m_tracker->Save();
 
     if (m_dbDataChanged)
     {
@@ -287,6 +311,11 @@ void VideoScannerThread::verifyFiles(FileCheckList &files,
                     iter->second.check = true;
                 }
             }
+            else if (lhost.isEmpty() &&
+                     !m_tracker->IsChanged(QFileInfo(lname).path()))
+            {
+                // In a directory that hasn't changed, so it wasn't listed
+            }
             else if (lhost.isEmpty())
             {
                 // If it's only in the database, and not on a host we
@@ -411,7 +440,8 @@ bool VideoScannerThread::buildFileList(const QString &directory,
     FileAssociations::getFileAssociation().getExtensionIgnoreList(ext_list);
 
     dirhandler<FileCheckList> dh(filelist, imageExtensions);
-    return ScanVideoDirectory(directory, &dh, ext_list, m_listUnknown);
+    return ScanVideoDirectory(directory, &dh, ext_list, m_listUnknown,
+                              m_tracker);
 }
 
 void VideoScannerThread::SendProgressEvent(uint progress, uint total,
@@ -18,6 +18,7 @@
 #include "mythprogressdialog.h"
 
 class VideoMetadataListManager;
+class FileChangeTracker;
 
 class META_PUBLIC VideoScanner : public QObject
 {
@@ -107,6 +108,7 @@ class META_PUBLIC VideoScannerThread : public MThread
     QStringList m_offlineSGHosts;
 
     VideoMetadataListManager *m_dbMetadata {nullptr};
+    FileChangeTracker        *m_tracker    {nullptr};
     MythUIProgressDialog     *m_dialog     {nullptr};
 
     QList<int> m_addList; // newly added intids
@@ -373,7 +373,17 @@ void MythSocketManager::HandleVersion(MythSocket *socket,
 
     LOG(VB_SOCKET, LOG_DEBUG, LOC + "Client validated");
     retlist << "ACCEPT" << MYTH_PROTO_VERSION;
-    socket->WriteStringList(retlist);
+
+    // The reply is still sent with legacy framing, the client switches
+    // once it sees the framing token echoed back.
+    bool binary = (slist.size() >= 4) &&
+        (slist[3] == MythSocketFraming::kBinaryToken);
+    if (binary)
+        retlist << MythSocketFraming::kBinaryToken;
+    socket->WriteStringListAndSwitch(
+        retlist,
+        binary ? MythSocketFraming::kBinary : MythSocketFraming::kLegacy,
+        MythSocket::kNotPipelined);
     socket->m_isValidated = true;
 }
 
@@ -706,7 +706,7 @@ bool FileServerHandler::HandleQueryFileHash(SocketHandler *socket,
         // looking for file on me, return directly
         StorageGroup sgroup(storageGroup, gCoreContext->GetHostName());
         QString fullname = sgroup.FindFile(filename);
-        hash = FileHash(fullname);
+        hash = CachedFileHash(fullname);
     }
     else
     {
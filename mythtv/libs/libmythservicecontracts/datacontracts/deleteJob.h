@@ -0,0 +1,78 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: deleteJob.h
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef DELETEJOB_H_
+#define DELETEJOB_H_
+
+#include <QDateTime>
+#include <QString>
+
+#include "serviceexp.h"
+#include "datacontracthelper.h"
+
+namespace DTC
+{
+
+/////////////////////////////////////////////////////////////////////////////
+
+class SERVICE_PUBLIC DeleteJob : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO( "version"    , "1.0" );
+
+    Q_PROPERTY( QString         FileName        READ FileName         WRITE setFileName       )
+    Q_PROPERTY( qlonglong       FileSystem      READ FileSystem       WRITE setFileSystem     )
+    Q_PROPERTY( QString         Priority        READ Priority         WRITE setPriority       )
+    Q_PROPERTY( qlonglong       Size            READ Size             WRITE setSize           )
+    Q_PROPERTY( qlonglong       Remaining       READ Remaining        WRITE setRemaining      )
+    Q_PROPERTY( QDateTime       QueuedTime      READ QueuedTime       WRITE setQueuedTime     )
+    Q_PROPERTY( bool            Started         READ Started          WRITE setStarted        )
+
+    PROPERTYIMP    ( QString    , FileName       )
+    PROPERTYIMP    ( qlonglong  , FileSystem     )
+    PROPERTYIMP    ( QString    , Priority       )
+    PROPERTYIMP    ( qlonglong  , Size           )
+    PROPERTYIMP    ( qlonglong  , Remaining      )
+    PROPERTYIMP    ( QDateTime  , QueuedTime     )
+    PROPERTYIMP    ( bool       , Started        );
+
+    public:
+
+        static inline void InitializeCustomTypes();
+
+        Q_INVOKABLE DeleteJob(QObject *parent = nullptr)
+            : QObject         ( parent ),
+              m_FileSystem    ( 0      ),
+              m_Size          ( 0      ),
+              m_Remaining     ( 0      ),
+              m_Started       ( false  )
+        {
+        }
+
+        void Copy( const DeleteJob *src )
+        {
+            m_FileName      = src->m_FileName      ;
+            m_FileSystem    = src->m_FileSystem    ;
+            m_Priority      = src->m_Priority      ;
+            m_Size          = src->m_Size          ;
+            m_Remaining     = src->m_Remaining     ;
+            m_QueuedTime    = src->m_QueuedTime    ;
+            m_Started       = src->m_Started       ;
+        }
+
+    private:
+        Q_DISABLE_COPY(DeleteJob);
+};
+
+inline void DeleteJob::InitializeCustomTypes()
+{
+    qRegisterMetaType< DeleteJob*  >();
+}
+
+} // namespace DTC
+
+#endif
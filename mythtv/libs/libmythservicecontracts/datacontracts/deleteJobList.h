@@ -0,0 +1,93 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: deleteJobList.h
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef DELETEJOBLIST_H_
+#define DELETEJOBLIST_H_
+
+#include <QDateTime>
+#include <QVariantList>
+
+#include "serviceexp.h"
+#include "datacontracthelper.h"
+
+#include "deleteJob.h"
+
+namespace DTC
+{
+
+class SERVICE_PUBLIC DeleteJobList : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO( "version", "1.0" );
+
+    // Q_CLASSINFO Used to augment Metadata for properties.
+    // See datacontracthelper.h for details
+
+    Q_CLASSINFO( "DeleteJobs", "type=DTC::DeleteJob");
+
+    Q_PROPERTY( QDateTime    StartTime      READ StartTime      WRITE setStartTime      )
+    Q_PROPERTY( qlonglong    BytesPerSec    READ BytesPerSec    WRITE setBytesPerSec    )
+    Q_PROPERTY( qlonglong    QueuedBytes    READ QueuedBytes    WRITE setQueuedBytes    )
+    Q_PROPERTY( qlonglong    DeletedFiles   READ DeletedFiles   WRITE setDeletedFiles   )
+    Q_PROPERTY( qlonglong    DeletedBytes   READ DeletedBytes   WRITE setDeletedBytes   )
+    Q_PROPERTY( QVariantList DeleteJobs     READ DeleteJobs     DESIGNABLE true         )
+
+    PROPERTYIMP       ( QDateTime   , StartTime    )
+    PROPERTYIMP       ( qlonglong   , BytesPerSec  )
+    PROPERTYIMP       ( qlonglong   , QueuedBytes  )
+    PROPERTYIMP       ( qlonglong   , DeletedFiles )
+    PROPERTYIMP       ( qlonglong   , DeletedBytes )
+    PROPERTYIMP_RO_REF( QVariantList, DeleteJobs   );
+
+    public:
+
+        static inline void InitializeCustomTypes();
+
+        Q_INVOKABLE DeleteJobList(QObject *parent = nullptr)
+            : QObject       ( parent ),
+              m_BytesPerSec ( 0      ),
+              m_QueuedBytes ( 0      ),
+              m_DeletedFiles( 0      ),
+              m_DeletedBytes( 0      )
+        {
+        }
+
+        void Copy( const DeleteJobList *src )
+        {
+            m_StartTime    = src->m_StartTime;
+            m_BytesPerSec  = src->m_BytesPerSec;
+            m_QueuedBytes  = src->m_QueuedBytes;
+            m_DeletedFiles = src->m_DeletedFiles;
+            m_DeletedBytes = src->m_DeletedBytes;
+            CopyListContents< DeleteJob >( this, m_DeleteJobs, src->m_DeleteJobs );
+        }
+
+        DeleteJob *AddNewDeleteJob()
+        {
+            // We must make sure the object added to the QVariantList has
+            // a parent of 'this'
+
+            auto *pObject = new DeleteJob( this );
+            m_DeleteJobs.append( QVariant::fromValue<QObject *>( pObject ));
+
+            return pObject;
+        }
+
+    private:
+        Q_DISABLE_COPY(DeleteJobList);
+};
+
+inline void DeleteJobList::InitializeCustomTypes()
+{
+    qRegisterMetaType< DeleteJobList*  >();
+
+    DeleteJob::InitializeCustomTypes();
+}
+
+} // namespace DTC
+
+#endif
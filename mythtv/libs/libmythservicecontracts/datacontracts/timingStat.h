@@ -0,0 +1,86 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: timingStat.h
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMINGSTAT_H_
+#define TIMINGSTAT_H_
+
+#include <QString>
+
+#include "serviceexp.h"
+#include "datacontracthelper.h"
+
+namespace DTC
+{
+
+/////////////////////////////////////////////////////////////////////////////
+
+class SERVICE_PUBLIC TimingStat : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO( "version"    , "1.0" );
+
+    Q_PROPERTY( QString         Name            READ Name             WRITE setName           )
+    Q_PROPERTY( QString         Detail          READ Detail           WRITE setDetail         )
+    Q_PROPERTY( qlonglong       Count           READ Count            WRITE setCount          )
+    Q_PROPERTY( double          TotalMS         READ TotalMS          WRITE setTotalMS        )
+    Q_PROPERTY( double          MeanMS          READ MeanMS           WRITE setMeanMS         )
+    Q_PROPERTY( double          P50MS           READ P50MS            WRITE setP50MS          )
+    Q_PROPERTY( double          P99MS           READ P99MS            WRITE setP99MS          )
+    Q_PROPERTY( double          MaxMS           READ MaxMS            WRITE setMaxMS          )
+    Q_PROPERTY( qlonglong       Rows            READ Rows             WRITE setRows           )
+
+    PROPERTYIMP    ( QString    , Name           )
+    PROPERTYIMP    ( QString    , Detail         )
+    PROPERTYIMP    ( qlonglong  , Count          )
+    PROPERTYIMP    ( double     , TotalMS        )
+    PROPERTYIMP    ( double     , MeanMS         )
+    PROPERTYIMP    ( double     , P50MS          )
+    PROPERTYIMP    ( double     , P99MS          )
+    PROPERTYIMP    ( double     , MaxMS          )
+    PROPERTYIMP    ( qlonglong  , Rows           );
+
+    public:
+
+        static inline void InitializeCustomTypes();
+
+        Q_INVOKABLE TimingStat(QObject *parent = nullptr)
+            : QObject         ( parent ),
+              m_Count         ( 0      ),
+              m_TotalMS       ( 0.0    ),
+              m_MeanMS        ( 0.0    ),
+              m_P50MS         ( 0.0    ),
+              m_P99MS         ( 0.0    ),
+              m_MaxMS         ( 0.0    ),
+              m_Rows          ( 0      )
+        {
+        }
+
+        void Copy( const TimingStat *src )
+        {
+            m_Name          = src->m_Name          ;
+            m_Detail        = src->m_Detail        ;
+            m_Count         = src->m_Count         ;
+            m_TotalMS       = src->m_TotalMS       ;
+            m_MeanMS        = src->m_MeanMS        ;
+            m_P50MS         = src->m_P50MS         ;
+            m_P99MS         = src->m_P99MS         ;
+            m_MaxMS         = src->m_MaxMS         ;
+            m_Rows          = src->m_Rows          ;
+        }
+
+    private:
+        Q_DISABLE_COPY(TimingStat);
+};
+
+inline void TimingStat::InitializeCustomTypes()
+{
+    qRegisterMetaType< TimingStat*  >();
+}
+
+} // namespace DTC
+
+#endif
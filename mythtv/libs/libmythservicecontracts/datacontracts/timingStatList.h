@@ -0,0 +1,80 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: timingStatList.h
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef TIMINGSTATLIST_H_
+#define TIMINGSTATLIST_H_
+
+#include <QDateTime>
+#include <QVariantList>
+
+#include "serviceexp.h"
+#include "datacontracthelper.h"
+
+#include "timingStat.h"
+
+namespace DTC
+{
+
+class SERVICE_PUBLIC TimingStatList : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO( "version", "1.0" );
+
+    // Q_CLASSINFO Used to augment Metadata for properties.
+    // See datacontracthelper.h for details
+
+    Q_CLASSINFO( "TimingStats", "type=DTC::TimingStat");
+
+    Q_PROPERTY( QString      Group       READ Group       WRITE setGroup     )
+    Q_PROPERTY( QDateTime    StartTime   READ StartTime   WRITE setStartTime )
+    Q_PROPERTY( QVariantList TimingStats READ TimingStats DESIGNABLE true    )
+
+    PROPERTYIMP       ( QString     , Group       )
+    PROPERTYIMP       ( QDateTime   , StartTime   )
+    PROPERTYIMP_RO_REF( QVariantList, TimingStats );
+
+    public:
+
+        static inline void InitializeCustomTypes();
+
+        Q_INVOKABLE TimingStatList(QObject *parent = nullptr)
+            : QObject( parent )
+        {
+        }
+
+        void Copy( const TimingStatList *src )
+        {
+            m_Group     = src->m_Group;
+            m_StartTime = src->m_StartTime;
+            CopyListContents< TimingStat >( this, m_TimingStats, src->m_TimingStats );
+        }
+
+        TimingStat *AddNewTimingStat()
+        {
+            // We must make sure the object added to the QVariantList has
+            // a parent of 'this'
+
+            auto *pObject = new TimingStat( this );
+            m_TimingStats.append( QVariant::fromValue<QObject *>( pObject ));
+
+            return pObject;
+        }
+
+    private:
+        Q_DISABLE_COPY(TimingStatList);
+};
+
+inline void TimingStatList::InitializeCustomTypes()
+{
+    qRegisterMetaType< TimingStatList*  >();
+
+    TimingStat::InitializeCustomTypes();
+}
+
+} // namespace DTC
+
+#endif
@@ -62,6 +62,8 @@ HEADERS += datacontracts/backendInfo.h           datacontracts/envInfo.h
 HEADERS += datacontracts/buildInfo.h             datacontracts/logInfo.h
 HEADERS += datacontracts/genre.h                 datacontracts/genreList.h
 HEADERS += datacontracts/musicMetadataInfo.h     datacontracts/musicMetadataInfoList.h
+HEADERS += datacontracts/timingStat.h            datacontracts/timingStatList.h
+HEADERS += datacontracts/deleteJob.h             datacontracts/deleteJobList.h
 
 HEADERS += enums/recStatus.h
 
@@ -125,6 +127,8 @@ incDatacontracts.files += datacontracts/enum.h                datacontracts/enum
 incDatacontracts.files += datacontracts/cutting.h             datacontracts/cutList.h
 incDatacontracts.files += datacontracts/backendInfo.h         datacontracts/envInfo.h
 incDatacontracts.files += datacontracts/buildInfo.h           datacontracts/logInfo.h
+incDatacontracts.files += datacontracts/timingStat.h          datacontracts/timingStatList.h
+incDatacontracts.files += datacontracts/deleteJob.h           datacontracts/deleteJobList.h
 
 INSTALLS += inc incServices incDatacontracts incEnums
 
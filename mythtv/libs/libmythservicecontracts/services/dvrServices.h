@@ -39,6 +39,10 @@
 //    type.  Defaults to "BOTH", available values:
 //          "GET", "POST" or "BOTH"
 //
+//  * Q_CLASSINFO( "<methodName>_Cache", ...) lets GET responses be cached
+//    until the listed data changes, see ServiceResponseCache. Values are
+//    ';' separated: "recordings", "schedule" or "guide"
+//
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 
@@ -58,6 +62,12 @@ class SERVICE_PUBLIC DvrServices : public Service  //, public QScriptable ???
     Q_CLASSINFO( "EnableRecordSchedule_Method",                 "POST" )
     Q_CLASSINFO( "DisableRecordSchedule_Method",                "POST" )
     Q_CLASSINFO( "ManageJobQueue_Method",                       "POST" )
+    Q_CLASSINFO( "GetExpiringList_Cache",                       "recordings" )
+    Q_CLASSINFO( "GetRecordedList_Cache",                       "recordings" )
+    Q_CLASSINFO( "GetTitleInfoList_Cache",                      "recordings" )
+    Q_CLASSINFO( "GetConflictList_Cache",                       "schedule" )
+    Q_CLASSINFO( "GetUpcomingList_Cache",                       "schedule;recordings" )
+    Q_CLASSINFO( "GetRecordScheduleList_Cache",                 "schedule" )
 
 
     public:
@@ -34,6 +34,10 @@
 //    type.  Defaults to "BOTH", available values:
 //          "GET", "POST" or "BOTH"
 //
+//  * Q_CLASSINFO( "<methodName>_Cache", ...) lets GET responses be cached
+//    until the listed data changes, see ServiceResponseCache. Values are
+//    ';' separated: "recordings", "schedule" or "guide"
+//
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
 
@@ -43,6 +47,8 @@ class SERVICE_PUBLIC GuideServices : public Service  //, public QScriptable ???
     Q_CLASSINFO( "version"    , "2.4" )
     Q_CLASSINFO( "AddToChannelGroup_Method",                     "POST" )
     Q_CLASSINFO( "RemoveFromChannelGroup_Method",                "POST" )
+    Q_CLASSINFO( "GetProgramGuide_Cache",                        "guide;schedule" )
+    Q_CLASSINFO( "GetProgramList_Cache",                         "guide;schedule" )
 
     public:
 
@@ -24,6 +24,8 @@
 #include "datacontracts/logMessageList.h"
 #include <datacontracts/frontendList.h>
 #include "datacontracts/backendInfo.h"
+#include "datacontracts/timingStatList.h"
+#include "datacontracts/deleteJobList.h"
 
 /////////////////////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////////////////////
@@ -44,7 +46,7 @@
 class SERVICE_PUBLIC MythServices : public Service  //, public QScriptable ???
 {
     Q_OBJECT
-    Q_CLASSINFO( "version"    , "5.2" );
+    Q_CLASSINFO( "version"    , "5.5" );
     Q_CLASSINFO( "AddStorageGroupDir_Method",    "POST" )
     Q_CLASSINFO( "RemoveStorageGroupDir_Method", "POST" )
     Q_CLASSINFO( "PutSetting_Method",            "POST" )
@@ -59,6 +61,7 @@ class SERVICE_PUBLIC MythServices : public Service  //, public QScriptable ???
     Q_CLASSINFO( "ProfileDelete_Method",         "POST" )
     Q_CLASSINFO( "ManageDigestUser_Method",      "POST" )
     Q_CLASSINFO( "ManageUrlProtection_Method",   "POST" )
+    Q_CLASSINFO( "ResetTimingStats_Method",      "POST" )
 
     public:
 
@@ -75,6 +78,8 @@ class SERVICE_PUBLIC MythServices : public Service  //, public QScriptable ???
             DTC::LogMessageList     ::InitializeCustomTypes();
             DTC::FrontendList       ::InitializeCustomTypes();
             DTC::BackendInfo        ::InitializeCustomTypes();
+            DTC::TimingStatList     ::InitializeCustomTypes();
+            DTC::DeleteJobList      ::InitializeCustomTypes();
         }
 
     public slots:
@@ -187,6 +192,14 @@ class SERVICE_PUBLIC MythServices : public Service  //, public QScriptable ???
 
         virtual bool                ManageUrlProtection ( const QString &Services,
                                                           const QString &AdminPassword) = 0;
+
+        virtual DTC::TimingStatList* GetTimingStats     ( const QString &Group ) = 0;
+
+        virtual bool                ResetTimingStats    ( const QString &Group ) = 0;
+
+        virtual DTC::TimingStatList* GetDatabaseProfile ( int Count ) = 0;
+
+        virtual DTC::DeleteJobList* GetDeleteQueue      ( ) = 0;
 };
 
 #endif
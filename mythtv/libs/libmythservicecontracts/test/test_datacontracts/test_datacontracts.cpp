@@ -16,6 +16,7 @@
  *   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA
  */
 
+#include <QBuffer>
 #include <QStringList>
 #include "mythversion.h"
 #include "mythdate.h"
@@ -24,6 +25,41 @@
 #include "datacontracts/programList.h"
 #include "datacontracts/recRule.h"
 #include "datacontracts/recording.h"
+#include "jsonSerializer.h"
+#include "xmlSerializer.h"
+
+static QString get_etag(Serializer &ser)
+{
+    QStringMap headers;
+    ser.AddHeaders(headers);
+    return headers["ETag"];
+}
+
+static DTC::ProgramList *make_programlist(int count)
+{
+    DTC::ProgramList::InitializeCustomTypes();
+
+    auto *pPrograms = new DTC::ProgramList();
+    for (int i = 0; i < count; i++)
+    {
+        DTC::Program *pProgram = pPrograms->AddNewProgram();
+        pProgram->setTitle("Big Buck Bunny");
+        pProgram->setSubTitle(QString("Part %1/2 \"Rodents\"").arg(i));
+        pProgram->setDescription("Follow a day of the life of Big Buck Bunny "
+                                 "when he meets three bullying rodents...");
+        pProgram->setInetref    ("10378");
+        pProgram->setCategory   ("movie");
+        pProgram->setStartTime  (QDateTime(QDate(2020, 1, 1),
+                                           QTime(20, 0), Qt::UTC));
+    }
+    pPrograms->setStartIndex    ( 0 );
+    pPrograms->setCount         ( count );
+    pPrograms->setTotalAvailable( count );
+    pPrograms->setAsOf          ( MythDate::current() );
+    pPrograms->setVersion       ( MYTH_BINARY_VERSION );
+    pPrograms->setProtoVer      ( MYTH_PROTO_VERSION  );
+    return pPrograms;
+}
 
 void TestDataContracts::initTestCase(void)
 {
@@ -174,6 +210,93 @@ void TestDataContracts::test_recordinginfo(void)
     QCOMPARE(pRecording->EndTs(), pRecording2->EndTs());
 }
 
+void TestDataContracts::test_serialize_json(void)
+{
+    DTC::ProgramList *pPrograms = make_programlist(2);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    JSONSerializer ser(&buffer, "GetRecordedList");
+    ser.Serialize(pPrograms, "ProgramList");
+    QString json = QString::fromUtf8(buffer.data());
+
+    QVERIFY(json.startsWith("{\"ProgramList\": {\"StartIndex\": \"0\""));
+    QVERIFY(json.contains("\"Programs\": [{"));
+    QVERIFY(json.contains("\"Title\": \"Big Buck Bunny\""));
+    QVERIFY(json.contains("\"SubTitle\": \"Part 1\\/2 \\\"Rodents\\\"\""));
+    QVERIFY(json.contains("\"StartTime\": \"2020-01-01T20:00:00Z\""));
+    QVERIFY(!json.contains("objectName"));
+
+    // AsOf is transient, so it must not change the ETag
+    QString etag = get_etag(ser);
+    pPrograms->setAsOf(MythDate::current().addDays(1));
+    QBuffer buffer2;
+    buffer2.open(QIODevice::ReadWrite);
+    JSONSerializer ser2(&buffer2, "GetRecordedList");
+    ser2.Serialize(pPrograms, "ProgramList");
+    QCOMPARE(get_etag(ser2), etag);
+
+    // Anything else does
+    pPrograms->setCount(5);
+    QBuffer buffer3;
+    buffer3.open(QIODevice::ReadWrite);
+    JSONSerializer ser3(&buffer3, "GetRecordedList");
+    ser3.Serialize(pPrograms, "ProgramList");
+    QVERIFY(get_etag(ser3) != etag);
+
+    delete pPrograms;
+}
+
+void TestDataContracts::test_serialize_xml(void)
+{
+    DTC::ProgramList *pPrograms = make_programlist(2);
+
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+    XmlSerializer ser(&buffer, "GetRecordedList");
+    ser.Serialize(pPrograms, "ProgramList");
+    QString xml = QString::fromUtf8(buffer.data());
+
+    QVERIFY(xml.contains("<ProgramList xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
+                         "version=\"1.0\""));
+    // The list item name comes from the "type=DTC::Program" class info
+    QVERIFY(xml.contains("<Programs><Program><StartTime>2020-01-01T20:00:00Z</StartTime>"));
+    QCOMPARE(xml.count("<Program>"), 2);
+    QVERIFY(xml.contains("<Title>Big Buck Bunny</Title>"));
+
+    delete pPrograms;
+}
+
+void TestDataContracts::test_serialize_bench_data(void)
+{
+    QTest::addColumn<bool>("json");
+    QTest::newRow("json") << true;
+    QTest::newRow("xml")  << false;
+}
+
+void TestDataContracts::test_serialize_bench(void)
+{
+    QFETCH(bool, json);
+
+    DTC::ProgramList *pPrograms = make_programlist(5000);
 
+    QBENCHMARK
+    {
+        QBuffer buffer;
+        buffer.open(QIODevice::ReadWrite);
+        if (json)
+        {
+            JSONSerializer ser(&buffer, "GetRecordedList");
+            ser.Serialize(pPrograms, "ProgramList");
+        }
+        else
+        {
+            XmlSerializer ser(&buffer, "GetRecordedList");
+            ser.Serialize(pPrograms, "ProgramList");
+        }
+    }
+
+    delete pPrograms;
+}
 
 QTEST_APPLESS_MAIN(TestDataContracts)
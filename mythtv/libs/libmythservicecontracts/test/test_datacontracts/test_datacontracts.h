@@ -32,4 +32,8 @@ private slots:
     static void test_programlist(void);
     static void test_recrule(void);
     static void test_recordinginfo(void);
+    static void test_serialize_json(void);
+    static void test_serialize_xml(void);
+    static void test_serialize_bench_data(void);
+    static void test_serialize_bench(void);
 };
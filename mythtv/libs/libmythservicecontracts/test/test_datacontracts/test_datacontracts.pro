@@ -6,6 +6,7 @@ TEMPLATE = app
 TARGET = test_datacontracts
 DEPENDPATH += . ../.. ../../../libmyth ../../../libmythbase
 INCLUDEPATH += . ../.. ../../../libmyth ../../../libmythbase
+INCLUDEPATH += ../../../libmythupnp ../../../libmythupnp/serializers
 LIBS += -L../../../libmythbase -lmythbase-$$LIBVERSION
 LIBS += -L../../../libmyth -lmyth-$$LIBVERSION
 LIBS += -L../../../libmythui -lmythui-$$LIBVERSION
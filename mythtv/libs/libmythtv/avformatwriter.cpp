@@ -96,16 +96,21 @@ bool AVFormatWriter::Init(void)
     else
         m_fmt.video_codec = AV_CODEC_ID_NONE;
 
-    m_avAudioCodec = avcodec_find_encoder_by_name(
-        m_audioCodec.toLatin1().constData());
-    if (!m_avAudioCodec)
+    if (!m_audioCodec.isEmpty())
     {
-        LOG(VB_RECORD, LOG_ERR, LOC +
-            QString("Init(): Unable to find audio codec %1").arg(m_audioCodec));
-        return false;
-    }
+        m_avAudioCodec = avcodec_find_encoder_by_name(
+            m_audioCodec.toLatin1().constData());
+        if (!m_avAudioCodec)
+        {
+            LOG(VB_RECORD, LOG_ERR, LOC +
+                QString("Init(): Unable to find audio codec %1").arg(m_audioCodec));
+            return false;
+        }
 
-    m_fmt.audio_codec = m_avAudioCodec->id;
+        m_fmt.audio_codec = m_avAudioCodec->id;
+    }
+    else
+        m_fmt.audio_codec = AV_CODEC_ID_NONE;
 
     m_ctx = avformat_alloc_context();
     if (!m_ctx)
@@ -436,6 +441,61 @@ bool AVFormatWriter::ReOpen(const QString& filename)
     return result;
 }
 
+/** \brief Adds a stream that takes already encoded packets.
+ *
+ *  Must be called after Init() and before OpenFile(). Init() leaves out
+ *  the encoded video and audio streams when no width, height or audio
+ *  codec are set, so a writer can be used for stream copy only.
+ */
+AVStream* AVFormatWriter::AddCopyStream(const AVCodecParameters *par,
+                                        AVRational timeBase)
+{
+    AVStream *st = avformat_new_stream(m_ctx, nullptr);
+    if (!st)
+    {
+        LOG(VB_RECORD, LOG_ERR,
+            LOC + "AddCopyStream(): avformat_new_stream() failed");
+        return nullptr;
+    }
+
+    if (avcodec_parameters_copy(st->codecpar, par) < 0)
+    {
+        LOG(VB_RECORD, LOG_ERR,
+            LOC + "AddCopyStream(): avcodec_parameters_copy() failed");
+        return nullptr;
+    }
+
+    // The tag is specific to the input container, let the muxer pick one.
+    st->codecpar->codec_tag = 0;
+    st->time_base           = timeBase;
+
+    return st;
+}
+
+/** \brief Writes an encoded packet to one of the streams.
+ *
+ *  The packet timestamps are in timeBase, they are rescaled to the time
+ *  base the muxer chose for the stream.
+ */
+bool AVFormatWriter::WritePacket(AVPacket *pkt, AVRational timeBase)
+{
+    if (!m_ctx || pkt->stream_index < 0 ||
+        static_cast<uint>(pkt->stream_index) >= m_ctx->nb_streams)
+        return false;
+
+    av_packet_rescale_ts(pkt, timeBase,
+                         m_ctx->streams[pkt->stream_index]->time_base);
+
+    if (av_interleaved_write_frame(m_ctx, pkt) < 0)
+    {
+        LOG(VB_RECORD, LOG_ERR, LOC + "WritePacket(): "
+                "av_interleaved_write_frame couldn't write packet");
+        return false;
+    }
+
+    return true;
+}
+
 AVStream* AVFormatWriter::AddVideoStream(void)
 {
     AVStream *st = avformat_new_stream(m_ctx, nullptr);
@@ -31,6 +31,9 @@ class MTV_PUBLIC AVFormatWriter : public FileWriterBase
     bool NextFrameIsKeyFrame(void);
     bool ReOpen(const QString& filename);
 
+    AVStream *AddCopyStream(const AVCodecParameters *par, AVRational timeBase);
+    bool WritePacket(AVPacket *pkt, AVRational timeBase);
+
   private:
     AVStream *AddVideoStream(void);
     bool OpenVideo(void);
@@ -3786,6 +3786,45 @@ nullptr
             return false;
     }
 
+    if (dbver == "1361")
+    {
+        // FileHash() of local files, by what identifies their contents
+        const char *updates[] = {
+            "CREATE TABLE IF NOT EXISTS filehash ("
+            "  hostname VARCHAR(64) NOT NULL DEFAULT '',"
+            "  filename VARCHAR(255) NOT NULL DEFAULT '',"
+            "  device BIGINT UNSIGNED NOT NULL DEFAULT 0,"
+            "  inode BIGINT UNSIGNED NOT NULL DEFAULT 0,"
+            "  filesize BIGINT NOT NULL DEFAULT 0,"
+            "  mtime BIGINT NOT NULL DEFAULT 0,"
+            "  hash VARCHAR(64) NOT NULL DEFAULT '',"
+            "  PRIMARY KEY (hostname, device, inode, filesize, mtime),"
+            "  KEY filename (hostname, filename)"
+            ") ENGINE=MyISAM DEFAULT CHARSET=utf8;",
+            nullptr
+        };
+        if (!performActualUpdate(updates, "1362", dbver))
+            return false;
+    }
+
+    if (dbver == "1362")
+    {
+        // Directory snapshots used by FileChangeTracker
+        const char *updates[] = {
+            "CREATE TABLE IF NOT EXISTS scannerdirs ("
+            "  hostname VARCHAR(64) NOT NULL DEFAULT '',"
+            "  scanner VARCHAR(32) NOT NULL DEFAULT '',"
+            "  path TEXT NOT NULL,"
+            "  mtime BIGINT NOT NULL DEFAULT 0,"
+            "  inode BIGINT UNSIGNED NOT NULL DEFAULT 0,"
+            "  KEY scanner (hostname, scanner)"
+            ") ENGINE=MyISAM DEFAULT CHARSET=utf8;",
+            nullptr
+        };
+        if (!performActualUpdate(updates, "1363", dbver))
+            return false;
+    }
+
     return true;
 }
 
@@ -5,11 +5,15 @@
  * License: GPL v2
  */
 
+#include <QDataStream>
 #include <QDateTime>
+#include <QDir>
+#include <QFile>
 
 #include "eitcache.h"
 #include "mythcontext.h"
 #include "mythdb.h"
+#include "mythdirs.h"
 #include "mythlogging.h"
 #include "mythdate.h"
 
@@ -18,6 +22,15 @@
 // Highest version number. version is 5bits
 const uint EITCache::kVersionMax = 31;
 
+// "EITC", followed by the format version
+static const quint32 kSnapshotMagic   = 0x45495443;
+static const quint32 kSnapshotVersion = 1;
+
+static QString snapshot_filename(void)
+{
+    return GetConfDir() + "/cache/eitcache.bin";
+}
+
 EITCache::EITCache()
 {
     // 24 hours ago
@@ -31,6 +44,9 @@ EITCache::EITCache()
 EITCache::~EITCache()
 {
     WriteToDB();
+
+    for (auto & shard : m_shards)
+        qDeleteAll(shard.m_channels);
 }
 
 void EITCache::ResetStatistics(void)
@@ -45,20 +61,29 @@ void EITCache::ResetStatistics(void)
     m_prunedHitCnt = 0;
     m_futureHitCnt = 0;
     m_wrongChannelHitCnt = 0;
+    m_snapshotLoadCnt = 0;
 }
 
 QString EITCache::GetStatistics(void) const
 {
-    QMutexLocker locker(&m_eventMapLock);
+    uint accessCnt = m_accessCnt;
+    uint hitCnt = m_hitCnt;
+    uint prunedHitCnt = m_prunedHitCnt;
+    uint futureHitCnt = m_futureHitCnt;
+    uint wrongChannelHitCnt = m_wrongChannelHitCnt;
+
     return QString(
         "EITCache stats: Access:%1 Hits:%2 "
         "Table:%3 Version:%4 Endtime:%5 New:%6 "
         "Pruned:%7 Pruned Hits:%8 Future:%9 Wrong Channel:%10 "
-        "Hit Ratio:%11")
-        .arg(m_accessCnt).arg(m_hitCnt)
-        .arg(m_tblChgCnt).arg(m_verChgCnt).arg(m_endChgCnt).arg(m_entryCnt)
-        .arg(m_pruneCnt).arg(m_prunedHitCnt).arg(m_futureHitCnt).arg(m_wrongChannelHitCnt)
-        .arg((m_hitCnt+m_prunedHitCnt+m_futureHitCnt+m_wrongChannelHitCnt)/(double)m_accessCnt);
+        "Hit Ratio:%11 Snapshot Loads:%12")
+        .arg(accessCnt).arg(hitCnt)
+        .arg(m_tblChgCnt.load()).arg(m_verChgCnt.load())
+        .arg(m_endChgCnt.load()).arg(m_entryCnt.load())
+        .arg(m_pruneCnt.load()).arg(prunedHitCnt).arg(futureHitCnt)
+        .arg(wrongChannelHitCnt)
+        .arg((hitCnt+prunedHitCnt+futureHitCnt+wrongChannelHitCnt)/(double)accessCnt)
+        .arg(m_snapshotLoadCnt.load());
 }
 
 /*
@@ -93,6 +118,80 @@ static inline bool modified(uint64_t sig)
     return (sig >> 63) != 0U;
 }
 
+void EITEventTable::Resize(size_t capacity)
+{
+    std::vector<uint32_t> keys(capacity, 0);
+    std::vector<uint64_t> sigs(capacity, 0);
+    m_keys.swap(keys);
+    m_sigs.swap(sigs);
+    m_size = 0;
+
+    for (size_t i = 0; i < keys.size(); i++)
+    {
+        if (sigs[i])
+            Insert(keys[i], sigs[i]);
+    }
+}
+
+uint64_t *EITEventTable::Find(uint eventid)
+{
+    size_t mask = m_keys.size() - 1;
+    for (size_t i = Slot(eventid); m_sigs[i]; i = (i + 1) & mask)
+    {
+        if (m_keys[i] == eventid)
+            return &m_sigs[i];
+    }
+    return nullptr;
+}
+
+void EITEventTable::Insert(uint eventid, uint64_t sig)
+{
+    uint64_t *existing = Find(eventid);
+    if (existing)
+    {
+        *existing = sig;
+        return;
+    }
+
+    // Keep at least half the slots free so probe sequences stay short
+    if ((m_size + 1) * 2 > m_keys.size())
+        Resize(m_keys.size() * 2);
+
+    size_t mask = m_keys.size() - 1;
+    size_t i = Slot(eventid);
+    while (m_sigs[i])
+        i = (i + 1) & mask;
+
+    m_keys[i] = eventid;
+    m_sigs[i] = sig;
+    m_size++;
+}
+
+uint EITEventTable::Prune(uint endtime)
+{
+    uint removed = 0;
+    for (auto & sig : m_sigs)
+    {
+        if (sig && extract_endtime(sig) <= endtime)
+        {
+            sig = 0;
+            removed++;
+        }
+    }
+
+    if (!removed)
+        return 0;
+
+    // Emptied slots may break the probe sequence of the entries after
+    // them, rebuild the table at a size that fits what is left.
+    size_t capacity = kMinCapacity;
+    while (capacity < (size_t)(m_size - removed) * 2)
+        capacity *= 2;
+    Resize(capacity);
+
+    return removed;
+}
+
 static void replace_in_db(QStringList &value_clauses,
                           uint chanid, uint eventid, uint64_t sig)
 {
@@ -177,7 +276,9 @@ static bool lock_channel(uint chanid, uint endtime)
     return true;
 }
 
-static void unlock_channel(uint chanid, uint updated)
+/// Releases the channel lock and records the statistics row, returns the
+/// time written to the statistics row.
+static uint unlock_channel(uint chanid, uint updated)
 {
     MSqlQuery query(MSqlQuery::InitCon());
 
@@ -211,14 +312,45 @@ static void unlock_channel(uint chanid, uint updated)
 
     if (!query.exec())
         MythDB::DBError("Error inserting eit statistics", query);
+
+    return now;
 }
 
+/// Returns when the channel was last written to the database by any
+/// backend, or 0 if that isn't known.
+static uint last_sync_time(uint chanid)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+
+    QString qstr =
+        "SELECT MAX(endtime) "
+        "FROM eit_cache "
+        "WHERE chanid  = :CHANID   AND "
+        "      status  = :STATUS";
+
+    query.prepare(qstr);
+    query.bindValue(":CHANID",  chanid);
+    query.bindValue(":STATUS",  STATISTIC);
 
-event_map_t * EITCache::LoadChannel(uint chanid)
+    if (!query.exec() || !query.isActive())
+    {
+        MythDB::DBError("Error reading eit statistics", query);
+        return 0;
+    }
+
+    return query.next() ? query.value(0).toUInt() : 0;
+}
+
+
+EITEventTable * EITCache::LoadChannel(uint chanid)
 {
     if (!lock_channel(chanid, m_lastPruneTime))
         return nullptr;
 
+    EITEventTable *eventTable = LoadChannelFromSnapshot(chanid);
+    if (eventTable)
+        return eventTable;
+
     MSqlQuery query(MSqlQuery::InitCon());
 
     QString qstr =
@@ -230,7 +362,7 @@ event_map_t * EITCache::LoadChannel(uint chanid)
 
     query.prepare(qstr);
     query.bindValue(":CHANID",   chanid);
-    query.bindValue(":ENDTIME",  m_lastPruneTime);
+    query.bindValue(":ENDTIME",  m_lastPruneTime.load());
     query.bindValue(":STATUS",   EITDATA);
 
     if (!query.exec() || !query.isActive())
@@ -239,7 +371,7 @@ event_map_t * EITCache::LoadChannel(uint chanid)
         return nullptr;
     }
 
-    auto *eventMap = new event_map_t();
+    eventTable = new EITEventTable();
 
     while (query.next())
     {
@@ -248,49 +380,224 @@ event_map_t * EITCache::LoadChannel(uint chanid)
         uint version = query.value(2).toUInt();
         uint endtime = query.value(3).toUInt();
 
-        (*eventMap)[eventid] = construct_sig(tableid, version, endtime, false);
+        eventTable->Insert(eventid,
+                           construct_sig(tableid, version, endtime, false));
     }
 
-    if (!eventMap->empty())
+    if (eventTable->size())
         LOG(VB_EIT, LOG_INFO, LOC + QString("Loaded %1 entries for channel %2")
-                .arg(eventMap->size()).arg(chanid));
+                .arg(eventTable->size()).arg(chanid));
 
-    m_entryCnt += eventMap->size();
-    return eventMap;
+    m_entryCnt += eventTable->size();
+    return eventTable;
 }
 
-bool EITCache::WriteChannelToDB(QStringList &value_clauses, uint chanid)
+/** \fn EITCache::LoadChannelFromSnapshot(uint chanid)
+ *  \brief Returns the channel's entries from the snapshot written by the
+ *         last WriteToDB(), or nullptr if the database has to be used.
+ *
+ *  The snapshot is only used when the newest statistics row for the
+ *  channel is the one written along with it, otherwise another backend
+ *  has updated the channel since.
+ */
+EITEventTable * EITCache::LoadChannelFromSnapshot(uint chanid)
 {
-    event_map_t * eventMap = m_channelMap[chanid];
+    QMutexLocker locker(&m_snapshotLock);
 
-    if (!eventMap)
-        return false;
+    if (!m_snapshotLoaded)
+        LoadSnapshot();
 
-    uint size    = eventMap->size();
-    uint updated = 0;
-    uint removed = 0;
+    auto it = m_snapshot.find(chanid);
+    if (it == m_snapshot.end())
+        return nullptr;
+
+    Snapshot snapshot = std::move(*it);
+    m_snapshot.erase(it);
+    locker.unlock();
+
+    if (!snapshot.m_syncTime || snapshot.m_syncTime != last_sync_time(chanid))
+    {
+        LOG(VB_EIT, LOG_DEBUG, LOC +
+            QString("Snapshot of channel %1 is out of date").arg(chanid));
+        return nullptr;
+    }
+
+    uint lastPruneTime = m_lastPruneTime;
+    auto *eventTable = new EITEventTable();
+    for (const auto & event : snapshot.m_events)
+    {
+        if (extract_endtime(event.second) > lastPruneTime)
+            eventTable->Insert(event.first, event.second);
+    }
+
+    if (eventTable->size())
+        LOG(VB_EIT, LOG_INFO, LOC +
+            QString("Loaded %1 entries for channel %2 from snapshot")
+                .arg(eventTable->size()).arg(chanid));
+
+    m_entryCnt += eventTable->size();
+    m_snapshotLoadCnt++;
+    return eventTable;
+}
+
+/// Reads the snapshot file, the caller must hold m_snapshotLock.
+void EITCache::LoadSnapshot(void)
+{
+    m_snapshotLoaded = true;
+
+    QFile file(snapshot_filename());
+    if (!file.open(QIODevice::ReadOnly))
+        return;
 
-    event_map_t::iterator it = eventMap->begin();
-    while (it != eventMap->end())
+    QDataStream in(&file);
+    quint32 magic    = 0;
+    quint32 version  = 0;
+    quint32 channels = 0;
+    in >> magic >> version >> channels;
+
+    if (magic != kSnapshotMagic || version != kSnapshotVersion)
+    {
+        LOG(VB_EIT, LOG_WARNING, LOC +
+            QString("Ignoring snapshot %1 with unknown format")
+                .arg(file.fileName()));
+        return;
+    }
+
+    uint total = 0;
+    for (quint32 i = 0; i < channels && in.status() == QDataStream::Ok; i++)
     {
-        if (extract_endtime(*it) > m_lastPruneTime)
+        quint32 chanid   = 0;
+        quint32 syncTime = 0;
+        quint32 events   = 0;
+        in >> chanid >> syncTime >> events;
+
+        // Each event takes 12 bytes, don't trust a count the file can't hold
+        if (events > file.bytesAvailable() / 12)
         {
-            if (modified(*it))
-            {
-                replace_in_db(value_clauses, chanid, it.key(), *it);
-                updated++;
-                *it &= ~(uint64_t)0 >> 1; // mark as synced
-            }
-            ++it;
+            in.setStatus(QDataStream::ReadCorruptData);
+            break;
         }
-        else
+
+        Snapshot &snapshot = m_snapshot[chanid];
+        snapshot.m_syncTime = syncTime;
+        snapshot.m_events.reserve(events);
+        for (quint32 j = 0; j < events; j++)
         {
-            // Event is too old; remove from eit cache in memory
-            it = eventMap->erase(it);
-            removed++;
+            quint32 eventid = 0;
+            quint64 sig     = 0;
+            in >> eventid >> sig;
+            snapshot.m_events.emplace_back(eventid, sig);
         }
+        total += events;
+    }
+
+    if (in.status() != QDataStream::Ok)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Snapshot %1 is corrupt, ignoring it")
+                .arg(file.fileName()));
+        m_snapshot.clear();
+        return;
     }
-    unlock_channel(chanid, updated);
+
+    LOG(VB_EIT, LOG_INFO, LOC +
+        QString("Read snapshot of %1 entries for %2 channels")
+            .arg(total).arg(channels));
+}
+
+/** \fn EITCache::WriteSnapshot(const QByteArray&, uint)
+ *  \brief Replaces the snapshot file with the channels written by
+ *         WriteChannelToDB() and those in the previous snapshot that
+ *         haven't been seen since it was read.
+ */
+void EITCache::WriteSnapshot(const QByteArray &channels, uint channelCount)
+{
+    QMutexLocker locker(&m_snapshotLock);
+
+    if (!m_snapshotLoaded)
+    {
+        // Nothing was cached in this process, leave the file alone
+        if (!channelCount)
+            return;
+        LoadSnapshot();
+    }
+
+    QString filename = snapshot_filename();
+    QString tmpname  = filename + ".tmp";
+
+    QDir dir;
+    dir.mkpath(GetConfDir() + "/cache");
+
+    QFile file(tmpname);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to write snapshot %1").arg(tmpname));
+        return;
+    }
+
+    QDataStream out(&file);
+    out << kSnapshotMagic << kSnapshotVersion
+        << (quint32)(channelCount + m_snapshot.size());
+    out.writeRawData(channels.constData(), channels.size());
+
+    for (auto it = m_snapshot.cbegin(); it != m_snapshot.cend(); ++it)
+    {
+        out << (quint32)it.key() << (quint32)it->m_syncTime
+            << (quint32)it->m_events.size();
+        for (const auto & event : it->m_events)
+            out << (quint32)event.first << (quint64)event.second;
+    }
+
+    file.close();
+
+    if (out.status() != QDataStream::Ok || file.error() != QFile::NoError)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Error writing snapshot %1").arg(tmpname));
+        QFile::remove(tmpname);
+        return;
+    }
+
+    QFile::remove(filename);
+    if (!QFile::rename(tmpname, filename))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Unable to rename snapshot to %1").arg(filename));
+    }
+}
+
+bool EITCache::WriteChannelToDB(QStringList &value_clauses, uint chanid,
+                                EITEventTable *eventTable,
+                                QByteArray &snapshot)
+{
+    if (!eventTable)
+        return false;
+
+    uint size    = eventTable->size();
+    uint updated = 0;
+
+    // Event is too old; remove from eit cache in memory
+    uint removed = eventTable->Prune(m_lastPruneTime);
+
+    QDataStream out(&snapshot, QIODevice::Append);
+    QByteArray  events;
+    QDataStream eventsOut(&events, QIODevice::WriteOnly);
+
+    eventTable->ForEach([&](uint eventid, uint64_t &sig)
+    {
+        if (modified(sig))
+        {
+            replace_in_db(value_clauses, chanid, eventid, sig);
+            updated++;
+            sig &= ~(uint64_t)0 >> 1; // mark as synced
+        }
+        eventsOut << (quint32)eventid << (quint64)sig;
+    });
+    uint syncTime = unlock_channel(chanid, updated);
+
+    out << (quint32)chanid << (quint32)syncTime << (quint32)eventTable->size();
+    out.writeRawData(events.constData(), events.size());
 
     if (updated)
     {
@@ -311,86 +618,104 @@ bool EITCache::WriteChannelToDB(QStringList &value_clauses, uint chanid)
 
 void EITCache::WriteToDB(void)
 {
-    QMutexLocker locker(&m_eventMapLock);
+    QMutexLocker writeLocker(&m_writeLock);
 
     QStringList value_clauses;
-    key_map_t::iterator it = m_channelMap.begin();
-    while (it != m_channelMap.end())
-    {
-        if (!WriteChannelToDB(value_clauses, it.key()))
-            it = m_channelMap.erase(it);
-        else
-            ++it;
-    }
+    QByteArray  snapshot;
+    uint        channelCount = 0;
 
-    if(value_clauses.isEmpty())
+    for (auto & shard : m_shards)
     {
-        return;
+        QMutexLocker locker(&shard.m_lock);
+
+        auto it = shard.m_channels.begin();
+        while (it != shard.m_channels.end())
+        {
+            if (!WriteChannelToDB(value_clauses, it.key(), *it, snapshot))
+            {
+                it = shard.m_channels.erase(it);
+            }
+            else
+            {
+                ++it;
+                channelCount++;
+            }
+        }
     }
 
-    MSqlQuery query(MSqlQuery::InitCon());
-    query.prepare(QString("REPLACE INTO eit_cache "
-                          "(chanid, eventid, tableid, version, endtime) "
-                          "VALUES %1").arg(value_clauses.join(",")));
-    if (!query.exec())
+    if (!value_clauses.isEmpty())
     {
-        MythDB::DBError("Error updating eitcache", query);
+        MSqlQuery query(MSqlQuery::InitCon());
+        query.prepare(QString("REPLACE INTO eit_cache "
+                              "(chanid, eventid, tableid, version, endtime) "
+                              "VALUES %1").arg(value_clauses.join(",")));
+        if (!query.exec())
+        {
+            MythDB::DBError("Error updating eitcache", query);
+        }
     }
+
+    // Every channel written above has a new statistics row, so the
+    // snapshot has to be rewritten even when nothing was modified.
+    WriteSnapshot(snapshot, channelCount);
 }
 
 bool EITCache::IsNewEIT(uint chanid,  uint tableid,   uint version,
                         uint eventid, uint endtime)
 {
-    m_accessCnt++;
+    uint accessCnt = ++m_accessCnt;
 
-    if (m_accessCnt % 500000 == 50000)
+    if (accessCnt % 500000 == 50000)
     {
         LOG(VB_EIT, LOG_INFO, GetStatistics());
         WriteToDB();
     }
 
+    uint lastPruneTime = m_lastPruneTime;
+
     // don't re-add pruned entries
-    if (endtime < m_lastPruneTime)
+    if (endtime < lastPruneTime)
     {
         m_prunedHitCnt++;
         return false;
     }
 
     // validity check, reject events with endtime over 7 weeks in the future
-    if (endtime > m_lastPruneTime + 50 * 86400)
+    if (endtime > lastPruneTime + 50 * 86400)
     {
         m_futureHitCnt++;
         return false;
     }
 
-    QMutexLocker locker(&m_eventMapLock);
-    if (!m_channelMap.contains(chanid))
-    {
-        m_channelMap[chanid] = LoadChannel(chanid);
-    }
+    Shard &shard = ShardFor(chanid);
+    QMutexLocker locker(&shard.m_lock);
 
-    if (!m_channelMap[chanid])
+    auto cit = shard.m_channels.find(chanid);
+    if (cit == shard.m_channels.end())
+        cit = shard.m_channels.insert(chanid, LoadChannel(chanid));
+
+    EITEventTable *eventTable = *cit;
+    if (!eventTable)
     {
         m_wrongChannelHitCnt++;
         return false;
     }
 
-    event_map_t * eventMap = m_channelMap[chanid];
-    event_map_t::iterator it = eventMap->find(eventid);
-    if (it != eventMap->end())
+    uint64_t *sig = eventTable->Find(eventid);
+    if (sig)
     {
-        if (extract_table_id(*it) > tableid)
+        if (extract_table_id(*sig) > tableid)
         {
             // EIT from lower (ie. better) table number
             m_tblChgCnt++;
         }
-        else if ((extract_table_id(*it) == tableid) &&
-                 (extract_version(*it) != version))
+        else if ((extract_table_id(*sig) == tableid) &&
+                 (extract_version(*sig) != version))
         {
             // EIT updated version on current table
             m_verChgCnt++;
         }
-        else if (extract_endtime(*it) != endtime)
+        else if (extract_endtime(*sig) != endtime)
         {
             // Endtime (starttime + duration) changed
             m_endChgCnt++;
@@ -401,9 +726,12 @@ bool EITCache::IsNewEIT(uint chanid,  uint tableid,   uint version,
             m_hitCnt++;
             return false;
         }
+        *sig = construct_sig(tableid, version, endtime, true);
+    }
+    else
+    {
+        eventTable->Insert(eventid, construct_sig(tableid, version, endtime, true));
     }
-
-    eventMap->insert(eventid, construct_sig(tableid, version, endtime, true));
     m_entryCnt++;
 
     return true;
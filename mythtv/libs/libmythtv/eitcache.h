@@ -6,18 +6,62 @@
 #ifndef _EIT_CACHE_H
 #define _EIT_CACHE_H
 
+#include <atomic>
 #include <cstdint>
+#include <utility>
+#include <vector>
 
 // Qt headers
 #include <QString>
 #include <QMutex>
-#include <QMap>
+#include <QHash>
 
 // MythTV headers
 #include "mythtvexp.h"
 
-using event_map_t = QMap<uint, uint64_t>;
-using key_map_t = QMap<uint, event_map_t*>;
+/** \brief Open addressing hash of event id to packed signature for the
+ *         events of a single channel.
+ *
+ *  The signature packs the table id, version and end time into 64 bits
+ *  (see construct_sig() in eitcache.cpp), a signature of 0 marks an
+ *  unused slot since it would have an end time in 1970. Linear probing
+ *  keeps lookups in one or two cache lines, entries are only ever
+ *  removed in bulk so Prune() simply rebuilds the table.
+ */
+class EITEventTable
+{
+  public:
+    EITEventTable() { Resize(kMinCapacity); }
+
+    /// Returns the slot holding eventid, or nullptr if there is none.
+    uint64_t *Find(uint eventid);
+    void Insert(uint eventid, uint64_t sig);
+
+    /// Removes entries ending at or before endtime, returns how many.
+    uint Prune(uint endtime);
+
+    uint size(void) const { return m_size; }
+    uint capacity(void) const { return m_keys.size(); }
+
+    /// Calls func(eventid, sig) for every entry, sig may be modified.
+    template <typename FUNC> void ForEach(FUNC func)
+    {
+        for (size_t i = 0; i < m_keys.size(); i++)
+            if (m_sigs[i])
+                func(m_keys[i], m_sigs[i]);
+    }
+
+  private:
+    size_t Slot(uint eventid) const
+        { return (eventid * 0x9E3779B1U) & (m_keys.size() - 1); }
+    void Resize(size_t capacity);
+
+    static const size_t kMinCapacity = 64;
+
+    std::vector<uint32_t> m_keys;
+    std::vector<uint64_t> m_sigs;
+    uint                  m_size {0};
+};
 
 class EITCache
 {
@@ -35,26 +79,61 @@ class EITCache
     QString GetStatistics(void) const;
 
   private:
-    event_map_t * LoadChannel(uint chanid);
-    bool WriteChannelToDB(QStringList &value_clauses, uint chanid);
+    /// A channel that is locked by another backend, or failed to load,
+    /// has a nullptr table so it isn't retried on every section.
+    using channel_map_t = QHash<uint, EITEventTable*>;
+
+    class Shard
+    {
+      public:
+        QMutex        m_lock;
+        channel_map_t m_channels; // protected by m_lock
+    };
+
+    class Snapshot
+    {
+      public:
+        uint                                   m_syncTime {0};
+        std::vector<std::pair<uint,uint64_t>>  m_events;
+    };
+
+    Shard &ShardFor(uint chanid) { return m_shards[chanid % kNumShards]; }
+
+    EITEventTable * LoadChannel(uint chanid);
+    EITEventTable * LoadChannelFromSnapshot(uint chanid);
+    bool WriteChannelToDB(QStringList &value_clauses, uint chanid,
+                          EITEventTable *eventTable, QByteArray &snapshot);
+
+    void LoadSnapshot(void);
+    void WriteSnapshot(const QByteArray &channels, uint channelCount);
+
+    // event key cache, channels are spread over the shards by chanid so
+    // recorders on different channels rarely contend for a lock
+    static const uint kNumShards = 16;
+    Shard          m_shards[kNumShards];
+
+    std::atomic<uint> m_lastPruneTime;
 
-    // event key cache
-    key_map_t      m_channelMap;
+    // on disk snapshot of the cache as of the last WriteToDB()
+    QMutex         m_snapshotLock;
+    bool           m_snapshotLoaded     {false}; // protected by m_snapshotLock
+    QHash<uint, Snapshot> m_snapshot;            // protected by m_snapshotLock
 
-    mutable QMutex m_eventMapLock;
-    uint           m_lastPruneTime;
+    // serializes WriteToDB(), taken before any shard lock
+    QMutex         m_writeLock;
 
     // statistics
-    uint           m_accessCnt          {0};
-    uint           m_hitCnt             {0};
-    uint           m_tblChgCnt          {0};
-    uint           m_verChgCnt          {0};
-    uint           m_endChgCnt          {0};
-    uint           m_entryCnt           {0};
-    uint           m_pruneCnt           {0};
-    uint           m_prunedHitCnt       {0};
-    uint           m_futureHitCnt       {0};
-    uint           m_wrongChannelHitCnt {0};
+    std::atomic<uint> m_accessCnt          {0};
+    std::atomic<uint> m_hitCnt             {0};
+    std::atomic<uint> m_tblChgCnt          {0};
+    std::atomic<uint> m_verChgCnt          {0};
+    std::atomic<uint> m_endChgCnt          {0};
+    std::atomic<uint> m_entryCnt           {0};
+    std::atomic<uint> m_pruneCnt           {0};
+    std::atomic<uint> m_prunedHitCnt       {0};
+    std::atomic<uint> m_futureHitCnt       {0};
+    std::atomic<uint> m_wrongChannelHitCnt {0};
+    std::atomic<uint> m_snapshotLoadCnt    {0};
 
     static const uint kVersionMax;
 
@@ -1,6 +1,10 @@
 // C++ headers
 #include <algorithm>
 
+// Qt headers
+#include <QRegularExpression>
+#include <QVector>
+
 // MythTV headers
 #include "eitfixup.h"
 #include "programinfo.h" // for CategoryType
@@ -9,6 +13,8 @@
 #include "programinfo.h" // for subtitle types and audio and video properties
 #include "dishdescriptors.h" // for dish_theme_type_to_string
 #include "mythlogging.h"
+#include "mythtimer.h"
+#include "mythtimingstats.h"
 
 /*------------------------------------------------------------------------
  * Event Fix Up Scripts - Turned on by entry in dtv_privatetype table
@@ -224,33 +230,111 @@ EITFixUp::EITFixUp()
       m_grNotPreviouslyShown("(?:\\W?)(?:-\\s*)*(?:\\b[Α1]['΄η]?\\s*(?:τηλεοπτικ[ηή]\\s*)?(?:μετ[αά]δοση|προβολ[ηή]))(?:\\W?)",Qt::CaseInsensitive),
       // Try to exctract Greek categories from keywords in description.
       m_grEpisodeAsSubtitle("(?:^Επεισ[οό]διο:\\s?)([\\w\\s-,']+)\\.(?:\\s)?"),
-      m_grCategFood("(?:\\W)?(?:εκπομπ[ηή]\\W)?(Γαστρονομ[ιί]α[σς]?|μαγειρικ[ηή][σς]?|chef|συνταγ[εέηή]|διατροφ|wine|μ[αά]γειρα[σς]?)(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategDrama("(?:\\W)?(κοινωνικ[ηήό]|δραματικ[ηή]|δρ[αά]μα)(?:\\W)(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?",Qt::CaseInsensitive),
-      m_grCategComedy("(?:\\W)?(κωμικ[ηήοό]|χιουμοριστικ[ηήοό]|κωμωδ[ιί]α)(?:\\W)(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?",Qt::CaseInsensitive),
-      m_grCategChildren("(?:\\W)?(παιδικ[ηήοό]|κινο[υύ]μ[εέ]ν(ων|α)\\sσχ[εέ]δ[ιί](ων|α))(?:\\W)(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?",Qt::CaseInsensitive),
-      m_grCategMystery("(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?(?:\\W)?(μυστηρ[ιί]ου)(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategFantasy("(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?(?:\\W)?(φαντασ[ιί]ας)(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategHistory("(?:\\W)?(ιστορικ[ηήοό])(?:\\W)?(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?",Qt::CaseInsensitive),
-      m_grCategTeleMag("(?:\\W)?(ενημερωτικ[ηή]|ψυχαγωγικ[ηή]|τηλεπεριοδικ[οό]|μαγκαζ[ιί]νο)(?:\\W)?(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?",Qt::CaseInsensitive),
-      m_grCategTeleShop("(?:\\W)?(οδηγ[οό][σς]?\\sαγορ[ωώ]ν|τηλεπ[ωώ]λ[ηή]σ|τηλεαγορ|τηλεμ[αά]ρκετ|telemarket)(?:\\W)?(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?",Qt::CaseInsensitive),
-      m_grCategGameShow("(?:\\W)?(τηλεπαιχν[ιί]δι|quiz)(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategDocumentary("(?:\\W)?(ντοκ[ιυ]μαντ[εέ]ρ)(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategBiography("(?:\\W)?(βιογραφ[ιί]α|βιογραφικ[οό][σς]?)(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategNews("(?:\\W)?(δελτ[ιί]ο\\W?|ειδ[ηή]σε(ι[σς]|ων))(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategSports("(?:\\W)?(champion|αθλητικ[αάοόηή]|πρωτ[αά]θλημα|ποδ[οό]σφαιρο(ου)?|κολ[υύ]μβηση|πατιν[αά]ζ|formula|μπ[αά]σκετ|β[οό]λε[ιϊ])(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategMusic("(?:\\W)?(μουσικ[οόηή]|eurovision|τραγο[υύ]δι)(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategReality("(?:\\W)?(ρι[αά]λιτι|reality)(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategReligion("(?:\\W)?(θρησκε[ιί]α|θρησκευτικ|να[οό][σς]?|θε[ιί]α λειτουργ[ιί]α)(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategCulture("(?:\\W)?(τ[εέ]χν(η|ε[σς])|πολιτισμ)(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategNature("(?:\\W)?(φ[υύ]ση|περιβ[αά]λλο|κατασκευ|επιστ[ηή]μ(?!ονικ[ηή]ς φαντασ[ιί]ας))(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategSciFi("(?:\\W)?(επιστ(.|ημονικ[ηή]ς)\\s?φαντασ[ιί]ας)(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategHealth("(?:\\W)?(υγε[ιί]α|υγειιν|ιατρικ|διατροφ)(?:\\W)?",Qt::CaseInsensitive),
-      m_grCategSpecial("(?:\\W)?(αφι[εέ]ρωμα)(?:\\W)?",Qt::CaseInsensitive),
       m_unitymediaImdbrating("\\s*IMDb Rating: (\\d\\.\\d)\\s?/10$")
 {
 }
 
+/// The fixups in the order they are applied.
+const EITFixUp::Rule EITFixUp::kRules[] =
+{
+    { kFixHTML,     "HTML",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixStripHTML(e); } },
+    { kFixHDTV,     "HDTV",
+      [](const EITFixUp &/*f*/, DBEventEIT &e) { e.m_videoProps |= VID_HDTV; } },
+    { kFixBell,     "Bell",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixBellExpressVu(e); } },
+    { kFixDish,     "Dish",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixBellExpressVu(e); } },
+    { kFixUK,       "UK",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixUK(e); } },
+    { kFixPBS,      "PBS",
+      [](const EITFixUp &/*f*/, DBEventEIT &e) { FixPBS(e); } },
+    { kFixComHem,   "ComHem",
+      [](const EITFixUp &f, DBEventEIT &e)
+      { f.FixComHem(e, (kFixSubtitle & e.m_fixup) != 0U); } },
+    { kFixAUStar,   "AUStar",
+      [](const EITFixUp &/*f*/, DBEventEIT &e) { FixAUStar(e); } },
+    { kFixAUDescription, "AUDescription",
+      [](const EITFixUp &/*f*/, DBEventEIT &e) { FixAUDescription(e); } },
+    { kFixAUFreeview, "AUFreeview",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixAUFreeview(e); } },
+    { kFixAUNine,   "AUNine",
+      [](const EITFixUp &/*f*/, DBEventEIT &e) { FixAUNine(e); } },
+    { kFixAUSeven,  "AUSeven",
+      [](const EITFixUp &/*f*/, DBEventEIT &e) { FixAUSeven(e); } },
+    { kFixMCA,      "MCA",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixMCA(e); } },
+    { kFixRTL,      "RTL",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixRTL(e); } },
+    { kFixP7S1,     "P7S1",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixPRO7(e); } },
+    { kFixATV,      "ATV",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixATV(e); } },
+    { kFixDisneyChannel, "DisneyChannel",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixDisneyChannel(e); } },
+    { kFixFI,       "FI",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixFI(e); } },
+    { kFixPremiere, "Premiere",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixPremiere(e); } },
+    { kFixNL,       "NL",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixNL(e); } },
+    { kFixNO,       "NO",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixNO(e); } },
+    { kFixNRK_DVBT, "NRK_DVBT",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixNRK_DVBT(e); } },
+    { kFixDK,       "DK",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixDK(e); } },
+    { kFixCategory, "Category",
+      [](const EITFixUp &/*f*/, DBEventEIT &e) { FixCategory(e); } },
+    { kFixGreekSubtitle, "GreekSubtitle",
+      [](const EITFixUp &/*f*/, DBEventEIT &e) { FixGreekSubtitle(e); } },
+    { kFixGreekEIT, "GreekEIT",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixGreekEIT(e); } },
+    { kFixGreekCategories, "GreekCategories",
+      [](const EITFixUp &/*f*/, DBEventEIT &e) { FixGreekCategories(e); } },
+    { kFixUnitymedia, "Unitymedia",
+      [](const EITFixUp &f, DBEventEIT &e) { f.FixUnitymedia(e); } },
+};
+
+const size_t EITFixUp::kNumRules = sizeof(kRules) / sizeof(kRules[0]);
+
+EITFixUp::RuleTimes::RuleTimes() :
+    m_nsecs(kNumRules, 0), m_events(kNumRules, 0)
+{
+}
+
+/// Adds the time spent in each rule to the "eitfixup" group of
+/// MythTimingStats, as one sample per rule with the events as its rows.
+void EITFixUp::RecordRuleTimes(const RuleTimes &times)
+{
+    static MythTimingStats *s_stats = MythTimingStats::Get("eitfixup");
+
+    for (size_t i = 0; i < kNumRules; ++i)
+    {
+        if (times.m_events[i])
+            s_stats->Record(kRules[i].m_name, times.m_nsecs[i] / 1000,
+                            times.m_events[i]);
+    }
+}
+
 void EITFixUp::Fix(DBEventEIT &event) const
+{
+    RuleTimes times;
+    FixEvent(event, times);
+    RecordRuleTimes(times);
+}
+
+/// Fixes a batch of events, such as those from one EIT table, recording
+/// the time spent in each rule once for the whole batch.
+void EITFixUp::Fix(const QList<DBEventEIT*> &events) const
+{
+    RuleTimes times;
+    for (auto *event : events)
+        FixEvent(*event, times);
+    RecordRuleTimes(times);
+}
+
+void EITFixUp::FixEvent(DBEventEIT &event, RuleTimes &times) const
 {
     if (event.m_fixup)
     {
@@ -264,89 +348,19 @@ void EITFixUp::Fix(DBEventEIT &event) const
         }
     }
 
-    if (kFixHTML & event.m_fixup)
-        FixStripHTML(event);
-
-    if (kFixHDTV & event.m_fixup)
-        event.m_videoProps |= VID_HDTV;
-
-    if (kFixBell & event.m_fixup)
-        FixBellExpressVu(event);
-
-    if (kFixDish & event.m_fixup)
-        FixBellExpressVu(event);
-
-    if (kFixUK & event.m_fixup)
-        FixUK(event);
-
-    if (kFixPBS & event.m_fixup)
-        FixPBS(event);
-
-    if (kFixComHem & event.m_fixup)
-        FixComHem(event, (kFixSubtitle & event.m_fixup) != 0U);
-
-    if (kFixAUStar & event.m_fixup)
-        FixAUStar(event);
-
-    if (kFixAUDescription & event.m_fixup)
-        FixAUDescription(event);
-
-    if (kFixAUFreeview & event.m_fixup)
-        FixAUFreeview(event);
-
-    if (kFixAUNine & event.m_fixup)
-        FixAUNine(event);
-
-    if (kFixAUSeven & event.m_fixup)
-        FixAUSeven(event);
-
-    if (kFixMCA & event.m_fixup)
-        FixMCA(event);
-
-    if (kFixRTL & event.m_fixup)
-        FixRTL(event);
-
-    if (kFixP7S1 & event.m_fixup)
-        FixPRO7(event);
-
-    if (kFixATV & event.m_fixup)
-        FixATV(event);
-
-    if (kFixDisneyChannel & event.m_fixup)
-        FixDisneyChannel(event);
-
-    if (kFixFI & event.m_fixup)
-        FixFI(event);
-
-    if (kFixPremiere & event.m_fixup)
-        FixPremiere(event);
-
-    if (kFixNL & event.m_fixup)
-        FixNL(event);
-
-    if (kFixNO & event.m_fixup)
-        FixNO(event);
-
-    if (kFixNRK_DVBT & event.m_fixup)
-        FixNRK_DVBT(event);
-
-    if (kFixDK & event.m_fixup)
-        FixDK(event);
-
-    if (kFixCategory & event.m_fixup)
-        FixCategory(event);
-
-    if (kFixGreekSubtitle & event.m_fixup)
-        FixGreekSubtitle(event);
-
-    if (kFixGreekEIT & event.m_fixup)
-        FixGreekEIT(event);
-
-    if (kFixGreekCategories & event.m_fixup)
-        FixGreekCategories(event);
+    // Time each fixup, so the expensive ones show up in the "eitfixup"
+    // group of MythTimingStats
+    for (size_t i = 0; i < kNumRules; ++i)
+    {
+        const Rule &rule = kRules[i];
+        if ((rule.m_mask & event.m_fixup) == 0U)
+            continue;
 
-    if (kFixUnitymedia & event.m_fixup)
-        FixUnitymedia(event);
+        MythTimer timer(MythTimer::kStartRunning);
+        rule.m_fix(*this, event);
+        times.m_nsecs[i] += timer.nsecsElapsed();
+        times.m_events[i]++;
+    }
 
     if (event.m_fixup)
     {
@@ -842,51 +856,70 @@ void EITFixUp::FixUK(DBEventEIT &event) const
 
     bool isMovie = event.m_category.startsWith("Movie",Qt::CaseInsensitive) ||
                    event.m_category.startsWith("Film",Qt::CaseInsensitive);
+    // Most events need none of the removals below, so each regex is
+    // only run when a literal it requires is present.
+
     // BBC three case (could add another record here ?)
-    event.m_description = event.m_description.remove(m_ukThen);
-    event.m_description = event.m_description.remove(m_ukNew);
-    event.m_title = event.m_title.remove(m_ukNewTitle);
+    if (event.m_description.contains("60 Seconds", Qt::CaseInsensitive))
+        event.m_description = event.m_description.remove(m_ukThen);
+    if (event.m_description.contains("New", Qt::CaseInsensitive))
+        event.m_description = event.m_description.remove(m_ukNew);
+    if (event.m_title.startsWith("New:", Qt::CaseInsensitive) ||
+        event.m_title.startsWith("Brand New", Qt::CaseInsensitive))
+        event.m_title = event.m_title.remove(m_ukNewTitle);
 
     // Removal of Class TV, CBBC and CBeebies etc..
-    event.m_title = event.m_title.remove(m_ukTitleRemove);
-    event.m_description = event.m_description.remove(m_ukDescriptionRemove);
+    if (event.m_title.startsWith("T4:", Qt::CaseInsensitive) ||
+        event.m_title.startsWith("Schools"))
+        event.m_title = event.m_title.remove(m_ukTitleRemove);
+    if (event.m_description.startsWith("CB") ||
+        event.m_description.startsWith("Class TV") ||
+        event.m_description.startsWith("BBC Switch."))
+        event.m_description = event.m_description.remove(m_ukDescriptionRemove);
 
     // Removal of BBC FOUR and BBC THREE
-    event.m_description = event.m_description.remove(m_ukBBC34);
+    if (event.m_description.contains(" on BBC ", Qt::CaseInsensitive))
+        event.m_description = event.m_description.remove(m_ukBBC34);
 
     // BBC 7 [Rpt of ...] case.
-    event.m_description = event.m_description.remove(m_ukBBC7rpt);
+    if (event.m_description.contains("[Rpt"))
+        event.m_description = event.m_description.remove(m_ukBBC7rpt);
 
     // "All New To 4Music!
-    event.m_description = event.m_description.remove(m_ukAllNew);
+    if (event.m_description.contains("4Music!"))
+        event.m_description = event.m_description.remove(m_ukAllNew);
 
     // Removal of 'Also in HD' text
- 	event.m_description = event.m_description.remove(m_ukAlsoInHD);
+    if (event.m_description.contains("Also in HD.", Qt::CaseInsensitive))
+        event.m_description = event.m_description.remove(m_ukAlsoInHD);
 
     // Remove [AD,S] etc.
-    bool    ccMatched = false;
-    QRegExp tmpCC = m_ukCC;
     int position1 = 0;
-    while ((position1 = tmpCC.indexIn(event.m_description, position1)) != -1)
+    if (event.m_description.contains('['))
     {
-        ccMatched = true;
-        position1 += tmpCC.matchedLength();
+        bool    ccMatched = false;
+        QRegExp tmpCC = m_ukCC;
+        while ((position1 = tmpCC.indexIn(event.m_description, position1)) != -1)
+        {
+            ccMatched = true;
+            position1 += tmpCC.matchedLength();
 
-        QStringList tmpCCitems = tmpCC.cap(0).remove("[").remove("]").split(",");
-        if (tmpCCitems.contains("AD"))
-            event.m_audioProps |= AUD_VISUALIMPAIR;
-        if (tmpCCitems.contains("HD"))
-            event.m_videoProps |= VID_HDTV;
-        if (tmpCCitems.contains("S"))
-            event.m_subtitleType |= SUB_NORMAL;
-        if (tmpCCitems.contains("SL"))
-            event.m_subtitleType |= SUB_SIGNED;
-        if (tmpCCitems.contains("W"))
-            event.m_videoProps |= VID_WIDESCREEN;
-    }
+            QStringList tmpCCitems = tmpCC.cap(0).remove("[").remove("]").split(",");
+            if (tmpCCitems.contains("AD"))
+                event.m_audioProps |= AUD_VISUALIMPAIR;
+            if (tmpCCitems.contains("HD"))
+                event.m_videoProps |= VID_HDTV;
+            if (tmpCCitems.contains("S"))
+                event.m_subtitleType |= SUB_NORMAL;
+            if (tmpCCitems.contains("SL"))
+                event.m_subtitleType |= SUB_SIGNED;
+            if (tmpCCitems.contains("W"))
+                event.m_videoProps |= VID_WIDESCREEN;
+        }
 
-    if(ccMatched)
-        event.m_description = event.m_description.remove(m_ukCC);
+        if(ccMatched)
+            event.m_description = event.m_description.remove(m_ukCC);
+    }
 
     event.m_title       = event.m_title.trimmed();
     event.m_description = event.m_description.trimmed();
@@ -2906,105 +2939,176 @@ void EITFixUp::FixGreekEIT(DBEventEIT &event) const
 // να σβήσω τα κομμάτια που περισσεύουν από την περιγραφή πχ παραγωγής χχχχ
 }
 
-void EITFixUp::FixGreekCategories(DBEventEIT &event) const
+namespace {
+
+enum GreekCategoryRegex
 {
-    if (event.m_description.indexOf(m_grCategComedy) != -1)
-    {
-        event.m_category = "Κωμωδία";
-    }
-    else if (event.m_description.indexOf(m_grCategTeleMag) != -1)
-    {
-        event.m_category = "Τηλεπεριοδικό";
-    }
-    else if (event.m_description.indexOf(m_grCategNature) != -1)
-    {
-        event.m_category = "Επιστήμη/Φύση";
-    }
-    else if (event.m_description.indexOf(m_grCategHealth) != -1)
-    {
-        event.m_category = "Υγεία";
-    }
-    else if (event.m_description.indexOf(m_grCategReality) != -1)
-    {
-        event.m_category = "Ριάλιτι";
-    }
-    else if (event.m_description.indexOf(m_grCategDrama) != -1)
-    {
-        event.m_category = "Κοινωνικό";
-    }
-    else if (event.m_description.indexOf(m_grCategChildren) != -1)
-    {
-        event.m_category = "Παιδικό";
-    }
-    else if (event.m_description.indexOf(m_grCategSciFi) != -1)
-    {
-        event.m_category = "Επιστ.Φαντασίας";
-    }
-    else if ((event.m_description.indexOf(m_grCategFantasy) != -1)
-             && (event.m_description.indexOf(m_grCategMystery) != -1))
-    {
-        event.m_category = "Φαντασίας/Μυστηρίου";
-    }
-    else if (event.m_description.indexOf(m_grCategMystery) != -1)
-    {
-        event.m_category = "Μυστηρίου";
-    }
-    else if (event.m_description.indexOf(m_grCategFantasy) != -1)
-    {
-        event.m_category = "Φαντασίας";
-    }
-    else if (event.m_description.indexOf(m_grCategHistory) != -1)
-    {
-        event.m_category = "Ιστορικό";
-    }
-    else if (event.m_description.indexOf(m_grCategTeleShop) != -1
-            || event.m_title.indexOf(m_grCategTeleShop) != -1)
-    {
-        event.m_category = "Τηλεπωλήσεις";
-    }
-    else if (event.m_description.indexOf(m_grCategFood) != -1)
-    {
-        event.m_category = "Γαστρονομία";
-    }
-    else if (event.m_description.indexOf(m_grCategGameShow) != -1
-             || event.m_title.indexOf(m_grCategGameShow) != -1)
-    {
-        event.m_category = "Τηλεπαιχνίδι";
-    }
-    else if (event.m_description.indexOf(m_grCategBiography) != -1)
-    {
-        event.m_category = "Βιογραφία";
-    }
-    else if (event.m_title.indexOf(m_grCategNews) != -1)
-    {
-        event.m_category = "Ειδήσεις";
-    }
-    else if (event.m_description.indexOf(m_grCategSports) != -1)
-    {
-        event.m_category = "Αθλητικά";
-    }
-    else if (event.m_description.indexOf(m_grCategMusic) != -1
-            || event.m_title.indexOf(m_grCategMusic) != -1)
-    {
-        event.m_category = "Μουσική";
-    }
-    else if (event.m_description.indexOf(m_grCategDocumentary) != -1)
-    {
-        event.m_category = "Ντοκιμαντέρ";
-    }
-    else if (event.m_description.indexOf(m_grCategReligion) != -1)
-    {
-        event.m_category = "Θρησκεία";
-    }
-    else if (event.m_description.indexOf(m_grCategCulture) != -1)
-    {
-        event.m_category = "Τέχνες/Πολιτισμός";
-    }
-    else if (event.m_description.indexOf(m_grCategSpecial) != -1)
-    {
-        event.m_category = "Αφιέρωμα";
-    }
+    kGrNone,
+    kGrComedy,
+    kGrTeleMag,
+    kGrNature,
+    kGrHealth,
+    kGrReality,
+    kGrDrama,
+    kGrChildren,
+    kGrSciFi,
+    kGrMystery,
+    kGrFantasy,
+    kGrHistory,
+    kGrTeleShop,
+    kGrFood,
+    kGrGameShow,
+    kGrBiography,
+    kGrNews,
+    kGrSports,
+    kGrMusic,
+    kGrDocumentary,
+    kGrReligion,
+    kGrCulture,
+    kGrSpecial,
+    kGrNumRegexes
+};
+
+enum GreekCategoryField
+{
+    kDescription = 0x1,
+    kTitle       = 0x2,
+};
+
+class GreekCategoryRule
+{
+  public:
+    const char *m_category;
+    int         m_fields;      // GreekCategoryField, match in any of them
+    int         m_regex;
+    int         m_alsoRegex;   // must match the description as well
+};
+
+} // namespace
+
+/**
+ *  \brief Returns the Greek category keyword expressions.
+ *
+ *  Unlike QRegExp a QRegularExpression can be matched from several threads
+ *  at once, so they are compiled once per process and JIT optimized up
+ *  front rather than once per EITFixUp on first use.
+ */
+static const QVector<QRegularExpression> &greek_category_regexes(void)
+{
+    static const QVector<QRegularExpression> s_regexes = []()
+    {
+        QVector<QRegularExpression> regexes(kGrNumRegexes);
+        const QPair<int,const char*> patterns[] =
+        {
+            { kGrComedy,
+              "(?:\\W)?(κωμικ[ηήοό]|χιουμοριστικ[ηήοό]|κωμωδ[ιί]α)(?:\\W)(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?" },
+            { kGrTeleMag,
+              "(?:\\W)?(ενημερωτικ[ηή]|ψυχαγωγικ[ηή]|τηλεπεριοδικ[οό]|μαγκαζ[ιί]νο)(?:\\W)?(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?" },
+            { kGrNature,
+              "(?:\\W)?(φ[υύ]ση|περιβ[αά]λλο|κατασκευ|επιστ[ηή]μ(?!ονικ[ηή]ς φαντασ[ιί]ας))(?:\\W)?" },
+            { kGrHealth,
+              "(?:\\W)?(υγε[ιί]α|υγειιν|ιατρικ|διατροφ)(?:\\W)?" },
+            { kGrReality,
+              "(?:\\W)?(ρι[αά]λιτι|reality)(?:\\W)?" },
+            { kGrDrama,
+              "(?:\\W)?(κοινωνικ[ηήό]|δραματικ[ηή]|δρ[αά]μα)(?:\\W)(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?" },
+            { kGrChildren,
+              "(?:\\W)?(παιδικ[ηήοό]|κινο[υύ]μ[εέ]ν(ων|α)\\sσχ[εέ]δ[ιί](ων|α))(?:\\W)(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?" },
+            { kGrSciFi,
+              "(?:\\W)?(επιστ(.|ημονικ[ηή]ς)\\s?φαντασ[ιί]ας)(?:\\W)?" },
+            { kGrMystery,
+              "(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?(?:\\W)?(μυστηρ[ιί]ου)(?:\\W)?" },
+            { kGrFantasy,
+              "(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?(?:\\W)?(φαντασ[ιί]ας)(?:\\W)?" },
+            { kGrHistory,
+              "(?:\\W)?(ιστορικ[ηήοό])(?:\\W)?(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?" },
+            { kGrTeleShop,
+              "(?:\\W)?(οδηγ[οό][σς]?\\sαγορ[ωώ]ν|τηλεπ[ωώ]λ[ηή]σ|τηλεαγορ|τηλεμ[αά]ρκετ|telemarket)(?:\\W)?(?:(?:εκπομπ[ηή]|σειρ[αά]|ταιν[ιί]α)\\W)?" },
+            { kGrFood,
+              "(?:\\W)?(?:εκπομπ[ηή]\\W)?(Γαστρονομ[ιί]α[σς]?|μαγειρικ[ηή][σς]?|chef|συνταγ[εέηή]|διατροφ|wine|μ[αά]γειρα[σς]?)(?:\\W)?" },
+            { kGrGameShow,
+              "(?:\\W)?(τηλεπαιχν[ιί]δι|quiz)(?:\\W)?" },
+            { kGrBiography,
+              "(?:\\W)?(βιογραφ[ιί]α|βιογραφικ[οό][σς]?)(?:\\W)?" },
+            { kGrNews,
+              "(?:\\W)?(δελτ[ιί]ο\\W?|ειδ[ηή]σε(ι[σς]|ων))(?:\\W)?" },
+            { kGrSports,
+              "(?:\\W)?(champion|αθλητικ[αάοόηή]|πρωτ[αά]θλημα|ποδ[οό]σφαιρο(ου)?|κολ[υύ]μβηση|πατιν[αά]ζ|formula|μπ[αά]σκετ|β[οό]λε[ιϊ])(?:\\W)?" },
+            { kGrMusic,
+              "(?:\\W)?(μουσικ[οόηή]|eurovision|τραγο[υύ]δι)(?:\\W)?" },
+            { kGrDocumentary,
+              "(?:\\W)?(ντοκ[ιυ]μαντ[εέ]ρ)(?:\\W)?" },
+            { kGrReligion,
+              "(?:\\W)?(θρησκε[ιί]α|θρησκευτικ|να[οό][σς]?|θε[ιί]α λειτουργ[ιί]α)(?:\\W)?" },
+            { kGrCulture,
+              "(?:\\W)?(τ[εέ]χν(η|ε[σς])|πολιτισμ)(?:\\W)?" },
+            { kGrSpecial,
+              "(?:\\W)?(αφι[εέ]ρωμα)(?:\\W)?" },
+        };
+        for (const auto & pattern : patterns)
+        {
+            QRegularExpression &regex = regexes[pattern.first];
+            // QRegExp's \w, \W and \b are Unicode aware
+            regex = QRegularExpression(QString::fromUtf8(pattern.second),
+                QRegularExpression::CaseInsensitiveOption |
+                QRegularExpression::UseUnicodePropertiesOption);
+            regex.optimize();
+        }
+        return regexes;
+    }();
+    return s_regexes;
+}
 
+void EITFixUp::FixGreekCategories(DBEventEIT &event)
+{
+    // The first rule that matches wins
+    static const GreekCategoryRule kRules[] =
+    {
+        { "Κωμωδία", kDescription, kGrComedy },
+        { "Τηλεπεριοδικό", kDescription, kGrTeleMag },
+        { "Επιστήμη/Φύση", kDescription, kGrNature },
+        { "Υγεία", kDescription, kGrHealth },
+        { "Ριάλιτι", kDescription, kGrReality },
+        { "Κοινωνικό", kDescription, kGrDrama },
+        { "Παιδικό", kDescription, kGrChildren },
+        { "Επιστ.Φαντασίας", kDescription, kGrSciFi },
+        { "Φαντασίας/Μυστηρίου", kDescription, kGrFantasy, kGrMystery },
+        { "Μυστηρίου", kDescription, kGrMystery },
+        { "Φαντασίας", kDescription, kGrFantasy },
+        { "Ιστορικό", kDescription, kGrHistory },
+        { "Τηλεπωλήσεις", kDescription | kTitle, kGrTeleShop },
+        { "Γαστρονομία", kDescription, kGrFood },
+        { "Τηλεπαιχνίδι", kDescription | kTitle, kGrGameShow },
+        { "Βιογραφία", kDescription, kGrBiography },
+        { "Ειδήσεις", kTitle, kGrNews },
+        { "Αθλητικά", kDescription, kGrSports },
+        { "Μουσική", kDescription | kTitle, kGrMusic },
+        { "Ντοκιμαντέρ", kDescription, kGrDocumentary },
+        { "Θρησκεία", kDescription, kGrReligion },
+        { "Τέχνες/Πολιτισμός", kDescription, kGrCulture },
+        { "Αφιέρωμα", kDescription, kGrSpecial },
+    };
+
+    const QVector<QRegularExpression> &regexes = greek_category_regexes();
+
+    for (const auto & rule : kRules)
+    {
+        const QRegularExpression &regex = regexes[rule.m_regex];
+        bool matched =
+            (((rule.m_fields & kDescription) != 0) &&
+             event.m_description.contains(regex)) ||
+            (((rule.m_fields & kTitle) != 0) &&
+             event.m_title.contains(regex));
+
+        if (matched && rule.m_alsoRegex != kGrNone)
+            matched = event.m_description.contains(regexes[rule.m_alsoRegex]);
+
+        if (matched)
+        {
+            event.m_category = QString::fromUtf8(rule.m_category);
+            return;
+        }
+    }
 }
 
 void EITFixUp::FixUnitymedia(DBEventEIT &event) const
@@ -19,9 +19,13 @@ using namespace std;
 #include "programdata.h"
 #include "programinfo.h" // for subtitle types and audio and video properties
 #include "scheduledrecording.h" // for ScheduledRecording
+#include "mythtimer.h"
+#include "mythtimingstats.h"
 #include "compat.h" // for gmtime_r on windows.
 
 const uint EITHelper::kChunkSize = 20;
+const uint EITHelper::kBulkChunkSize = 1000;
+const uint EITHelper::kBulkThreshold = 500;
 EITCache *EITHelper::s_eitCache = new EITCache();
 
 static uint get_chan_id_from_db_atsc(uint sourceid,
@@ -58,6 +62,11 @@ uint EITHelper::GetListSize(void) const
 /** \fn EITHelper::ProcessEvents(void)
  *  \brief Inserts events in EIT list.
  *
+ *  Normally at most kChunkSize events are handled per call. Once more
+ *  than kBulkThreshold are queued, e.g. during the initial scan of a
+ *  satellite, up to kBulkChunkSize are taken at once and written by
+ *  UpdateDBBulk() in a single transaction.
+ *
  *  \return Returns number of events inserted into DB.
  */
 uint EITHelper::ProcessEvents(void)
@@ -68,40 +77,194 @@ uint EITHelper::ProcessEvents(void)
     if (m_dbEvents.empty())
         return 0;
 
+    bool bulk = m_dbEvents.size() >= kBulkThreshold;
+    uint chunk = bulk ? kBulkChunkSize : kChunkSize;
+
+    QList<DBEventEIT*> events;
+    for (uint i = 0; (i < chunk) && (!m_dbEvents.empty()); i++)
+        events.push_back(m_dbEvents.dequeue());
+    m_eitListLock.unlock();
+
+    MythTimer t(MythTimer::kStartRunning);
+
+    m_eitFixup->Fix(events);
+
     MSqlQuery query(MSqlQuery::InitCon());
-    for (uint i = 0; (i < kChunkSize) && (!m_dbEvents.empty()); i++)
+    if (bulk)
+    {
+        insertCount = UpdateDBBulk(query, events);
+    }
+    else
     {
-        DBEventEIT *event = m_dbEvents.dequeue();
-        m_eitListLock.unlock();
+        for (auto *event : events)
+            insertCount += event->UpdateDB(query, 1000);
+    }
 
-        m_eitFixup->Fix(*event);
+    uint64_t usecs = t.nsecsElapsed() / 1000;
+    MythTimingStats::Get("eit")->Record(
+        "ProcessEvents", usecs, events.size(), bulk ? "bulk" : "single");
 
-        insertCount += event->UpdateDB(query, 1000);
-        m_maxStarttime = max (m_maxStarttime, event->m_starttime);
+    m_eitListLock.lock();
 
+    for (auto *event : events)
+    {
+        m_maxStarttime = max (m_maxStarttime, event->m_starttime);
         delete event;
-        m_eitListLock.lock();
     }
 
     if (!insertCount)
         return 0;
 
+    double rate = events.size() * 1000000.0 / max(usecs, (uint64_t)1);
+
     if (!m_incompleteEvents.empty())
     {
         LOG(VB_EIT, LOG_INFO,
-            LOC + QString("Added %1 events -- complete: %2 incomplete: %3")
-                .arg(insertCount).arg(m_dbEvents.size())
-                .arg(m_incompleteEvents.size()));
+            LOC + QString("Added %1 events (%2 events/s) -- "
+                          "complete: %3 incomplete: %4")
+                .arg(insertCount).arg(rate, 0, 'f', 0)
+                .arg(m_dbEvents.size()).arg(m_incompleteEvents.size()));
     }
     else
     {
         LOG(VB_EIT, LOG_INFO,
-            LOC + QString("Added %1 events").arg(insertCount));
+            LOC + QString("Added %1 events (%2 events/s) -- queued: %3")
+                .arg(insertCount).arg(rate, 0, 'f', 0)
+                .arg(m_dbEvents.size()));
     }
 
     return insertCount;
 }
 
+bool EITHelper::HasBacklog(void) const
+{
+    QMutexLocker locker(&m_eitListLock);
+    return m_dbEvents.size() >= kBulkThreshold;
+}
+
+// Mirrors the overlap test in DBEvent::GetOverlappingPrograms()
+static inline bool overlaps(qint64 s, qint64 e, qint64 start, qint64 end)
+{
+    return (s >= start && s < end) ||
+           (e >  start && e <= end) ||
+           (s <  start && e > end);
+}
+
+/** \brief Writes a batch of events with as few statements as possible.
+ *
+ *  Events are grouped per channel and the programs already in the DB
+ *  for the time span of each group are fetched with one query. Events
+ *  that overlap neither those programs nor each other would simply be
+ *  inserted by DBEvent::UpdateDB(), so they are inserted with
+ *  multi-row statements instead. Only the rest go through the usual
+ *  matching, which needs the titles of the overlapping programs.
+ */
+uint EITHelper::UpdateDBBulk(MSqlQuery &query,
+                             const QList<DBEventEIT*> &events)
+{
+    QMap<uint, QList<DBEventEIT*> > channels;
+    for (auto *event : events)
+        channels[event->m_chanid].push_back(event);
+
+    qint64 now = MythDate::current().toMSecsSinceEpoch();
+    uint insertCount = 0;
+
+    if (!query.exec("START TRANSACTION"))
+        MythDB::DBError("EITHelper::UpdateDBBulk start", query);
+
+    for (auto it = channels.begin(); it != channels.end(); ++it)
+    {
+        uint chanid = it.key();
+        QList<DBEventEIT*> &list = *it;
+
+        std::stable_sort(list.begin(), list.end(),
+                         [](const DBEventEIT *a, const DBEventEIT *b)
+                         { return a->m_starttime < b->m_starttime; });
+
+        // Times as integers, so the overlap tests below are cheap
+        size_t count = list.size();
+        vector<qint64> starts(count);
+        vector<qint64> ends(count);
+        qint64 maxEnd = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            starts[i] = list[i]->m_starttime.toMSecsSinceEpoch();
+            ends[i]   = list[i]->m_endtime.toMSecsSinceEpoch();
+            maxEnd    = max(maxEnd, ends[i]);
+        }
+
+        vector<pair<qint64,qint64> > existing;
+        query.prepare(
+            "SELECT starttime, endtime "
+            "FROM program "
+            "WHERE chanid    = :CHANID    AND "
+            "      manualid  = 0          AND "
+            "      starttime < :MAXEND    AND "
+            "      endtime  >= :MINSTART");
+        query.bindValue(":CHANID",   chanid);
+        query.bindValue(":MAXEND",   QDateTime::fromMSecsSinceEpoch(maxEnd, Qt::UTC));
+        query.bindValue(":MINSTART", list.front()->m_starttime);
+        if (!query.exec())
+        {
+            MythDB::DBError("EITHelper::UpdateDBBulk overlaps", query);
+            existing.emplace_back(starts.front(), maxEnd); // nothing is clean
+        }
+        while (query.next())
+        {
+            existing.emplace_back(
+                MythDate::as_utc(query.value(0).toDateTime()).toMSecsSinceEpoch(),
+                MythDate::as_utc(query.value(1).toDateTime()).toMSecsSinceEpoch());
+        }
+
+        // Events overlapping each other have to be matched in order
+        vector<bool> clean(count, true);
+        for (size_t i = 0; i < count; i++)
+        {
+            for (size_t j = i + 1; j < count; j++)
+            {
+                if (starts[j] >= ends[i] && starts[j] != starts[i])
+                    break;
+                clean[i] = clean[j] = false;
+            }
+        }
+
+        vector<const DBEvent*> inserts;
+        QList<DBEventEIT*> updates;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (ends[i] < now)
+                continue; // in the past, UpdateDB would skip it too
+
+            if (clean[i])
+            {
+                for (const auto & prog : existing)
+                {
+                    if (overlaps(prog.first, prog.second, starts[i], ends[i]))
+                    {
+                        clean[i] = false;
+                        break;
+                    }
+                }
+            }
+
+            if (clean[i])
+                inserts.push_back(list[i]);
+            else
+                updates.push_back(list[i]);
+        }
+
+        insertCount += DBEvent::BulkInsertDB(query, chanid, inserts);
+
+        for (auto *event : updates)
+            insertCount += event->UpdateDB(query, 1000);
+    }
+
+    if (!query.exec("COMMIT"))
+        MythDB::DBError("EITHelper::UpdateDBBulk commit", query);
+
+    return insertCount;
+}
+
 void EITHelper::SetFixup(uint atsc_major, uint atsc_minor, FixupValue eitfixup)
 {
     QMutexLocker locker(&m_eitListLock);
@@ -10,6 +10,7 @@
 
 // Qt includes
 #include <QDateTime>
+#include <QList>
 #include <QMap>
 #include <QMutex>
 #include <QObject>
@@ -97,6 +98,7 @@ class EITHelper
     virtual ~EITHelper(void);
 
     uint GetListSize(void) const;
+    bool HasBacklog(void) const;
     uint ProcessEvents(void);
 
     uint GetGPSOffset(void) const { return (uint) (0 - m_gpsOffset); }
@@ -138,6 +140,9 @@ class EITHelper
                        const ATSCEvent &event,
                        const QString   &ett);
 
+    static uint UpdateDBBulk(MSqlQuery &query,
+                             const QList<DBEventEIT*> &events);
+
         //QListList_Events  m_eitList;     ///< Event Information Tables List
     mutable QMutex          m_eitListLock; ///< EIT List lock
     mutable ServiceToChanID m_srvToChanid;
@@ -162,6 +167,10 @@ class EITHelper
 
     /// Maximum number of DB inserts per ProcessEvents call.
     static const uint kChunkSize;
+    /// Maximum number of DB inserts per ProcessEvents call with a backlog.
+    static const uint kBulkChunkSize;
+    /// Queue length at which events are written in bulk.
+    static const uint kBulkThreshold;
 };
 
 #endif // EIT_HELPER_H
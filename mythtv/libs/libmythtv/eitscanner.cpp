@@ -160,8 +160,11 @@ void EITScanner::run(void)
 #endif
         }
 
+        // Don't sleep while there is a backlog to write out
+        bool backlog = m_eitHelper->HasBacklog();
+
         m_lock.lock();
-        if ((m_activeScan || m_activeScanStopped) && !m_exitThread)
+        if ((m_activeScan || m_activeScanStopped) && !m_exitThread && !backlog)
             m_exitThreadCond.wait(&m_lock, 400); // sleep up to 400 ms.
 
         if (!m_activeScan && !m_activeScanStopped)
@@ -2,6 +2,10 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#ifdef __linux__
+#include <sys/sysmacros.h>
+#endif
+#include <algorithm>
 #include <iostream>
 #include <cstdlib>
 #include <fcntl.h>
@@ -9,6 +13,7 @@
 using namespace std;
 
 #include <QDateTime>
+#include <QFile>
 #include <QFileInfo>
 #include <QRegExp>
 #include <QEvent>
@@ -32,6 +37,7 @@ using namespace std;
 #include "mythsystemlegacy.h"
 #include "mythlogging.h"
 #include "mythmiscutil.h"
+#include "mythtimingstats.h"
 
 #ifndef O_STREAMING
 #define O_STREAMING 0
@@ -143,6 +149,13 @@ void JobQueue::customEvent(QEvent *e)
                 m_runningJobsLock->unlock();
             }
         }
+        else if (message == "JOBQUEUE_CHANGE")
+        {
+            // A job was queued somewhere, look at it now instead
+            // of at the next JobQueueCheckFrequency poll
+            QMutexLocker locker(&m_queueThreadCondLock);
+            m_queueThreadCond.wakeAll();
+        }
     }
 }
 
@@ -205,6 +218,7 @@ void JobQueue::ProcessQueue(void)
         if (!jobs.empty())
         {
             inTimeWindow = InJobRunWindow();
+            UpdateResourceUsage();
             foreach (auto & job, jobs)
             {
                 int status = job.status;
@@ -427,6 +441,17 @@ void JobQueue::ProcessQueue(void)
                 if (startedJobAlready)
                     continue;
 
+                // Is there room for it on this host right now?
+                QString reason;
+                if ((inTimeWindow) && (!AdmitJob(jobs[x], reason)))
+                {
+                    message = QString("Deferring '%1' job for %2, %3")
+                                      .arg(JobText(jobs[x].type)).arg(logInfo)
+                                      .arg(reason);
+                    LOG(VB_JOBQUEUE, LOG_INFO, LOC + message);
+                    continue;
+                }
+
                 if ((inTimeWindow) &&
                     (hostname.isEmpty()) &&
                     (!ChangeJobHost(jobID, m_hostname)))
@@ -595,6 +620,8 @@ bool JobQueue::QueueJob(int jobType, uint chanid, const QDateTime &recstartts,
         return false;
     }
 
+    gCoreContext->SendMessage("JOBQUEUE_CHANGE");
+
     return true;
 }
 
@@ -1456,6 +1483,194 @@ bool JobQueue::AllowedToRun(const JobQueueEntry& job)
     return gCoreContext->GetBoolSetting(allowSetting, true);
 }
 
+/** \brief Estimated CPU cores and storage bandwidth used by a job.
+ *
+ *  These are rough figures for a typical HD recording, they only need to
+ *  be good enough to keep the budgets in AdmitJob() meaningful.
+ */
+void JobQueue::GetJobCost(int jobType, double &cores, double &ioMBps)
+{
+    if (jobType & JOB_USERJOB)
+    {
+        cores  = 1.0;
+        ioMBps = 4.0;
+        return;
+    }
+
+    switch (jobType)
+    {
+        case JOB_TRANSCODE: cores = 2.0; ioMBps = 8.0; break;
+        case JOB_COMMFLAG:  cores = 1.0; ioMBps = 8.0; break;
+        case JOB_PREVIEW:   cores = 0.5; ioMBps = 1.0; break;
+        default:            cores = 0.0; ioMBps = 0.0; break;
+    }
+}
+
+/** \brief Updates the number of recordings in progress on this host and
+ *         the bandwidth used on the devices holding its storage groups.
+ */
+void JobQueue::UpdateResourceUsage(void)
+{
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT COUNT(*) FROM inuseprograms "
+                  "WHERE hostname = :HOSTNAME "
+                  "  AND recusage IN (:RECORDER, :IMPORTER) "
+                  "  AND lastupdatetime > :CUTOFF;");
+    query.bindValue(":HOSTNAME", m_hostname);
+    query.bindValue(":RECORDER", kRecorderInUseID);
+    query.bindValue(":IMPORTER", kImportRecorderInUseID);
+    query.bindValue(":CUTOFF", MythDate::current().addSecs(-61 * 60));
+    if (query.exec() && query.next())
+        m_activeRecordings = query.value(0).toInt();
+    else
+        MythDB::DBError("JobQueue::UpdateResourceUsage()", query);
+
+#ifdef __linux__
+    QStringList devices;
+    query.prepare("SELECT DISTINCT dirname FROM storagegroup "
+                  "WHERE hostname = :HOSTNAME;");
+    query.bindValue(":HOSTNAME", m_hostname);
+    if (query.exec())
+    {
+        while (query.next())
+        {
+            struct stat st {};
+            QByteArray dir = query.value(0).toString().toLocal8Bit();
+            if (stat(dir.constData(), &st) != 0)
+                continue;
+            QString device = QString("%1:%2")
+                .arg(major(st.st_dev)).arg(minor(st.st_dev));
+            if (!devices.contains(device))
+                devices << device;
+        }
+    }
+
+    // Sectors read and written are the 6th and 10th fields, always 512 bytes
+    uint64_t sectors = 0;
+    QFile diskstats("/proc/diskstats");
+    if (!devices.isEmpty() && diskstats.open(QIODevice::ReadOnly))
+    {
+        foreach (const QByteArray &line, diskstats.readAll().split('\n'))
+        {
+            QList<QByteArray> fields = line.simplified().split(' ');
+            if (fields.size() < 10)
+                continue;
+            if (devices.contains(QString(fields[0] + ':' + fields[1])))
+                sectors += fields[5].toULongLong() + fields[9].toULongLong();
+        }
+    }
+
+    qint64 elapsed = m_storageTimer.restart();
+    if (devices == m_storageDevices && elapsed > 0 &&
+        sectors >= m_storageSectors)
+    {
+        m_storageMBps = (sectors - m_storageSectors) * 512.0 /
+                        (1024.0 * 1024.0) / (elapsed / 1000.0);
+    }
+    else
+    {
+        m_storageMBps = 0.0;
+    }
+    m_storageDevices = devices;
+    m_storageSectors = sectors;
+#endif
+
+    LOG(VB_JOBQUEUE, LOG_DEBUG, LOC +
+        QString("%1 recording(s) in progress, storage groups using %2 MB/s")
+            .arg(m_activeRecordings).arg(m_storageMBps, 0, 'f', 1));
+}
+
+/** \brief Returns true if the job fits in this host's CPU and I/O budgets.
+ *
+ *  The "JobQueueCPUCores" setting limits the estimated cores used by the
+ *  jobs running on this host, and "JobQueueMaxIOMBps" the storage
+ *  bandwidth used by recordings and jobs together, 0 disables either
+ *  limit. The bandwidth is whichever is higher of what was measured on
+ *  the storage group devices and what the recordings in progress and
+ *  the running jobs are expected to use, so a job that was just started
+ *  is counted before it shows up in the measurement.
+ *
+ *  A job that doesn't fit any budget on its own still runs once
+ *  nothing else is using this host.
+ */
+bool JobQueue::AdmitJob(const JobQueueEntry& job, QString &reason)
+{
+    static const double kRecordingMBps = 2.5;
+
+    double coreBudget = gCoreContext->GetFloatSetting("JobQueueCPUCores", 0.0);
+    double ioBudget = gCoreContext->GetFloatSetting("JobQueueMaxIOMBps", 0.0);
+    if (coreBudget <= 0.0 && ioBudget <= 0.0)
+        return true;
+
+    double cores = 0.0;
+    double ioMBps = 0.0;
+    GetJobCost(job.type, cores, ioMBps);
+
+    double usedCores = 0.0;
+    double usedMBps = m_activeRecordings * kRecordingMBps;
+    m_runningJobsLock->lock();
+    foreach (const auto &running, m_runningJobs)
+    {
+        double runningCores = 0.0;
+        double runningMBps = 0.0;
+        GetJobCost(running.type, runningCores, runningMBps);
+        usedCores += runningCores;
+        usedMBps += runningMBps;
+    }
+    bool idle = m_runningJobs.isEmpty();
+    m_runningJobsLock->unlock();
+
+    if (coreBudget > 0.0 && !idle && (usedCores + cores > coreBudget))
+    {
+        reason = QString("%1 of %2 CPU cores are in use")
+            .arg(usedCores).arg(coreBudget);
+        return false;
+    }
+
+    usedMBps = std::max(usedMBps, m_storageMBps);
+    if (ioBudget > 0.0 && (!idle || m_activeRecordings > 0) &&
+        (usedMBps + ioMBps > ioBudget))
+    {
+        reason = QString("%1 of %2 MB/s of storage bandwidth are in use "
+                         "with %3 recording(s) in progress")
+            .arg(usedMBps, 0, 'f', 1).arg(ioBudget)
+            .arg(m_activeRecordings);
+        return false;
+    }
+
+    return true;
+}
+
+/** \brief Runs a job's command like myth_system() and records the CPU
+ *         time and storage I/O it used.
+ */
+uint JobQueue::RunJobCommand(int jobID, const QString &command, uint flags)
+{
+    MythSystemLegacy ms(command, flags | kMSRunShell | kMSAutoCleanup);
+    QElapsedTimer timer;
+    timer.start();
+    ms.Run();
+    uint result = ms.Wait(0);
+
+    m_runningJobsLock->lock();
+    int jobType = m_runningJobs.contains(jobID) ? m_runningJobs[jobID].type
+                                                : JOB_NONE;
+    m_runningJobsLock->unlock();
+
+    uint64_t ioMB = ms.GetIOBytes() / (1024 * 1024);
+    static MythTimingStats *s_stats = MythTimingStats::Get("jobqueue");
+    s_stats->Record(JobText(jobType), timer.nsecsElapsed() / 1000, 0, "run");
+    s_stats->Record(JobText(jobType), ms.GetCPUUsecs(), ioMB, "cpu");
+
+    LOG(VB_JOBQUEUE, LOG_INFO, LOC +
+        QString("Job ID %1 used %2 s of CPU time and %3 MB of storage I/O "
+                "in %4 s")
+            .arg(jobID).arg(ms.GetCPUUsecs() / 1000000.0, 0, 'f', 1)
+            .arg(ioMB).arg(timer.elapsed() / 1000.0, 0, 'f', 1));
+
+    return result;
+}
+
 enum JobCmds JobQueue::GetJobCmd(int jobID)
 {
     MSqlQuery query(MSqlQuery::InitCon());
@@ -1718,6 +1933,14 @@ void JobQueue::ProcessJob(const JobQueueEntry& job)
     }
 
 
+    QDateTime queuedSince = std::max(job.inserttime, job.schedruntime);
+    if (queuedSince.isValid())
+    {
+        static MythTimingStats *s_stats = MythTimingStats::Get("jobqueue");
+        qint64 waitSecs = std::max(queuedSince.secsTo(MythDate::current()), 0LL);
+        s_stats->Record(JobText(job.type), waitSecs * 1000000, 0, "wait");
+    }
+
     m_runningJobsLock->lock();
 
     ChangeJobStatus(jobID, JOB_STARTING);
@@ -1865,6 +2088,10 @@ void JobQueue::RemoveRunningJob(int id)
     }
 
     m_runningJobsLock->unlock();
+
+    // A slot may have opened up for the next job
+    QMutexLocker locker(&m_queueThreadCondLock);
+    m_queueThreadCond.wakeAll();
 }
 
 QString JobQueue::PrettyPrint(off_t bytes)
@@ -2024,7 +2251,7 @@ void JobQueue::DoTranscodeThread(int jobID)
                                            .arg(command));
 
         GetMythDB()->GetDBManager()->CloseDatabases();
-        uint result = myth_system(command);
+        uint result = RunJobCommand(jobID, command);
         int status = GetJobStatus(jobID);
 
         if ((result == GENERIC_EXIT_DAEMONIZING_ERROR) ||
@@ -2199,7 +2426,7 @@ void JobQueue::DoMetadataLookupThread(int jobID)
             .arg(command));
 
     GetMythDB()->GetDBManager()->CloseDatabases();
-    retVal = myth_system(command);
+    retVal = RunJobCommand(jobID, command);
     int priority = LOG_NOTICE;
     QString comment;
 
@@ -2336,7 +2563,7 @@ void JobQueue::DoFlagCommercialsThread(int jobID)
             .arg(command));
 
     GetMythDB()->GetDBManager()->CloseDatabases();
-    breaksFound = myth_system(command, kMSLowExitVal);
+    breaksFound = RunJobCommand(jobID, command, kMSLowExitVal);
     int priority = LOG_NOTICE;
     QString comment;
 
@@ -2454,7 +2681,7 @@ void JobQueue::DoUserJobThread(int jobID)
     LOG(VB_JOBQUEUE, LOG_INFO, LOC + QString("Running command: '%1'")
                                        .arg(command));
     GetMythDB()->GetDBManager()->CloseDatabases();
-    uint result = myth_system(command);
+    uint result = RunJobCommand(jobID, command);
 
     if ((result == GENERIC_EXIT_DAEMONIZING_ERROR) ||
         (result == GENERIC_EXIT_CMD_NOT_FOUND))
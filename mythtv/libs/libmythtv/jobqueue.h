@@ -4,6 +4,8 @@
 #include <sys/types.h>
 
 #include <QWaitCondition>
+#include <QElapsedTimer>
+#include <QStringList>
 #include <QDateTime>
 #include <QRunnable>
 #include <QObject>
@@ -229,6 +231,11 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
 
     bool AllowedToRun(const JobQueueEntry& job);
 
+    void UpdateResourceUsage(void);
+    bool AdmitJob(const JobQueueEntry& job, QString &reason);
+    static void GetJobCost(int jobType, double &cores, double &ioMBps);
+    uint RunJobCommand(int jobID, const QString &command, uint flags = 0);
+
     static bool InJobRunWindow(int orStartsWithinMins = 0);
 
     void StartChildJob(void *(*ChildThreadRoutine)(void *), int jobID);
@@ -264,6 +271,13 @@ class MTV_PUBLIC JobQueue : public QObject, public QRunnable
     QMutex                    *m_runningJobsLock     {nullptr};
     QMap<int, RunningJobInfo>  m_runningJobs;
 
+    // Load on this host, updated by UpdateResourceUsage()
+    int                        m_activeRecordings    {0};
+    double                     m_storageMBps         {0.0};
+    QStringList                m_storageDevices;
+    uint64_t                   m_storageSectors      {0};
+    QElapsedTimer              m_storageTimer;
+
     bool                       m_isMaster;
 
     MThread                   *m_queueThread         {nullptr};
@@ -191,6 +191,7 @@ SOURCES += teletextdecoder.cpp      teletextreader.cpp vbilut.cpp
 
 # MPEG parsing stuff
 HEADERS += mpeg/tspacket.h          mpeg/pespacket.h
+HEADERS += mpeg/mpegcrc.h
 HEADERS += mpeg/mpegtables.h        mpeg/atsctables.h
 HEADERS += mpeg/dvbtables.h         mpeg/premieretables.h
 HEADERS += mpeg/sctetables.h
@@ -209,6 +210,7 @@ HEADERS += mpeg/tablestatus.h
 HEADERS += mpeg/tsstreamdata.h
 
 SOURCES += mpeg/tspacket.cpp        mpeg/pespacket.cpp
+SOURCES += mpeg/mpegcrc.cpp
 SOURCES += mpeg/mpegtables.cpp      mpeg/atsctables.cpp
 SOURCES += mpeg/dvbtables.cpp       mpeg/premieretables.cpp
 SOURCES += mpeg/sctetables.cpp
@@ -0,0 +1,64 @@
+// -*- Mode: c++ -*-
+
+// C++ headers
+#include <array>
+
+// MythTV headers
+#include "mpegcrc.h"
+
+namespace {
+
+class CRCTables
+{
+  public:
+    CRCTables()
+    {
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t crc = i << 24;
+            for (int bit = 0; bit < 8; bit++)
+                crc = (crc << 1) ^ ((crc & 0x80000000) ? 0x04C11DB7 : 0);
+            m_table[0][i] = crc;
+        }
+
+        // m_table[k][i] is the CRC of byte i followed by k zero bytes
+        for (size_t k = 1; k < m_table.size(); k++)
+        {
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t crc = m_table[k - 1][i];
+                m_table[k][i] = (crc << 8) ^ m_table[0][crc >> 24];
+            }
+        }
+    }
+
+    std::array<std::array<uint32_t,256>,8> m_table {};
+};
+
+const CRCTables kCRCTables;
+
+} // namespace
+
+uint32_t mpeg_crc32(const unsigned char *data, size_t length, uint32_t crc)
+{
+    const auto &t = kCRCTables.m_table;
+
+    // The bytes are combined one by one so neither the alignment nor the
+    // byte order of the host matter, compilers turn this into word loads.
+    for (; length >= 8; data += 8, length -= 8)
+    {
+        uint32_t hi = crc ^ ((uint32_t(data[0]) << 24) |
+                             (uint32_t(data[1]) << 16) |
+                             (uint32_t(data[2]) <<  8) |
+                              uint32_t(data[3]));
+        crc = t[7][ hi >> 24        ] ^ t[6][(hi >> 16) & 0xFF] ^
+              t[5][(hi >>  8) & 0xFF] ^ t[4][ hi        & 0xFF] ^
+              t[3][data[4]] ^ t[2][data[5]] ^
+              t[1][data[6]] ^ t[0][data[7]];
+    }
+
+    for (; length; data++, length--)
+        crc = (crc << 8) ^ t[0][(crc >> 24) ^ *data];
+
+    return crc;
+}
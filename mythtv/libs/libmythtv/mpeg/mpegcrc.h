@@ -0,0 +1,26 @@
+// -*- Mode: c++ -*-
+#ifndef MPEG_CRC_H
+#define MPEG_CRC_H
+
+// C++ headers
+#include <cstddef>
+#include <cstdint>
+
+// MythTV headers
+#include "mythtvexp.h"
+
+/** \brief Returns the CRC-32/MPEG-2 of data, as carried at the end of
+ *         PSI/SI sections (ISO/IEC 13818-1 Annex A).
+ *
+ *  This is the MSB first CRC with polynomial 0x04C11DB7, an initial value
+ *  of 0xFFFFFFFF and no final XOR, so running it over a section including
+ *  its CRC_32 field gives 0. Pass the result of a previous call as crc to
+ *  continue over a buffer in pieces.
+ *
+ *  Eight bytes are processed per step using eight 256 entry tables
+ *  ("slicing-by-8"), twice as many per step as av_crc().
+ */
+MTV_PUBLIC uint32_t mpeg_crc32(const unsigned char *data, size_t length,
+                               uint32_t crc = 0xFFFFFFFF);
+
+#endif // MPEG_CRC_H
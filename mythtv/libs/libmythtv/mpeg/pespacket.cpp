@@ -3,13 +3,12 @@
 #include "mythlogging.h"
 #include "pespacket.h"
 #include "mpegtables.h"
+#include "mpegcrc.h"
 
 extern "C" {
 #include "mythconfig.h"
 #include "libavcodec/avcodec.h"
 #include "libavformat/avformat.h"
-#include "libavutil/crc.h"
-#include "libavutil/bswap.h"
 }
 
 #include <vector>
@@ -146,8 +145,7 @@ uint PESPacket::CalcCRC(void) const
 {
     if (Length() < 1)
         return kTheMagicNoCRCCRC;
-    return av_bswap32(av_crc(av_crc_get_table(AV_CRC_32_IEEE), (uint32_t) -1,
-                             m_pesData, Length() - 1));
+    return mpeg_crc32(m_pesData, Length() - 1);
 }
 
 bool PESPacket::VerifyCRC(void) const
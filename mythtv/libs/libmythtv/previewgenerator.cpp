@@ -298,6 +298,7 @@ bool PreviewGenerator::Run(void)
             if (ok)
             {
                 LOG(VB_PLAYBACK, LOG_INFO, LOC + "Preview process ran ok.");
+                StorageGroup::FileAdded(fi.absoluteFilePath());
                 msg = QString("Generated on %1 in %2 seconds, starting at %3")
                     .arg(gCoreContext->GetHostName())
                     .arg(te.elapsed()*0.001)
@@ -616,6 +617,7 @@ bool PreviewGenerator::SavePreview(const QString &filename,
         of.remove();
         if (f.rename(filename))
         {
+            StorageGroup::FileAdded(QFileInfo(filename).absoluteFilePath());
             LOG(VB_PLAYBACK, LOG_INFO, LOC + QString("Saved preview '%0' %1x%2")
                     .arg(filename).arg((int) ppw).arg((int) pph));
             return true;
@@ -37,12 +37,66 @@ static QVariant denullify(const QDateTime &dt)
     return dt.isNull() ? QVariant("0000-00-00 00:00:00") : QVariant(dt);
 }
 
+/// Most rows written by a single multi-row statement.
+static const size_t kBulkInsertRows = 50;
+
+static const QString kGenreRelevance =
+    QStringLiteral("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+
+/** \brief Inserts count rows kBulkInsertRows at a time.
+ *
+ *  row is the VALUES tuple with %1 in place of the placeholder suffix,
+ *  bind(i, suffix) binds the placeholders for row i. When given, the
+ *  indices of the rows whose statement succeeded are added to inserted.
+ *
+ *  \return Number of rows that were part of a successful statement.
+ */
+template <typename Bind>
+static uint bulk_insert(MSqlQuery &query, const char *name,
+                        const QString &prefix, const QString &row,
+                        size_t count, Bind bind,
+                        vector<size_t> *inserted = nullptr)
+{
+    uint total = 0;
+
+    for (size_t first = 0; first < count; first += kBulkInsertRows)
+    {
+        size_t last = min(first + kBulkInsertRows, count);
+
+        QString sql = prefix;
+        for (size_t i = first; i < last; i++)
+        {
+            if (i != first)
+                sql += ",";
+            sql += row.arg(i - first);
+        }
+
+        query.prepare(sql);
+        for (size_t i = first; i < last; i++)
+            bind(i, QString::number(i - first));
+
+        if (!query.exec())
+        {
+            MythDB::DBError(name, query);
+            continue;
+        }
+
+        if (inserted)
+        {
+            for (size_t i = first; i < last; i++)
+                inserted->push_back(i);
+        }
+        total += last - first;
+    }
+
+    return total;
+}
+
 static void add_genres(MSqlQuery &query, const QStringList &genres,
                 uint chanid, const QDateTime &starttime)
 {
-    QString relevance = QStringLiteral("0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ");
     for (auto it = genres.constBegin(); (it != genres.constEnd()) &&
-             ((it - genres.constBegin()) < relevance.size()); ++it)
+             ((it - genres.constBegin()) < kGenreRelevance.size()); ++it)
     {
         query.prepare(
            "INSERT INTO programgenres "
@@ -51,7 +105,7 @@ static void add_genres(MSqlQuery &query, const QStringList &genres,
         query.bindValue(":CHANID",    chanid);
         query.bindValue(":START",     starttime);
         query.bindValue(":genre",     *it);
-        query.bindValue(":relevance", relevance.at(it - genres.constBegin()));
+        query.bindValue(":relevance", kGenreRelevance.at(it - genres.constBegin()));
 
         if (!query.exec())
             MythDB::DBError("programgenres insert", query);
@@ -1080,37 +1134,7 @@ uint DBEvent::InsertDB(MSqlQuery &query, uint chanid) const
         " :SEASON,        :EPISODE,       :TOTALEPISODES, "
         " :INETREF ) ");
 
-    QString cattype = myth_category_type_to_string(m_categoryType);
-    QString empty("");
-    query.bindValue(":CHANID",      chanid);
-    query.bindValue(":TITLE",       denullify(m_title));
-    query.bindValue(":SUBTITLE",    denullify(m_subtitle));
-    query.bindValue(":DESCRIPTION", denullify(m_description));
-    query.bindValue(":CATEGORY",    denullify(m_category));
-    query.bindValue(":CATTYPE",     cattype);
-    query.bindValue(":STARTTIME",   m_starttime);
-    query.bindValue(":ENDTIME",     m_endtime);
-    query.bindValue(":CC",          (m_subtitleType & SUB_HARDHEAR) != 0);
-    query.bindValue(":STEREO",      (m_audioProps   & AUD_STEREO) != 0);
-    query.bindValue(":HDTV",        (m_videoProps   & VID_HDTV) != 0);
-    query.bindValue(":HASSUBTITLES",(m_subtitleType & SUB_NORMAL) != 0);
-    query.bindValue(":SUBTYPES",    m_subtitleType);
-    query.bindValue(":AUDIOPROP",   m_audioProps);
-    query.bindValue(":VIDEOPROP",   m_videoProps);
-    query.bindValue(":STARS",       m_stars);
-    query.bindValue(":PARTNUMBER",  m_partnumber);
-    query.bindValue(":PARTTOTAL",   m_parttotal);
-    query.bindValue(":SYNDICATENO", denullify(m_syndicatedepisodenumber));
-    query.bindValue(":AIRDATE",     m_airdate ? QString::number(m_airdate) : "0000");
-    query.bindValue(":ORIGAIRDATE", m_originalairdate);
-    query.bindValue(":LSOURCE",     m_listingsource);
-    query.bindValue(":SERIESID",    denullify(m_seriesId));
-    query.bindValue(":PROGRAMID",   denullify(m_programId));
-    query.bindValue(":PREVSHOWN",   m_previouslyshown);
-    query.bindValue(":SEASON",      m_season);
-    query.bindValue(":EPISODE",     m_episode);
-    query.bindValue(":TOTALEPISODES", m_totalepisodes);
-    query.bindValue(":INETREF",     m_inetref);
+    BindInsertValues(query, chanid, QString());
 
     if (!query.exec())
     {
@@ -1118,6 +1142,51 @@ uint DBEvent::InsertDB(MSqlQuery &query, uint chanid) const
         return 0;
     }
 
+    InsertRelatedDB(query, chanid);
+
+    return 1;
+}
+
+/// Binds the values for the program table insert, with suffix appended
+/// to each placeholder name so several rows can share one statement.
+void DBEvent::BindInsertValues(
+    MSqlQuery &query, uint chanid, const QString &suffix) const
+{
+    QString cattype = myth_category_type_to_string(m_categoryType);
+    query.bindValue(":CHANID"      + suffix, chanid);
+    query.bindValue(":TITLE"       + suffix, denullify(m_title));
+    query.bindValue(":SUBTITLE"    + suffix, denullify(m_subtitle));
+    query.bindValue(":DESCRIPTION" + suffix, denullify(m_description));
+    query.bindValue(":CATEGORY"    + suffix, denullify(m_category));
+    query.bindValue(":CATTYPE"     + suffix, cattype);
+    query.bindValue(":STARTTIME"   + suffix, m_starttime);
+    query.bindValue(":ENDTIME"     + suffix, m_endtime);
+    query.bindValue(":CC"          + suffix, (m_subtitleType & SUB_HARDHEAR) != 0);
+    query.bindValue(":STEREO"      + suffix, (m_audioProps   & AUD_STEREO) != 0);
+    query.bindValue(":HDTV"        + suffix, (m_videoProps   & VID_HDTV) != 0);
+    query.bindValue(":HASSUBTITLES"+ suffix, (m_subtitleType & SUB_NORMAL) != 0);
+    query.bindValue(":SUBTYPES"    + suffix, m_subtitleType);
+    query.bindValue(":AUDIOPROP"   + suffix, m_audioProps);
+    query.bindValue(":VIDEOPROP"   + suffix, m_videoProps);
+    query.bindValue(":STARS"       + suffix, m_stars);
+    query.bindValue(":PARTNUMBER"  + suffix, m_partnumber);
+    query.bindValue(":PARTTOTAL"   + suffix, m_parttotal);
+    query.bindValue(":SYNDICATENO" + suffix, denullify(m_syndicatedepisodenumber));
+    query.bindValue(":AIRDATE"     + suffix, m_airdate ? QString::number(m_airdate) : "0000");
+    query.bindValue(":ORIGAIRDATE" + suffix, m_originalairdate);
+    query.bindValue(":LSOURCE"     + suffix, m_listingsource);
+    query.bindValue(":SERIESID"    + suffix, denullify(m_seriesId));
+    query.bindValue(":PROGRAMID"   + suffix, denullify(m_programId));
+    query.bindValue(":PREVSHOWN"   + suffix, m_previouslyshown);
+    query.bindValue(":SEASON"      + suffix, m_season);
+    query.bindValue(":EPISODE"     + suffix, m_episode);
+    query.bindValue(":TOTALEPISODES" + suffix, m_totalepisodes);
+    query.bindValue(":INETREF"     + suffix, m_inetref);
+}
+
+/// Inserts the ratings, credits and genres that belong to this program.
+void DBEvent::InsertRelatedDB(MSqlQuery &query, uint chanid) const
+{
     foreach (const auto & rating, m_ratings)
     {
         query.prepare(
@@ -1140,8 +1209,187 @@ uint DBEvent::InsertDB(MSqlQuery &query, uint chanid) const
     }
 
     add_genres(query, m_genres, chanid, m_starttime);
+}
 
-    return 1;
+/** \brief Inserts events that are known not to overlap anything already in
+ *         the program table, or each other, using multi-row statements.
+ *
+ *  This is equivalent to calling UpdateDB() on each of them, which
+ *  would find no overlapping programs and call InsertDB(), but with
+ *  one statement per kBulkInsertRows programs. Subclasses that override
+ *  InsertDB() must not be passed in.
+ *
+ *  \return Number of events inserted.
+ */
+uint DBEvent::BulkInsertDB(MSqlQuery &query, uint chanid,
+                           const vector<const DBEvent*> &events)
+{
+    static const QString kColumns =
+        "REPLACE INTO program ("
+        "  chanid,         title,          subtitle,        description, "
+        "  category,       category_type, "
+        "  starttime,      endtime, "
+        "  closecaptioned, stereo,         hdtv,            subtitled, "
+        "  subtitletypes,  audioprop,      videoprop, "
+        "  stars,          partnumber,     parttotal, "
+        "  syndicatedepisodenumber, "
+        "  airdate,        originalairdate,listingsource, "
+        "  seriesid,       programid,      previouslyshown, "
+        "  season,         episode,        totalepisodes, "
+        "  inetref ) "
+        "VALUES ";
+    static const QString kRow =
+        "(:CHANID%1, :TITLE%1, :SUBTITLE%1, :DESCRIPTION%1, "
+        " :CATEGORY%1, :CATTYPE%1, :STARTTIME%1, :ENDTIME%1, "
+        " :CC%1, :STEREO%1, :HDTV%1, :HASSUBTITLES%1, "
+        " :SUBTYPES%1, :AUDIOPROP%1, :VIDEOPROP%1, "
+        " :STARS%1, :PARTNUMBER%1, :PARTTOTAL%1, :SYNDICATENO%1, "
+        " :AIRDATE%1, :ORIGAIRDATE%1, :LSOURCE%1, "
+        " :SERIESID%1, :PROGRAMID%1, :PREVSHOWN%1, "
+        " :SEASON%1, :EPISODE%1, :TOTALEPISODES%1, :INETREF%1)";
+
+    vector<size_t> inserted;
+    uint count = bulk_insert(
+        query, "BulkInsertDB", kColumns, kRow, events.size(),
+        [&](size_t i, const QString &suffix)
+            { events[i]->BindInsertValues(query, chanid, suffix); },
+        &inserted);
+
+    vector<const DBEvent*> related;
+    related.reserve(inserted.size());
+    for (size_t i : inserted)
+        related.push_back(events[i]);
+    BulkInsertRelatedDB(query, chanid, related);
+
+    return count;
+}
+
+/** \brief Inserts the ratings, credits and genres of events with
+ *         multi-row statements, see InsertRelatedDB().
+ *
+ *  People are added and looked up by name in batches. A credit whose
+ *  name comes back differently from the people table (the name column
+ *  has a case insensitive collation) is inserted on its own instead.
+ */
+void DBEvent::BulkInsertRelatedDB(MSqlQuery &query, uint chanid,
+                                  const vector<const DBEvent*> &events)
+{
+    vector<pair<const DBEvent*, const EventRating*> > ratings;
+    vector<pair<const DBEvent*, const DBPerson*> >    credits;
+    vector<pair<const DBEvent*, int> >                genres;
+    QStringList                                       names;
+    QSet<QString>                                     seen;
+
+    for (const auto *event : events)
+    {
+        for (const auto & rating : event->m_ratings)
+            ratings.emplace_back(event, &rating);
+
+        if (event->m_credits)
+        {
+            for (const auto & credit : *event->m_credits)
+            {
+                credits.emplace_back(event, &credit);
+                if (!seen.contains(credit.GetName()))
+                {
+                    seen.insert(credit.GetName());
+                    names.push_back(credit.GetName());
+                }
+            }
+        }
+
+        int ngenres = min(event->m_genres.size(), kGenreRelevance.size());
+        for (int i = 0; i < ngenres; i++)
+            genres.emplace_back(event, i);
+    }
+
+    bulk_insert(
+        query, "programrating insert",
+        "INSERT IGNORE INTO programrating "
+        "       ( chanid, starttime, `system`, rating) VALUES ",
+        "(:CHANID%1, :START%1, :SYS%1, :RATING%1)", ratings.size(),
+        [&](size_t i, const QString &suffix)
+        {
+            query.bindValue(":CHANID" + suffix, chanid);
+            query.bindValue(":START"  + suffix, ratings[i].first->m_starttime);
+            query.bindValue(":SYS"    + suffix, ratings[i].second->m_system);
+            query.bindValue(":RATING" + suffix, ratings[i].second->m_rating);
+        });
+
+    bulk_insert(
+        query, "insert_person",
+        "INSERT IGNORE INTO people (name) VALUES ", "(:NAME%1)",
+        names.size(),
+        [&](size_t i, const QString &suffix)
+            { query.bindValue(":NAME" + suffix, names[i]); });
+
+    QHash<QString, uint> personids;
+    for (int first = 0; first < names.size(); first += kBulkInsertRows)
+    {
+        int last = min<int>(first + kBulkInsertRows, names.size());
+
+        QStringList placeholders;
+        for (int i = first; i < last; i++)
+            placeholders.push_back(QString(":NAME%1").arg(i - first));
+
+        query.prepare(
+            "SELECT person, name "
+            "FROM people "
+            "WHERE name IN (" + placeholders.join(",") + ")");
+        for (int i = first; i < last; i++)
+            query.bindValue(placeholders[i - first], names[i]);
+
+        if (!query.exec())
+        {
+            MythDB::DBError("get_person", query);
+            continue;
+        }
+
+        while (query.next())
+            personids[query.value(1).toString()] = query.value(0).toUInt();
+    }
+
+    vector<pair<const DBEvent*, const DBPerson*> > known;
+    known.reserve(credits.size());
+    for (const auto & credit : credits)
+    {
+        if (personids.contains(credit.second->GetName()))
+            known.push_back(credit);
+        else
+            credit.second->InsertDB(query, chanid, credit.first->m_starttime);
+    }
+
+    bulk_insert(
+        query, "insert_credits",
+        "REPLACE INTO credits "
+        "       ( person,  chanid,  starttime,  role) VALUES ",
+        "(:PERSON%1, :CHANID%1, :STARTTIME%1, :ROLE%1)", known.size(),
+        [&](size_t i, const QString &suffix)
+        {
+            const DBPerson *person = known[i].second;
+            query.bindValue(":PERSON"    + suffix,
+                            personids.value(person->GetName()));
+            query.bindValue(":CHANID"    + suffix, chanid);
+            query.bindValue(":STARTTIME" + suffix, known[i].first->m_starttime);
+            query.bindValue(":ROLE"      + suffix, person->GetRole());
+        });
+
+    // A genre listed twice for one program would fail the whole
+    // statement, so duplicates are ignored rather than reported.
+    bulk_insert(
+        query, "programgenres insert",
+        "INSERT IGNORE INTO programgenres "
+        "       ( chanid,  starttime, genre,  relevance) VALUES ",
+        "(:CHANID%1, :START%1, :GENRE%1, :RELEVANCE%1)", genres.size(),
+        [&](size_t i, const QString &suffix)
+        {
+            const DBEvent *event = genres[i].first;
+            int            index = genres[i].second;
+            query.bindValue(":CHANID"    + suffix, chanid);
+            query.bindValue(":START"     + suffix, event->m_starttime);
+            query.bindValue(":GENRE"     + suffix, event->m_genres[index]);
+            query.bindValue(":RELEVANCE" + suffix, kGenreRelevance.at(index));
+        });
 }
 
 ProgInfo::ProgInfo(const ProgInfo &other) :
@@ -1241,44 +1489,7 @@ uint ProgInfo::InsertDB(MSqlQuery &query, uint chanid) const
         " :SEASON,        :EPISODE,       :TOTALEPISODES, "
         " :INETREF )");
 
-    QString cattype = myth_category_type_to_string(m_categoryType);
-
-    query.bindValue(":CHANID",      chanid);
-    query.bindValue(":TITLE",       denullify(m_title));
-    query.bindValue(":SUBTITLE",    denullify(m_subtitle));
-    query.bindValue(":DESCRIPTION", denullify(m_description));
-    query.bindValue(":CATEGORY",    denullify(m_category));
-    query.bindValue(":CATTYPE",     cattype);
-    query.bindValue(":STARTTIME",   m_starttime);
-    query.bindValue(":ENDTIME",     denullify(m_endtime));
-    query.bindValue(":CC",
-                    (m_subtitleType & SUB_HARDHEAR) != 0);
-    query.bindValue(":STEREO",
-                    (m_audioProps   & AUD_STEREO) != 0);
-    query.bindValue(":HDTV",
-                    (m_videoProps   & VID_HDTV) != 0);
-    query.bindValue(":HASSUBTITLES",
-                    (m_subtitleType & SUB_NORMAL) != 0);
-    query.bindValue(":SUBTYPES",    m_subtitleType);
-    query.bindValue(":AUDIOPROP",   m_audioProps);
-    query.bindValue(":VIDEOPROP",   m_videoProps);
-    query.bindValue(":PARTNUMBER",  m_partnumber);
-    query.bindValue(":PARTTOTAL",   m_parttotal);
-    query.bindValue(":SYNDICATENO", denullify(m_syndicatedepisodenumber));
-    query.bindValue(":AIRDATE",     m_airdate ? QString::number(m_airdate):"0000");
-    query.bindValue(":ORIGAIRDATE", m_originalairdate);
-    query.bindValue(":LSOURCE",     m_listingsource);
-    query.bindValue(":SERIESID",    denullify(m_seriesId));
-    query.bindValue(":PROGRAMID",   denullify(m_programId));
-    query.bindValue(":PREVSHOWN",   m_previouslyshown);
-    query.bindValue(":STARS",       m_stars);
-    query.bindValue(":SHOWTYPE",    m_showtype);
-    query.bindValue(":TITLEPRON",   m_title_pronounce);
-    query.bindValue(":COLORCODE",   m_colorcode);
-    query.bindValue(":SEASON",      m_season);
-    query.bindValue(":EPISODE",     m_episode);
-    query.bindValue(":TOTALEPISODES", m_totalepisodes);
-    query.bindValue(":INETREF",     m_inetref);
+    BindProgInfoValues(query, chanid, QString());
 
     if (!query.exec())
     {
@@ -1286,30 +1497,120 @@ uint ProgInfo::InsertDB(MSqlQuery &query, uint chanid) const
         return 0;
     }
 
-    for (const auto & rating : m_ratings)
-    {
-        query.prepare(
-            "INSERT IGNORE INTO programrating "
-            "       ( chanid, starttime, `system`, rating) "
-            "VALUES (:CHANID, :START,    :SYS,  :RATING)");
-        query.bindValue(":CHANID", chanid);
-        query.bindValue(":START",  m_starttime);
-        query.bindValue(":SYS",    rating.m_system);
-        query.bindValue(":RATING", rating.m_rating);
+    InsertRelatedDB(query, chanid);
 
-        if (!query.exec())
-            MythDB::DBError("programrating insert", query);
-    }
+    return 1;
+}
 
-    if (m_credits)
+/// Binds the values for ProgInfo::InsertDB(), with suffix appended to
+/// each placeholder name so several rows can share one statement.
+void ProgInfo::BindProgInfoValues(
+    MSqlQuery &query, uint chanid, const QString &suffix) const
+{
+    QString cattype = myth_category_type_to_string(m_categoryType);
+
+    query.bindValue(":CHANID"      + suffix, chanid);
+    query.bindValue(":TITLE"       + suffix, denullify(m_title));
+    query.bindValue(":SUBTITLE"    + suffix, denullify(m_subtitle));
+    query.bindValue(":DESCRIPTION" + suffix, denullify(m_description));
+    query.bindValue(":CATEGORY"    + suffix, denullify(m_category));
+    query.bindValue(":CATTYPE"     + suffix, cattype);
+    query.bindValue(":STARTTIME"   + suffix, m_starttime);
+    query.bindValue(":ENDTIME"     + suffix, denullify(m_endtime));
+    query.bindValue(":CC"          + suffix,
+                    (m_subtitleType & SUB_HARDHEAR) != 0);
+    query.bindValue(":STEREO"      + suffix,
+                    (m_audioProps   & AUD_STEREO) != 0);
+    query.bindValue(":HDTV"        + suffix,
+                    (m_videoProps   & VID_HDTV) != 0);
+    query.bindValue(":HASSUBTITLES"+ suffix,
+                    (m_subtitleType & SUB_NORMAL) != 0);
+    query.bindValue(":SUBTYPES"    + suffix, m_subtitleType);
+    query.bindValue(":AUDIOPROP"   + suffix, m_audioProps);
+    query.bindValue(":VIDEOPROP"   + suffix, m_videoProps);
+    query.bindValue(":PARTNUMBER"  + suffix, m_partnumber);
+    query.bindValue(":PARTTOTAL"   + suffix, m_parttotal);
+    query.bindValue(":SYNDICATENO" + suffix, denullify(m_syndicatedepisodenumber));
+    query.bindValue(":AIRDATE"     + suffix, m_airdate ? QString::number(m_airdate):"0000");
+    query.bindValue(":ORIGAIRDATE" + suffix, m_originalairdate);
+    query.bindValue(":LSOURCE"     + suffix, m_listingsource);
+    query.bindValue(":SERIESID"    + suffix, denullify(m_seriesId));
+    query.bindValue(":PROGRAMID"   + suffix, denullify(m_programId));
+    query.bindValue(":PREVSHOWN"   + suffix, m_previouslyshown);
+    query.bindValue(":STARS"       + suffix, m_stars);
+    query.bindValue(":SHOWTYPE"    + suffix, m_showtype);
+    query.bindValue(":TITLEPRON"   + suffix, m_title_pronounce);
+    query.bindValue(":COLORCODE"   + suffix, m_colorcode);
+    query.bindValue(":SEASON"      + suffix, m_season);
+    query.bindValue(":EPISODE"     + suffix, m_episode);
+    query.bindValue(":TOTALEPISODES" + suffix, m_totalepisodes);
+    query.bindValue(":INETREF"     + suffix, m_inetref);
+}
+
+/** \brief Insert programs into the "program" database using multi-row
+ *         statements.
+ *
+ *  Like DBEvent::BulkInsertDB() the programs must not overlap each
+ *  other or anything already in the database for chanid.
+ *
+ *  \return Number of programs inserted.
+ */
+uint ProgInfo::BulkInsertDB(MSqlQuery &query, uint chanid,
+                            const vector<const ProgInfo*> &programs)
+{
+    static const QString kColumns =
+        "REPLACE INTO program ("
+        "  chanid,         title,          subtitle,        description, "
+        "  category,       category_type,  "
+        "  starttime,      endtime, "
+        "  closecaptioned, stereo,         hdtv,            subtitled, "
+        "  subtitletypes,  audioprop,      videoprop, "
+        "  partnumber,     parttotal, "
+        "  syndicatedepisodenumber, "
+        "  airdate,        originalairdate,listingsource, "
+        "  seriesid,       programid,      previouslyshown, "
+        "  stars,          showtype,       title_pronounce, colorcode, "
+        "  season,         episode,        totalepisodes, "
+        "  inetref ) "
+        "VALUES ";
+    static const QString kRow =
+        "(:CHANID%1, :TITLE%1, :SUBTITLE%1, :DESCRIPTION%1, "
+        " :CATEGORY%1, :CATTYPE%1, :STARTTIME%1, :ENDTIME%1, "
+        " :CC%1, :STEREO%1, :HDTV%1, :HASSUBTITLES%1, "
+        " :SUBTYPES%1, :AUDIOPROP%1, :VIDEOPROP%1, "
+        " :PARTNUMBER%1, :PARTTOTAL%1, :SYNDICATENO%1, "
+        " :AIRDATE%1, :ORIGAIRDATE%1, :LSOURCE%1, "
+        " :SERIESID%1, :PROGRAMID%1, :PREVSHOWN%1, "
+        " :STARS%1, :SHOWTYPE%1, :TITLEPRON%1, :COLORCODE%1, "
+        " :SEASON%1, :EPISODE%1, :TOTALEPISODES%1, :INETREF%1)";
+
+    if (VERBOSE_LEVEL_CHECK(VB_XMLTV, LOG_INFO))
     {
-        for (auto & credit : *m_credits)
-            credit.InsertDB(query, chanid, m_starttime);
+        for (const auto *pinfo : programs)
+        {
+            LOG(VB_XMLTV, LOG_INFO,
+                QString("Inserting new program    : %1 - %2 %3 %4")
+                    .arg(pinfo->m_starttime.toString(Qt::ISODate))
+                    .arg(pinfo->m_endtime.toString(Qt::ISODate))
+                    .arg(pinfo->m_channel)
+                    .arg(pinfo->m_title));
+        }
     }
 
-    add_genres(query, m_genres, chanid, m_starttime);
+    vector<size_t> inserted;
+    uint count = bulk_insert(
+        query, "program insert", kColumns, kRow, programs.size(),
+        [&](size_t i, const QString &suffix)
+            { programs[i]->BindProgInfoValues(query, chanid, suffix); },
+        &inserted);
 
-    return 1;
+    vector<const DBEvent*> related;
+    related.reserve(inserted.size());
+    for (size_t i : inserted)
+        related.push_back(programs[i]);
+    BulkInsertRelatedDB(query, chanid, related);
+
+    return count;
 }
 
 bool ProgramData::ClearDataByChannel(
@@ -1462,62 +1763,82 @@ void ProgramData::HandlePrograms(
     uint unchanged = 0;
     uint updated = 0;
 
-    MSqlQuery query(MSqlQuery::InitCon());
-
-    QMap<QString, QList<ProgInfo> >::const_iterator mapiter;
-    for (mapiter = proglist.begin(); mapiter != proglist.end(); ++mapiter)
-    {
-        if (mapiter.key().isEmpty())
-            continue;
+    for (auto it = proglist.begin(); it != proglist.end(); ++it)
+        HandleChannelPrograms(sourceid, it.key(), *it, unchanged, updated);
 
-        query.prepare(
-            "SELECT chanid "
-            "FROM channel "
-            "WHERE deleted  IS NULL AND "
-            "      sourceid = :ID AND "
-            "      xmltvid  = :XMLTVID");
-        query.bindValue(":ID",      sourceid);
-        query.bindValue(":XMLTVID", mapiter.key());
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("Updated programs: %1 Unchanged programs: %2")
+                .arg(updated) .arg(unchanged));
+}
 
-        if (!query.exec())
-        {
-            MythDB::DBError("ProgramData::HandlePrograms", query);
-            continue;
-        }
+/**
+ *  \brief Merges the programs of a single xmltv channel into the database.
+ *
+ *  Every channel of the source with the given xmltvid is updated. This
+ *  opens its own database connection so importers may call it for
+ *  different channels from several threads at once.
+ *
+ *  \param sourceid  The data source identifier
+ *  \param xmltvid   The xmltv channel identifier
+ *  \param list      The programs of the channel, sorted in place
+ *  \param unchanged Incremented by the number of unchanged programs
+ *  \param updated   Incremented by the number of updated programs
+ */
+void ProgramData::HandleChannelPrograms(
+    uint sourceid, const QString &xmltvid, QList<ProgInfo> &list,
+    uint &unchanged, uint &updated)
+{
+    if (xmltvid.isEmpty() || list.isEmpty())
+        return;
 
-        vector<uint> chanids;
-        while (query.next())
-            chanids.push_back(query.value(0).toUInt());
+    MSqlQuery query(MSqlQuery::InitCon());
 
-        if (chanids.empty())
-        {
-            LOG(VB_GENERAL, LOG_NOTICE,
-                QString("Unknown xmltv channel identifier: %1"
-                        " - Skipping channel.").arg(mapiter.key()));
-            continue;
-        }
+    query.prepare(
+        "SELECT chanid "
+        "FROM channel "
+        "WHERE deleted  IS NULL AND "
+        "      sourceid = :ID AND "
+        "      xmltvid  = :XMLTVID");
+    query.bindValue(":ID",      sourceid);
+    query.bindValue(":XMLTVID", xmltvid);
 
-        QList<ProgInfo> &list = proglist[mapiter.key()];
-        QList<ProgInfo*> sortlist;
-        // NOLINTNEXTLINE(modernize-loop-convert)
-        for (auto it = list.begin(); it != list.end(); ++it)
-            sortlist.push_back(&(*it));
+    if (!query.exec())
+    {
+        MythDB::DBError("ProgramData::HandlePrograms", query);
+        return;
+    }
 
-        FixProgramList(sortlist);
+    vector<uint> chanids;
+    while (query.next())
+        chanids.push_back(query.value(0).toUInt());
 
-        for (uint chanid : chanids)
-            HandlePrograms(query, chanid, sortlist, unchanged, updated);
+    if (chanids.empty())
+    {
+        LOG(VB_GENERAL, LOG_NOTICE,
+            QString("Unknown xmltv channel identifier: %1"
+                    " - Skipping channel.").arg(xmltvid));
+        return;
     }
 
-    LOG(VB_GENERAL, LOG_INFO,
-        QString("Updated programs: %1 Unchanged programs: %2")
-                .arg(updated) .arg(unchanged));
+    QList<ProgInfo*> sortlist;
+    // NOLINTNEXTLINE(modernize-loop-convert)
+    for (auto it = list.begin(); it != list.end(); ++it)
+        sortlist.push_back(&(*it));
+
+    FixProgramList(sortlist);
+
+    for (uint chanid : chanids)
+        HandlePrograms(query, chanid, sortlist, unchanged, updated);
 }
 
 /**
  *  \brief Called from HandlePrograms to bulk insert data into the
  *  program database.
  *
+ *  FixProgramList() has removed any overlaps within sortlist, so once the
+ *  existing programs they overlap have been deleted the new programs are
+ *  written with multi-row inserts.
+ *
  *  \param query A mysql query related to all channel ids for
  *               a given source
  *  \param chanid The specific channel id to process
@@ -1531,6 +1852,8 @@ void ProgramData::HandlePrograms(MSqlQuery             &query,
                                  uint &unchanged,
                                  uint &updated)
 {
+    vector<const ProgInfo*> inserts;
+
     foreach (auto pinfo, sortlist)
     {
         if (IsUnchanged(query, chanid, *pinfo))
@@ -1542,8 +1865,10 @@ void ProgramData::HandlePrograms(MSqlQuery             &query,
         if (!DeleteOverlaps(query, chanid, *pinfo))
             continue;
 
-        updated += pinfo->InsertDB(query, chanid);
+        inserts.push_back(pinfo);
     }
+
+    updated += ProgInfo::BulkInsertDB(query, chanid, inserts);
 }
 
 int ProgramData::fix_end_times(void)
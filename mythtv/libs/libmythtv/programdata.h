@@ -46,6 +46,7 @@ class MTV_PUBLIC DBPerson
     DBPerson(const QString &_role, QString _name);
 
     QString GetRole(void) const;
+    QString GetName(void) const { return m_name; }
 
     uint InsertDB(MSqlQuery &query, uint chanid,
                   const QDateTime &starttime) const;
@@ -110,6 +111,8 @@ class MTV_PUBLIC DBEvent
     void AddPerson(const QString &role, const QString &name);
 
     uint UpdateDB(MSqlQuery &query, uint chanid, int match_threshold) const;
+    static uint BulkInsertDB(MSqlQuery &query, uint chanid,
+                             const vector<const DBEvent*> &events);
 
     bool HasCredits(void) const { return m_credits; }
     bool HasTimeConflict(const DBEvent &other) const;
@@ -128,6 +131,11 @@ class MTV_PUBLIC DBEvent
     bool MoveOutOfTheWayDB(
         MSqlQuery &query, uint chanid, const DBEvent &prog) const;
     virtual uint InsertDB(MSqlQuery &query, uint chanid) const;
+    void BindInsertValues(
+        MSqlQuery &query, uint chanid, const QString &suffix) const;
+    void InsertRelatedDB(MSqlQuery &query, uint chanid) const;
+    static void BulkInsertRelatedDB(MSqlQuery &query, uint chanid,
+                                    const vector<const DBEvent*> &events);
     virtual void Squeeze(void);
 
   public:
@@ -218,11 +226,17 @@ class MTV_PUBLIC ProgInfo : public DBEvent
     ProgInfo(const ProgInfo &other);
 
     uint InsertDB(MSqlQuery &query, uint chanid) const override; // DBEvent
+    static uint BulkInsertDB(MSqlQuery &query, uint chanid,
+                             const vector<const ProgInfo*> &programs);
 
     void Squeeze(void) override; // DBEvent
 
     ProgInfo &operator=(const ProgInfo &other);
 
+  private:
+    void BindProgInfoValues(
+        MSqlQuery &query, uint chanid, const QString &suffix) const;
+
   public:
     // extra XMLTV stuff
     QString       m_channel;
@@ -240,6 +254,9 @@ class MTV_PUBLIC ProgramData
   public:
     static void HandlePrograms(uint sourceid,
                                QMap<QString, QList<ProgInfo> > &proglist);
+    static void HandleChannelPrograms(uint sourceid, const QString &xmltvid,
+                                      QList<ProgInfo> &list,
+                                      uint &unchanged, uint &updated);
 
     static int  fix_end_times(void);
     static bool ClearDataByChannel(
@@ -29,6 +29,7 @@ using namespace std;
 #include "cardutil.h"
 #include "tv_rec.h"
 #include "mythdate.h"
+#include "mythmiscutil.h"
 #if CONFIG_LIBMP3LAME
 #include "NuppelVideoRecorder.h"
 #endif
@@ -484,7 +485,15 @@ void RecorderBase::FinishRecording(void)
         SavePositionMap(true, true); // Save Position Map only, not file size
 
         if (m_ringBuffer)
+        {
             m_curRecording->SaveFilesize(m_ringBuffer->GetRealFileSize());
+
+            // Save the hash worked out while writing, so the file doesn't
+            // have to be read back to answer QUERY_FILE_HASH.
+            QString hash = m_ringBuffer->WriterFileHash();
+            if (!hash.isEmpty())
+                SaveFileHash(m_ringBuffer->GetFilename(), hash);
+        }
     }
 
     LOG(VB_GENERAL, LOG_NOTICE, QString("Finished Recording: "
@@ -1829,6 +1829,17 @@ bool RingBuffer::WriterSetBlocking(bool block)
     return false;
 }
 
+/** \brief Calls ThreadedFileWriter::GetFileHash(void)
+ */
+QString RingBuffer::WriterFileHash(void)
+{
+    QReadLocker lock(&m_rwLock);
+
+    if (m_tfw)
+        return m_tfw->GetFileHash();
+    return QString();
+}
+
 /** \brief Tell RingBuffer if this is an old file or not.
  *
  *  Normally the RingBuffer determines that the file is old
@@ -167,6 +167,7 @@ class MTV_PUBLIC RingBuffer : protected MThread
     void Sync(void);
     long long WriterSeek(long long pos, int whence, bool has_lock = false);
     bool WriterSetBlocking(bool lock = true);
+    QString WriterFileHash(void);
 
     long long SetAdjustFilesize(void);
 
@@ -786,6 +786,44 @@ void TestEITFixups::testATV()
     delete event;
 }
 
+void TestEITFixups::testGreekCategories()
+{
+    EITFixUp fixup;
+
+    DBEventEIT *event = SimpleDBEventEIT (EITFixUp::kFixGreekCategories,
+                                         "Τίτλος",
+                                         "",
+                                         "ΚΩΜΙΚΗ σειρά με τον Θανάση.");
+
+    fixup.Fix(*event);
+    PRINT_EVENT(*event);
+    QCOMPARE(event->m_category, QString("Κωμωδία"));
+
+    delete event;
+
+    DBEventEIT *event2 = SimpleDBEventEIT (EITFixUp::kFixGreekCategories,
+                                         "Τίτλος",
+                                         "",
+                                         "Ταινία φαντασίας και μυστηρίου.");
+
+    fixup.Fix(*event2);
+    PRINT_EVENT(*event2);
+    QCOMPARE(event2->m_category, QString("Φαντασίας/Μυστηρίου"));
+
+    delete event2;
+
+    DBEventEIT *event3 = SimpleDBEventEIT (EITFixUp::kFixGreekCategories,
+                                         "Δελτίο ειδήσεων",
+                                         "",
+                                         "Τα νέα της ημέρας.");
+
+    fixup.Fix(*event3);
+    PRINT_EVENT(*event3);
+    QCOMPARE(event3->m_category, QString("Ειδήσεις"));
+
+    delete event3;
+}
+
 void TestEITFixups::test64BitEnum(void)
 {
     QVERIFY(EITFixUp::kFixUnitymedia != EITFixUp::kFixNone);
@@ -822,4 +860,58 @@ void TestEITFixups::test64BitEnum(void)
     QVERIFY(1<<31 & 1ULL<<32);
 }
 
+void TestEITFixups::testBenchmark_data()
+{
+    QTest::addColumn<FixupValue>("fixup");
+    QTest::addColumn<QString>("title");
+    QTest::addColumn<QString>("subtitle");
+    QTest::addColumn<QString>("description");
+
+    QTest::newRow("UK") << (FixupValue)EITFixUp::kFixUK
+        << "Book of the Week" << ""
+        << "Girl in the Dark: Anna Lyndsey's account of finding light in the darkness after illness changed her life. 3/5. A Descent into Darkness: The disquieting persistence of the light.";
+    QTest::newRow("UK+HTML") << (FixupValue)(EITFixUp::kFixUK | EITFixUp::kFixHTML)
+        << "<EM>New: Jericho</EM>" << ""
+        << "Drama set in 1870s Yorkshire. In her desperation to protect her son, Annie unwittingly opens the door for Bamford the railway detective, who has returned to Jericho. [AD,S]";
+    QTest::newRow("Premiere") << (FixupValue)EITFixUp::kFixPremiere
+        << "Titel" << "Subtitle"
+        << "4. Staffel, Folge 16: Viele Mitglieder einer christlichen Gemeinde erkranken nach einem Giftanschlag tödlich. 50 Min. USA 2008. Von Leslie Libman, mit Rob Morrow, David Krumholtz, Judd Hirsch. Ab 12 Jahren";
+    QTest::newRow("P7S1") << (FixupValue)EITFixUp::kFixP7S1
+        << "Titel" << "Folgentitel, Mystery, USA 2011" << "Beschreibung";
+    QTest::newRow("DisneyChannel") << (FixupValue)EITFixUp::kFixDisneyChannel
+        << "Meine Schwester Charlie"
+        << "Das Ablenkungsmanöver Familien-Serie, USA 2011" << "...";
+    QTest::newRow("ATV") << (FixupValue)EITFixUp::kFixATV
+        << "Gilmore Girls" << "Eine Hochzeit und ein Todesfall, Folge 17"
+        << "Lorelai und Rory helfen Luke in seinem Café aus, der mit den Vorbereitungen für das ...";
+    QTest::newRow("Unitymedia") << (FixupValue)EITFixUp::kFixUnitymedia
+        << "Titel" << "Beschreib" << "Beschreibung ... IMDb Rating: 8.9 /10";
+    QTest::newRow("GreekCategories") << (FixupValue)EITFixUp::kFixGreekCategories
+        << "Τίτλος" << ""
+        << "Ντοκιμαντέρ για την ιστορία της Αθήνας.";
+}
+
+/**
+ * Time a full Fix() per fixup type, events/sec is the inverse of the
+ * reported time per iteration. Run with -tickcounter or -iterations for
+ * steadier numbers.
+ */
+void TestEITFixups::testBenchmark()
+{
+    QFETCH(FixupValue, fixup);
+    QFETCH(QString, title);
+    QFETCH(QString, subtitle);
+    QFETCH(QString, description);
+
+    EITFixUp fixer;
+
+    QBENCHMARK
+    {
+        DBEventEIT *event = SimpleDBEventEIT (fixup, title, subtitle,
+                                              description);
+        fixer.Fix(*event);
+        delete event;
+    }
+}
+
 QTEST_APPLESS_MAIN(TestEITFixups)
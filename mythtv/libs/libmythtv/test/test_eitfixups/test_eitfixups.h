@@ -46,7 +46,10 @@ class TestEITFixups : public QObject
     static void testUnitymedia(void);
     static void testDeDisneyChannel(void);
     static void testATV(void);
+    static void testGreekCategories(void);
     static void test64BitEnum(void);
+    static void testBenchmark_data(void);
+    static void testBenchmark(void);
 
   private:
     static DBEventEIT *SimpleDBEventEIT (FixupValue fix, const QString& title, const QString& subtitle, const QString& description);
@@ -23,6 +23,19 @@
 #include "atsctables.h"
 #include "mpegtables.h"
 #include "dvbtables.h"
+#include "mpegcrc.h"
+
+extern "C" {
+#include "libavutil/crc.h"
+#include "libavutil/bswap.h"
+}
+
+/// The CRC as calculated by PESPacket before mpeg_crc32() was added.
+static uint32_t av_mpeg_crc32(const unsigned char *data, size_t length)
+{
+    return av_bswap32(av_crc(av_crc_get_table(AV_CRC_32_IEEE),
+                             UINT32_MAX, data, length));
+}
 
 void TestMPEGTables::pat_test(void)
 {
@@ -384,4 +397,102 @@ void TestMPEGTables::OTAChannelName_test (void)
     QCOMPARE (tvct.GetExtendedChannelName(999), QString());
 }
 
+void TestMPEGTables::crc_check_test(void)
+{
+    // Check value from the CRC catalogue
+    const unsigned char check[] = "123456789";
+    QCOMPARE (mpeg_crc32(check, 9), 0x0376E6E7U);
+
+    // Including the CRC_32 field of a good section gives 0
+    const unsigned char pat_data[] = {
+        0x00, 0xb0, 0x31, 0x04, 0x37, 0xdf, 0x00, 0x00,  0x2b, 0x66, 0xf7, 0xd4, 0x6d, 0x66, 0xe0, 0x64,
+        0x6d, 0x67, 0xe0, 0xc8, 0x6d, 0x68, 0xe1, 0x2c,  0x6d, 0x6b, 0xe2, 0x58, 0x6d, 0x6c, 0xe2, 0xbc,
+        0x6d, 0x6d, 0xe3, 0x20, 0x6d, 0x6e, 0xe2, 0x8a,  0x6d, 0x70, 0xe4, 0x4c, 0x6d, 0x71, 0xe1, 0x9b,
+        0xc0, 0x79, 0xa6, 0x2b
+    };
+    QCOMPARE (mpeg_crc32(pat_data, sizeof(pat_data)), 0U);
+
+    PSIPTable psip(pat_data);
+    QVERIFY (psip.VerifyCRC());
+    QCOMPARE (psip.CalcCRC(), 0xc079a62bU);
+}
+
+void TestMPEGTables::crc_test_data(void)
+{
+    QTest::addColumn<int>("offset");
+    QTest::addColumn<int>("length");
+
+    // Every alignment, and lengths around the eight byte steps
+    for (int offset = 0; offset < 8; offset++)
+    {
+        for (int length : { 0, 1, 7, 8, 9, 15, 16, 17, 183, 1021, 4093 })
+        {
+            QTest::newRow(qPrintable(QString("%1+%2").arg(offset).arg(length)))
+                << offset << length;
+        }
+    }
+}
+
+void TestMPEGTables::crc_test(void)
+{
+    QFETCH(int, offset);
+    QFETCH(int, length);
+
+    QByteArray buffer(offset + length, '\0');
+    quint32 seed = (offset * 4099) + length;
+    for (char &byte : buffer)
+    {
+        seed = (seed * 1103515245) + 12345;
+        byte = static_cast<char>(seed >> 16);
+    }
+    const auto *data =
+        reinterpret_cast<const unsigned char *>(buffer.constData()) + offset;
+
+    QCOMPARE (mpeg_crc32(data, length), av_mpeg_crc32(data, length));
+
+    // Continuing from a partial CRC gives the CRC of the whole buffer
+    int split = length / 3;
+    QCOMPARE (mpeg_crc32(data + split, length - split, mpeg_crc32(data, split)),
+              av_mpeg_crc32(data, length));
+}
+
+void TestMPEGTables::crc_benchmark_data(void)
+{
+    QTest::addColumn<bool>("libav");
+    QTest::addColumn<int>("length");
+
+    for (int length : { 188, 1024, 4096 })
+    {
+        QTest::newRow(qPrintable(QString("av_crc %1").arg(length)))
+            << true << length;
+        QTest::newRow(qPrintable(QString("mpeg_crc32 %1").arg(length)))
+            << false << length;
+    }
+}
+
+void TestMPEGTables::crc_benchmark(void)
+{
+    QFETCH(bool, libav);
+    QFETCH(int, length);
+
+    QByteArray buffer(length, '\x5A');
+    const auto *data = reinterpret_cast<const unsigned char *>(buffer.constData());
+    uint32_t crc = 0;
+    if (libav)
+    {
+        QBENCHMARK
+        {
+            crc ^= av_mpeg_crc32(data, length);
+        }
+    }
+    else
+    {
+        QBENCHMARK
+        {
+            crc ^= mpeg_crc32(data, length);
+        }
+    }
+    Q_UNUSED(crc);
+}
+
 QTEST_APPLESS_MAIN(TestMPEGTables)
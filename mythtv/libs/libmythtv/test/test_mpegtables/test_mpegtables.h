@@ -74,4 +74,12 @@ class TestMPEGTables: public QObject
     /** test US channel names for trailing \0 characters, #12612
       */
     static void OTAChannelName_test (void);
+
+    /** test mpeg_crc32() against av_crc() and known section CRCs
+     */
+    static void crc_check_test (void);
+    static void crc_test (void);
+    static void crc_test_data (void);
+    static void crc_benchmark (void);
+    static void crc_benchmark_data (void);
 };
@@ -7,6 +7,7 @@ TARGET = test_mpegtables
 DEPENDPATH += . ../..
 INCLUDEPATH += . ../.. ../../mpeg ../../../libmythui ../../../libmyth ../../../libmythbase
 INCLUDEPATH += ../../../libmythservicecontracts
+INCLUDEPATH += ../../../../external/FFmpeg
 
 LIBS += ../../$(OBJECTS_DIR)/dvbdescriptors.o
 LIBS += ../../$(OBJECTS_DIR)/iso6937tables.o
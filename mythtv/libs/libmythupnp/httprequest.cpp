@@ -403,7 +403,9 @@ qint64 HTTPRequest::SendResponse( void )
 
     if (( nContentLen > 0 ) && m_mapHeaders[ "accept-encoding" ].contains( "gzip" ))
     {
-        QByteArray compressed = gzipCompress( m_response.buffer() );
+        QByteArray compressed = m_compressedResponse;
+        if (compressed.isEmpty())
+            compressed = gzipCompress( m_response.buffer() );
         compBuffer.setData( compressed );
 
         if (!compBuffer.buffer().isEmpty())
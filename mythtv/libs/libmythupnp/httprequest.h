@@ -153,6 +153,7 @@ class UPNP_PUBLIC HTTPRequest
         QString             m_sFileName;
 
         QBuffer             m_response;
+        QByteArray          m_compressedResponse; // gzip'd m_response, if already known
 
         IPostProcess       *m_pPostProcess      {nullptr};
 
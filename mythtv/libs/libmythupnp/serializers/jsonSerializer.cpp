@@ -230,21 +230,44 @@ QString JSONSerializer::Encode(const QString &sIn)
     if (sIn.isEmpty())
         return sIn;
 
-    QString sStr = sIn;
+    // Most values need no escaping at all, don't copy those.
 
-    // -=>TODO: Would it be better to just loop through string once and build 
-    // new string with encoded chars instead of calling replace multiple times?
-    // It might perform better.
+    int nFirst = 0;
 
-    sStr.replace( '\\', "\\\\" ); // This must be first
-    sStr.replace( '"' , "\\\"" ); 
+    for (; nFirst < sIn.length(); ++nFirst)
+    {
+        ushort ch = sIn.at( nFirst ).unicode();
+
+        if (ch == '\\' || ch == '"' || ch == '/' || ch == '\b' ||
+            ch == '\f' || ch == '\n' || ch == '\r' || ch == '\t')
+            break;
+    }
+
+    if (nFirst == sIn.length())
+        return sIn;
+
+    QString sStr;
 
-    sStr.replace( '\b', "\\b"  );
-    sStr.replace( '\f', "\\f"  );
-    sStr.replace( '\n', "\\n"  );
-    sStr.replace( "\r", "\\r"  );
-    sStr.replace( "\t", "\\t"  );
-    sStr.replace(  "/", "\\/"  );
+    sStr.reserve( sIn.length() + 16 );
+    sStr.append( sIn.constData(), nFirst );
+
+    for (int nIdx = nFirst; nIdx < sIn.length(); ++nIdx)
+    {
+        QChar ch = sIn.at( nIdx );
+
+        switch (ch.unicode())
+        {
+            case '\\': sStr += "\\\\"; break;
+            case '"' : sStr += "\\\""; break;
+            case '\b': sStr += "\\b";  break;
+            case '\f': sStr += "\\f";  break;
+            case '\n': sStr += "\\n";  break;
+            case '\r': sStr += "\\r";  break;
+            case '\t': sStr += "\\t";  break;
+            case '/' : sStr += "\\/";  break;
+            default  : sStr += ch;      break;
+        }
+    }
 
     // we don't handle hex values yet...
     /*
@@ -12,8 +12,28 @@
 
 #include "serializer.h"
 
+#include <QAtomicPointer>
+#include <QHash>
 #include <QMetaObject>
 #include <QMetaProperty>
+#include <QMutex>
+
+// Open addressed, insert only table of PropertyTables by QMetaObject, so
+// looking a type up never takes a lock.  There are a few hundred DTC
+// types at most.
+
+static const int kPropertyTableSlots = 1024; // power of 2
+
+struct PropertyTableCache
+{
+    QAtomicPointer< const void > m_slots[ kPropertyTableSlots ];
+
+    // Only used if the slots ever run out
+    QMutex                                        m_overflowLock;
+    QHash< const QMetaObject*, const void* >      m_overflow;
+};
+
+Q_GLOBAL_STATIC( PropertyTableCache, s_propertyTables )
 
 //////////////////////////////////////////////////////////////////////////////
 //
@@ -104,41 +124,27 @@ void Serializer::SerializeObjectProperties( const QObject *pObject )
 {
     if (pObject != nullptr)
     {
-        const QMetaObject *pMetaObject = pObject->metaObject();
-
-        int nCount = pMetaObject->propertyCount();
+        const QMetaObject   *pMetaObject = pObject->metaObject();
+        const PropertyTable *pTable      = GetPropertyTable( pMetaObject );
 
-        for (int nIdx=0; nIdx < nCount; ++nIdx ) 
+        for (const auto & info : pTable->m_properties)
         {
-            QMetaProperty metaProperty = pMetaObject->property( nIdx );
+            // Designable can depend on the instance (e.g. SerializeDetails)
+
+            if (!info.m_metaProp.isDesignable( pObject ))
+                continue;
+
+            if (!info.m_bTransient)
+                m_hash.addData( info.m_sUtf8Name );
 
-            if (metaProperty.isDesignable( pObject ))
+            QVariant value( info.m_metaProp.read( pObject ) );
+
+            if (!info.m_bTransient && !value.canConvert< QObject* >())
             {
-                const char *pszPropName = metaProperty.name();
-                QString     sPropName( pszPropName );
-
-                if ( sPropName.compare( "objectName" ) == 0)
-                    continue;
-                
-                bool bHash = false;
-
-                if (ReadPropertyMetadata( pObject, 
-                                          sPropName,
-                                          "transient").toLower() != "true" )
-                {
-                    bHash = true;
-                    m_hash.addData( sPropName.toUtf8() );
-                }
-
-                QVariant value( pObject->property( pszPropName ) );
-
-                if (bHash && !value.canConvert< QObject* >()) 
-                {
-                    m_hash.addData( value.toString().toUtf8() );
-                }
-
-                AddProperty( sPropName, value, pMetaObject, &metaProperty );
+                m_hash.addData( value.toString().toUtf8() );
             }
+
+            AddProperty( info.m_sName, value, pMetaObject, &info.m_metaProp );
         }
     }
 }
@@ -147,12 +153,124 @@ void Serializer::SerializeObjectProperties( const QObject *pObject )
 //
 /////////////////////////////////////////////////////////////////////////////
 
-QString Serializer::ReadPropertyMetadata( const QObject *pObject, 
-                                                const QString&  sPropName,
-                                                const QString&  sKey )
+const Serializer::PropertyInfo *Serializer::PropertyTable::Find( int nPropIndex ) const
+{
+    if (nPropIndex < 0 || nPropIndex >= m_lookup.size())
+        return nullptr;
+
+    int nIdx = m_lookup.at( nPropIndex );
+
+    return (nIdx < 0) ? nullptr : &m_properties.at( nIdx );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+const Serializer::PropertyTable *Serializer::GetPropertyTable( const QMetaObject *pMetaObject )
 {
-    const QMetaObject *pMeta = pObject->metaObject();
+    // Meta objects are static, so tables are never freed or rebuilt.  Two
+    // threads may build the table of a new type at the same time, only
+    // the one that gets into the cache first is kept.
+
+    PropertyTableCache *pCache = s_propertyTables();
+    PropertyTable      *pNew   = nullptr;
+
+    uint nSlot = qHash( pMetaObject ) & (kPropertyTableSlots - 1);
 
+    for (int nProbe = 0; nProbe < kPropertyTableSlots; ++nProbe)
+    {
+        QAtomicPointer< const void > &slot = pCache->m_slots[ nSlot ];
+
+        auto *pTable = static_cast< const PropertyTable* >( slot.loadAcquire() );
+
+        if (pTable == nullptr)
+        {
+            if (pNew == nullptr)
+                pNew = BuildPropertyTable( pMetaObject );
+
+            if (slot.testAndSetOrdered( nullptr, pNew ))
+                return pNew;
+
+            pTable = static_cast< const PropertyTable* >( slot.loadAcquire() );
+        }
+
+        if (pTable->m_pMetaObject == pMetaObject)
+        {
+            delete pNew;
+            return pTable;
+        }
+
+        nSlot = (nSlot + 1) & (kPropertyTableSlots - 1);
+    }
+
+    QMutexLocker locker( &pCache->m_overflowLock );
+
+    const void *&pTable = pCache->m_overflow[ pMetaObject ];
+
+    if (pTable == nullptr)
+        pTable = (pNew != nullptr) ? pNew : BuildPropertyTable( pMetaObject );
+    else
+        delete pNew;
+
+    return static_cast< const PropertyTable* >( pTable );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+Serializer::PropertyTable *Serializer::BuildPropertyTable( const QMetaObject *pMetaObject )
+{
+    auto *pNew = new PropertyTable;
+
+    pNew->m_pMetaObject = pMetaObject;
+
+    int nClassIdx = pMetaObject->indexOfClassInfo( "version" );
+
+    if (nClassIdx >= 0)
+        pNew->m_sVersion = pMetaObject->classInfo( nClassIdx ).value();
+
+    int nCount = pMetaObject->propertyCount();
+
+    pNew->m_lookup.fill( -1, nCount );
+
+    for (int nIdx=0; nIdx < nCount; ++nIdx )
+    {
+        QMetaProperty metaProperty = pMetaObject->property( nIdx );
+        QString       sPropName( metaProperty.name() );
+
+        if ( sPropName.compare( "objectName" ) == 0)
+            continue;
+
+        PropertyInfo info;
+
+        info.m_metaProp   = metaProperty;
+        info.m_sName      = sPropName;
+        info.m_sUtf8Name  = sPropName.toUtf8();
+        info.m_bTransient = ReadPropertyMetadata( pMetaObject, sPropName,
+                                                  "transient" ).toLower() == "true";
+
+        info.m_sContentName = ReadPropertyMetadata( pMetaObject, sPropName, "name" );
+
+        if (info.m_sContentName.isEmpty())
+            info.m_sContentName = ReadPropertyMetadata( pMetaObject, sPropName, "type" );
+
+        pNew->m_lookup[ nIdx ] = pNew->m_properties.size();
+        pNew->m_properties.append( info );
+    }
+
+    return pNew;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+QString Serializer::ReadPropertyMetadata( const QMetaObject *pMeta,
+                                         const QString&     sPropName,
+                                         const QString&     sKey )
+{
     int nIdx = -1;
 
     if (pMeta)
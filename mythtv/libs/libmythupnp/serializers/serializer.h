@@ -17,7 +17,9 @@
 #include "upnputil.h"
 
 #include <QList>
+#include <QVector>
 #include <QMetaType>
+#include <QMetaProperty>
 #include <QCryptographicHash>
 
 //////////////////////////////////////////////////////////////////////////////
@@ -32,6 +34,39 @@ class UPNP_PUBLIC Serializer
 {
     protected:
 
+        // ------------------------------------------------------------------
+        // Everything the serializers need to know about a property that
+        // doesn't depend on the object instance.  Built once per type, so
+        // the class info strings aren't parsed again for every object in
+        // a list.
+        // ------------------------------------------------------------------
+
+        class PropertyInfo
+        {
+            public:
+
+                QMetaProperty m_metaProp;
+                QString       m_sName;
+                QByteArray    m_sUtf8Name;
+                QString       m_sContentName; // from "name=" or "type=" metadata
+                bool          m_bTransient {false};
+        };
+
+        class PropertyTable
+        {
+            public:
+
+                const QMetaObject      *m_pMetaObject {nullptr};
+                QVector< PropertyInfo > m_properties;   // serializable only
+                QVector< int >          m_lookup;       // property index -> m_properties
+                QString                 m_sVersion;     // "version" class info
+
+                const PropertyInfo *Find( int nPropIndex ) const;
+        };
+
+        static const PropertyTable *GetPropertyTable  ( const QMetaObject *pMetaObject );
+        static PropertyTable       *BuildPropertyTable( const QMetaObject *pMetaObject );
+
         QCryptographicHash  m_hash;
 
         virtual void BeginSerialize( QString &/*sName*/ ) {}
@@ -50,9 +85,9 @@ class UPNP_PUBLIC Serializer
         void SerializeObject          ( const QObject *pObject, const QString &sName );
         void SerializeObjectProperties( const QObject *pObject );
 
-        static QString    ReadPropertyMetadata  ( const QObject *pObject, 
-                                                 const QString&  sPropName,
-                                                 const QString&  sKey );
+        static QString    ReadPropertyMetadata  ( const QMetaObject *pMeta,
+                                                  const QString&     sPropName,
+                                                  const QString&     sKey );
 
     public:
 
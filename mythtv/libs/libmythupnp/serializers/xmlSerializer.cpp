@@ -90,13 +90,13 @@ void XmlSerializer::BeginObject( const QString &sName, const QObject  *pObject )
 
     const QMetaObject *pMeta = pObject->metaObject();
 
-    int nIdx = -1;
-
     if (pMeta)
-        nIdx = pMeta->indexOfClassInfo( "version" );
+    {
+        const PropertyTable *pTable = GetPropertyTable( pMeta );
 
-    if (nIdx >=0)
-        m_pXmlWriter->writeAttribute( "version", pMeta->classInfo( nIdx ).value() );
+        if (!pTable->m_sVersion.isEmpty())
+            m_pXmlWriter->writeAttribute( "version", pTable->m_sVersion );
+    }
 
     m_pXmlWriter->writeAttribute( "serializerVersion", XML_SERIALIZER_VERSION );
 
@@ -320,8 +320,24 @@ QString XmlSerializer::GetItemName( const QString &sName )
 
 QString XmlSerializer::GetContentName( const QString        &sName, 
                                        const QMetaObject   *pMetaObject,
-                                       const QMetaProperty */*pMetaProp*/ )
+                                       const QMetaProperty *pMetaProp )
 {
+    // Use the metadata already parsed for this type if we can.
+
+    if ( pMetaObject && pMetaProp )
+    {
+        const PropertyInfo *pInfo =
+            GetPropertyTable( pMetaObject )->Find( pMetaProp->propertyIndex() );
+
+        if (pInfo != nullptr)
+        {
+            if (!pInfo->m_sContentName.isEmpty())
+                return GetItemName( pInfo->m_sContentName );
+
+            return GetItemName( sName );
+        }
+    }
+
     // Try to read Name or TypeName from classinfo metadata.
 
     int nClassIdx = -1;
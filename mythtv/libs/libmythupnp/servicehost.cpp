@@ -13,7 +13,10 @@
 #include <QDomDocument>
 
 #include "mythlogging.h"
+#include "mythtimer.h"
+#include "mythtimingstats.h"
 #include "servicehost.h"
+#include "serviceresponsecache.h"
 #include "wsdl.h"
 #include "xsd.h"
 //#include "services/rtti.h"
@@ -249,6 +252,23 @@ ServiceHost::ServiceHost(const QMetaObject &metaObject,
                                                              RequestTypeHead);
             }
 
+            // --------------------------------------------------------------
+            // Read-only methods can ask for their responses to be cached,
+            // see ServiceResponseCache for the available tags.
+            // --------------------------------------------------------------
+
+            QString sCacheClassInfo = oInfo.m_sName + "_Cache";
+
+            nClassIdx =
+                m_oMetaObject.indexOfClassInfo(sCacheClassInfo.toLatin1());
+
+            if (nClassIdx >=0)
+            {
+                oInfo.m_cacheTags =
+                    QString(m_oMetaObject.classInfo(nClassIdx).value())
+                        .split(';', QString::SkipEmptyParts);
+            }
+
             m_Methods.insert( oInfo.m_sName, oInfo );
         }
     }
@@ -393,6 +413,36 @@ bool ServiceHost::ProcessRequest( HTTPRequest *pRequest )
 
                 if (( pRequest->m_eType & oInfo.m_eRequestType ) != 0)
                 {
+                    // ------------------------------------------------------
+                    // Polled methods may have a cached response that is
+                    // still valid.
+                    // ------------------------------------------------------
+
+                    ServiceResponseCache *pCache = nullptr;
+                    QString               sCacheKey;
+                    uint                  nGeneration = 0;
+                    MythTimer             timer(MythTimer::kStartRunning);
+
+                    if (!oInfo.m_cacheTags.isEmpty())
+                    {
+                        pCache = ServiceResponseCache::Instance();
+                        if (pCache->IsEnabled())
+                            sCacheKey = ServiceResponseCache::MakeKey(pRequest);
+                        if (sCacheKey.isEmpty())
+                            pCache = nullptr;
+                    }
+
+                    if (pCache && pCache->Lookup( sCacheKey, pRequest ))
+                    {
+                        MythTimingStats::Get("services")->Record(
+                            sMethodName, timer.nsecsElapsed() / 1000,
+                            pRequest->m_response.buffer().size(), "hit");
+                        return true;
+                    }
+
+                    if (pCache)
+                        nGeneration = pCache->Generation();
+
                     // ------------------------------------------------------
                     // Create new Instance of the Service Class so
                     // it's guaranteed to be on the same thread
@@ -406,6 +456,24 @@ bool ServiceHost::ProcessRequest( HTTPRequest *pRequest )
                                                     pRequest->m_mapParams);
 
                     bHandled = FormatResponse( pRequest, vResult );
+
+                    if (pCache && bHandled)
+                    {
+                        ServiceResponseCache::SetETag( pRequest );
+                        pCache->Insert( sCacheKey, oInfo.m_cacheTags,
+                                        nGeneration, pRequest );
+                        MythTimingStats::Get("services")->Record(
+                            sMethodName, timer.nsecsElapsed() / 1000,
+                            pRequest->m_response.buffer().size(), "miss");
+                    }
+
+                    // ------------------------------------------------------
+                    // Anything posted to a service may have changed data
+                    // that a cached response was built from.
+                    // ------------------------------------------------------
+
+                    if (pRequest->m_eType == RequestTypePost)
+                        ServiceResponseCache::Instance()->Invalidate();
                 }
             }
 
@@ -0,0 +1,219 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: serviceresponsecache.cpp
+//
+// Purpose     : Cache of serialized Services API GET responses
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include <QCoreApplication>
+
+#include "mythcorecontext.h"
+#include "mythcoreutil.h"
+#include "mythdate.h"
+#include "mythevent.h"
+#include "mythlogging.h"
+#include "httprequest.h"
+#include "serviceresponsecache.h"
+
+#define LOC QString("ServiceResponseCache: ")
+
+/// Upper bound on the memory used by cached responses, in KB.
+static const int kMaxCacheKB = 32 * 1024;
+
+ServiceResponseCache *ServiceResponseCache::Instance(void)
+{
+    static ServiceResponseCache *s_instance = new ServiceResponseCache();
+    return s_instance;
+}
+
+ServiceResponseCache::ServiceResponseCache()
+{
+    m_cache.setMaxCost(kMaxCacheKB);
+    m_maxAge = gCoreContext->GetNumSetting("ServiceCacheMaxAge", 60);
+
+    // Requests are handled on pool threads without an event loop,
+    // events have to be delivered on the main thread.
+    if (QCoreApplication::instance())
+        moveToThread(QCoreApplication::instance()->thread());
+
+    gCoreContext->addListener(this);
+}
+
+QString ServiceResponseCache::MakeKey(const HTTPRequest *pRequest)
+{
+    if (pRequest->m_bSOAPRequest ||
+        (pRequest->m_eType & (RequestTypeGet | RequestTypeHead)) == 0)
+        return QString();
+
+    QString sKey = pRequest->m_sBaseUrl + '/' + pRequest->m_sMethod + '?';
+
+    // Parameter names are matched case-insensitively by MethodInfo::Invoke,
+    // QMap keeps them sorted so the order they were given in doesn't matter.
+    QStringMap params;
+    for (auto it = pRequest->m_mapParams.cbegin();
+         it != pRequest->m_mapParams.cend(); ++it)
+        params[it.key().toLower()] = *it;
+
+    for (auto it = params.cbegin(); it != params.cend(); ++it)
+        sKey += it.key() + '=' + *it + '&';
+
+    sKey += '|' + pRequest->m_mapHeaders.value("accept", "*/*").toLower();
+
+    return sKey;
+}
+
+uint ServiceResponseCache::Generation(void) const
+{
+    QMutexLocker locker(&m_lock);
+    return m_generation;
+}
+
+bool ServiceResponseCache::Lookup(const QString &sKey, HTTPRequest *pRequest)
+{
+    bool bGzip =
+        pRequest->m_mapHeaders.value("accept-encoding").contains("gzip");
+
+    QMutexLocker locker(&m_lock);
+
+    Entry *pEntry = m_cache.object(sKey);
+    if (pEntry && pEntry->m_expires < MythDate::current())
+    {
+        m_cache.remove(sKey);
+        pEntry = nullptr;
+    }
+
+    if (!pEntry)
+    {
+        m_misses++;
+        return false;
+    }
+
+    m_hits++;
+
+    // Compress once, rather than on every hit
+    if (bGzip && pEntry->m_gzipBody.isEmpty() && !pEntry->m_body.isEmpty())
+        pEntry->m_gzipBody = gzipCompress(pEntry->m_body);
+
+    pRequest->m_eResponseType     = ResponseTypeOther;
+    pRequest->m_sResponseTypeText = pEntry->m_sContentType;
+    pRequest->m_nResponseStatus   = 200;
+    pRequest->m_response.buffer() = pEntry->m_body;
+    if (bGzip)
+        pRequest->m_compressedResponse = pEntry->m_gzipBody;
+
+    for (auto it = pEntry->m_headers.cbegin();
+         it != pEntry->m_headers.cend(); ++it)
+        pRequest->SetResponseHeader(it.key(), *it, true);
+
+    return true;
+}
+
+void ServiceResponseCache::Insert(const QString &sKey,
+                                  const QStringList &tags,
+                                  uint nGeneration, HTTPRequest *pRequest)
+{
+    if (pRequest->m_eResponseType != ResponseTypeOther ||
+        pRequest->m_nResponseStatus != 200)
+        return;
+
+    auto *pEntry = new Entry;
+    pEntry->m_body         = pRequest->m_response.buffer();
+    pEntry->m_sContentType = pRequest->m_sResponseTypeText;
+    pEntry->m_headers      = pRequest->m_mapRespHeaders;
+    pEntry->m_tags         = tags;
+    pEntry->m_expires      = MythDate::current().addSecs(m_maxAge);
+
+    int nCost = (pEntry->m_body.size() / 1024) + 1;
+
+    QMutexLocker locker(&m_lock);
+
+    // The data changed while this response was being built, it may
+    // already be stale.
+    if (nGeneration != m_generation)
+    {
+        delete pEntry;
+        return;
+    }
+
+    m_cache.insert(sKey, pEntry, nCost);
+}
+
+void ServiceResponseCache::Invalidate(const QString &sTag)
+{
+    QMutexLocker locker(&m_lock);
+
+    m_generation++;
+
+    int nRemoved = 0;
+    if (sTag.isEmpty())
+    {
+        nRemoved = m_cache.size();
+        m_cache.clear();
+    }
+    else
+    {
+        foreach (const QString &sKey, m_cache.keys())
+        {
+            Entry *pEntry = m_cache.object(sKey);
+            if (pEntry && pEntry->m_tags.contains(sTag))
+            {
+                m_cache.remove(sKey);
+                nRemoved++;
+            }
+        }
+    }
+
+    LOG(VB_HTTP, LOG_INFO, LOC +
+        QString("Invalidated %1 entries tagged '%2' (%3 hits, %4 misses)")
+            .arg(nRemoved).arg(sTag.isEmpty() ? "*" : sTag)
+            .arg(m_hits).arg(m_misses));
+}
+
+void ServiceResponseCache::SetETag(HTTPRequest *pRequest)
+{
+    if (pRequest->m_eResponseType != ResponseTypeOther ||
+        pRequest->m_nResponseStatus != 200)
+        return;
+
+    // Serializers already provide an ETag from the non-transient content,
+    // only fall back to hashing the body for anything that didn't.
+    pRequest->SetResponseHeader(
+        "ETag", HTTPRequest::GetETagHash(pRequest->m_response.buffer()));
+
+    // Let clients revalidate with If-None-Match instead of reusing
+    // their copy for the serializer's default two hours.
+    pRequest->SetResponseHeader("Cache-Control", "no-cache", true);
+}
+
+void ServiceResponseCache::customEvent(QEvent *e)
+{
+    if (e->type() != MythEvent::MythEventMessage)
+        return;
+
+    auto *me = dynamic_cast<MythEvent *>(e);
+    if (me == nullptr)
+        return;
+
+    QString sMessage = me->Message();
+
+    if (sMessage.startsWith("RECORDING_LIST_CHANGE") ||
+        sMessage.startsWith("MASTER_UPDATE_REC_INFO"))
+    {
+        Invalidate("recordings");
+    }
+    else if (sMessage.startsWith("SCHEDULE_CHANGE"))
+    {
+        Invalidate("schedule");
+        Invalidate("guide");
+    }
+    else if (sMessage.startsWith("RESCHEDULE_RECORDINGS"))
+    {
+        Invalidate("guide");
+    }
+    else if (sMessage == "CLEAR_SETTINGS_CACHE")
+    {
+        Invalidate();
+    }
+}
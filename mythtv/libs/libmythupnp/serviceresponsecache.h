@@ -0,0 +1,104 @@
+//////////////////////////////////////////////////////////////////////////////
+// Program Name: serviceresponsecache.h
+//
+// Purpose     : Cache of serialized Services API GET responses
+//
+// Licensed under the GPL v2 or later, see COPYING for details
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef SERVICERESPONSECACHE_H_
+#define SERVICERESPONSECACHE_H_
+
+// Qt headers
+#include <QObject>
+#include <QCache>
+#include <QMutex>
+#include <QDateTime>
+#include <QStringList>
+
+// MythTV headers
+#include "upnpexp.h"
+#include "upnputil.h"
+
+class HTTPRequest;
+
+/** \brief Caches the serialized output of Services API methods that are
+ *         polled by clients (recording lists, upcoming lists, guide data).
+ *
+ *  A method opts in with Q_CLASSINFO( "<methodName>_Cache", "<tags>" ),
+ *  where tags is a ';' separated list of what the response depends on:
+ *
+ *      - "recordings" - dropped on RECORDING_LIST_CHANGE and
+ *                       MASTER_UPDATE_REC_INFO
+ *      - "schedule"   - dropped on SCHEDULE_CHANGE
+ *      - "guide"      - dropped on RESCHEDULE_RECORDINGS and SCHEDULE_CHANGE,
+ *                       which follow guide data updates
+ *
+ *  Entries are keyed on the service, the method name as requested (it
+ *  becomes the root element of the response), the normalized parameters
+ *  and the Accept header. Every entry also expires after the
+ *  "ServiceCacheMaxAge" setting (in seconds, 0 disables the cache) so
+ *  anything the events miss is only briefly stale, and any POST to a
+ *  service clears the whole cache.
+ *
+ *  Hits and misses are recorded per method in the "services" group of
+ *  MythTimingStats.
+ */
+class UPNP_PUBLIC ServiceResponseCache : public QObject
+{
+    Q_OBJECT
+
+  public:
+    static ServiceResponseCache *Instance(void);
+
+    bool IsEnabled(void) const { return m_maxAge > 0; }
+
+    /// Returns the key for the request, or an empty string if the
+    /// request can't be cached.
+    static QString MakeKey(const HTTPRequest *pRequest);
+
+    /// Current invalidation generation, take before generating a response.
+    uint Generation(void) const;
+
+    /// Fills in pRequest from the cache, returns false on a miss.
+    bool Lookup(const QString &sKey, HTTPRequest *pRequest);
+
+    /// Stores the response in pRequest, unless an invalidation happened
+    /// since nGeneration was taken.
+    void Insert(const QString &sKey, const QStringList &tags,
+                uint nGeneration, HTTPRequest *pRequest);
+
+    void Invalidate(const QString &sTag = QString());
+
+    /// Makes sure a freshly generated response has a validator and is
+    /// revalidated by clients on every poll.
+    static void SetETag(HTTPRequest *pRequest);
+
+  protected:
+    void customEvent(QEvent *e) override; // QObject
+
+  private:
+    ServiceResponseCache();
+    ~ServiceResponseCache() override = default;
+
+    class Entry
+    {
+      public:
+        QByteArray  m_body;
+        QByteArray  m_gzipBody;
+        QString     m_sContentType;
+        QStringMap  m_headers;
+        QStringList m_tags;
+        QDateTime   m_expires;
+    };
+
+    mutable QMutex         m_lock;
+    QCache<QString, Entry> m_cache;         // cost is in KB
+    uint                   m_generation {0};
+    int                    m_maxAge     {0};
+    uint64_t               m_hits       {0};
+    uint64_t               m_misses     {0};
+};
+
+#endif
@@ -41,6 +41,7 @@ using namespace std;
 #include "compat.h"
 #include "mythlogging.h"
 #include "tv_rec.h"
+#include "scheduler.h"
 
 #define LOC     QString("AutoExpire: ")
 #define LOC_ERR QString("AutoExpire Error: ")
@@ -52,6 +53,37 @@ extern AutoExpire *expirer;
  */
 #define SPACE_TOO_BIG_KB (3*1024*1024)
 
+/** Recordings aren't pre-expired when a scheduled recording starts within
+ *  this many seconds, so slow deletes are finished before it starts.
+ */
+#define PRE_EXPIRE_QUIET_SECS (30*60)
+
+/** \brief Returns the IDs of the file systems holding a storage group's
+ *         directories on a host.
+ *
+ *  Like the scheduler, this uses the Default group for groups without
+ *  directories on the host.
+ */
+static QList<int> group_filesystems(const QList<FileSystemInfo> &fsInfos,
+                                    const QString &group, const QString &host)
+{
+    QStringList dirs = StorageGroup::getGroupDirs(group, host);
+    if (dirs.empty())
+        dirs = StorageGroup::getGroupDirs("Default", host);
+
+    QList<int> fsIDs;
+    foreach (const auto & fsInfo, fsInfos)
+    {
+        if ((fsInfo.getHostname() == host) &&
+            dirs.contains(fsInfo.getPath()) &&
+            !fsIDs.contains(fsInfo.getFSysID()))
+        {
+            fsIDs.push_back(fsInfo.getFSysID());
+        }
+    }
+    return fsIDs;
+}
+
 /// \brief This calls AutoExpire::RunExpirer() from within a new thread.
 void ExpireThread::run(void)
 {
@@ -256,6 +288,115 @@ void AutoExpire::CalcParams()
     m_instanceLock.unlock();
 }
 
+/**
+ *  \brief Forecasts the space needed on each file system by the recordings
+ *         scheduled in the next AutoExpireForecastHours hours.
+ *
+ *   Each recording is sized from the maximum bitrate of its recorder and
+ *   split evenly between the file systems of its storage group on its
+ *   backend, since the scheduler only picks the directory when the
+ *   recording starts. The forecast is expired ahead of time when the
+ *   recorders are idle, see ExpireRecordings().
+ *
+ *   \param pending The scheduler's pending recordings, see RunExpirer()
+ */
+void AutoExpire::CalcForecast(const ProgramList &pending)
+{
+    QList<FileSystemInfo> fsInfos;
+    QMap<int, int64_t> forecast;
+    QDateTime nextRecording;
+    int hours = gCoreContext->GetNumSetting("AutoExpireForecastHours", 4);
+
+    m_instanceLock.lock();
+    if (m_mainServer)
+        m_mainServer->GetFilesystemInfos(fsInfos, true);
+    m_instanceLock.unlock();
+
+    QDateTime now = MythDate::current();
+    QDateTime end = now.addSecs(hours * 60 * 60);
+    QMap<QString, QList<int> > groupFileSystems;
+    QMap<uint, uint64_t> bitrates;
+
+    for (auto *p : pending)
+    {
+        if (hours <= 0)
+            break;
+
+        if ((p->GetRecordingStatus() != RecStatus::WillRecord) &&
+            (p->GetRecordingStatus() != RecStatus::Pending))
+            continue;
+
+        QDateTime startts = p->GetRecordingStartTime();
+        if ((startts < now) || (startts > end))
+            continue;
+
+        if (!nextRecording.isValid() || (startts < nextRecording))
+            nextRecording = startts;
+
+        QString key = p->GetStorageGroup() + ":" + p->GetHostname();
+        if (!groupFileSystems.contains(key))
+        {
+            groupFileSystems[key] = group_filesystems(
+                fsInfos, p->GetStorageGroup(), p->GetHostname());
+        }
+        const QList<int> &fsIDs = groupFileSystems[key];
+        if (fsIDs.empty())
+            continue;
+
+        uint inputid = p->GetInputID();
+        if (!bitrates.contains(inputid))
+        {
+            uint64_t maxBitrate = 0;
+            EncoderLink *enc = m_encoderList->value(inputid, nullptr);
+            if (enc && enc->IsConnected())
+                maxBitrate = enc->GetMaxBitrate();
+            bitrates[inputid] = maxBitrate ? maxBitrate : 19500000LL;
+        }
+
+        int64_t secs = startts.secsTo(p->GetRecordingEndTime());
+        int64_t neededKB = ((bitrates[inputid] >> 13) * max(secs, (int64_t)0LL)) /
+                           fsIDs.size();
+        foreach (auto fsID, fsIDs)
+            forecast[fsID] += neededKB;
+    }
+
+    QMap<int, int64_t>::const_iterator it = forecast.constBegin();
+    for (; it != forecast.constEnd(); ++it)
+    {
+        LOG(VB_FILE, LOG_INFO, LOC +
+            QString("CalcForecast(): fsID #%1 needs %2 GB for the recordings "
+                    "in the next %3 hours")
+                .arg(it.key()).arg(*it / 1024.0 / 1024.0, 0, 'f', 1)
+                .arg(hours));
+    }
+
+    m_instanceLock.lock();
+    m_forecastSpace = forecast;
+    m_nextRecording = nextRecording;
+    m_instanceLock.unlock();
+}
+
+/**
+ *  \brief Returns true when no recorder is busy and no recording is
+ *         scheduled to start for PRE_EXPIRE_QUIET_SECS.
+ *
+ *  Must be called with m_instanceLock and TVRec::s_inputsLock held.
+ */
+bool AutoExpire::IsIdle(void) const
+{
+    if (m_nextRecording.isValid() &&
+        (MythDate::current().secsTo(m_nextRecording) < PRE_EXPIRE_QUIET_SECS))
+        return false;
+
+    foreach (auto enc, *m_encoderList)
+    {
+        if (enc->IsConnected() && enc->IsBusy())
+            return false;
+    }
+
+    return true;
+}
+
 /** \brief This contains the main loop for the auto expire process.
  *
  *   Responsible for cleanup of old LiveTV programs as well as deleting as
@@ -279,9 +420,24 @@ void AutoExpire::RunExpirer(void)
 
     while (m_expireThreadRun)
     {
+        curTime = MythDate::current();
+
+        // The scheduler holds its lock while it takes the inputs lock and
+        // asks for the desired space, so get its pending recordings before
+        // taking either.
+        ProgramList pending;
+        if (curTime >= next_expire)
+        {
+            locker.unlock();
+            m_schedulerLock.lock();
+            if (m_scheduler)
+                m_scheduler->GetAllPending(pending);
+            m_schedulerLock.unlock();
+            locker.relock();
+        }
+
         TVRec::s_inputsLock.lockForRead();
 
-        curTime = MythDate::current();
         // recalculate auto expire parameters
         if (curTime >= next_expire)
         {
@@ -296,6 +452,7 @@ void AutoExpire::RunExpirer(void)
 
             locker.unlock();
             CalcParams();
+            CalcForecast(pending);
             locker.relock();
             if (!m_expireThreadRun)
                 break;
@@ -325,7 +482,7 @@ void AutoExpire::RunExpirer(void)
 
             ExpireEpisodesOverMax();
 
-            ExpireRecordings();
+            ExpireRecordings(IsIdle());
         }
 
         TVRec::s_inputsLock.unlock();
@@ -393,14 +550,18 @@ void AutoExpire::ExpireQuickDeleted(void)
     ClearExpireList(expireList);
 }
 
-/** \fn AutoExpire::ExpireRecordings()
+/** \fn AutoExpire::ExpireRecordings(bool)
  *  \brief This expires normal recordings.
  *
+ *   When preExpire is set, enough is also expired for the forecast of the
+ *   upcoming recordings, see CalcForecast(). Those recordings are deleted
+ *   slowly, since the space isn't needed yet.
  */
-void AutoExpire::ExpireRecordings(void)
+void AutoExpire::ExpireRecordings(bool preExpire)
 {
     pginfolist_t expireList;
     pginfolist_t deleteList;
+    pginfolist_t slowDeleteList;
     QList<FileSystemInfo> fsInfos;
     QList<FileSystemInfo>::iterator fsit;
 
@@ -499,12 +660,26 @@ void AutoExpire::ExpireRecordings(void)
             continue;
         }
 
-        if (max((int64_t)0LL, fsit->getFreeSpace()) <
-            m_desiredSpace[fsit->getFSysID()])
+        int64_t desiredSpace = m_desiredSpace[fsit->getFSysID()];
+        int64_t targetSpace = desiredSpace;
+        if (preExpire)
+            targetSpace += m_forecastSpace.value(fsit->getFSysID());
+
+        if (max((int64_t)0LL, fsit->getFreeSpace()) < targetSpace)
         {
-            LOG(VB_FILE, LOG_INFO,
-                QString("    Not Enough Free Space!  We want %1 MB")
-                    .arg(m_desiredSpace[fsit->getFSysID()] / 1024));
+            if (max((int64_t)0LL, fsit->getFreeSpace()) < desiredSpace)
+            {
+                LOG(VB_FILE, LOG_INFO,
+                    QString("    Not Enough Free Space!  We want %1 MB")
+                        .arg(desiredSpace / 1024));
+            }
+            else
+            {
+                LOG(VB_FILE, LOG_INFO,
+                    QString("    Not Enough Free Space for upcoming "
+                            "recordings!  We want %1 MB")
+                        .arg(targetSpace / 1024));
+            }
 
             QMap<QString, int> dirList;
             QList<FileSystemInfo>::iterator fsit2;
@@ -528,8 +703,7 @@ void AutoExpire::ExpireRecordings(void)
             QString myHostName = gCoreContext->GetHostName();
             auto it = expireList.begin();
             while ((it != expireList.end()) &&
-                   (max((int64_t)0LL, fsit->getFreeSpace()) <
-                    m_desiredSpace[fsit->getFSysID()]))
+                   (max((int64_t)0LL, fsit->getFreeSpace()) < targetSpace))
             {
                 ProgramInfo *p = *it;
                 ++it;
@@ -584,9 +758,12 @@ void AutoExpire::ExpireRecordings(void)
                 QFileInfo vidFile(p->GetPathname());
                 if (dirList.contains(p->GetHostname() + ':' + vidFile.path()))
                 {
+                    if (max((int64_t)0LL, fsit->getFreeSpace()) < desiredSpace)
+                        deleteList.push_back(p);
+                    else
+                        slowDeleteList.push_back(p);
                     fsit->setUsedSpace(fsit->getUsedSpace()
                                                 - (p->GetFilesize() / 1024));
-                    deleteList.push_back(p);
 
                     LOG(VB_FILE, LOG_INFO,
                         QString("        FOUND file expirable. "
@@ -602,15 +779,20 @@ void AutoExpire::ExpireRecordings(void)
     }
 
     SendDeleteMessages(deleteList);
+    SendDeleteMessages(slowDeleteList, true);
 
     ClearExpireList(deleteList, false);
+    ClearExpireList(slowDeleteList, false);
     ClearExpireList(expireList);
 }
 
 /**
  *  \brief This sends delete message to main event thread.
+ *
+ *  \param slowDelete Truncate the files slowly even when the
+ *                    TruncateDeletesSlowly setting is off.
  */
-void AutoExpire::SendDeleteMessages(pginfolist_t &deleteList)
+void AutoExpire::SendDeleteMessages(pginfolist_t &deleteList, bool slowDelete)
 {
     QString msg;
 
@@ -634,8 +816,9 @@ void AutoExpire::SendDeleteMessages(pginfolist_t &deleteList)
         LOG(VB_GENERAL, LOG_NOTICE, msg);
 
         // send auto expire message to backend's event thread.
-        MythEvent me(QString("AUTO_EXPIRE %1 %2").arg((*it)->GetChanID())
-                     .arg((*it)->GetRecordingStartTime(MythDate::ISODate)));
+        MythEvent me(QString("AUTO_EXPIRE %1 %2%3").arg((*it)->GetChanID())
+                     .arg((*it)->GetRecordingStartTime(MythDate::ISODate))
+                     .arg(slowDelete ? " SLOW" : ""));
         gCoreContext->dispatch(me);
 
         ++it; // move on to next program
@@ -825,10 +1008,12 @@ void AutoExpire::PrintExpireList(const QString& expHost)
     ClearExpireList(expireList);
 }
 
-/** \fn AutoExpire::GetAllExpiring(QStringList&)
+/** \fn AutoExpire::GetAllExpiring(QStringList&, bool)
  *  \brief Gets the full list of programs that can expire in expiration order
+ *
+ *  The programs are sent as ProgramInfo::ToDataStream() data if typed is set.
  */
-void AutoExpire::GetAllExpiring(QStringList &strList)
+void AutoExpire::GetAllExpiring(QStringList &strList, bool typed)
 {
     QMutexLocker lockit(&m_instanceLock);
     pginfolist_t expireList;
@@ -841,10 +1026,7 @@ void AutoExpire::GetAllExpiring(QStringList &strList)
     FillDBOrdered(expireList, gCoreContext->GetNumSetting("AutoExpireMethod",
                   emOldestFirst));
 
-    strList << QString::number(expireList.size());
-
-    for (auto & info : expireList)
-        info->ToStringList(strList);
+    ProgramListToStringList(expireList, strList, typed);
 
     ClearExpireList(expireList);
 }
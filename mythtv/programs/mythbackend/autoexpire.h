@@ -16,11 +16,13 @@ using namespace std;
 #include <QMap>
 
 #include "mthread.h"
+#include "programinfo.h"
 
 class ProgramInfo;
 class EncoderLink;
 class FileSystemInfo;
 class MainServer;
+class Scheduler;
 
 using pginfolist_t  = vector<ProgramInfo*>;
 using enclinklist_t = vector<EncoderLink*>;
@@ -73,7 +75,7 @@ class AutoExpire : public QObject
 
     uint64_t GetDesiredSpace(int fsID) const;
 
-    void GetAllExpiring(QStringList &strList);
+    void GetAllExpiring(QStringList &strList, bool typed = false);
     void GetAllExpiring(pginfolist_t &list);
     static void ClearExpireList(pginfolist_t &expireList, bool deleteProg = true);
 
@@ -86,6 +88,12 @@ class AutoExpire : public QObject
         m_mainServer = ms;
     }
 
+    void SetScheduler(Scheduler *sched)
+    {
+        QMutexLocker locker(&m_schedulerLock);
+        m_scheduler = sched;
+    }
+
     QMap<int, EncoderLink *> *m_encoderList {nullptr};
 
   protected:
@@ -95,14 +103,18 @@ class AutoExpire : public QObject
     void ExpireLiveTV(int type);
     void ExpireOldDeleted(void);
     void ExpireQuickDeleted(void);
-    void ExpireRecordings(void);
+    void ExpireRecordings(bool preExpire);
     void ExpireEpisodesOverMax(void);
 
     void FillExpireList(pginfolist_t &expireList);
     void FillDBOrdered(pginfolist_t &expireList, int expMethod);
-    static void SendDeleteMessages(pginfolist_t &deleteList);
+    static void SendDeleteMessages(pginfolist_t &deleteList,
+                                   bool slowDelete = false);
     void Sleep(int sleepTime /*ms*/);
 
+    void CalcForecast(const ProgramList &pending);
+    bool IsIdle(void) const;
+
     void UpdateDontExpireSet(void);
     bool IsInDontExpireSet(uint chanid, const QDateTime &recstartts) const;
     static bool IsInExpireList(const pginfolist_t &expireList,
@@ -116,12 +128,19 @@ class AutoExpire : public QObject
 
     QMap<int, int64_t>  m_desiredSpace;          // protected by m_instanceLock
     QMap<int, int>      m_usedEncoders;          // protected by m_instanceLock
+    QMap<int, int64_t>  m_forecastSpace;         // protected by m_instanceLock
+    QDateTime           m_nextRecording;         // protected by m_instanceLock
 
     mutable QMutex m_instanceLock;
     QWaitCondition m_instanceCond;               // protected by m_instanceLock
 
     MainServer    *m_mainServer       {nullptr};  // protected by m_instanceLock
 
+    // Not protected by m_instanceLock, the scheduler asks for the desired
+    // space with its own lock held.
+    QMutex         m_schedulerLock;
+    Scheduler     *m_scheduler        {nullptr};  // protected by m_schedulerLock
+
     // update info
     QMutex              m_updateLock;
     QQueue<UpdateEntry> m_updateQueue;           // protected by m_updateLock
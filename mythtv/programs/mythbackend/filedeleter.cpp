@@ -0,0 +1,388 @@
+// POSIX headers
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#  include <linux/falloc.h>
+#endif
+
+// C++ headers
+#include <algorithm>
+#include <cerrno>
+using namespace std;
+
+// Qt headers
+#include <QElapsedTimer>
+
+// MythTV headers
+#include "filedeleter.h"
+#include "programinfo.h"
+#include "mythdbcon.h"
+#include "mythdate.h"
+#include "mythlogging.h"
+
+#define LOC QString("FileDeleter: ")
+
+/// Time between steps in milliseconds
+static const int kStepMs = 500;
+
+/// Steps between updates of the in use marks, about once a minute
+static const int kInUseUpdateSteps = 100;
+
+QMutex       FileDeleter::s_lock;
+FileDeleter *FileDeleter::s_deleter  = nullptr;
+bool         FileDeleter::s_shutdown = false;
+
+/** \brief Stops the FileDeleter.
+ *
+ *  Files still queued are closed at once, without freeing their space
+ *  gradually, as are any queued after this.
+ */
+void FileDeleter::Shutdown(void)
+{
+    QMutexLocker locker(&s_lock);
+    s_shutdown = true;
+    delete s_deleter;
+    s_deleter = nullptr;
+}
+
+/** \brief Returns the queued files and statistics of the FileDeleter.
+ *
+ *  \return false, leaving jobs and stats untouched, if nothing has been
+ *          queued since the backend started.
+ */
+bool FileDeleter::GetStatusIfRunning(QList<JobStatus> &jobs, Stats &stats)
+{
+    QMutexLocker locker(&s_lock);
+    if (!s_deleter)
+        return false;
+
+    s_deleter->GetStatus(jobs, stats);
+    return true;
+}
+
+FileDeleter::FileDeleter(void) : MThread("FileDeleter")
+{
+    m_stats.m_startTime = MythDate::current();
+}
+
+FileDeleter::~FileDeleter()
+{
+    {
+        QMutexLocker locker(&m_lock);
+        m_stop = true;
+        m_wait.wakeAll();
+    }
+
+    wait();
+
+    int     files = 0;
+    int64_t bytes = 0;
+    foreach (auto & queue, m_queues)
+    {
+        foreach (auto job, queue)
+        {
+            files++;
+            bytes += job->m_remaining;
+        }
+    }
+    if (files)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Shutting down, freeing the last %1 MB of %2 files at "
+                    "once").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1)
+                           .arg(files));
+    }
+
+    foreach (auto & queue, m_queues)
+    {
+        foreach (auto job, queue)
+            Finish(job);
+    }
+    m_queues.clear();
+}
+
+/** \brief Queues an unlinked file to have its space freed, starting the
+ *         FileDeleter if needed.
+ *
+ *  The FileDeleter takes ownership of the file descriptor. When pginfo is
+ *  set the recording is marked as in use by a truncating delete until the
+ *  file is closed, so the AutoExpirer waits for the space to be freed.
+ *  Once the FileDeleter has been shut down the file is closed at once.
+ */
+void FileDeleter::Queue(int fd, const QString &filename, off_t size,
+                        Priority priority, const ProgramInfo *pginfo)
+{
+    QMutexLocker locker(&s_lock);
+    if (s_shutdown)
+    {
+        LOG(VB_FILE, LOG_INFO, LOC +
+            QString("Shutting down, closing '%1' without freeing its space "
+                    "gradually").arg(filename));
+        if (close(fd) != 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC + QString("Error closing '%1'")
+                    .arg(filename) + ENO);
+        }
+        return;
+    }
+
+    if (!s_deleter)
+    {
+        s_deleter = new FileDeleter();
+        s_deleter->start();
+    }
+
+    auto *job = new Job;
+    job->m_fd        = fd;
+    job->m_filename  = filename;
+    job->m_priority  = priority;
+    job->m_size      = max((int64_t)0, (int64_t)size);
+    job->m_remaining = job->m_size;
+    job->m_queued    = MythDate::current();
+
+    struct stat st {};
+    if (fstat(fd, &st) == 0)
+        job->m_device = st.st_dev;
+
+    if (pginfo)
+    {
+        job->m_pginfo = new ProgramInfo(*pginfo);
+        job->m_pginfo->SetPathname(filename);
+        job->m_pginfo->MarkAsInUse(true, kTruncatingDeleteInUseID);
+    }
+
+    s_deleter->QueueJob(job);
+}
+
+/// \brief Adds a job to the queue of its file system.
+void FileDeleter::QueueJob(Job *job)
+{
+    QMutexLocker locker(&m_lock);
+    Priority priority = job->m_priority;
+
+    // After the files of the same or a higher priority
+    JobList &queue = m_queues[job->m_device];
+    auto it = queue.begin();
+    while (it != queue.end() && (*it)->m_priority <= priority)
+        ++it;
+    queue.insert(it, job);
+
+    LOG(VB_FILE, LOG_INFO, LOC +
+        QString("Queued '%1', %2 MB with %3 priority, %4 files on this "
+                "file system")
+            .arg(job->m_filename)
+            .arg(job->m_size / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(PriorityToString(priority)).arg(queue.size()));
+
+    m_wait.wakeAll();
+}
+
+void FileDeleter::GetStatus(QList<JobStatus> &jobs, Stats &stats) const
+{
+    QMutexLocker locker(&m_lock);
+
+    stats = m_stats;
+
+    foreach (auto & queue, m_queues)
+    {
+        foreach (auto job, queue)
+        {
+            JobStatus status;
+            status.m_filename  = job->m_filename;
+            status.m_device    = job->m_device;
+            status.m_priority  = job->m_priority;
+            status.m_size      = job->m_size;
+            status.m_remaining = job->m_remaining;
+            status.m_queued    = job->m_queued;
+            status.m_started   = job->m_started;
+            jobs.push_back(status);
+        }
+    }
+}
+
+QString FileDeleter::PriorityToString(Priority priority)
+{
+    switch (priority)
+    {
+        case kLiveTV:     return "LiveTV";
+        case kNormal:     return "Normal";
+        case kBackground: return "Background";
+    }
+    return "Unknown";
+}
+
+void FileDeleter::run(void)
+{
+    RunProlog();
+
+    QMutexLocker locker(&m_lock);
+    int steps = 0;
+
+    while (!m_stop)
+    {
+        if (m_queues.empty())
+        {
+            m_stats.m_bytesPerSec = 0;
+            m_wait.wait(&m_lock);
+            continue;
+        }
+
+        if (m_stats.m_bytesPerSec == 0)
+        {
+            locker.unlock();
+            int64_t bytesPerSec = CalcBytesPerSec();
+            locker.relock();
+            m_stats.m_bytesPerSec = bytesPerSec;
+
+            LOG(VB_FILE, LOG_INFO, LOC +
+                QString("Freeing %1 MB every %2 milliseconds")
+                    .arg(bytesPerSec * kStepMs / 1000 / (1024.0 * 1024.0),
+                         0, 'f', 2)
+                    .arg(kStepMs));
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+
+        // The budget is shared between the file systems, each shrinks the
+        // first file in its queue. Only this thread removes jobs, so the
+        // pointers stay valid while the lock is released.
+        int64_t bytes = m_stats.m_bytesPerSec * kStepMs / 1000 /
+                        m_queues.size();
+        JobList jobs;
+        JobList inUse;
+        bool updateInUse = (++steps % kInUseUpdateSteps) == 0;
+        foreach (auto & queue, m_queues)
+        {
+            queue.first()->m_started = true;
+            jobs.push_back(queue.first());
+            foreach (auto job, queue)
+            {
+                if (updateInUse && job->m_pginfo)
+                    inUse.push_back(job);
+            }
+        }
+
+        locker.unlock();
+
+        QList<int64_t> remaining;
+        foreach (auto job, jobs)
+            remaining.push_back(Shrink(job, bytes));
+
+        foreach (auto job, inUse)
+            job->m_pginfo->UpdateInUseMark(true);
+
+        locker.relock();
+
+        JobList finished;
+        for (int i = 0; i < jobs.size(); ++i)
+        {
+            Job *job = jobs[i];
+            job->m_remaining = max((int64_t)0, remaining[i]);
+            if (remaining[i] > 0)
+                continue;
+
+            JobList &queue = m_queues[job->m_device];
+            queue.removeOne(job);
+            if (queue.empty())
+                m_queues.remove(job->m_device);
+
+            m_stats.m_deletedFiles++;
+            m_stats.m_deletedBytes += job->m_size;
+            finished.push_back(job);
+        }
+
+        if (!finished.empty())
+        {
+            locker.unlock();
+            foreach (auto job, finished)
+                Finish(job);
+            locker.relock();
+        }
+
+        // Files queued meanwhile wake us, don't let them shorten the step
+        while (!m_stop && timer.elapsed() < kStepMs)
+            m_wait.wait(&m_lock, kStepMs - timer.elapsed());
+    }
+
+    locker.unlock();
+
+    RunEpilog();
+}
+
+/** \brief Returns the number of bytes freed per second.
+ *
+ *  This is enough to keep up with every capture card recording at
+ *  22.2 Mbps with a 20% margin, and at least 8 MB/s.
+ */
+int64_t FileDeleter::CalcBytesPerSec(void)
+{
+    int cards = 5;
+    MSqlQuery query(MSqlQuery::InitCon());
+    query.prepare("SELECT COUNT(cardid) FROM capturecard;");
+    if (query.exec() && query.next())
+        cards = query.value(0).toInt();
+
+    const int64_t min_bps  = 8 * 1024 * 1024;
+    const auto    calc_bps = (int64_t) (cards * 1.2 * (22200000LL / 8.0));
+    return max(min_bps, calc_bps);
+}
+
+/** \brief Frees up to bytes from the end of the job's file.
+ *
+ *  \return the size left to free, or -1 on error
+ */
+int64_t FileDeleter::Shrink(Job *job, int64_t bytes)
+{
+    if (job->m_remaining <= 0)
+        return 0;
+
+    int64_t offset = max((int64_t)0, job->m_remaining - bytes);
+
+#if defined(__linux__) && defined(FALLOC_FL_PUNCH_HOLE)
+    if (job->m_punchHole)
+    {
+        if (fallocate(job->m_fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                      offset, job->m_remaining - offset) == 0)
+            return offset;
+
+        LOG(VB_FILE, LOG_INFO, LOC +
+            QString("Can't punch holes in '%1', truncating it instead")
+                .arg(job->m_filename) + ENO);
+        job->m_punchHole = false;
+    }
+#endif
+
+    if (ftruncate(job->m_fd, offset) != 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Error truncating '%1'")
+                .arg(job->m_filename) + ENO);
+        return -1;
+    }
+
+    return offset;
+}
+
+/// \brief Closes the job's file and deletes the job.
+void FileDeleter::Finish(Job *job)
+{
+    if (close(job->m_fd) != 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("Error closing '%1'")
+                .arg(job->m_filename) + ENO);
+    }
+
+    if (job->m_pginfo)
+    {
+        job->m_pginfo->MarkAsInUse(false, kTruncatingDeleteInUseID);
+        delete job->m_pginfo;
+    }
+
+    LOG(VB_FILE, LOG_INFO, LOC +
+        QString("Finished deleting '%1'").arg(job->m_filename));
+
+    delete job;
+}
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
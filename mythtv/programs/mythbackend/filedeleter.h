@@ -0,0 +1,118 @@
+#ifndef FILEDELETER_H_
+#define FILEDELETER_H_
+
+#include <cstdint>
+#include <sys/types.h>
+
+#include <QWaitCondition>
+#include <QDateTime>
+#include <QString>
+#include <QMutex>
+#include <QList>
+#include <QMap>
+
+#include "mthread.h"
+
+class ProgramInfo;
+
+/** \class FileDeleter
+ *  \brief Frees the space of deleted files gradually, within one I/O budget
+ *         for the whole backend.
+ *
+ *  Files are queued already unlinked, as an open file descriptor, see
+ *  MainServer::DeleteFile(). Each file system has its own queue, ordered by
+ *  priority and then by the time the file was queued. Every step the budget
+ *  is split between the file systems with files queued, and each shrinks
+ *  the first file in its queue, so concurrent deletes never add up to more
+ *  disk bandwidth than one would use. LiveTV files go first, then files
+ *  deleted by users, then recordings expired ahead of time.
+ *
+ *  Where the file system supports it the files are shrunk by punching holes
+ *  at their ends with fallocate(), otherwise with ftruncate(). The file is
+ *  closed once it is empty.
+ */
+class FileDeleter : public MThread
+{
+  public:
+    enum Priority
+    {
+        kLiveTV     = 0,
+        kNormal     = 1,
+        kBackground = 2,
+    };
+
+    class JobStatus
+    {
+      public:
+        QString   m_filename;
+        uint64_t  m_device    {0};
+        Priority  m_priority  {kNormal};
+        int64_t   m_size      {0};
+        int64_t   m_remaining {0};
+        QDateTime m_queued;
+        bool      m_started   {false};
+    };
+
+    class Stats
+    {
+      public:
+        int64_t   m_bytesPerSec   {0};
+        int64_t   m_deletedFiles  {0};
+        int64_t   m_deletedBytes  {0};
+        QDateTime m_startTime;
+    };
+
+    static void Shutdown(void);
+
+    static void Queue(int fd, const QString &filename, off_t size,
+                      Priority priority, const ProgramInfo *pginfo = nullptr);
+
+    static bool GetStatusIfRunning(QList<JobStatus> &jobs, Stats &stats);
+
+    static QString PriorityToString(Priority priority);
+
+  protected:
+    void run(void) override; // MThread
+
+  private:
+    FileDeleter(void);
+    ~FileDeleter() override;
+    Q_DISABLE_COPY(FileDeleter)
+
+    class Job
+    {
+      public:
+        int          m_fd        {-1};
+        QString      m_filename;
+        uint64_t     m_device    {0};
+        Priority     m_priority  {kNormal};
+        int64_t      m_size      {0};
+        int64_t      m_remaining {0};
+        QDateTime    m_queued;
+        bool         m_started   {false};
+        bool         m_punchHole {true};
+        ProgramInfo *m_pginfo    {nullptr};
+    };
+    using JobList = QList<Job*>;
+
+    void QueueJob(Job *job);
+    void GetStatus(QList<JobStatus> &jobs, Stats &stats) const;
+
+    static int64_t CalcBytesPerSec(void);
+    static int64_t Shrink(Job *job, int64_t bytes);
+    static void Finish(Job *job);
+
+    mutable QMutex          m_lock;
+    QWaitCondition          m_wait;
+    QMap<uint64_t, JobList> m_queues;   ///< by file system device
+    Stats                   m_stats;
+    bool                    m_stop      {false};
+
+    static QMutex           s_lock;
+    static FileDeleter     *s_deleter;
+    static bool             s_shutdown;
+};
+
+#endif
+
+/* vim: set expandtab tabstop=4 shiftwidth=4: */
@@ -1,25 +1,57 @@
+// POSIX headers
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+#include <algorithm>
+
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QFileInfo>
 #include <utility>
 
+#include "mythconfig.h" // for HAVE_POSIX_FADVISE
 #include "filetransfer.h"
 #include "ringbuffer.h"
 #include "mythdate.h"
 #include "mythsocket.h"
 #include "programinfo.h"
 #include "mythlogging.h"
+#include "mythcorecontext.h"
+#include "mythtimingstats.h"
+
+#if HAVE_POSIX_FADVISE < 1
+static int posix_fadvise(int, off_t, off_t, int) { return 0; }
+#define POSIX_FADV_SEQUENTIAL 0
+#define POSIX_FADV_WILLNEED 0
+#endif
+
+#define LOC QString("FileTransfer(%1): ").arg(m_fd)
+
+/// Seconds of the client's observed bitrate to keep in the page cache.
+static const int       kReadAheadSecs  = 8;
+static const long long kMinReadAhead   = 2LL  * 1024 * 1024;
+static const long long kMaxReadAhead   = 64LL * 1024 * 1024;
+/// Give up on a zero-copy send if the socket accepts nothing for this long.
+static const int       kSendTimeoutMs  = 10000;
 
 FileTransfer::FileTransfer(QString &filename, MythSocket *remote,
                            bool usereadahead, int timeout_ms) :
     ReferenceCounter(QString("FileTransfer:%1").arg(filename)),
-    m_rbuffer(RingBuffer::Create(filename, false, usereadahead, timeout_ms, true)),
-    m_sock(remote)
+    m_sock(remote), m_filename(filename),
+    m_usereadahead(usereadahead), m_timeoutMs(timeout_ms)
 {
     m_pginfo = new ProgramInfo(filename);
     m_pginfo->MarkAsInUse(true, kFileTransferInUseID);
-    if (m_rbuffer && m_rbuffer->IsOpen())
-        m_rbuffer->Start();
+
+    // The RingBuffer is only created if sendfile() can't be used, or
+    // when it is refused part way through the transfer.
+    if (!OpenDirect(filename))
+        OpenRingBuffer();
 }
 
 FileTransfer::FileTransfer(QString &filename, MythSocket *remote, bool write) :
@@ -40,6 +72,22 @@ FileTransfer::~FileTransfer()
 {
     Stop();
 
+    if (m_requests)
+    {
+        int ms = std::max(m_openTimer.elapsed(), 1);
+        LOG(VB_FILE, LOG_INFO, LOC +
+            QString("Sent %1 bytes in %2 requests over %3 s, %4 KB/s (%5)")
+                .arg(m_bytesSent).arg(m_requests).arg(ms / 1000)
+                .arg(m_bytesSent / ms)
+                .arg(IsZeroCopy() ? "sendfile" : "ringbuffer"));
+    }
+
+    if (m_fd >= 0)
+    {
+        close(m_fd);
+        m_fd = -1;
+    }
+
     if (m_sock) // FileTransfer becomes responsible for deleting the socket
         m_sock->DecrRef();
 
@@ -58,7 +106,48 @@ FileTransfer::~FileTransfer()
 
 bool FileTransfer::isOpen(void)
 {
-    return m_rbuffer && m_rbuffer->IsOpen();
+    QMutexLocker locker(&m_lock);
+    return (m_fd >= 0) || (m_rbuffer && m_rbuffer->IsOpen());
+}
+
+/// Opens the RingBuffer used for files that can't be sent with sendfile().
+bool FileTransfer::OpenRingBuffer(void)
+{
+    m_rbuffer = RingBuffer::Create(m_filename, false, m_usereadahead,
+                                   m_timeoutMs, true);
+    if (!m_rbuffer || !m_rbuffer->IsOpen())
+        return false;
+
+    m_rbuffer->SetOldFile(m_oldFile);
+    m_rbuffer->Start();
+    return true;
+}
+
+/** \brief Returns true if a recorder is still writing to the file.
+ *
+ *  ProgramInfo(pathname) loads the recording as already recorded, so this
+ *  asks the inuseprograms table instead, which the recorders keep updated
+ *  while they write.
+ */
+bool FileTransfer::IsInProgress(void) const
+{
+    if (!m_pginfo || !m_pginfo->IsRecording())
+        return false;
+
+    if (m_pginfo->GetRecordingGroup() == "LiveTV")
+        return true;
+
+    QStringList byWho;
+    if (!m_pginfo->QueryIsInUse(byWho))
+        return false;
+
+    for (int i = 0; i + 2 < byWho.size(); i += 3)
+    {
+        if (byWho[i] == kRecorderInUseID || byWho[i] == kImportRecorderInUseID)
+            return true;
+    }
+
+    return false;
 }
 
 bool FileTransfer::ReOpen(const QString& newFilename)
@@ -119,9 +208,179 @@ void FileTransfer::Unpause(void)
         m_pginfo->UpdateInUseMark();
 }
 
+/** \brief Opens filename for the sendfile() fast path if it is a plain
+ *         local file that is not being written to.
+ *
+ *  LiveTV and in-progress recordings keep using the RingBuffer, which
+ *  knows how to wait for a growing file.
+ */
+bool FileTransfer::OpenDirect(const QString &filename)
+{
+#ifdef __linux__
+    if (!gCoreContext->GetBoolSetting("FileTransferZeroCopy", true))
+        return false;
+
+    if (!filename.startsWith('/') ||
+        gCoreContext->IsRegisteredFileForWrite(filename))
+        return false;
+
+    if (IsInProgress())
+        return false;
+
+    int fd = open(filename.toLocal8Bit().constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat st {};
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode))
+    {
+        close(fd);
+        return false;
+    }
+
+    m_fd = fd;
+    m_fdSize = st.st_size;
+    m_fdPos = 0;
+    m_advisedEnd = 0;
+    posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    LOG(VB_FILE, LOG_INFO, LOC +
+        QString("Using sendfile() for '%1'").arg(filename));
+    return true;
+#else
+    Q_UNUSED(filename);
+    return false;
+#endif
+}
+
+/// Drops the fast path and opens the RingBuffer at the position the client
+/// has reached, so the transfer can continue through it.
+/// Must be called with m_lock held.
+bool FileTransfer::CloseDirect(void)
+{
+    if (m_fd < 0)
+        return m_rbuffer != nullptr;
+
+    close(m_fd);
+    m_fd = -1;
+
+    if (!OpenRingBuffer())
+        return false;
+
+    m_rbuffer->Seek(m_fdPos, SEEK_SET);
+    return true;
+}
+
+/// Tracks the rate at which the client is pulling data, which is
+/// effectively its playback bitrate since clients request as they consume.
+void FileTransfer::UpdateRate(int bytes)
+{
+    if (!m_rateTimer.isRunning())
+    {
+        m_rateTimer.start();
+        return;
+    }
+
+    int ms = m_rateTimer.restart();
+    if (ms <= 0 || bytes <= 0)
+        return;
+
+    double rate = bytes * 1000.0 / ms;
+    m_bytesPerSec = (m_bytesPerSec > 0.0) ?
+        (0.8 * m_bytesPerSec) + (0.2 * rate) : rate;
+}
+
+/// Asks the kernel to prefetch kReadAheadSecs of the client's bitrate
+/// ahead of the current position, topping up once half of it is used.
+void FileTransfer::AdviseReadAhead(void)
+{
+    auto window = static_cast<long long>(m_bytesPerSec * kReadAheadSecs);
+    window = std::min(std::max(window, kMinReadAhead), kMaxReadAhead);
+
+    if (m_fdPos + (window / 2) < m_advisedEnd)
+        return;
+
+    long long start = std::max(m_fdPos, m_advisedEnd);
+    long long end   = m_fdPos + window;
+    posix_fadvise(m_fd, start, end - start, POSIX_FADV_WILLNEED);
+    m_advisedEnd = end;
+}
+
+/// Sends up to size bytes from m_fd straight to the data socket without
+/// copying them through user space. Must be called with m_lock held.
+int FileTransfer::RequestBlockDirect(int size)
+{
+#ifdef __linux__
+    // A file that is still growing was started by a recorder after the
+    // transfer was opened, only the RingBuffer waits for more data.
+    struct stat st {};
+    if (fstat(m_fd, &st) == 0 && st.st_size != m_fdSize)
+    {
+        LOG(VB_FILE, LOG_INFO, LOC +
+            "File is being written to, switching to RingBuffer");
+        return CloseDirect() ? -2 : -1;
+    }
+
+    int sockfd = m_sock->GetSocketDescriptor();
+    int tot = 0;
+    MythTimer stalled(MythTimer::kStartRunning);
+
+    AdviseReadAhead();
+
+    while (tot < size && m_readthreadlive)
+    {
+        off_t offset = m_fdPos;
+        ssize_t ret = sendfile(sockfd, m_fd, &offset, size - tot);
+        if (ret > 0)
+        {
+            tot += ret;
+            m_fdPos = offset;
+            stalled.restart();
+            continue;
+        }
+
+        if (ret == 0)
+            break; // we hit eof
+
+        if (errno == EINTR)
+            continue;
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            // Qt keeps the socket non-blocking, wait for it to drain
+            if (stalled.elapsed() > kSendTimeoutMs)
+            {
+                LOG(VB_GENERAL, LOG_ERR, LOC +
+                    "RequestBlock: Timed out waiting for client");
+                return -1;
+            }
+            struct pollfd pfd {sockfd, POLLOUT, 0};
+            poll(&pfd, 1, 100 /*ms*/);
+            continue;
+        }
+
+        if (tot == 0 && (errno == EINVAL || errno == ENOSYS))
+        {
+            // Filesystem doesn't support it, use the RingBuffer instead
+            LOG(VB_FILE, LOG_INFO, LOC +
+                "sendfile() not supported, falling back to RingBuffer");
+            return CloseDirect() ? -2 : -1;
+        }
+
+        LOG(VB_GENERAL, LOG_ERR, LOC + "RequestBlock: sendfile() " + ENO);
+        return -1;
+    }
+
+    return tot;
+#else
+    Q_UNUSED(size);
+    return -2;
+#endif
+}
+
 int FileTransfer::RequestBlock(int size)
 {
-    if (!m_readthreadlive || !m_rbuffer)
+    if (!m_readthreadlive)
         return -1;
 
     int tot = 0;
@@ -131,6 +390,30 @@ int FileTransfer::RequestBlock(int size)
     while (m_readsLocked)
         m_readsUnlockedCond.wait(&m_lock, 100 /*ms*/);
 
+    if (m_fd < 0 && !m_rbuffer)
+        return -1;
+
+    MythTimer t(MythTimer::kStartRunning);
+    UpdateRate(size);
+    m_requests++;
+
+    if (m_fd >= 0)
+    {
+        tot = RequestBlockDirect(size);
+        if (tot != -2)
+        {
+            if (tot > 0)
+                m_bytesSent += tot;
+            MythTimingStats::Get("filetransfer")->Record(
+                "REQUEST_BLOCK", t.nsecsElapsed() / 1000,
+                std::max(tot, 0), "sendfile");
+            if (m_pginfo)
+                m_pginfo->UpdateInUseMark();
+            return tot;
+        }
+        tot = 0;
+    }
+
     m_requestBuffer.resize(max((size_t)max(size,0) + 128, m_requestBuffer.size()));
     char *buf = &m_requestBuffer[0];
     while (tot < size && !m_rbuffer->GetStopReads() && m_readthreadlive)
@@ -153,6 +436,12 @@ int FileTransfer::RequestBlock(int size)
             break; // we hit eof
     }
 
+    if (tot > 0)
+        m_bytesSent += tot;
+    MythTimingStats::Get("filetransfer")->Record(
+        "REQUEST_BLOCK", t.nsecsElapsed() / 1000,
+        std::max(tot, 0), "ringbuffer");
+
     if (m_pginfo)
         m_pginfo->UpdateInUseMark();
 
@@ -225,13 +514,38 @@ long long FileTransfer::Seek(long long curpos, long long pos, int whence)
     if (m_pginfo)
         m_pginfo->UpdateInUseMark();
 
-    if (!m_rbuffer)
-        return -1;
     if (!m_readthreadlive)
         return -1;
 
     m_ateof = false;
 
+    QMutexLocker locker(&m_lock);
+    if (m_fd >= 0)
+    {
+        long long desired = pos;
+        if (whence == SEEK_CUR)
+            desired = curpos + pos;
+        else if (whence == SEEK_END)
+        {
+            struct stat st {};
+            if (fstat(m_fd, &st) < 0)
+                return -1;
+            desired = st.st_size + pos;
+        }
+
+        if (desired < 0)
+            return -1;
+
+        // Restart the read-ahead window at the new position
+        m_fdPos = desired;
+        m_advisedEnd = desired;
+        return desired;
+    }
+
+    if (!m_rbuffer)
+        return -1;
+    locker.unlock();
+
     Pause();
 
     if (whence == SEEK_CUR)
@@ -257,11 +571,22 @@ uint64_t FileTransfer::GetFileSize(void)
     if (m_pginfo)
         m_pginfo->UpdateInUseMark();
 
+    QMutexLocker locker(&m_lock);
+    if (m_fd >= 0)
+    {
+        struct stat st {};
+        return (fstat(m_fd, &st) == 0) ? st.st_size : 0;
+    }
+
     return m_rbuffer ? m_rbuffer->GetRealFileSize() : 0;
 }
 
 QString FileTransfer::GetFileName(void)
 {
+    QMutexLocker locker(&m_lock);
+    if (m_fd >= 0)
+        return m_filename;
+
     if (!m_rbuffer)
         return QString();
 
@@ -273,6 +598,8 @@ void FileTransfer::SetTimeout(bool fast)
     if (m_pginfo)
         m_pginfo->UpdateInUseMark();
 
+    QMutexLocker locker(&m_lock);
+    m_oldFile = fast;
     if (m_rbuffer)
         m_rbuffer->SetOldFile(fast);
 }
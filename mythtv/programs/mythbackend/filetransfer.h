@@ -8,15 +8,16 @@ using namespace std;
 
 // Qt headers
 #include <QMutex>
+#include <QString>
 #include <QWaitCondition>
 
 // MythTV headers
 #include "referencecounter.h"
+#include "mythtimer.h"
 
 class ProgramInfo;
 class RingBuffer;
 class MythSocket;
-class QString;
 
 class FileTransfer : public ReferenceCounter
 {
@@ -46,9 +47,20 @@ class FileTransfer : public ReferenceCounter
 
     void SetTimeout(bool fast);
 
+    uint64_t GetBytesSent(void) const { return m_bytesSent; }
+    bool IsZeroCopy(void) const { return m_fd >= 0; }
+
   private:
    ~FileTransfer() override;
 
+    bool OpenRingBuffer(void);
+    bool IsInProgress(void) const;
+    bool OpenDirect(const QString &filename);
+    bool CloseDirect(void);
+    int  RequestBlockDirect(int size);
+    void AdviseReadAhead(void);
+    void UpdateRate(int bytes);
+
     volatile bool   m_readthreadlive    {true};
     bool            m_readsLocked       {false};
     QWaitCondition  m_readsUnlockedCond;
@@ -63,6 +75,26 @@ class FileTransfer : public ReferenceCounter
     QMutex          m_lock              {QMutex::NonRecursive};
 
     bool            m_writemode         {false};
+
+    // Needed to open the RingBuffer if the zero-copy path is dropped
+    QString         m_filename;
+    bool            m_usereadahead      {true};
+    int             m_timeoutMs         {2000};
+    bool            m_oldFile           {false};
+
+    // Zero-copy path for plain local files, m_fd is -1 when the
+    // RingBuffer is used instead.
+    int             m_fd                {-1};
+    long long       m_fdSize            {0};
+    long long       m_fdPos             {0};
+    long long       m_advisedEnd        {0};
+
+    // Throughput accounting, protected by m_lock
+    double          m_bytesPerSec       {0.0};
+    MythTimer       m_rateTimer;
+    MythTimer       m_openTimer         {MythTimer::kStartRunning};
+    uint64_t        m_bytesSent         {0};
+    uint            m_requests          {0};
 };
 
 #endif
@@ -62,6 +62,7 @@ using namespace std;
 #include "jobqueue.h"
 #include "autoexpire.h"
 #include "storagegroup.h"
+#include "filedeleter.h"
 #include "compat.h"
 #include "ringbuffer.h"
 #include "remotefile.h"
@@ -74,6 +75,7 @@ using namespace std;
 #include "metadatafactory.h"
 #include "videoutils.h"
 #include "mythlogging.h"
+#include "mythtimingstats.h"
 #include "filesysteminfo.h"
 #include "metaio.h"
 #include "musicmetadata.h"
@@ -90,6 +92,10 @@ using namespace std;
 #define PRT_TIMEOUT 10
 /** Number of threads in process request thread pool at startup. */
 #define PRT_STARTUP_THREAD_COUNT 5
+/** Default upper bound on process request threads, once reached requests
+ *  queue for the next free thread instead of growing the pool further.
+ */
+#define PRT_MAX_THREAD_COUNT 64
 
 #define LOC      QString("MainServer: ")
 #define LOC_WARN QString("MainServer, Warning: ")
@@ -107,6 +113,8 @@ bool delete_file_immediately(const QString &filename,
 
     LOG(VB_FILE, LOG_INFO, LOC +
         QString("About to delete file: %1").arg(filename));
+    StorageGroup::FileRemoved(filename);
+    RemoveFileHash(filename);
     if (followLinks)
     {
         QFileInfo finfo(filename);
@@ -134,14 +142,13 @@ bool delete_file_immediately(const QString &filename,
 
 };
 
-QMutex MainServer::s_truncate_and_close_lock;
 const uint MainServer::kMasterServerReconnectTimeout = 1000; //ms
 
 class ProcessRequestRunnable : public QRunnable
 {
   public:
     ProcessRequestRunnable(MainServer &parent, MythSocket *sock) :
-        m_parent(parent), m_sock(sock)
+        m_parent(parent), m_sock(sock), m_queued(MythTimer::kStartRunning)
     {
         m_sock->IncrRef();
     }
@@ -157,6 +164,8 @@ class ProcessRequestRunnable : public QRunnable
 
     void run(void) override // QRunnable
     {
+        MythTimingStats::Get("protocol")->Record(
+            "(queue wait)", m_queued.nsecsElapsed() / 1000);
         m_parent.ProcessRequest(m_sock);
         m_sock->DecrRef();
         m_sock = nullptr;
@@ -165,6 +174,39 @@ class ProcessRequestRunnable : public QRunnable
   private:
     MainServer &m_parent;
     MythSocket *m_sock;
+    MythTimer   m_queued;
+};
+
+/** \brief Records how long a protocol command took to handle in the
+ *         "protocol" MythTimingStats group when it goes out of scope.
+ */
+class CommandTimer
+{
+  public:
+    CommandTimer(QString command, const QStringList &listline) :
+        m_command(std::move(command)), m_timer(MythTimer::kStartRunning)
+    {
+        // Commands that multiplex several requests carry the real
+        // request in the second item, e.g. QUERY_FILETRANSFER 12.
+        if (listline.size() > 1 &&
+            (m_command == "QUERY_FILETRANSFER" ||
+             m_command == "QUERY_RECORDER" ||
+             m_command == "QUERY_REMOTEENCODER"))
+        {
+            m_detail = listline[1].section(' ', 0, 0);
+        }
+    }
+
+    ~CommandTimer()
+    {
+        MythTimingStats::Get("protocol")->Record(
+            m_command, m_timer.nsecsElapsed() / 1000, 0, m_detail);
+    }
+
+  private:
+    QString   m_command;
+    QString   m_detail;
+    MythTimer m_timer;
 };
 
 class FreeSpaceUpdater : public QRunnable
@@ -248,6 +290,9 @@ MainServer::MainServer(bool master, int port,
     PreviewGeneratorQueue::AddListener(this);
 
     m_threadPool.setMaxThreadCount(PRT_STARTUP_THREAD_COUNT);
+    m_maxRequestThreads = std::max(PRT_STARTUP_THREAD_COUNT,
+        gCoreContext->GetNumSetting("MaxProcessRequestThreads",
+                                    PRT_MAX_THREAD_COUNT));
 
     m_masterBackendOverride =
         gCoreContext->GetBoolSetting("MasterBackendOverride", false);
@@ -322,7 +367,10 @@ MainServer::MainServer(bool master, int port,
         sched->SetMainServer(this);
     }
     if (expirer)
+    {
         expirer->SetMainServer(this);
+        expirer->SetScheduler(sched);
+    }
 
     m_metadatafactory = new MetadataFactory(this);
 
@@ -393,7 +441,10 @@ void MainServer::Stop()
     }
 
     if (m_expirer)
+    {
         m_expirer->SetMainServer(nullptr);
+        m_expirer->SetScheduler(nullptr);
+    }
 
     {
         QMutexLocker locker(&m_masterFreeSpaceListLock);
@@ -404,6 +455,8 @@ void MainServer::Stop()
         }
     }
 
+    FileDeleter::Shutdown();
+
     // Close all open sockets
     QWriteLocker locker(&m_sockListLock);
 
@@ -443,13 +496,47 @@ void MainServer::NewConnection(qt_socket_fd_t socketDescriptor)
 
 void MainServer::readyRead(MythSocket *sock)
 {
-    m_threadPool.startReserved(
-        new ProcessRequestRunnable(*this, sock),
-        "ProcessRequest", PRT_TIMEOUT);
+    StartRequest(sock);
 
     QCoreApplication::processEvents();
 }
 
+/** \brief Hands a readable socket to a request thread.
+ *
+ *  The pool grows on demand so one slow request cannot stall the others,
+ *  but past m_maxRequestThreads requests in flight a request waits for
+ *  the next free thread so a burst of clients cannot balloon the thread
+ *  count without bound. Pool threads stay around idle for a while, so
+ *  the requests are counted here rather than asking the pool.
+ *
+ *  Requests from slave backends and media servers never wait, they may be
+ *  made while handling a request that is itself holding a thread.
+ */
+void MainServer::StartRequest(MythSocket *sock)
+{
+    bool reserve = m_requestsInFlight.fetchAndAddOrdered(1) <
+        m_maxRequestThreads;
+
+    if (!reserve)
+    {
+        QReadLocker locker(&m_sockListLock);
+        PlaybackSock *pbs = GetPlaybackBySock(sock);
+        reserve = pbs && (pbs->isSlaveBackend() || pbs->isMediaServer());
+    }
+
+    if (reserve)
+    {
+        m_threadPool.startReserved(
+            new ProcessRequestRunnable(*this, sock),
+            "ProcessRequest", PRT_TIMEOUT);
+    }
+    else
+    {
+        m_threadPool.start(
+            new ProcessRequestRunnable(*this, sock), "ProcessRequest");
+    }
+}
+
 void MainServer::ProcessRequest(MythSocket *sock)
 {
     if (sock->IsDataAvailable())
@@ -457,6 +544,8 @@ void MainServer::ProcessRequest(MythSocket *sock)
     else
         LOG(VB_GENERAL, LOG_INFO, LOC + QString("No data on sock %1")
             .arg(sock->GetSocketDescriptor()));
+
+    m_requestsInFlight.deref();
 }
 
 void MainServer::ProcessRequestWork(MythSocket *sock)
@@ -469,33 +558,59 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     bool bIsControl = (pbs) ? false : m_controlSocketList.contains(sock);
     m_sockListLock.unlock();
 
-    QStringList listline;
-    if (pbs)
+    // On a pipelined socket the client doesn't wait for our reply before
+    // sending its next request. Only one thread reads at a time, and it
+    // hands any further request to another thread before handling its own
+    // so that a slow request doesn't hold up the ones behind it.
+    bool pipelined = sock->IsPipelined();
+    if (pipelined)
     {
-        if (!pbs->ReadStringList(listline) || listline.empty())
+        QMutexLocker locker(&m_pipelineReadLock);
+        if (m_pipelineReading.contains(sock))
         {
-            pbs->DecrRef();
-            LOG(VB_GENERAL, LOG_INFO, "No data in ProcessRequestWork()");
+            if (pbs)
+                pbs->DecrRef();
             return;
         }
+        m_pipelineReading.insert(sock);
+    }
+
+    QStringList listline;
+    bool ok = false;
+    if (pbs)
+    {
+        ok = pbs->ReadStringList(listline) && !listline.empty();
         pbs->DecrRef();
+        if (!ok)
+            LOG(VB_GENERAL, LOG_INFO, "No data in ProcessRequestWork()");
     }
-    else if (!bIsControl)
+    else if (bIsControl)
     {
-        // The socket has been disconnected
-        return;
+        ok = sock->ReadStringList(listline) && !listline.empty();
+        if (!ok)
+            LOG(VB_GENERAL, LOG_INFO, LOC + "No data in ProcessRequestWork()");
     }
-    else if (!sock->ReadStringList(listline) || listline.empty())
+    // else the socket has been disconnected
+
+    if (pipelined)
     {
-        LOG(VB_GENERAL, LOG_INFO, LOC + "No data in ProcessRequestWork()");
-        return;
+        {
+            QMutexLocker locker(&m_pipelineReadLock);
+            m_pipelineReading.remove(sock);
+        }
+        if (ok && sock->IsDataAvailable())
+            StartRequest(sock);
     }
 
+    if (!ok)
+        return;
+
     QString line = listline[0];
 
     line = line.simplified();
     QStringList tokens = line.split(' ', QString::SkipEmptyParts);
     QString command = tokens[0];
+    CommandTimer commandTimer(command, listline);
 
     if (command == "MYTH_PROTO_VERSION")
     {
@@ -577,6 +692,10 @@ void MainServer::ProcessRequestWork(MythSocket *sock)
     {
         HandleQueryMemStats(pbs);
     }
+    else if (command == "QUERY_TIMING_STATS")
+    {
+        HandleQueryTimingStats(listline, pbs);
+    }
     else if (command == "QUERY_TIME_ZONE")
     {
         HandleQueryTimeZone(pbs);
@@ -1236,12 +1355,15 @@ void MainServer::customEvent(QEvent *e)
             QStringList tokens = me->Message()
                 .split(" ", QString::SkipEmptyParts);
 
-            if (tokens.size() != 3)
+            if (tokens.size() != 3 && tokens.size() != 4)
             {
                 LOG(VB_GENERAL, LOG_ERR, LOC + "Bad AUTO_EXPIRE message");
                 return;
             }
 
+            // Recordings expired ahead of time are deleted slowly
+            bool slowDelete = (tokens.size() == 4) && (tokens[3] == "SLOW");
+
             QDateTime startts = MythDate::fromString(tokens[2]);
             RecordingInfo recInfo(tokens[1].toUInt(), startts);
 
@@ -1258,7 +1380,8 @@ void MainServer::customEvent(QEvent *e)
                 {
                     recInfo.ForgetHistory();
                 }
-                DoHandleDeleteRecording(recInfo, nullptr, false, true, false);
+                DoHandleDeleteRecording(recInfo, nullptr, false, true, false,
+                                        slowDelete);
             }
             else
             {
@@ -1633,8 +1756,15 @@ void MainServer::customEvent(QEvent *e)
 /**
  * \addtogroup myth_network_protocol
  * \par        MYTH_PROTO_VERSION \e version \e token
+ * \par        MYTH_PROTO_VERSION \e version \e token [BINARY] [PIPELINE]
  * Checks that \e version and \e token match the backend's version.
  * If it matches, the stringlist of "ACCEPT" \e "version" is returned.
+ * If the client asked for BINARY framing, "BINARY" is appended to the
+ * reply and all following messages on the socket use length-prefixed
+ * fields (see MythSocketFraming).
+ * If the client asked for PIPELINE, "PIPELINE" is appended to the reply
+ * and every following request and reply starts with a request ID, so the
+ * client may send further requests before the first one is answered.
  * If it does not, "REJECT" \e "version" is returned,
  * and the socket is closed (for this client)
  */
@@ -1678,7 +1808,18 @@ void MainServer::HandleVersion(MythSocket *socket, const QStringList &slist)
     }
 
     retlist << "ACCEPT" << MYTH_PROTO_VERSION;
-    socket->WriteStringList(retlist);
+
+    QStringList options = slist.mid(3);
+    bool binary = options.contains(MythSocketFraming::kBinaryToken);
+    bool pipeline = options.contains(MythSocketFraming::kPipelineToken);
+    if (binary)
+        retlist << MythSocketFraming::kBinaryToken;
+    if (pipeline)
+        retlist << MythSocketFraming::kPipelineToken;
+    socket->WriteStringListAndSwitch(
+        retlist,
+        binary ? MythSocketFraming::kBinary : MythSocketFraming::kLegacy,
+        pipeline ? MythSocket::kPipelineServer : MythSocket::kNotPipelined);
 }
 
 /**
@@ -2116,6 +2257,14 @@ void MainServer::SendResponse(MythSocket *socket, QStringList &commands)
     }
 }
 
+/// Program lists are sent as ProgramInfo::ToDataStream() data to clients
+/// that negotiated binary framing, see ProgramListToStringList().
+static bool IsTypedSocket(const MythSocket *socket)
+{
+    return socket &&
+        (socket->GetFramingMode() == MythSocketFraming::kBinary);
+}
+
 /**
  * \addtogroup myth_network_protocol
  * \par        QUERY_RECORDINGS \e type
@@ -2123,6 +2272,11 @@ void MainServer::SendResponse(MythSocket *socket, QStringList &commands)
  * or "Descending".
  * Returns programinfo (title, subtitle, description, category, chanid,
  * channum, callsign, channel.name, fileURL, \e et \e cetera)
+ * On sockets using binary framing the count is preceded by
+ * PROGRAMINFO_STREAM and followed by one field holding the programs'
+ * ProgramInfo::ToDataStream() encoding. The same goes for the lists
+ * returned by QUERY_GETALLPENDING, QUERY_GETALLSCHEDULED,
+ * QUERY_GETCONFLICTING and QUERY_GETEXPIRING.
  */
 void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs)
 {
@@ -2154,7 +2308,6 @@ void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs)
     for (; mit != recMap.end(); mit = recMap.erase(mit))
         delete *mit;
 
-    QStringList outputlist(QString::number(destination.size()));
     QMap<QString, int> backendPortMap;
     int port = gCoreContext->GetBackendServerPort();
     QString host = gCoreContext->GetHostName();
@@ -2241,10 +2394,10 @@ void MainServer::HandleQueryRecordings(const QString& type, PlaybackSock *pbs)
 
         if (slave)
             slave->DecrRef();
-
-        proginfo->ToStringList(outputlist);
     }
 
+    QStringList outputlist;
+    ProgramListToStringList(destination, outputlist, IsTypedSocket(pbssock));
     SendResponse(pbssock, outputlist);
 }
 
@@ -2408,7 +2561,8 @@ void MainServer::DoDeleteThread(DeleteStruct *ds)
         tvchain->DeleteProgram(&pginfo);
 
     bool followLinks = gCoreContext->GetBoolSetting("DeletesFollowLinks", false);
-    bool slowDeletes = gCoreContext->GetBoolSetting("TruncateDeletesSlowly", false);
+    bool slowDeletes = ds->m_slowDelete ||
+        gCoreContext->GetBoolSetting("TruncateDeletesSlowly", false);
     int fd = -1;
     off_t size = 0;
     bool errmsg = false;
@@ -2482,7 +2636,14 @@ void MainServer::DoDeleteThread(DeleteStruct *ds)
     m_deletelock.unlock();
 
     if (slowDeletes && fd >= 0)
-        TruncateAndClose(&pginfo, fd, ds->m_filename, size);
+    {
+        FileDeleter::Priority priority = FileDeleter::kNormal;
+        if (pginfo.GetRecordingGroup() == "LiveTV")
+            priority = FileDeleter::kLiveTV;
+        else if (ds->m_slowDelete)
+            priority = FileDeleter::kBackground;
+        FileDeleter::Queue(fd, ds->m_filename, size, priority, &pginfo);
+    }
 }
 
 void MainServer::DeleteRecordedFiles(DeleteStruct *ds)
@@ -2618,7 +2779,7 @@ void MainServer::DoDeleteInDB(DeleteStruct *ds)
 /**
  *  \brief Deletes links and unlinks the main file and returns the descriptor.
  *
- *  This is meant to be used with TruncateAndClose() to slowly shrink a
+ *  This is meant to be used with FileDeleter::Queue() to slowly shrink a
  *  large file and then eventually delete the file by closing the file
  *  descriptor.
  *
@@ -2635,6 +2796,8 @@ int MainServer::DeleteFile(const QString &filename, bool followLinks,
     LOG(VB_FILE, LOG_INFO, LOC +
         QString("About to unlink/delete file: '%1'")
             .arg(fname.constData()));
+    StorageGroup::FileRemoved(filename);
+    RemoveFileHash(filename);
 
     QString errmsg = QString("Delete Error '%1'").arg(fname.constData());
     if (finfo.isSymLink())
@@ -2703,87 +2866,6 @@ int MainServer::OpenAndUnlink(const QString &filename)
     return fd;
 }
 
-/**
- *  \brief Repeatedly truncate an open file in small increments.
- *
- *   When the file is small enough this closes the file and returns.
- *
- *   NOTE: This acquires a lock so that only one instance of TruncateAndClose()
- *         is running at a time.
- */
-bool MainServer::TruncateAndClose(ProgramInfo *pginfo, int fd,
-                                  const QString &filename, off_t fsize)
-{
-    QMutexLocker locker(&s_truncate_and_close_lock);
-
-    if (pginfo)
-    {
-        pginfo->SetPathname(filename);
-        pginfo->MarkAsInUse(true, kTruncatingDeleteInUseID);
-    }
-
-    int cards = 5;
-    {
-        MSqlQuery query(MSqlQuery::InitCon());
-        query.prepare("SELECT COUNT(cardid) FROM capturecard;");
-        if (query.exec() && query.next())
-            cards = query.value(0).toInt();
-    }
-
-    // Time between truncation steps in milliseconds
-    const size_t sleep_time = 500;
-    const size_t min_tps    = 8 * 1024 * 1024;
-    const auto calc_tps     = (size_t) (cards * 1.2 * (22200000LL / 8.0));
-    const size_t tps = max(min_tps, calc_tps);
-    const auto increment    = (size_t) (tps * (sleep_time * 0.001F));
-
-    LOG(VB_FILE, LOG_INFO, LOC +
-        QString("Truncating '%1' by %2 MB every %3 milliseconds")
-            .arg(filename)
-            .arg(increment / (1024.0 * 1024.0), 0, 'f', 2)
-            .arg(sleep_time));
-
-    GetMythDB()->GetDBManager()->PurgeIdleConnections(false);
-
-    int count = 0;
-    while (fsize > 0)
-    {
-#if 0
-        LOG(VB_FILE, LOG_DEBUG, LOC + QString("Truncating '%1' to %2 MB")
-                .arg(filename).arg(fsize / (1024.0 * 1024.0), 0, 'f', 2));
-#endif
-
-        int err = ftruncate(fd, fsize);
-        if (err)
-        {
-            LOG(VB_GENERAL, LOG_ERR, LOC + QString("Error truncating '%1'")
-                    .arg(filename) + ENO);
-            if (pginfo)
-                pginfo->MarkAsInUse(false, kTruncatingDeleteInUseID);
-            return 0 == close(fd);
-        }
-
-        fsize -= increment;
-
-        if (pginfo && ((count % 100) == 0))
-            pginfo->UpdateInUseMark(true);
-
-        count++;
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep_time));
-    }
-
-    bool ok = (0 == close(fd));
-
-    if (pginfo)
-        pginfo->MarkAsInUse(false, kTruncatingDeleteInUseID);
-
-    LOG(VB_FILE, LOG_INFO, LOC +
-        QString("Finished truncating '%1'").arg(filename));
-
-    return ok;
-}
-
 void MainServer::HandleCheckRecordingActive(QStringList &slist,
                                             PlaybackSock *pbs)
 {
@@ -2984,7 +3066,8 @@ void MainServer::HandleDeleteRecording(QStringList &slist, PlaybackSock *pbs,
 
 void MainServer::DoHandleDeleteRecording(
     RecordingInfo &recinfo, PlaybackSock *pbs,
-    bool forceMetadataDelete, bool lexpirer, bool forgetHistory)
+    bool forceMetadataDelete, bool lexpirer, bool forgetHistory,
+    bool slowDelete)
 {
     int resultCode = -1;
     MythSocket *pbssock = nullptr;
@@ -3086,7 +3169,7 @@ void MainServer::DoHandleDeleteRecording(
             recinfo.GetTitle(), recinfo.GetChanID(),
             recinfo.GetRecordingStartTime(), recinfo.GetRecordingEndTime(),
             recinfo.GetRecordingID(),
-            forceMetadataDelete);
+            forceMetadataDelete, slowDelete);
         deleteThread->start();
     }
     else
@@ -3544,6 +3627,57 @@ void MainServer::HandleQueryMemStats(PlaybackSock *pbs)
     SendResponse(pbssock, strlist);
 }
 
+/**
+ * \addtogroup myth_network_protocol
+ * \par        QUERY_TIMING_STATS \e group \e count
+ * Returns the start time of the statistics in \e group (e.g. "protocol"
+ * or "database") followed by name, detail, count, total, p50, p99 and
+ * max (all in microseconds) and rows for each of the \e count most
+ * expensive entries, or all of them if \e count is 0 or missing.
+ * Returns "ERROR" if nothing has recorded statistics in \e group.
+ */
+void MainServer::HandleQueryTimingStats(QStringList &slist, PlaybackSock *pbs)
+{
+    MythSocket *pbssock = pbs->getSocket();
+    QStringList strlist;
+
+    if (slist.size() < 2 || slist[1].isEmpty())
+    {
+        strlist << "ERROR" << "No statistics group given.";
+        SendResponse(pbssock, strlist);
+        return;
+    }
+
+    MythTimingStats *stats = MythTimingStats::Find(slist[1]);
+    if (!stats)
+    {
+        strlist << "ERROR" << "Unknown statistics group.";
+        SendResponse(pbssock, strlist);
+        return;
+    }
+
+    int count = (slist.size() > 2) ? slist[2].toInt() : 0;
+
+    QList<MythTimingStats::Entry> entries = stats->Snapshot();
+    if (count <= 0 || count > entries.size())
+        count = entries.size();
+
+    strlist << stats->GetStartTime().toString(Qt::ISODate);
+    for (int i = 0; i < count; i++)
+    {
+        const MythTimingStats::Entry &entry = entries[i];
+        strlist << entry.m_name << entry.m_detail
+                << QString::number(entry.m_count)
+                << QString::number(entry.m_totalUsecs)
+                << QString::number(entry.m_p50Usecs)
+                << QString::number(entry.m_p99Usecs)
+                << QString::number(entry.m_maxUsecs)
+                << QString::number(entry.m_rows);
+    }
+
+    SendResponse(pbssock, strlist);
+}
+
 /**
  * \addtogroup myth_network_protocol
  * \par        QUERY_TIME_ZONE
@@ -3659,7 +3793,7 @@ void MainServer::HandleQueryFileHash(QStringList &slist, PlaybackSock *pbs)
     {
         StorageGroup sgroup(storageGroup, gCoreContext->GetHostName());
         QString fullname = sgroup.FindFile(filename);
-        hash = FileHash(fullname);
+        hash = CachedFileHash(fullname);
     }
     else
     {
@@ -3777,16 +3911,17 @@ void MainServer::HandleGetPendingRecordings(PlaybackSock *pbs,
     MythSocket *pbssock = pbs->getSocket();
 
     QStringList strList;
+    bool typed = IsTypedSocket(pbssock);
 
     if (m_sched)
     {
         if (tmptable.isEmpty())
-            m_sched->GetAllPending(strList);
+            m_sched->GetAllPending(strList, typed);
         else
         {
             auto *sched = new Scheduler(false, m_encoderList, tmptable, m_sched);
             sched->FillRecordListFromDB(recordid);
-            sched->GetAllPending(strList);
+            sched->GetAllPending(strList, typed);
             delete sched;
 
             if (recordid > 0)
@@ -3830,7 +3965,10 @@ void MainServer::HandleGetScheduledRecordings(PlaybackSock *pbs)
     QStringList strList;
 
     if (m_sched)
-        Scheduler::GetAllScheduled(strList);
+    {
+        Scheduler::GetAllScheduled(strList, Scheduler::kSortTitle, true,
+                                   IsTypedSocket(pbssock));
+    }
     else
         strList << QString::number(0);
 
@@ -3848,7 +3986,7 @@ void MainServer::HandleGetConflictingRecordings(QStringList &slist,
     QStringList strlist;
 
     if (m_sched && recinfo.GetChanID())
-        m_sched->getConflicting(&recinfo, strlist);
+        m_sched->getConflicting(&recinfo, strlist, IsTypedSocket(pbssock));
     else
         strlist << QString::number(0);
 
@@ -3862,7 +4000,7 @@ void MainServer::HandleGetExpiringRecordings(PlaybackSock *pbs)
     QStringList strList;
 
     if (m_expirer)
-        m_expirer->GetAllExpiring(strList);
+        m_expirer->GetAllExpiring(strList, IsTypedSocket(pbssock));
     else
         strList << QString::number(0);
 
@@ -5489,25 +5627,6 @@ void RenameThread::run()
     m_ms.SendResponse(m_pbs.getSocket(), retlist);
 }
 
-void TruncateThread::run(void)
-{
-    if (m_ms)
-        m_ms->DoTruncateThread(this);
-}
-
-void MainServer::DoTruncateThread(DeleteStruct *ds)
-{
-    if (gCoreContext->GetBoolSetting("TruncateDeletesSlowly", false))
-    {
-        TruncateAndClose(nullptr, ds->m_fd, ds->m_filename, ds->m_size);
-    }
-    else
-    {
-        QMutexLocker dl(&m_deletelock);
-        close(ds->m_fd);
-    }
-}
-
 bool MainServer::HandleDeleteFile(QStringList &slist, PlaybackSock *pbs)
 {
     return HandleDeleteFile(slist[1], slist[2], pbs);
@@ -5579,9 +5698,15 @@ bool MainServer::HandleDeleteFile(const QString& filename, const QString& storag
     // DeleteFile() opened up a file for us to delete
     if (fd >= 0)
     {
-        // Thread off the actual file truncate
-        auto *truncateThread = new TruncateThread(this, fullfile, fd, size);
-        truncateThread->run();
+        if (gCoreContext->GetBoolSetting("TruncateDeletesSlowly", false))
+        {
+            FileDeleter::Queue(fd, fullfile, size, FileDeleter::kNormal);
+        }
+        else
+        {
+            QMutexLocker dl(&m_deletelock);
+            close(fd);
+        }
     }
 
     return true;
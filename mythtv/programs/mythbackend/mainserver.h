@@ -46,16 +46,11 @@ class DeleteStruct
     DeleteStruct(MainServer *ms, QString  filename, QString  title,
                  uint chanid, QDateTime recstartts, QDateTime recendts,
                  uint recordedId,
-                 bool forceMetadataDelete) : 
+                 bool forceMetadataDelete, bool slowDelete = false) : 
         m_ms(ms), m_filename(std::move(filename)), m_title(std::move(title)),
         m_chanid(chanid), m_recstartts(std::move(recstartts)),
         m_recendts(std::move(recendts)), m_recordedid(recordedId),
-        m_forceMetadataDelete(forceMetadataDelete)
-    {
-    }
-
-    DeleteStruct(MainServer *ms, QString  filename, int fd, off_t size) :
-        m_ms(ms), m_filename(std::move(filename)), m_fd(fd), m_size(size)
+        m_forceMetadataDelete(forceMetadataDelete), m_slowDelete(slowDelete)
     {
     }
 
@@ -68,8 +63,7 @@ class DeleteStruct
     QDateTime   m_recendts;
     uint        m_recordedid          {0};
     bool        m_forceMetadataDelete {false};
-    int         m_fd                  {-1};
-    off_t       m_size                {0};
+    bool        m_slowDelete          {false};
 };
 
 class DeleteThread : public QRunnable, public DeleteStruct
@@ -77,24 +71,15 @@ class DeleteThread : public QRunnable, public DeleteStruct
   public:
     DeleteThread(MainServer *ms, const QString& filename, const QString& title, uint chanid,
                  QDateTime recstartts, QDateTime recendts, uint recordingId,
-                 bool forceMetadataDelete) :
+                 bool forceMetadataDelete, bool slowDelete = false) :
                      DeleteStruct(ms, filename, title, chanid, std::move(recstartts),
-                                  std::move(recendts), recordingId, forceMetadataDelete)  {}
+                                  std::move(recendts), recordingId, forceMetadataDelete,
+                                  slowDelete)  {}
     void start(void)
         { MThreadPool::globalInstance()->startReserved(this, "DeleteThread"); }
     void run(void) override; // QRunnable
 };
 
-class TruncateThread : public QRunnable, public DeleteStruct
-{
-  public:
-    TruncateThread(MainServer *ms, const QString& filename, int fd, off_t size) :
-                DeleteStruct(ms, filename, fd, size)  {}
-    void start(void)
-        { MThreadPool::globalInstance()->start(this, "Truncate"); }
-    void run(void) override; // QRunnable
-};
-
 class RenameThread : public QRunnable
 {
 public:
@@ -116,7 +101,6 @@ class MainServer : public QObject, public MythSocketCBs
     Q_OBJECT
 
     friend class DeleteThread;
-    friend class TruncateThread;
     friend class FreeSpaceUpdater;
     friend class RenameThread;
   public:
@@ -164,6 +148,7 @@ class MainServer : public QObject, public MythSocketCBs
 
   private:
 
+    void StartRequest(MythSocket *sock);
     void ProcessRequestWork(MythSocket *sock);
     void HandleAnnounce(QStringList &slist, QStringList commands,
                         MythSocket *socket);
@@ -188,7 +173,8 @@ class MainServer : public QObject, public MythSocketCBs
                                bool forceMetadataDelete);
     void DoHandleDeleteRecording(RecordingInfo &recinfo, PlaybackSock *pbs,
                                  bool forceMetadataDelete, bool expirer=false,
-                                 bool forgetHistory=false);
+                                 bool forgetHistory=false,
+                                 bool slowDelete=false);
     void HandleUndeleteRecording(QStringList &slist, PlaybackSock *pbs);
     void DoHandleUndeleteRecording(RecordingInfo &recinfo, PlaybackSock *pbs);
     void HandleForgetRecording(QStringList &slist, PlaybackSock *pbs);
@@ -266,6 +252,7 @@ class MainServer : public QObject, public MythSocketCBs
     void HandleQueryUptime(PlaybackSock *pbs);
     void HandleQueryHostname(PlaybackSock *pbs);
     void HandleQueryMemStats(PlaybackSock *pbs);
+    void HandleQueryTimingStats(QStringList &slist, PlaybackSock *pbs);
     void HandleQueryTimeZone(PlaybackSock *pbs);
     void HandleBlockShutdown(bool blockShutdown, PlaybackSock *pbs);
     void HandleDownloadFile(const QStringList &command, PlaybackSock *pbs);
@@ -289,7 +276,6 @@ class MainServer : public QObject, public MythSocketCBs
 
     int GetfsID(const QList<FileSystemInfo>::iterator& fsInfo);
 
-    void DoTruncateThread(DeleteStruct *ds);
     void DoDeleteThread(DeleteStruct *ds);
     static void DeleteRecordedFiles(DeleteStruct *ds);
     static void DoDeleteInDB(DeleteStruct *ds);
@@ -305,9 +291,6 @@ class MainServer : public QObject, public MythSocketCBs
     static int  DeleteFile(const QString &filename, bool followLinks,
                            bool deleteBrokenSymlinks = false);
     static int  OpenAndUnlink(const QString &filename);
-    static bool TruncateAndClose(ProgramInfo *pginfo,
-                                 int fd, const QString &filename,
-                                 off_t fsize);
 
     vector<LiveTVChain*> m_liveTVChains;
     QMutex               m_liveTVChainsLock;
@@ -323,6 +306,9 @@ class MainServer : public QObject, public MythSocketCBs
     QSet<MythSocket*>      m_controlSocketList;
     vector<MythSocket*>    m_decrRefSocketList;
 
+    QMutex                 m_pipelineReadLock;
+    QSet<MythSocket*>      m_pipelineReading; // protected by m_pipelineReadLock
+
     QMutex                      m_masterFreeSpaceListLock;
     FreeSpaceUpdater * volatile m_masterFreeSpaceListUpdater {nullptr};
     QWaitCondition              m_masterFreeSpaceListWait;
@@ -335,6 +321,8 @@ class MainServer : public QObject, public MythSocketCBs
 
     QMutex m_deletelock;
     MThreadPool m_threadPool;
+    int m_maxRequestThreads                  {0};
+    QAtomicInt m_requestsInFlight            {0};
 
     bool m_masterBackendOverride             {false};
 
@@ -353,7 +341,6 @@ class MainServer : public QObject, public MythSocketCBs
     MythDeque<DeferredDeleteStruct> m_deferredDeleteList;
 
     QTimer *m_autoexpireUpdateTimer          {nullptr}; // audited ref #5318
-    static QMutex s_truncate_and_close_lock;
 
     QMap<QString, int>    m_fsIDcache;
     QMutex                m_fsIDcacheLock;
@@ -1693,18 +1693,17 @@ void Scheduler::UpdateNextRecord(void)
     }
 }
 
-void Scheduler::getConflicting(RecordingInfo *pginfo, QStringList &strlist)
+void Scheduler::getConflicting(RecordingInfo *pginfo, QStringList &strlist,
+                               bool typed)
 {
     RecList retlist;
     getConflicting(pginfo, &retlist);
 
-    strlist << QString::number(retlist.size());
+    ProgramListToStringList(retlist, strlist, typed);
 
     while (!retlist.empty())
     {
-        RecordingInfo *p = retlist.front();
-        p->ToStringList(strlist);
-        delete p;
+        delete retlist.front();
         retlist.pop_front();
     }
 }
@@ -1797,37 +1796,41 @@ RecStatus::Type Scheduler::GetRecStatus(const ProgramInfo &pginfo)
 }
 
 void Scheduler::GetAllPending(QStringList &strList) const
+{
+    GetAllPending(strList, false);
+}
+
+/// Returns all pending programs serialized into a QStringList, as
+/// ProgramInfo::ToDataStream() data if typed is set
+void Scheduler::GetAllPending(QStringList &strList, bool typed) const
 {
     RecList retlist;
     bool hasconflicts = GetAllPending(retlist);
 
     strList << QString::number(hasconflicts);
-    strList << QString::number(retlist.size());
+    ProgramListToStringList(retlist, strList, typed);
 
     while (!retlist.empty())
     {
-        RecordingInfo *p = retlist.front();
-        p->ToStringList(strList);
-        delete p;
+        delete retlist.front();
         retlist.pop_front();
     }
 }
 
-/// Returns all scheduled programs serialized into a QStringList
+/// Returns all scheduled programs serialized into a QStringList, as
+/// ProgramInfo::ToDataStream() data if typed is set
 void Scheduler::GetAllScheduled(QStringList &strList, SchedSortColumn sortBy,
-                                bool ascending)
+                                bool ascending, bool typed)
 {
     RecList schedlist;
 
     GetAllScheduled(schedlist, sortBy, ascending);
 
-    strList << QString::number(schedlist.size());
+    ProgramListToStringList(schedlist, strList, typed);
 
     while (!schedlist.empty())
     {
-        RecordingInfo *pginfo = schedlist.front();
-        pginfo->ToStringList(strList);
-        delete pginfo;
+        delete schedlist.front();
         schedlist.pop_front();
     }
 }
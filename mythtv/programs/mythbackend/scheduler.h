@@ -80,18 +80,20 @@ class Scheduler : public MThread, public MythScheduler
     bool GetAllPending(RecList &retList, int recRuleId = 0) const;
     bool GetAllPending(ProgramList &retList, int recRuleId = 0) const;
     void GetAllPending(QStringList &strList) const override; // MythScheduler
+    void GetAllPending(QStringList &strList, bool typed) const;
     QMap<QString,ProgramInfo*> GetRecording(void) const override; // MythScheduler
 
     enum SchedSortColumn { kSortTitle, kSortLastRecorded, kSortNextRecording,
                            kSortPriority, kSortType };
     static void GetAllScheduled(QStringList &strList,
                                 SchedSortColumn sortBy = kSortTitle,
-                                bool ascending = true);
+                                bool ascending = true, bool typed = false);
     static void GetAllScheduled(RecList &proglist,
                                 SchedSortColumn sortBy = kSortTitle,
                                 bool ascending = true);
 
-    void getConflicting(RecordingInfo *pginfo, QStringList &strlist);
+    void getConflicting(RecordingInfo *pginfo, QStringList &strlist,
+                        bool typed = false);
     void getConflicting(RecordingInfo *pginfo, RecList *retlist);
 
     void PrintList(bool onlyFutureRecordings = false)
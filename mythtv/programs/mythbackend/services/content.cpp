@@ -814,7 +814,7 @@ QString Content::GetHash( const QString &sStorageGroup,
     StorageGroup sgroup(storageGroup, gCoreContext->GetHostName());
 
     QString fullname = sgroup.FindFile(sFileName);
-    QString hash = FileHash(fullname);
+    QString hash = CachedFileHash(fullname);
 
     if (hash == "NULL")
         return QString();
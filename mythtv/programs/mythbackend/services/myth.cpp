@@ -45,8 +45,10 @@
 #include "mythtimezone.h"
 #include "mythdate.h"
 #include "mythversion.h"
+#include "mythtimingstats.h"
 #include "serviceUtil.h"
 #include "scheduler.h"
+#include "filedeleter.h"
 
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -1152,3 +1154,128 @@ bool Myth::ManageUrlProtection( const QString &sServices,
     return gCoreContext->SaveSettingOnHost("HTTP/Protected/Urls",
                                            protectedURLs.join(';'), "");
 }
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+static DTC::TimingStatList* FillTimingStatList( const QString &group,
+                                                int nCount )
+{
+    // ----------------------------------------------------------------------
+    // Copy out the histograms, the statistics keep counting while we
+    // build the response.
+    // ----------------------------------------------------------------------
+
+    MythTimingStats *stats = MythTimingStats::Find(group);
+    auto *pList = new DTC::TimingStatList();
+
+    pList->setGroup( group );
+
+    // Nothing has been recorded in this group yet
+    if (stats == nullptr)
+        return pList;
+
+    pList->setStartTime( stats->GetStartTime() );
+
+    QList<MythTimingStats::Entry> entries = stats->Snapshot();
+    if (nCount > 0 && nCount < entries.size())
+        entries.erase(entries.begin() + nCount, entries.end());
+
+    for (const auto & entry : entries)
+    {
+        DTC::TimingStat *pStat = pList->AddNewTimingStat();
+
+        pStat->setName   ( entry.m_name                );
+        pStat->setDetail ( entry.m_detail              );
+        pStat->setCount  ( entry.m_count               );
+        pStat->setTotalMS( entry.m_totalUsecs / 1000.0 );
+        pStat->setMeanMS ( entry.MeanUsecs() / 1000.0  );
+        pStat->setP50MS  ( entry.m_p50Usecs / 1000.0   );
+        pStat->setP99MS  ( entry.m_p99Usecs / 1000.0   );
+        pStat->setMaxMS  ( entry.m_maxUsecs / 1000.0   );
+        pStat->setRows   ( entry.m_rows                );
+    }
+
+    return pList;
+}
+
+DTC::TimingStatList* Myth::GetTimingStats( const QString &sGroup )
+{
+    QString group = sGroup.isEmpty() ? QString("protocol") : sGroup;
+
+    if (!sGroup.isEmpty() && MythTimingStats::Find( group ) == nullptr)
+        throw( QString("Unknown statistics group") );
+
+    return FillTimingStatList( group, 0 );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+DTC::TimingStatList* Myth::GetDatabaseProfile( int nCount )
+{
+    // Query templates with the function that ran them in Detail,
+    // most expensive first.
+    return FillTimingStatList( "database", nCount );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+bool Myth::ResetTimingStats( const QString &sGroup )
+{
+    if (sGroup.isEmpty())
+        throw( QString("Group is required") );
+
+    MythTimingStats *stats = MythTimingStats::Find(sGroup);
+    if (stats == nullptr)
+        throw( QString("Unknown statistics group") );
+
+    stats->Reset();
+
+    return true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//
+/////////////////////////////////////////////////////////////////////////////
+
+DTC::DeleteJobList* Myth::GetDeleteQueue( )
+{
+    QList<FileDeleter::JobStatus> jobs;
+    FileDeleter::Stats            stats;
+
+    // Don't start the FileDeleter just to report that it is idle
+    FileDeleter::GetStatusIfRunning(jobs, stats);
+
+    auto *pList = new DTC::DeleteJobList();
+
+    pList->setStartTime   ( stats.m_startTime    );
+    pList->setBytesPerSec ( stats.m_bytesPerSec  );
+    pList->setDeletedFiles( stats.m_deletedFiles );
+    pList->setDeletedBytes( stats.m_deletedBytes );
+
+    qlonglong queuedBytes = 0;
+
+    for (const auto & job : jobs)
+    {
+        DTC::DeleteJob *pJob = pList->AddNewDeleteJob();
+
+        pJob->setFileName  ( job.m_filename );
+        pJob->setFileSystem( static_cast<qlonglong>(job.m_device) );
+        pJob->setPriority  ( FileDeleter::PriorityToString(job.m_priority) );
+        pJob->setSize      ( job.m_size );
+        pJob->setRemaining ( job.m_remaining );
+        pJob->setQueuedTime( job.m_queued );
+        pJob->setStarted   ( job.m_started );
+
+        queuedBytes += job.m_remaining;
+    }
+
+    pList->setQueuedBytes( queuedBytes );
+
+    return pList;
+}
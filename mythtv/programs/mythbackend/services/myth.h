@@ -151,6 +151,14 @@ class Myth : public MythServices
 
         bool                ManageUrlProtection  ( const QString &Services,
                                                    const QString &AdminPassword ) override; // MythServices
+
+        DTC::TimingStatList* GetTimingStats     ( const QString &Group ) override; // MythServices
+
+        bool                ResetTimingStats    ( const QString &Group ) override; // MythServices
+
+        DTC::TimingStatList* GetDatabaseProfile ( int Count ) override; // MythServices
+
+        DTC::DeleteJobList* GetDeleteQueue      ( ) override; // MythServices
 };
 
 // --------------------------------------------------------------------------
@@ -434,6 +442,34 @@ class ScriptableMyth : public QObject
                 return m_obj.ManageUrlProtection( Services, AdminPassword );
             )
         }
+
+        QObject* GetTimingStats( const QString &Group )
+        {
+            SCRIPT_CATCH_EXCEPTION( nullptr,
+                return m_obj.GetTimingStats( Group );
+            )
+        }
+
+        bool ResetTimingStats( const QString &Group )
+        {
+            SCRIPT_CATCH_EXCEPTION( false,
+                return m_obj.ResetTimingStats( Group );
+            )
+        }
+
+        QObject* GetDatabaseProfile( int Count )
+        {
+            SCRIPT_CATCH_EXCEPTION( nullptr,
+                return m_obj.GetDatabaseProfile( Count );
+            )
+        }
+
+        QObject* GetDeleteQueue()
+        {
+            SCRIPT_CATCH_EXCEPTION( nullptr,
+                return m_obj.GetDeleteQueue();
+            )
+        }
 };
 
 // NOLINTNEXTLINE(modernize-use-auto)
@@ -337,7 +337,7 @@ bool Video::AddVideo( const QString &sFileName,
     if ( !QFile::exists(fullname) )
         throw( QString( "Provided filename does not exist!" ));
 
-    QString hash = FileHash(fullname);
+    QString hash = CachedFileHash(fullname);
 
     if (hash == "NULL")
     {
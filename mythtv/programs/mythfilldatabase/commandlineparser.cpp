@@ -150,6 +150,14 @@ void MythFillDatabaseCommandLineParser::LoadArguments(void)
             "amount of data")
         ->SetGroup("Filtering");
 
+    add("--import-threads", "importthreads", 0,
+            "number of channels to import at once",
+            "Set how many channels of guide data are written to the "
+            "database at the same time, each on its own database "
+            "connection. The default of 0 picks a number from the "
+            "CPU count.")
+        ->SetGroup("Guide Data Handling");
+
     add("--only-update-channels", "onlychannels", false,
             "only update channel lineup",
             "Download as little listings data as possible to update the "
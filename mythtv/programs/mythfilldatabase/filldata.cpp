@@ -6,7 +6,10 @@
 #include <ctime>
 
 // C++ headers
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <utility>
 using namespace std;
 
 // Qt headers
@@ -16,6 +19,10 @@ using namespace std;
 #include <QList>
 #include <QMap>
 #include <QDir>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSet>
+#include <QThread>
 
 // MythTV headers
 #include "mythmiscutil.h"
@@ -26,6 +33,7 @@ using namespace std;
 #include "mythdate.h"
 #include "mythdirs.h"
 #include "mythdb.h"
+#include "mthreadpool.h"
 #include "mythsystemlegacy.h"
 #include "videosource.h" // for is_grabber..
 #include "mythcorecontext.h"
@@ -86,25 +94,120 @@ void FillData::SetRefresh(int day, bool set)
     }
 }
 
+/// Merges the programmes of each channel into the database on a pool of
+/// threads, each with its own database connection, while the rest of the
+/// file is still being parsed.
+class XMLTVImporter : public XMLTVHandler
+{
+  public:
+    XMLTVImporter(ChannelData &chanData, uint sourceid, int threads) :
+        m_chanData(chanData), m_sourceid(sourceid),
+        m_pool("XMLTVImport"), m_slots(threads * 2)
+    {
+        m_pool.setMaxThreadCount(threads);
+    }
+
+    void HandleChannels(ChannelInfoList &chanlist) override
+    {
+        m_chanData.handleChannels(m_sourceid, &chanlist);
+    }
+
+    void HandlePrograms(const QString &xmltvid,
+                        QList<ProgInfo> &proglist) override;
+
+    /// Waits for the queued channels to be written.
+    void Finish(void);
+
+    uint ProgramCount(void) const { return m_programs; }
+
+  private:
+    class Task : public QRunnable
+    {
+      public:
+        Task(XMLTVImporter *importer, QString xmltvid,
+             QList<ProgInfo> &proglist) :
+            m_importer(importer), m_xmltvid(std::move(xmltvid))
+        {
+            m_proglist.swap(proglist);
+        }
+
+        void run(void) override // QRunnable
+        {
+            uint unchanged = 0;
+            uint updated = 0;
+            ProgramData::HandleChannelPrograms(
+                m_importer->m_sourceid, m_xmltvid, m_proglist,
+                unchanged, updated);
+            m_importer->m_unchanged += unchanged;
+            m_importer->m_updated += updated;
+            m_importer->m_slots.release();
+        }
+
+      private:
+        XMLTVImporter   *m_importer;
+        QString          m_xmltvid;
+        QList<ProgInfo>  m_proglist;
+    };
+
+    ChannelData      &m_chanData;
+    uint              m_sourceid;
+    MThreadPool       m_pool;
+    QSemaphore        m_slots;      ///< bounds the channels held in memory
+    QSet<QString>     m_submitted;
+    uint              m_programs  {0};
+    std::atomic<uint> m_unchanged {0};
+    std::atomic<uint> m_updated   {0};
+};
+
+void XMLTVImporter::HandlePrograms(const QString &xmltvid,
+                                   QList<ProgInfo> &proglist)
+{
+    if (xmltvid.isEmpty() || proglist.isEmpty())
+        return;
+
+    // The file came back to a channel, its earlier programmes have to
+    // be in the database before these are compared against them.
+    if (m_submitted.contains(xmltvid))
+    {
+        m_pool.waitForDone();
+        m_submitted.clear();
+    }
+    m_submitted.insert(xmltvid);
+
+    m_programs += proglist.size();
+    m_slots.acquire();
+    m_pool.start(new Task(this, xmltvid, proglist), "XMLTVImport");
+}
+
+void XMLTVImporter::Finish(void)
+{
+    m_pool.waitForDone();
+
+    LOG(VB_GENERAL, LOG_INFO,
+        QString("Updated programs: %1 Unchanged programs: %2")
+                .arg(m_updated.load()) .arg(m_unchanged.load()));
+}
+
 // XMLTV stuff
 bool FillData::GrabDataFromFile(int id, QString &filename)
 {
-    ChannelInfoList chanlist;
-    QMap<QString, QList<ProgInfo> > proglist;
+    int threads = m_importThreads;
+    if (threads < 1)
+        threads = min(QThread::idealThreadCount(), 4);
+    threads = max(threads, 1);
 
-    if (!m_xmltvParser.parseFile(filename, &chanlist, &proglist))
+    XMLTVImporter importer(m_chanData, id, threads);
+
+    bool ok = m_xmltvParser.parseFile(filename, &importer);
+    importer.Finish();
+    if (!ok)
         return false;
 
-    m_chanData.handleChannels(id, &chanlist);
-    if (proglist.count() == 0)
+    if (importer.ProgramCount() == 0)
     {
         LOG(VB_GENERAL, LOG_INFO, "No programs found in data.");
         m_endOfData = true;
     }
-    else
-    {
-        ProgramData::HandlePrograms(id, proglist);
-    }
     return true;
 }
 
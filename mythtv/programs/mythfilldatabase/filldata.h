@@ -65,6 +65,7 @@ class FillData
 
     QString m_grabOptions;
     uint    m_maxDays                 {0};
+    int     m_importThreads           {0}; ///< 0 picks from the CPU count
 
     bool    m_interrupted             {false};
     bool    m_endOfData               {false};
@@ -240,6 +240,8 @@ int main(int argc, char *argv[])
         fill_data.m_onlyUpdateChannels = true;
     if (cmdline.toBool("noallatonce"))
         fill_data.m_noAllAtOnce = true;
+    if (cmdline.toBool("importthreads"))
+        fill_data.m_importThreads = cmdline.toInt("importthreads");
 
     mark_repeats = cmdline.toBool("markrepeats");
 
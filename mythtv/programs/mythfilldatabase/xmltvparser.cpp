@@ -2,6 +2,7 @@
 
 // Qt headers
 #include <QFile>
+#include <QSet>
 #include <QStringList>
 #include <QDateTime>
 #include <QDomDocument>
@@ -185,9 +186,19 @@ static int readNextWithErrorCheck(QXmlStreamReader &xml)
     return true;
 }
 
-bool XMLTVParser::parseFile(
-    const QString& filename, ChannelInfoList *chanlist,
-    QMap<QString, QList<ProgInfo> > *proglist)
+/** \brief Parses filename, passing channels and programmes to handler as
+ *         soon as they are complete.
+ *
+ *  The channels are handed over before the first programme. When the
+ *  programmes are grouped by channel, as most grabbers write them, each
+ *  channel is handed over when the next one starts so only one channel
+ *  is held in memory. Files sorted by time, or with a channel that shows
+ *  up again later, are held in memory from that point and handed over
+ *  once the whole file has been read.
+ *
+ *  Channels handed over before an error is found are not taken back.
+ */
+bool XMLTVParser::parseFile(const QString& filename, XMLTVHandler *handler)
 {
     m_movieGrabberPath = MetadataDownload::GetMovieGrabber();
     m_tvGrabberPath = MetadataDownload::GetTelevisionGrabber();
@@ -207,6 +218,11 @@ bool XMLTVParser::parseFile(
     bool haveReadTV = false;
     QString last_channel = ""; //xmltvId of the last program element we read
     QDateTime last_starttime; //starttime of the last program element we read
+    ChannelInfoList chanlist; //channels not handed to the handler yet
+    bool channelsHandled = false;
+    QMap<QString, QList<ProgInfo> > pending; //programmes not handed over yet
+    QSet<QString> flushed; //channels whose programmes were handed over
+    bool streaming = true; //are programmes grouped by channel
     while (!xml.atEnd() && !xml.hasError() && (! (xml.isEndElement() && xml.name() == "tv")))
     {
         if (xml.readNextStartElement())
@@ -282,7 +298,7 @@ bool XMLTVParser::parseFile(
                 chaninfo->m_freqId = chaninfo->m_chanNum;
                 //TODO optimize this, no use to do al this parsing if xmltvid is empty; but make sure you will read until the next channel!!
                 if (!chaninfo->m_xmltvId.isEmpty())
-                    chanlist->push_back(*chaninfo);
+                    chanlist.push_back(*chaninfo);
                 delete chaninfo;
             }//channel
             else if (xml.name() == "programme")
@@ -293,6 +309,13 @@ bool XMLTVParser::parseFile(
                     return false;
                 }
 
+                if (!channelsHandled || !chanlist.empty())
+                {
+                    handler->HandleChannels(chanlist);
+                    chanlist.clear();
+                    channelsHandled = true;
+                }
+
                 QString programid, season, episode, totalepisodes;
                 auto *pginfo = new ProgInfo();
 
@@ -705,6 +728,31 @@ bool XMLTVParser::parseFile(
                     // so we have a (relatively) clean program element now, which is good enough to process or to store
                     if (pginfo->m_channel != last_channel) {
                         //we have a channel change here
+                        if (streaming && !last_channel.isEmpty())
+                        {
+                            if (flushed.isEmpty() &&
+                                pending.value(last_channel).size() < 2)
+                            {
+                                //a file sorted by time changes channel after every programme
+                                LOG(VB_GENERAL, LOG_INFO, "Programmes are not grouped by channel, reading the whole file before importing it");
+                                streaming = false;
+                            }
+                            else
+                            {
+                                auto it = pending.find(last_channel);
+                                if (it != pending.end())
+                                {
+                                    handler->HandlePrograms(last_channel, *it);
+                                    pending.erase(it);
+                                }
+                                flushed.insert(last_channel);
+                            }
+                        }
+                        if (streaming && flushed.contains(pginfo->m_channel))
+                        {
+                            LOG(VB_GENERAL, LOG_NOTICE, QString("Programmes for %1 are not grouped together at line %2, reading the rest of the file before importing it").arg(pginfo->m_channel).arg(xml.lineNumber()));
+                            streaming = false;
+                        }
                         last_channel = pginfo->m_channel;
                         last_starttime = QDateTime(QDate(1970, 1, 1), QTime(0, 0, 0)); //initialize it to a time far, far away ...
                     }
@@ -720,7 +768,7 @@ bool XMLTVParser::parseFile(
                     }
 
                     if (pginfo->m_clumpidx.isEmpty())
-                        (*proglist)[pginfo->m_channel].push_back(*pginfo);
+                        pending[pginfo->m_channel].push_back(*pginfo);
                     else
                     {
                         /* append all titles/descriptions from one clump */
@@ -745,7 +793,7 @@ bool XMLTVParser::parseFile(
                         {
                             pginfo->m_title = aggregatedTitle;
                             pginfo->m_description = aggregatedDesc;
-                            (*proglist)[pginfo->m_channel].push_back(*pginfo);
+                            pending[pginfo->m_channel].push_back(*pginfo);
                         }
                     }
                 }
@@ -758,8 +806,13 @@ bool XMLTVParser::parseFile(
         LOG(VB_GENERAL, LOG_ERR, QString("Malformed XML file, missing </tv> element, at line %1, %2").arg(xml.lineNumber()).arg(xml.errorString()));
         return false;
     }
-    //TODO add code for adding data on the run
     f.close();
 
+    if (!channelsHandled || !chanlist.empty())
+        handler->HandleChannels(chanlist);
+
+    for (auto it = pending.begin(); it != pending.end(); ++it)
+        handler->HandlePrograms(it.key(), *it);
+
     return true;
 }
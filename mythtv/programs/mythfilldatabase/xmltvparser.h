@@ -13,12 +13,26 @@ class ProgInfo;
 class QUrl;
 class QDomElement;
 
+/// Receives the contents of an XMLTV file while it is being parsed.
+class XMLTVHandler
+{
+  public:
+    virtual ~XMLTVHandler() = default;
+
+    /// Called with the channels, before any programmes that use them.
+    virtual void HandleChannels(ChannelInfoList &chanlist) = 0;
+
+    /// Called with the programmes of a channel once they have been read.
+    /// May be called again for a channel the file comes back to later.
+    virtual void HandlePrograms(const QString &xmltvid,
+                                QList<ProgInfo> &proglist) = 0;
+};
+
 class XMLTVParser
 {
   public:
     XMLTVParser();
-    bool parseFile(const QString& filename, ChannelInfoList *chanlist,
-                   QMap<QString, QList<ProgInfo> > *proglist);
+    bool parseFile(const QString& filename, XMLTVHandler *handler);
 
   private:
     unsigned int m_currentYear {0};
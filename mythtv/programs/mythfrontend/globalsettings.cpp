@@ -447,6 +447,23 @@ static GlobalSpinBoxSetting *AutoExpireExtraSpace()
     return bs;
 };
 
+static GlobalSpinBoxSetting *AutoExpireForecastHours()
+{
+    auto *bs = new GlobalSpinBoxSetting("AutoExpireForecastHours", 0, 24, 1);
+
+    bs->setLabel(GeneralSettings::tr("Expire ahead of recordings (hours)"));
+
+    bs->setHelpText(GeneralSettings::tr("While nothing is recording, expire "
+                                        "enough recordings to make space for "
+                                        "the recordings scheduled in this "
+                                        "many hours. These are deleted "
+                                        "slowly. Set to 0 to disable."));
+
+    bs->setValue(4);
+
+    return bs;
+}
+
 #if 0
 static GlobalCheckBoxSetting *AutoExpireInsteadOfDelete()
 {
@@ -4422,6 +4439,7 @@ GeneralSettings::GeneralSettings()
     autoexp->addChild(AutoExpireLiveTVMaxAge());
     autoexp->addChild(AutoExpireDayPriority());
     autoexp->addChild(AutoExpireExtraSpace());
+    autoexp->addChild(AutoExpireForecastHours());
 
 //    autoexp->addChild(new DeletedExpireOptions());
     autoexp->addChild(DeletedMaxAge());
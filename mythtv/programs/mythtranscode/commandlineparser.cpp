@@ -37,12 +37,32 @@ void MythTranscodeCommandLineParser::LoadArguments(void)
             "Specifies that a lossless transcode should be used.", "")
         ->SetGroup("Encoding");
     add(QStringList{"-e", "--ostream"}, "ostream", "",
-            "Output stream type: ps, dvd, ts (Default: ps)", "")
+            "Output stream type: ps, dvd, ts (Default: ps), or with "
+            "--smartcut ts, mkv (Default: ts)", "")
+        ->SetGroup("Encoding");
+    add("--smartcut", "smartcut", false,
+            "Specifies that an H.264 or HEVC recording should be cut by "
+            "copying it, only re-encoding the frames around each cut.", "")
         ->SetGroup("Encoding");
     add("--avf", "avf", false, "Generate libavformat output file.", "")
         ->SetGroup("Encoding");
     add("--hls", "hls", false, "Generate HTTP Live Stream output.", "")
         ->SetGroup("Encoding");
+    add("--segments", "segments", 0,
+            "Split the recording at keyframes into this many segments, "
+            "transcode them at the same time and join the results.",
+            "Splits the recording at keyframes from its position map into "
+            "this many segments with about the same number of frames "
+            "after cutting. Each segment is transcoded by its own "
+            "mythtranscode process, and the results are joined into the "
+            "output file. Only libavformat output is supported.")
+        ->SetGroup("Encoding")
+        ->SetRequires("avf");
+    add("--threads", "threads", 0,
+            "Number of segments to transcode at the same time. "
+            "(Default: number of CPUs)", "")
+        ->SetGroup("Encoding")
+        ->SetRequires("avf");
 
     add(QStringList{"-f", "--fifodir"}, "fifodir", "",
             "Directory in which to write fifos to.", "")
@@ -89,12 +109,16 @@ void MythTranscodeCommandLineParser::LoadArguments(void)
             "profile to the jobqueue. Accepts an optional string to define "
             "the hostname.", "");
 
-//    add("--container", "container", "", "Output file container format", "")
-//        ->SetChildOf("avf");
-//    add("--acodec", "acodec", "", "Output file audio codec", "")
-//        ->SetChildOf("avf");
-//    add("--vcodec", "vcodec", "", "Output file video codec", "")
-//        ->SetChildOf("avf");
+    add("--container", "container", "", "Output file container format", "")
+        ->SetChildOf("avf");
+    add("--acodec", "acodec", "", "Output file audio codec", "")
+        ->SetChildOf("avf");
+    add("--vcodec", "vcodec", "", "Output file video codec", "")
+        ->SetChildOf("avf");
+    add("--progressfile", "progressfile", "",
+            "Write the number of the frame being transcoded to this file "
+            "every few seconds, used by --segments.", "")
+        ->SetChildOf("avf");
     add("--width", "width", 0, "Output Video Width", "")
         ->SetChildOf("avf")
         ->SetChildOf("hls");
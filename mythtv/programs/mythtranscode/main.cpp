@@ -8,6 +8,7 @@ using namespace std;
 // Qt headers
 #include <QCoreApplication>
 #include <QDir>
+#include <QThread>
 #include <utility>
 
 // MythTV headers
@@ -21,6 +22,8 @@ using namespace std;
 #include "mythdate.h"
 #include "transcode.h"
 #include "mpeg2fix.h"
+#include "smartcut.h"
+#include "paralleltranscode.h"
 #include "remotefile.h"
 #include "mythtranslation.h"
 #include "loggingserver.h"
@@ -158,6 +161,10 @@ int main(int argc, char *argv[])
     bool build_index = false;
     bool fifosync = false;
     bool mpeg2 = false;
+    bool smartcut = false;
+    QString container = "mpegts";
+    int segments = 1;
+    int threads = QThread::idealThreadCount();
     bool fifo_info = false;
     bool cleanCut = false;
     QMap<QString, QString> settingsOverride;
@@ -349,14 +356,30 @@ int main(int argc, char *argv[])
         recorderOptions = cmdline.toString("recopt");
     if (cmdline.toBool("mpeg2"))
         mpeg2 = true;
+    if (cmdline.toBool("smartcut"))
+        smartcut = true;
+    if (cmdline.toBool("threads"))
+        threads = std::max(cmdline.toInt("threads"), 1);
+    if (cmdline.toBool("segments"))
+        segments = cmdline.toInt("segments");
+    else if (cmdline.toBool("threads"))
+        segments = threads;
     if (cmdline.toBool("ostream"))
     {
+        if (smartcut && cmdline.toString("ostream") != "ts" &&
+            cmdline.toString("ostream") != "mkv")
+        {
+            cerr << "--smartcut only writes 'ts' or 'mkv' streams" << endl;
+            return GENERIC_EXIT_INVALID_CMDLINE;
+        }
         if (cmdline.toString("ostream") == "dvd")
             otype = REPLEX_DVD;
         else if (cmdline.toString("ostream") == "ps")
             otype = REPLEX_MPEG2;
         else if (cmdline.toString("ostream") == "ts")
             otype = REPLEX_TS_SD;
+        else if (cmdline.toString("ostream") == "mkv" && smartcut)
+            container = "matroska";
         else
         {
             cerr << "Invalid 'ostream' type: "
@@ -580,6 +603,8 @@ int main(int argc, char *argv[])
             transcode->SetCMDAudioCodec(cmdline.toString("acodec"));
         if (cmdline.toBool("vcodec"))
             transcode->SetCMDVideoCodec(cmdline.toString("vcodec"));
+        if (cmdline.toBool("progressfile"))
+            transcode->SetProgressFile(cmdline.toString("progressfile"));
     }
     else if (cmdline.toBool("hls"))
     {
@@ -609,14 +634,69 @@ int main(int argc, char *argv[])
         transcode->ShowProgress(true);
     if (!recorderOptions.isEmpty())
         transcode->SetRecorderOptions(recorderOptions);
+    void (*update_func)(float) = nullptr;
+    int (*check_func)() = nullptr;
+    if (jobID >= 0)
+    {
+       glbl_jobID = jobID;
+       update_func = &UpdateJobQueue;
+       check_func = &CheckJobQueue;
+    }
+
     int result = 0;
-    if ((!mpeg2 && !build_index) || cmdline.toBool("hls"))
+    if ((!mpeg2 && !smartcut && !build_index) || cmdline.toBool("hls"))
     {
-        result = transcode->TranscodeFile(infile, outfile,
-                                          profilename, useCutlist,
-                                          (fifosync || keyframesonly), jobID,
-                                          fifodir, fifo_info, cleanCut, deleteMap,
-                                          AudioTrackNo, passthru);
+        if (segments > 1 && cmdline.toBool("avf") && !cmdline.toBool("hls"))
+        {
+            if (useCutlist && deleteMap.isEmpty())
+                pginfo->QueryCutList(deleteMap);
+
+            // Everything that changes how a segment is encoded
+            QStringList childArgs;
+            childArgs << "--avf" << "--profile" << profilename;
+            if (!recorderOptions.isEmpty())
+                childArgs << "--recorderOptions" << recorderOptions;
+            if (cmdline.toBool("width"))
+                childArgs << "--width" << cmdline.toString("width");
+            if (cmdline.toBool("height"))
+                childArgs << "--height" << cmdline.toString("height");
+            if (cmdline.toBool("bitrate"))
+                childArgs << "--bitrate" << cmdline.toString("bitrate");
+            if (cmdline.toBool("audiobitrate"))
+                childArgs << "--audiobitrate"
+                          << cmdline.toString("audiobitrate");
+            if (cmdline.toBool("container"))
+                childArgs << "--container" << cmdline.toString("container");
+            if (cmdline.toBool("acodec"))
+                childArgs << "--acodec" << cmdline.toString("acodec");
+            if (cmdline.toBool("vcodec"))
+                childArgs << "--vcodec" << cmdline.toString("vcodec");
+            if (AudioTrackNo >= 0)
+                childArgs << "--audiotrack" << QString::number(AudioTrackNo);
+            if (passthru)
+                childArgs << "--passthrough";
+            if (fifosync || keyframesonly)
+                childArgs << "--allkeys";
+            if (isVideo)
+                childArgs << "--video";
+
+            QString avfContainer = cmdline.toBool("container") ?
+                cmdline.toString("container") : "mpegts";
+            ParallelTranscode parallel(pginfo, infile, outfile, deleteMap,
+                                       childArgs, avfContainer, segments,
+                                       threads, showprogress, update_func,
+                                       check_func);
+            result = parallel.Start();
+        }
+        else
+        {
+            result = transcode->TranscodeFile(infile, outfile,
+                                              profilename, useCutlist,
+                                              (fifosync || keyframesonly),
+                                              jobID, fifodir, fifo_info,
+                                              cleanCut, deleteMap,
+                                              AudioTrackNo, passthru);
+        }
 
         if ((result == REENCODE_OK) && (jobID >= 0))
         {
@@ -635,21 +715,61 @@ int main(int argc, char *argv[])
     }
 
     int exitcode = GENERIC_EXIT_OK;
-    if ((result == REENCODE_MPEG2TRANS) || mpeg2 || build_index)
+
+    if ((result == REENCODE_SMARTCUT) || smartcut)
     {
-        void (*update_func)(float) = nullptr;
-        int (*check_func)() = nullptr;
         if (useCutlist)
         {
             LOG(VB_GENERAL, LOG_INFO, "Honoring the cutlist while transcoding");
             if (deleteMap.isEmpty())
                 pginfo->QueryCutList(deleteMap);
         }
-        if (jobID >= 0)
+        if (jobID >= 0 && container != "mpegts")
         {
-           glbl_jobID = jobID;
-           update_func = &UpdateJobQueue;
-           check_func = &CheckJobQueue;
+            // The recording keeps its name, and the seek table is built
+            // for MPEG-TS only.
+            LOG(VB_GENERAL, LOG_NOTICE, "Recordings are always cut to MPEG-TS");
+            container = "mpegts";
+        }
+
+        frm_pos_map_t keyframes;
+        pginfo->QueryPositionMap(keyframes, MARK_GOP_BYFRAME);
+
+        SmartCutter cutter(infile, outfile, deleteMap, keyframes, container,
+                           showprogress, update_func, check_func);
+        cutter.SetAllAudio(cmdline.toBool("allaudio"));
+        result = cutter.Start();
+
+        if (result == REENCODE_OK && container == "mpegts")
+        {
+            auto *m2f = new MPEG2fixup(infile, outfile,
+                                       &deleteMap, nullptr, false, false, 20,
+                                       showprogress, otype, update_func,
+                                       check_func);
+            result = BuildKeyframeIndex(m2f, outfile, posMap, durMap, jobID);
+            delete m2f;
+            m2f = nullptr;
+            if (result == REENCODE_OK)
+            {
+                if (update_index)
+                    UpdatePositionMap(posMap, durMap, nullptr, pginfo);
+                else
+                    UpdatePositionMap(posMap, durMap, outfile + QString(".map"),
+                                      pginfo);
+            }
+            RecordingInfo recInfo(*pginfo);
+            RecordingFile *recFile = recInfo.GetRecordingFile();
+            recFile->m_containerFormat = formatMPEG2_TS;
+            recFile->Save();
+        }
+    }
+    else if ((result == REENCODE_MPEG2TRANS) || mpeg2 || build_index)
+    {
+        if (useCutlist)
+        {
+            LOG(VB_GENERAL, LOG_INFO, "Honoring the cutlist while transcoding");
+            if (deleteMap.isEmpty())
+                pginfo->QueryCutList(deleteMap);
         }
 
         auto *m2f = new MPEG2fixup(infile, outfile,
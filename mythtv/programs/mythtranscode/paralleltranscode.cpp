@@ -0,0 +1,431 @@
+// C++ headers
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <utility>
+
+// Qt
+#include <QElapsedTimer>
+#include <QFile>
+
+// MythTV
+#include "exitcodes.h"
+#include "mythdate.h"
+#include "mythdirs.h"
+#include "mythlogging.h"
+#include "mythsystemlegacy.h"
+#include "programinfo.h"
+#include "avformatwriter.h"
+#include "paralleltranscode.h"
+
+extern "C" {
+#include "libavformat/avformat.h"
+}
+
+#define LOC QString("ParallelTranscode: ")
+
+/// Used as the end of the recording in cutlists, as main() does.
+static const uint64_t kLastFrame = 999999999;
+
+ParallelTranscode::ParallelTranscode(ProgramInfo *pginfo, QString inf,
+                                     QString outf, frm_dir_map_t deleteMap,
+                                     QStringList childArgs,
+                                     QString container, int segments,
+                                     int threads, bool showprog,
+                                     void (*update_func)(float),
+                                     int (*check_func)())
+  : m_pginfo(pginfo), m_infile(std::move(inf)), m_outfile(std::move(outf)),
+    m_deleteMap(std::move(deleteMap)), m_childArgs(std::move(childArgs)),
+    m_container(std::move(container)),
+    m_numSegments(std::max(segments, 1)), m_threads(std::max(threads, 1)),
+    m_progress(showprog, update_func, check_func)
+{
+}
+
+ParallelTranscode::~ParallelTranscode()
+{
+    for (auto &seg : m_segments)
+    {
+        if (seg.m_process)
+        {
+            seg.m_process->Term(true);
+            delete seg.m_process;
+            seg.m_process = nullptr;
+        }
+    }
+    RemoveSegmentFiles();
+}
+
+int ParallelTranscode::Start(void)
+{
+    if (!PlanSegments())
+        return REENCODE_ERROR;
+
+    int result = RunSegments();
+    if (result != REENCODE_OK)
+        return result;
+
+    if (!Concatenate())
+        return REENCODE_ERROR;
+
+    return REENCODE_OK;
+}
+
+/** \brief Splits the recording into segments at keyframes.
+ *
+ *  The split points are chosen so each segment keeps about the same
+ *  number of frames once the cutlist is applied, a segment that starts
+ *  in a long cut just gets longer.
+ */
+bool ParallelTranscode::PlanSegments(void)
+{
+    frm_pos_map_t posMap;
+    m_pginfo->QueryPositionMap(posMap, MARK_GOP_BYFRAME);
+    if (posMap.size() < 2)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("No keyframe position map for %1, it can't be split. "
+                    "Run mythcommflag --rebuild to create one.")
+                .arg(m_infile));
+        return false;
+    }
+
+    QList<uint64_t> keyframes;
+    for (auto it = posMap.cbegin(); it != posMap.cend(); ++it)
+        keyframes.push_back(static_cast<uint64_t>(it.key()));
+    auto total = static_cast<uint64_t>(
+        std::max<int64_t>(m_pginfo->QueryTotalFrames(), 0));
+    total = std::max(total, keyframes.last() + 1);
+
+    m_keep = CutListKeptRanges(m_deleteMap, kLastFrame);
+
+    QList<uint64_t> splits =
+        CutListSplitPoints(m_keep, keyframes, total, m_numSegments);
+    if (splits.isEmpty())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "The cutlist removes everything");
+        return false;
+    }
+    splits.push_back(kLastFrame);
+
+    for (int i = 0; i + 1 < splits.size(); i++)
+    {
+        Segment seg;
+        seg.m_start   = splits[i];
+        seg.m_end     = splits[i + 1];
+        seg.m_frames  = KeptFrames(seg.m_start, std::min(seg.m_end, total));
+        seg.m_outfile = m_outfile + QString(".part%1").arg(i);
+        seg.m_progressFile = seg.m_outfile + ".progress";
+        m_segments.push_back(seg);
+
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Segment %1: frames %2-%3, keeping %4")
+                .arg(i).arg(seg.m_start)
+                .arg(std::min(seg.m_end, total)).arg(seg.m_frames));
+    }
+
+    return true;
+}
+
+uint64_t ParallelTranscode::KeptFrames(uint64_t start, uint64_t end) const
+{
+    return CountKeptFrames(m_keep, start, end);
+}
+
+/// Returns the cutlist, in --honorcutlist form, that keeps only the
+/// frames of the segment that the recording's cutlist keeps.
+QString ParallelTranscode::SegmentCutlist(const Segment &seg) const
+{
+    QStringList cuts;
+    for (const auto &cut : CutListForRange(m_keep, seg.m_start, seg.m_end,
+                                           kLastFrame))
+        cuts << QString("%1-%2").arg(cut.first).arg(cut.second);
+
+    return cuts.join(" ");
+}
+
+void ParallelTranscode::StartSegment(Segment &seg)
+{
+    QStringList args = m_childArgs;
+    args << "--infile" << m_infile << "--outfile" << seg.m_outfile
+         << "--progressfile" << seg.m_progressFile;
+
+    QString cutlist = SegmentCutlist(seg);
+    if (!cutlist.isEmpty())
+        args << "--honorcutlist" << cutlist;
+
+    seg.m_process = new MythSystemLegacy(GetAppBinDir() + "mythtranscode",
+                                         args, kMSPropagateLogs);
+    seg.m_started = MythDate::current();
+    seg.m_process->Run();
+
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Started %1").arg(seg.m_outfile));
+}
+
+/** \brief Runs the segment transcodes, at most m_threads at once.
+ *
+ *  If a segment fails the others are stopped, there is no point in
+ *  finishing them.
+ */
+int ParallelTranscode::RunSegments(void)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    uint64_t framesDone = 0;
+    int next = 0;
+    int running = 0;
+    int result = REENCODE_OK;
+
+    while (result == REENCODE_OK)
+    {
+        while (running < m_threads && next < m_segments.size())
+        {
+            Segment &seg = m_segments[next++];
+            if (!seg.m_frames)
+                continue;
+            StartSegment(seg);
+            running++;
+        }
+
+        if (!running)
+            break;
+
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+
+        for (auto &seg : m_segments)
+        {
+            if (!seg.m_process ||
+                seg.m_process->GetStatus() == GENERIC_EXIT_RUNNING)
+                continue;
+
+            uint status = seg.m_process->GetStatus();
+            delete seg.m_process;
+            seg.m_process = nullptr;
+            running--;
+
+            if (status != GENERIC_EXIT_OK)
+            {
+                LOG(VB_GENERAL, LOG_ERR, LOC +
+                    QString("Transcoding %1 failed, exit status %2")
+                        .arg(seg.m_outfile).arg(status));
+                result = REENCODE_ERROR;
+                break;
+            }
+
+            QFile::remove(seg.m_progressFile);
+            seg.m_secs = std::max<int>(
+                seg.m_started.secsTo(MythDate::current()), 1);
+            framesDone += seg.m_frames;
+
+            LOG(VB_GENERAL, LOG_INFO, LOC +
+                QString("Finished %1, %2 frames in %3s (%4 fps)")
+                    .arg(seg.m_outfile).arg(seg.m_frames).arg(seg.m_secs)
+                    .arg(double(seg.m_frames) / seg.m_secs, 0, 'f', 1));
+        }
+
+        if (result == REENCODE_OK && !CheckProgress(framesDone))
+            result = REENCODE_STOPPED;
+    }
+
+    if (result != REENCODE_OK)
+    {
+        for (auto &seg : m_segments)
+        {
+            if (seg.m_process)
+            {
+                seg.m_process->Term(true);
+                delete seg.m_process;
+                seg.m_process = nullptr;
+            }
+        }
+        return result;
+    }
+
+    // Throughput of the whole run, and how much the segments overlapped
+    double elapsed = std::max<qint64>(timer.elapsed(), 1) / 1000.0;
+    int segmentSecs = 0;
+    for (const auto &seg : m_segments)
+        segmentSecs += seg.m_secs;
+
+    LOG(VB_GENERAL, LOG_NOTICE, LOC +
+        QString("Transcoded %1 frames in %2s (%3 fps) with %4 segments, "
+                "%5 at a time, %6x the speed of a single transcode")
+            .arg(framesDone).arg(elapsed, 0, 'f', 0)
+            .arg(framesDone / elapsed, 0, 'f', 1)
+            .arg(m_segments.size()).arg(m_threads)
+            .arg(segmentSecs / elapsed, 0, 'f', 2));
+
+    return REENCODE_OK;
+}
+
+/** \brief Joins the segment files into the output file.
+ *
+ *  Each segment starts where the one before it ended. Packets at the
+ *  joins that would make a stream's dts go backwards are dropped, except
+ *  for video where the dts is moved on instead.
+ */
+bool ParallelTranscode::Concatenate(void)
+{
+    AVFormatWriter writer;
+    writer.SetFilename(m_outfile);
+    writer.SetContainer(m_container);
+    if (!writer.Init())
+        return false;
+
+    bool opened = false;
+    QVector<int64_t> lastDts;
+    int64_t nextStart = AV_NOPTS_VALUE;
+    AVPacket *pkt = av_packet_alloc();
+    bool ok = true;
+
+    for (const auto &seg : m_segments)
+    {
+        if (!seg.m_frames)
+            continue;
+
+        AVFormatContext *ic = nullptr;
+        QByteArray fname = seg.m_outfile.toLocal8Bit();
+        if (avformat_open_input(&ic, fname.constData(), nullptr, nullptr) < 0 ||
+            avformat_find_stream_info(ic, nullptr) < 0)
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("Couldn't open %1").arg(seg.m_outfile));
+            if (ic)
+                avformat_close_input(&ic);
+            ok = false;
+            break;
+        }
+
+        if (!opened)
+        {
+            for (uint i = 0; i < ic->nb_streams; i++)
+            {
+                if (!writer.AddCopyStream(ic->streams[i]->codecpar,
+                                          ic->streams[i]->time_base))
+                    ok = false;
+            }
+            lastDts.fill(AV_NOPTS_VALUE, ic->nb_streams);
+            ok = ok && writer.OpenFile();
+            opened = true;
+        }
+        else if (static_cast<int>(ic->nb_streams) != lastDts.size())
+        {
+            LOG(VB_GENERAL, LOG_ERR, LOC +
+                QString("%1 doesn't have the same streams as the first "
+                        "segment").arg(seg.m_outfile));
+            ok = false;
+        }
+
+        int64_t offset = 0;
+        if (nextStart != AV_NOPTS_VALUE && ic->start_time != AV_NOPTS_VALUE)
+            offset = nextStart - ic->start_time;
+
+        int64_t segmentEnd = nextStart;
+        while (ok && av_read_frame(ic, pkt) >= 0)
+        {
+            AVStream *st = ic->streams[pkt->stream_index];
+            int64_t shift = av_rescale_q(offset, AV_TIME_BASE_Q, st->time_base);
+            if (pkt->pts != AV_NOPTS_VALUE)
+                pkt->pts += shift;
+            if (pkt->dts != AV_NOPTS_VALUE)
+                pkt->dts += shift;
+
+            int64_t time = (pkt->pts != AV_NOPTS_VALUE) ? pkt->pts : pkt->dts;
+            if (time != AV_NOPTS_VALUE)
+            {
+                int64_t end = av_rescale_q(time + pkt->duration,
+                                           st->time_base, AV_TIME_BASE_Q);
+                if (segmentEnd == AV_NOPTS_VALUE || end > segmentEnd)
+                    segmentEnd = end;
+            }
+
+            int64_t &last = lastDts[pkt->stream_index];
+            if (pkt->dts != AV_NOPTS_VALUE && last != AV_NOPTS_VALUE &&
+                pkt->dts <= last)
+            {
+                if (st->codecpar->codec_type != AVMEDIA_TYPE_VIDEO)
+                {
+                    av_packet_unref(pkt);
+                    continue;
+                }
+                pkt->dts = last + 1;
+                if (pkt->pts != AV_NOPTS_VALUE)
+                    pkt->pts = std::max(pkt->pts, pkt->dts);
+            }
+            if (pkt->dts != AV_NOPTS_VALUE)
+                last = pkt->dts;
+
+            ok = writer.WritePacket(pkt, st->time_base);
+            av_packet_unref(pkt);
+        }
+
+        nextStart = segmentEnd;
+        avformat_close_input(&ic);
+
+        if (!ok)
+            break;
+    }
+
+    av_packet_free(&pkt);
+
+    if (!opened)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No segments to join");
+        return false;
+    }
+
+    writer.CloseFile();
+
+    if (ok)
+        RemoveSegmentFiles();
+
+    return ok;
+}
+
+void ParallelTranscode::RemoveSegmentFiles(void)
+{
+    for (const auto &seg : m_segments)
+    {
+        if (QFile::exists(seg.m_outfile))
+            QFile::remove(seg.m_outfile);
+        if (QFile::exists(seg.m_progressFile))
+            QFile::remove(seg.m_progressFile);
+    }
+}
+
+/// Returns how many of the frames the segment keeps its transcode has
+/// done so far, from the frame number it last wrote to its progress file.
+uint64_t ParallelTranscode::SegmentFramesDone(Segment &seg) const
+{
+    QFile progress(seg.m_progressFile);
+    if (progress.open(QIODevice::ReadOnly))
+    {
+        bool ok = false;
+        qulonglong frame = progress.readAll().trimmed().toULongLong(&ok);
+        if (ok)
+            seg.m_position = std::max<uint64_t>(seg.m_position, frame);
+    }
+
+    if (seg.m_position <= seg.m_start)
+        return 0;
+    return KeptFrames(seg.m_start, std::min(seg.m_position, seg.m_end));
+}
+
+/// Reports progress, returns false if the job was told to stop.
+/// \param framesDone Frames of the segments that have finished
+bool ParallelTranscode::CheckProgress(uint64_t framesDone)
+{
+    if (!m_progress.IsDue())
+        return true;
+
+    uint64_t total = 0;
+    for (auto &seg : m_segments)
+    {
+        total += seg.m_frames;
+        if (seg.m_process)
+            framesDone += SegmentFramesDone(seg);
+    }
+
+    return m_progress.Report(total ? 100.0F * framesDone / total : 0.0F);
+}
@@ -0,0 +1,88 @@
+#ifndef PARALLELTRANSCODE_H
+#define PARALLELTRANSCODE_H
+
+#include <cstdint>
+
+// Qt
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// MythTV
+#include "transcodedefs.h"
+#include "transcodeprogress.h"
+#include "programtypes.h"
+
+class ProgramInfo;
+class MythSystemLegacy;
+
+/** \class ParallelTranscode
+ *  \brief Transcodes a recording as several segments at once.
+ *
+ *  The recording is split at keyframes from its position map into
+ *  segments with about the same number of frames left after the cutlist
+ *  is applied. Each segment is transcoded by a separate mythtranscode
+ *  process, given a cutlist that removes everything outside the segment,
+ *  so every segment has its own decoder and encoder. When they are all
+ *  done the segments are joined by copying their packets into the output
+ *  file, in the same container as the segments, with the timestamps of
+ *  each moved on to follow the one before.
+ *
+ *  Only libavformat output (--avf) can be joined this way.
+ */
+class ParallelTranscode
+{
+  public:
+    ParallelTranscode(ProgramInfo *pginfo, QString inf, QString outf,
+                      frm_dir_map_t deleteMap, QStringList childArgs,
+                      QString container, int segments, int threads,
+                      bool showprog,
+                      void (*update_func)(float) = nullptr,
+                      int (*check_func)() = nullptr);
+    ~ParallelTranscode();
+
+    int Start(void);
+
+  private:
+    class Segment
+    {
+      public:
+        uint64_t          m_start    {0};  ///< first frame, a keyframe
+        uint64_t          m_end      {0};  ///< first frame of the next one
+        uint64_t          m_frames   {0};  ///< frames kept by the cutlist
+        uint64_t          m_position {0};  ///< last frame reported done
+        QString           m_outfile;
+        QString           m_progressFile;
+        MythSystemLegacy *m_process  {nullptr};
+        QDateTime         m_started;
+        int               m_secs     {0};
+    };
+
+    bool PlanSegments(void);
+    uint64_t KeptFrames(uint64_t start, uint64_t end) const;
+    QString SegmentCutlist(const Segment &seg) const;
+    int RunSegments(void);
+    void StartSegment(Segment &seg);
+    bool Concatenate(void);
+    void RemoveSegmentFiles(void);
+    uint64_t SegmentFramesDone(Segment &seg) const;
+    bool CheckProgress(uint64_t framesDone);
+
+    ProgramInfo      *m_pginfo          {nullptr};
+    QString           m_infile;
+    QString           m_outfile;
+    frm_dir_map_t     m_deleteMap;
+    QStringList       m_childArgs;
+    QString           m_container;
+    int               m_numSegments     {1};
+    int               m_threads         {1};
+
+    /// Kept frame ranges, [start, end)
+    frm_range_list_t  m_keep;
+    QList<Segment>    m_segments;
+
+    TranscodeProgress m_progress;
+};
+
+#endif
@@ -0,0 +1,813 @@
+// C++ headers
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+// Qt
+#include <QFileInfo>
+#include <QMutex>
+
+// MythTV
+#include "mythcorecontext.h"
+#include "mythlogging.h"
+#include "avformatwriter.h"
+#include "smartcut.h"
+
+#define LOC QString("SmartCut: ")
+
+static const int64_t kNoEnd = std::numeric_limits<int64_t>::max();
+
+/// Cuts shorter than this, in seconds, are read through rather than
+/// skipped with a seek.
+static const int kMinSeekSecs = 10;
+
+static QString av_error(int errnum)
+{
+    char error[AV_ERROR_MAX_STRING_SIZE];
+    return av_make_error_string(error, sizeof(error), errnum);
+}
+
+SmartCutter::SmartCutter(QString inf, QString outf,
+                         const frm_dir_map_t &deleteMap, frm_pos_map_t posMap,
+                         QString container, bool showprog,
+                         void (*update_func)(float), int (*check_func)())
+  : m_infile(std::move(inf)), m_outfile(std::move(outf)),
+    m_container(std::move(container)), m_deleteMap(deleteMap),
+    m_posMap(std::move(posMap)),
+    m_progress(showprog, update_func, check_func)
+{
+    if (m_progress.IsActive())
+        m_fileSize = QFileInfo(m_infile).size();
+}
+
+SmartCutter::~SmartCutter()
+{
+    ClearGOP(m_gop);
+    ClearGOP(m_prevGop);
+    av_frame_free(&m_frame);
+    avcodec_free_context(&m_encoder);
+    avcodec_free_context(&m_decoder);
+    delete m_writer;
+    if (m_inputFC)
+        avformat_close_input(&m_inputFC);
+}
+
+int SmartCutter::Start(void)
+{
+    if (!InitInput())
+        return REENCODE_ERROR;
+
+    BuildSegments();
+
+    if (!InitOutput())
+        return REENCODE_ERROR;
+
+    AVPacket *pkt = av_packet_alloc();
+    int result = REENCODE_OK;
+
+    while (result == REENCODE_OK)
+    {
+        int ret = av_read_frame(m_inputFC, pkt);
+        if (ret < 0)
+        {
+            if (ret != AVERROR_EOF)
+                LOG(VB_GENERAL, LOG_WARNING, LOC +
+                    QString("Read error, stopping at end of readable data: %1")
+                        .arg(av_error(ret)));
+            break;
+        }
+
+        UnwrapTimestamps(pkt);
+
+        if (pkt->stream_index != m_videoStream->index)
+        {
+            if (!CopyOther(pkt))
+                result = REENCODE_ERROR;
+            av_packet_unref(pkt);
+            continue;
+        }
+
+        int64_t pts = PacketTime(pkt);
+
+        if ((pkt->flags & AV_PKT_FLAG_KEY) && pts != AV_NOPTS_VALUE)
+        {
+            if (pkt->pts != AV_NOPTS_VALUE && pkt->dts != AV_NOPTS_VALUE)
+                m_reorderDelay = std::max(m_reorderDelay, pkt->pts - pkt->dts);
+
+            if (!m_gop.isEmpty() && !ProcessGOP())
+            {
+                result = REENCODE_ERROR;
+                break;
+            }
+
+            if (!CheckProgress())
+            {
+                result = REENCODE_STOPPED;
+                break;
+            }
+
+            // Everything that is kept has been written
+            if (!m_prevGop.isEmpty() &&
+                PacketTime(m_prevGop.first()) >= m_segments.last().m_end)
+                break;
+
+            if (SeekPastCut(pts))
+            {
+                av_packet_unref(pkt);
+                continue;
+            }
+        }
+        else if (m_gop.isEmpty())
+        {
+            // Pictures before the first keyframe can't be decoded
+            av_packet_unref(pkt);
+            continue;
+        }
+
+        AVPacket *gopPkt = av_packet_alloc();
+        av_packet_move_ref(gopPkt, pkt);
+        m_gop.push_back(gopPkt);
+    }
+
+    av_packet_free(&pkt);
+
+    if (result == REENCODE_OK && !m_gop.isEmpty() && !ProcessGOP())
+        result = REENCODE_ERROR;
+    if (result == REENCODE_OK && m_decoderActive && !DrainDecoder())
+        result = REENCODE_ERROR;
+    if (result == REENCODE_OK && !FlushEncoder())
+        result = REENCODE_ERROR;
+
+    if (result == REENCODE_OK)
+    {
+        m_writer->CloseFile();
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Copied %1 GOPs, re-encoded %2 frames")
+                .arg(m_gopsCopied).arg(m_framesEncoded));
+    }
+
+    return result;
+}
+
+bool SmartCutter::InitInput(void)
+{
+    QByteArray ifname = m_infile.toLocal8Bit();
+
+    LOG(VB_GENERAL, LOG_INFO, LOC + QString("Opening %1").arg(m_infile));
+
+    int ret = avformat_open_input(&m_inputFC, ifname.constData(),
+                                  nullptr, nullptr);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open input file: %1").arg(av_error(ret)));
+        return false;
+    }
+
+    ret = avformat_find_stream_info(m_inputFC, nullptr);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't get stream info: %1").arg(av_error(ret)));
+        return false;
+    }
+
+    int vid = av_find_best_stream(m_inputFC, AVMEDIA_TYPE_VIDEO,
+                                  -1, -1, nullptr, 0);
+    if (vid < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "No video stream found");
+        return false;
+    }
+
+    m_videoStream = m_inputFC->streams[vid];
+    AVCodecParameters *par = m_videoStream->codecpar;
+
+    if (par->codec_id != AV_CODEC_ID_H264 && par->codec_id != AV_CODEC_ID_HEVC)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("%1 video can't be smart cut")
+                .arg(avcodec_get_name(par->codec_id)));
+        return false;
+    }
+
+    // Better to find out now than at the first cut
+    if (!avcodec_find_encoder(par->codec_id))
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + QString("No %1 encoder available")
+                .arg(avcodec_get_name(par->codec_id)));
+        return false;
+    }
+
+    AVCodec *codec = avcodec_find_decoder(par->codec_id);
+    m_decoder = avcodec_alloc_context3(codec);
+    if (!m_decoder || avcodec_parameters_to_context(m_decoder, par) < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't set up the video decoder");
+        return false;
+    }
+    m_decoder->pkt_timebase = m_videoStream->time_base;
+
+    {
+        QMutexLocker locker(avcodeclock);
+        ret = avcodec_open2(m_decoder, codec, nullptr);
+    }
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open the video decoder: %1").arg(av_error(ret)));
+        return false;
+    }
+
+    m_frameRate = av_guess_frame_rate(m_inputFC, m_videoStream, nullptr);
+    if (m_frameRate.num <= 0 || m_frameRate.den <= 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Unknown video frame rate");
+        return false;
+    }
+
+    if (m_videoStream->start_time != AV_NOPTS_VALUE)
+        m_startPts = m_videoStream->start_time;
+
+    // Every stream is unwrapped close to where the video starts
+    for (uint i = 0; i < m_inputFC->nb_streams; i++)
+    {
+        m_lastTime.push_back(av_rescale_q(m_startPts, m_videoStream->time_base,
+                                          m_inputFC->streams[i]->time_base));
+    }
+
+    // Like MPEG2fixup, only the main audio stream is kept by default
+    m_audioIndex = av_find_best_stream(m_inputFC, AVMEDIA_TYPE_AUDIO,
+                                       -1, vid, nullptr, 0);
+
+    m_frame = av_frame_alloc();
+
+    return true;
+}
+
+bool SmartCutter::InitOutput(void)
+{
+    // Without a width, height or audio codec the writer only muxes
+    m_writer = new AVFormatWriter();
+    m_writer->SetFilename(m_outfile);
+    m_writer->SetContainer(m_container);
+
+    if (!m_writer->Init())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC + "Couldn't set up the output file");
+        return false;
+    }
+
+    AVOutputFormat *ofmt = av_guess_format(m_container.toLatin1().constData(),
+                                           nullptr, nullptr);
+
+    for (uint i = 0; i < m_inputFC->nb_streams; i++)
+    {
+        AVStream *st = m_inputFC->streams[i];
+        AVCodecParameters *par = st->codecpar;
+
+        bool keep = false;
+        if (st == m_videoStream)
+            keep = true;
+        else if (par->codec_type == AVMEDIA_TYPE_AUDIO)
+            keep = m_allAudio || static_cast<int>(i) == m_audioIndex;
+        else if (par->codec_type == AVMEDIA_TYPE_SUBTITLE)
+            keep = avformat_query_codec(ofmt, par->codec_id,
+                                        FF_COMPLIANCE_NORMAL) != 0;
+
+        if (!keep)
+        {
+            st->discard = AVDISCARD_ALL;
+            continue;
+        }
+
+        if (!m_writer->AddCopyStream(par, st->time_base))
+            return false;
+
+        m_streamMap[i] = m_lastDts.size();
+        m_lastDts.push_back(AV_NOPTS_VALUE);
+    }
+
+    if (!m_writer->OpenFile())
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open %1").arg(m_outfile));
+        return false;
+    }
+
+    return true;
+}
+
+/** \brief Moves the timestamps of pkt by whole wrap periods of its stream,
+ *         to the ones closest to the last timestamp read from it.
+ *
+ *  MPEG timestamps wrap around after 33 bits, about 26.5 hours. Unwrapped
+ *  timestamps keep increasing, so they can be compared with the section
+ *  bounds, whether or not libavformat already corrected the first wrap.
+ */
+void SmartCutter::UnwrapTimestamps(AVPacket *pkt)
+{
+    AVStream *st = m_inputFC->streams[pkt->stream_index];
+    if (st->pts_wrap_bits <= 0 || st->pts_wrap_bits >= 63)
+        return;
+
+    const int64_t wrap = INT64_C(1) << st->pts_wrap_bits;
+    int64_t &last = m_lastTime[pkt->stream_index];
+
+    auto unwrap = [&](int64_t &ts)
+    {
+        if (ts == AV_NOPTS_VALUE)
+            return;
+        while (ts - last > wrap / 2)
+            ts -= wrap;
+        while (last - ts > wrap / 2)
+            ts += wrap;
+    };
+    unwrap(pkt->pts);
+    unwrap(pkt->dts);
+
+    int64_t time = PacketTime(pkt);
+    if (time != AV_NOPTS_VALUE)
+        last = time;
+}
+
+/// Returns the unwrapped video timestamp of a frame number.
+int64_t SmartCutter::FrameToPts(uint64_t frame) const
+{
+    return m_startPts + av_rescale_q(frame, av_inv_q(m_frameRate),
+                                     m_videoStream->time_base);
+}
+
+/** \brief Turns the cutlist into a list of the sections to keep.
+ *
+ *  \sa CutListKeptRanges()
+ */
+void SmartCutter::BuildSegments(void)
+{
+    int64_t removed = 0;
+    int64_t lastEnd = m_startPts;
+
+    auto addSegment = [&](uint64_t startFrame, int64_t end)
+    {
+        Segment seg;
+        seg.m_startFrame = startFrame;
+        seg.m_start      = FrameToPts(startFrame);
+        seg.m_end        = end;
+        removed         += seg.m_start - lastEnd;
+        seg.m_offset     = removed;
+        lastEnd          = end;
+        m_segments.push_back(seg);
+
+        LOG(VB_GENERAL, LOG_INFO, LOC +
+            QString("Keeping from frame %1 (%2s), moved back %3s")
+                .arg(startFrame)
+                .arg((seg.m_start - m_startPts) *
+                     av_q2d(m_videoStream->time_base), 0, 'f', 2)
+                .arg(removed * av_q2d(m_videoStream->time_base), 0, 'f', 2));
+    };
+
+    const uint64_t lastFrame = std::numeric_limits<uint64_t>::max();
+    for (const auto &keep : CutListKeptRanges(m_deleteMap, lastFrame))
+    {
+        addSegment(keep.first, keep.second == lastFrame
+                               ? kNoEnd : FrameToPts(keep.second));
+    }
+
+    // An empty output is still a valid result
+    if (m_segments.isEmpty())
+    {
+        Segment seg;
+        seg.m_start = seg.m_end = m_startPts;
+        m_segments.push_back(seg);
+    }
+}
+
+const SmartCutter::Segment *SmartCutter::FindSegment(int64_t pts) const
+{
+    for (const auto &seg : m_segments)
+    {
+        if (pts >= seg.m_start && pts < seg.m_end)
+            return &seg;
+    }
+    return nullptr;
+}
+
+/// Returns the output timestamp for pts, in timeBase, or AV_NOPTS_VALUE
+/// if it is cut.
+int64_t SmartCutter::MapTime(int64_t pts, AVRational timeBase) const
+{
+    if (pts == AV_NOPTS_VALUE)
+        return AV_NOPTS_VALUE;
+
+    AVRational vtb = m_videoStream->time_base;
+    const Segment *seg = FindSegment(av_rescale_q(pts, timeBase, vtb));
+    if (!seg)
+        return AV_NOPTS_VALUE;
+
+    return pts - av_rescale_q(seg->m_offset, vtb, timeBase);
+}
+
+/** \brief Seeks to just before the next kept section, if the GOP starting
+ *         at keyPts is well inside a cut.
+ *
+ *  The position map gives the byte offset of the keyframes. The keyframe
+ *  two before the start of the section is used to allow for frame numbers
+ *  that don't exactly match the timestamps.
+ */
+bool SmartCutter::SeekPastCut(int64_t keyPts)
+{
+    if (m_posMap.isEmpty() || m_prevGop.isEmpty())
+        return false;
+
+    // Both this GOP and the previous one have to be cut, the leading
+    // pictures of this one display before it.
+    int64_t prevKey = PacketTime(m_prevGop.first());
+    if (FindSegment(prevKey) || FindSegment(keyPts))
+        return false;
+
+    const Segment *next = nullptr;
+    for (const auto &seg : m_segments)
+    {
+        if (seg.m_start > prevKey)
+        {
+            next = &seg;
+            break;
+        }
+    }
+    if (!next || next->m_start <= keyPts)
+        return false;
+
+    auto it = m_posMap.upperBound(next->m_startFrame);
+    for (int i = 0; i < 2 && it != m_posMap.begin(); i++)
+        --it;
+    if (it == m_posMap.end() || it.key() > next->m_startFrame)
+        return false;
+
+    int64_t minSeek = av_rescale_q(kMinSeekSecs, AVRational{1, 1},
+                                   m_videoStream->time_base);
+    if (FrameToPts(it.key()) - keyPts < minSeek)
+        return false;
+
+    int ret = av_seek_frame(m_inputFC, -1, *it, AVSEEK_FLAG_BYTE);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Couldn't seek to keyframe %1: %2")
+                .arg(it.key()).arg(av_error(ret)));
+        return false;
+    }
+
+    LOG(VB_GENERAL, LOG_INFO, LOC +
+        QString("Skipping to keyframe %1 at byte %2").arg(it.key()).arg(*it));
+
+    ClearGOP(m_prevGop);
+    m_prevCopied = false;
+
+    return true;
+}
+
+/** \brief Copies, re-encodes or drops the pictures of the GOP in m_gop.
+ *
+ *  A GOP is copied if all of its pictures are in the same kept section.
+ *  Pictures that display before the keyframe (the leading pictures of an
+ *  open GOP) may reference the previous GOP, they are only copied along
+ *  if it was copied too. Otherwise the previous GOP is decoded again to
+ *  re-encode them. The decoder runs on for as long as GOPs are being
+ *  re-encoded, and is drained before anything is copied.
+ */
+bool SmartCutter::ProcessGOP(void)
+{
+    // Packets without a timestamp, like the second field of a picture,
+    // go along with the packet before them.
+    QVector<int64_t> times;
+    times.reserve(m_gop.size());
+    for (const AVPacket *pkt : m_gop)
+    {
+        int64_t time = PacketTime(pkt);
+        times.push_back(time != AV_NOPTS_VALUE ? time : times.last());
+    }
+
+    int64_t keyPts = times.first();
+    const Segment *seg = FindSegment(keyPts);
+    int64_t lastPts = *std::max_element(times.cbegin(), times.cend());
+    bool copy = seg && lastPts < seg->m_end;
+
+    bool decodeLeading = false;
+    bool decodeAll = false;
+    for (int64_t pts : times)
+    {
+        bool leading = pts < keyPts;
+
+        if (copy && (!leading || m_prevCopied))
+            continue;
+        if (!FindSegment(pts))
+            continue;
+        // Nothing to decode them from
+        if (leading && m_prevGop.isEmpty() && !m_decoderActive)
+            continue;
+
+        m_encodePts.insert(pts);
+        if (leading)
+            decodeLeading = true;
+        else
+            decodeAll = true;
+    }
+
+    if (decodeLeading && !m_decoderActive)
+    {
+        for (AVPacket *pkt : m_prevGop)
+        {
+            if (!DecodePacket(pkt))
+                return false;
+        }
+        m_decoderActive = true;
+    }
+
+    if (decodeAll || decodeLeading)
+    {
+        for (int i = 0; i < m_gop.size(); i++)
+        {
+            if (!decodeAll && i > 0 && times[i] >= keyPts)
+                continue;
+            if (!DecodePacket(m_gop[i]))
+                return false;
+        }
+        m_decoderActive = true;
+    }
+
+    if (!decodeAll && m_decoderActive && !DrainDecoder())
+        return false;
+
+    if (copy)
+    {
+        // The re-encoded pictures come first
+        if (!FlushEncoder())
+            return false;
+
+        for (int i = 0; i < m_gop.size(); i++)
+        {
+            if (times[i] < keyPts && !m_prevCopied)
+                continue;
+            if (!CopyVideo(m_gop[i], times[i]))
+                return false;
+        }
+        m_gopsCopied++;
+    }
+
+    m_prevCopied = copy;
+    ClearGOP(m_prevGop);
+    m_prevGop.swap(m_gop);
+
+    return true;
+}
+
+bool SmartCutter::CopyVideo(const AVPacket *pkt, int64_t time)
+{
+    int64_t mapped = MapTime(time, m_videoStream->time_base);
+    if (mapped == AV_NOPTS_VALUE)
+        return true;
+
+    // The GOP is kept as a reference for the next one
+    AVPacket *out = av_packet_clone(pkt);
+    if (!out)
+        return false;
+
+    int64_t shift = time - mapped;
+    if (out->pts != AV_NOPTS_VALUE)
+        out->pts -= shift;
+    if (out->dts != AV_NOPTS_VALUE)
+        out->dts -= shift;
+
+    bool ok = WriteVideo(out);
+    av_packet_free(&out);
+    return ok;
+}
+
+bool SmartCutter::CopyOther(AVPacket *pkt)
+{
+    auto it = m_streamMap.constFind(pkt->stream_index);
+    if (it == m_streamMap.constEnd())
+        return true;
+
+    AVRational tb = m_inputFC->streams[pkt->stream_index]->time_base;
+    int64_t time = PacketTime(pkt);
+    int64_t mapped = MapTime(time, tb);
+    if (mapped == AV_NOPTS_VALUE)
+        return true;
+
+    int64_t shift = time - mapped;
+    if (pkt->pts != AV_NOPTS_VALUE)
+        pkt->pts -= shift;
+    if (pkt->dts != AV_NOPTS_VALUE)
+        pkt->dts -= shift;
+
+    // A packet straddling a cut can overlap the one before it
+    int64_t &lastDts = m_lastDts[*it];
+    if (pkt->dts != AV_NOPTS_VALUE)
+    {
+        if (lastDts != AV_NOPTS_VALUE && pkt->dts <= lastDts)
+            return true;
+        lastDts = pkt->dts;
+    }
+
+    pkt->stream_index = *it;
+    return m_writer->WritePacket(pkt, tb);
+}
+
+bool SmartCutter::WriteVideo(AVPacket *pkt)
+{
+    int index = m_streamMap.value(m_videoStream->index);
+    int64_t &lastDts = m_lastDts[index];
+
+    if (pkt->dts == AV_NOPTS_VALUE)
+        pkt->dts = pkt->pts;
+
+    // Where re-encoded and copied pictures meet the dts may not increase,
+    // move it on by a tick.
+    if (pkt->dts != AV_NOPTS_VALUE)
+    {
+        if (lastDts != AV_NOPTS_VALUE && pkt->dts <= lastDts)
+        {
+            pkt->dts = lastDts + 1;
+            pkt->pts = std::max(pkt->pts, pkt->dts);
+        }
+        lastDts = pkt->dts;
+    }
+
+    pkt->stream_index = index;
+    return m_writer->WritePacket(pkt, m_videoStream->time_base);
+}
+
+bool SmartCutter::DecodePacket(AVPacket *pkt)
+{
+    int ret = avcodec_send_packet(m_decoder, pkt);
+    if (ret < 0 && ret != AVERROR_EOF)
+    {
+        // Broadcast streams have errors, carry on with the next picture
+        LOG(VB_GENERAL, LOG_WARNING, LOC +
+            QString("Decode error: %1").arg(av_error(ret)));
+    }
+
+    while ((ret = avcodec_receive_frame(m_decoder, m_frame)) >= 0)
+    {
+        bool ok = EncodeFrame(m_frame);
+        av_frame_unref(m_frame);
+        if (!ok)
+            return false;
+    }
+
+    return true;
+}
+
+bool SmartCutter::DrainDecoder(void)
+{
+    bool ok = DecodePacket(nullptr);
+    avcodec_flush_buffers(m_decoder);
+    m_decoderActive = false;
+    // Anything still listed was never decoded
+    m_encodePts.clear();
+    return ok;
+}
+
+bool SmartCutter::EncodeFrame(AVFrame *frame)
+{
+    int64_t pts = frame->best_effort_timestamp;
+    if (!m_encodePts.remove(pts))
+        return true;
+
+    if (!m_encoder && !OpenEncoder(frame))
+        return false;
+
+    frame->pts       = MapTime(pts, m_videoStream->time_base);
+    frame->pict_type = AV_PICTURE_TYPE_NONE;
+
+    int ret = avcodec_send_frame(m_encoder, frame);
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Encode error: %1").arg(av_error(ret)));
+        return false;
+    }
+    m_framesEncoded++;
+
+    return WriteEncoded();
+}
+
+/** \brief Opens an encoder matching the decoded pictures.
+ *
+ *  A new encoder is used for every run of re-encoded pictures, so each
+ *  run starts with a keyframe carrying its own parameter sets.
+ */
+bool SmartCutter::OpenEncoder(const AVFrame *frame)
+{
+    AVCodec *codec = avcodec_find_encoder(m_decoder->codec_id);
+    if (!codec)
+        return false;
+
+    m_encoder = avcodec_alloc_context3(codec);
+    if (!m_encoder)
+        return false;
+
+    m_encoder->width               = frame->width;
+    m_encoder->height              = frame->height;
+    m_encoder->pix_fmt             = static_cast<AVPixelFormat>(frame->format);
+    m_encoder->sample_aspect_ratio = frame->sample_aspect_ratio;
+    m_encoder->color_range         = frame->color_range;
+    m_encoder->color_primaries     = frame->color_primaries;
+    m_encoder->color_trc           = frame->color_trc;
+    m_encoder->colorspace          = frame->colorspace;
+    m_encoder->time_base           = m_videoStream->time_base;
+    m_encoder->framerate           = m_frameRate;
+    m_encoder->thread_count        = 0;
+    // Keeps dts equal to pts, see WriteEncoded()
+    m_encoder->max_b_frames        = 0;
+
+    if (frame->interlaced_frame)
+    {
+        m_encoder->flags |= AV_CODEC_FLAG_INTERLACED_DCT |
+                            AV_CODEC_FLAG_INTERLACED_ME;
+        m_encoder->field_order = frame->top_field_first ? AV_FIELD_TT
+                                                        : AV_FIELD_BB;
+    }
+
+    // Only a GOP or two around each cut is re-encoded, so spend the bits
+    // to make it indistinguishable from the copied pictures. Other
+    // encoders don't take these options, give them the stream's bitrate.
+    AVDictionary *opts = nullptr;
+    QString name = codec->name;
+    if (name == "libx264" || name == "libx265")
+    {
+        av_dict_set(&opts, "crf", "18", 0);
+        av_dict_set(&opts, "preset", "fast", 0);
+    }
+    else if (m_videoStream->codecpar->bit_rate > 0)
+    {
+        m_encoder->bit_rate = m_videoStream->codecpar->bit_rate;
+    }
+
+    int ret = 0;
+    {
+        QMutexLocker locker(avcodeclock);
+        ret = avcodec_open2(m_encoder, codec, &opts);
+    }
+    av_dict_free(&opts);
+
+    if (ret < 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, LOC +
+            QString("Couldn't open the %1 encoder: %2")
+                .arg(codec->name).arg(av_error(ret)));
+        avcodec_free_context(&m_encoder);
+        return false;
+    }
+
+    return true;
+}
+
+bool SmartCutter::WriteEncoded(void)
+{
+    AVPacket *pkt = av_packet_alloc();
+    bool ok = true;
+
+    while (ok && avcodec_receive_packet(m_encoder, pkt) >= 0)
+    {
+        // Without B-frames dts equals pts. Moving it back by the reorder
+        // delay of the original stream lines it up with the copied GOPs.
+        pkt->dts = pkt->pts - m_reorderDelay;
+        ok = WriteVideo(pkt);
+        av_packet_unref(pkt);
+    }
+
+    av_packet_free(&pkt);
+    return ok;
+}
+
+bool SmartCutter::FlushEncoder(void)
+{
+    if (!m_encoder)
+        return true;
+
+    bool ok = avcodec_send_frame(m_encoder, nullptr) >= 0 && WriteEncoded();
+    avcodec_free_context(&m_encoder);
+    return ok;
+}
+
+void SmartCutter::ClearGOP(QList<AVPacket*> &gop)
+{
+    for (AVPacket *pkt : gop)
+        av_packet_free(&pkt);
+    gop.clear();
+}
+
+/// Reports progress, returns false if the job was told to stop.
+bool SmartCutter::CheckProgress(void)
+{
+    if (!m_progress.IsDue())
+        return true;
+
+    float percent_done = 0.0F;
+    if (m_fileSize > 0)
+        percent_done = 100.0F * avio_tell(m_inputFC->pb) / m_fileSize;
+
+    return m_progress.Report(percent_done);
+}
@@ -0,0 +1,136 @@
+#ifndef SMARTCUT_H
+#define SMARTCUT_H
+
+#include <cstdint>
+
+extern "C"
+{
+#include "libavcodec/avcodec.h"
+#include "libavformat/avformat.h"
+}
+
+// Qt
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+// MythTV
+#include "transcodedefs.h"
+#include "transcodeprogress.h"
+#include "programtypes.h"
+
+class AVFormatWriter;
+
+/** \class SmartCutter
+ *  \brief Applies a cutlist to an H.264 or HEVC recording without
+ *         re-encoding all of it.
+ *
+ *  Video is read one GOP at a time. GOPs that lie entirely inside a kept
+ *  section are copied as they are, only the pictures of GOPs that straddle
+ *  a cut point are decoded and re-encoded with the same codec, so every
+ *  kept section starts and ends on the exact cut frame. Audio and
+ *  subtitle packets inside the kept sections are copied. Timestamps after
+ *  each cut are moved back by the length of everything removed before it,
+ *  so the output plays without gaps.
+ *
+ *  Cut frame numbers are converted to timestamps using the stream frame
+ *  rate. Timestamps are unwrapped as packets are read, so they compare
+ *  correctly with the cut points after the 33 bit MPEG timestamps wrap
+ *  around. The keyframe position map of the recording is used to seek
+ *  past long cut sections, straight to the keyframes just before the next
+ *  kept section, instead of reading through them.
+ */
+class SmartCutter
+{
+  public:
+    SmartCutter(QString inf, QString outf, const frm_dir_map_t &deleteMap,
+                frm_pos_map_t posMap, QString container, bool showprog,
+                void (*update_func)(float) = nullptr,
+                int (*check_func)() = nullptr);
+    ~SmartCutter();
+
+    int Start(void);
+
+    void SetAllAudio(bool keep) { m_allAudio = keep; }
+
+    /// Returns true if recordings with the given video encoding, as
+    /// returned by MythPlayer::GetEncodingType(), can be smart cut.
+    static bool CanCut(const QString &encodingType)
+        { return encodingType == "H.264" || encodingType == "HEVC"; }
+
+  private:
+    class Segment
+    {
+      public:
+        uint64_t m_startFrame {0};
+        int64_t  m_start      {0};  ///< first kept pts, video time base
+        int64_t  m_end        {0};  ///< first pts after the section
+        int64_t  m_offset     {0};  ///< subtracted from pts in the section
+    };
+
+    bool InitInput(void);
+    bool InitOutput(void);
+    void UnwrapTimestamps(AVPacket *pkt);
+    void BuildSegments(void);
+    int64_t FrameToPts(uint64_t frame) const;
+    const Segment *FindSegment(int64_t pts) const;
+    int64_t MapTime(int64_t pts, AVRational timeBase) const;
+    bool SeekPastCut(int64_t keyPts);
+
+    bool ProcessGOP(void);
+    bool CopyVideo(const AVPacket *pkt, int64_t time);
+    bool CopyOther(AVPacket *pkt);
+    bool WriteVideo(AVPacket *pkt);
+
+    bool DecodePacket(AVPacket *pkt);
+    bool DrainDecoder(void);
+    bool EncodeFrame(AVFrame *frame);
+    bool OpenEncoder(const AVFrame *frame);
+    bool WriteEncoded(void);
+    bool FlushEncoder(void);
+
+    static void ClearGOP(QList<AVPacket*> &gop);
+    bool CheckProgress(void);
+
+    static int64_t PacketTime(const AVPacket *pkt)
+        { return pkt->pts != AV_NOPTS_VALUE ? pkt->pts : pkt->dts; }
+
+    QString           m_infile;
+    QString           m_outfile;
+    QString           m_container;
+    frm_dir_map_t     m_deleteMap;
+    frm_pos_map_t     m_posMap;          ///< keyframe number to byte offset
+
+    AVFormatContext  *m_inputFC          {nullptr};
+    AVStream         *m_videoStream      {nullptr};
+    int               m_audioIndex       {-1};  ///< kept without --allaudio
+    AVCodecContext   *m_decoder          {nullptr};
+    AVCodecContext   *m_encoder          {nullptr};
+    AVFrame          *m_frame            {nullptr};
+    AVFormatWriter   *m_writer           {nullptr};
+    AVRational        m_frameRate        {0, 1};
+    int64_t           m_startPts         {0};
+    int64_t           m_reorderDelay     {0};
+
+    QList<Segment>    m_segments;
+    QMap<int,int>     m_streamMap;       ///< input to output stream index
+    QVector<int64_t>  m_lastDts;         ///< per output stream
+    QVector<int64_t>  m_lastTime;        ///< per input stream, unwrapped
+
+    QList<AVPacket*>  m_gop;             ///< current GOP, in decode order
+    QList<AVPacket*>  m_prevGop;         ///< references for leading pictures
+    QSet<int64_t>     m_encodePts;       ///< pictures to re-encode
+    bool              m_prevCopied       {false};
+    bool              m_decoderActive    {false};
+
+    bool              m_allAudio         {false};
+    uint64_t          m_gopsCopied       {0};
+    uint64_t          m_framesEncoded    {0};
+
+    TranscodeProgress m_progress;
+    int64_t           m_fileSize         {0};
+};
+
+#endif
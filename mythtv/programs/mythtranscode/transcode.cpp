@@ -2,6 +2,7 @@
 #include <cmath>
 #include <iostream>
 
+#include <QFile>
 #include <QStringList>
 #include <QMap>
 #include <QRegExp>
@@ -34,6 +35,7 @@
 
 #include "videodecodebuffer.h"
 #include "cutter.h"
+#include "smartcut.h"
 #include "audioreencodebuffer.h"
 
 extern "C" {
@@ -642,6 +644,14 @@ int Transcode::TranscodeFile(const QString &inputname,
             return REENCODE_MPEG2TRANS;
         }
 
+        if (SmartCutter::CanCut(encodingType) &&
+            get_bool_option(m_recProfile, "transcodelossless"))
+        {
+            LOG(VB_GENERAL, LOG_NOTICE, "Switching to smart cutter.");
+            SetPlayerContext(nullptr);
+            return REENCODE_SMARTCUT;
+        }
+
         // Recorder setup
         if (get_bool_option(m_recProfile, "transcodelossless"))
         {
@@ -1511,6 +1521,13 @@ int Transcode::TranscodeFile(const QString &inputname,
                         arg((long)(curFrameNum / video_frame_rate)));
             }
 
+            if (!m_progressFile.isEmpty())
+            {
+                QFile progress(m_progressFile);
+                if (progress.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                    progress.write(QByteArray::number((qlonglong)curFrameNum));
+            }
+
             if (hls && hls->CheckStop())
             {
                 hls->UpdateStatus(kHLSStatusStopping);
@@ -24,6 +24,7 @@ class Transcode : public QObject
         const QString& fifodir, bool fifo_info, bool cleanCut, frm_dir_map_t &deleteMap,
         int AudioTrackNo, bool passthru = false);
     void ShowProgress(bool val) { m_showProgress = val; }
+    void SetProgressFile(const QString &file) { m_progressFile = file; }
     void SetRecorderOptions(const QString& options) { m_recorderOptions = options; }
     void SetAVFMode(void) { m_avfMode = true; }
     void SetHLSMode(void) { m_hlsMode = true; }
@@ -58,6 +59,7 @@ class Transcode : public QObject
     FIFOWriter          *m_fifow               { nullptr };
     KFATable            *m_kfaTable            { nullptr };
     bool                 m_showProgress        { false };
+    QString              m_progressFile;
     QString              m_recorderOptions;
     bool                 m_avfMode             { false };
     bool                 m_hlsMode             { false };
@@ -0,0 +1,39 @@
+// MythTV
+#include "mythdate.h"
+#include "mythlogging.h"
+#include "transcodeprogress.h"
+
+TranscodeProgress::TranscodeProgress(bool showprog,
+                                     void (*update_func)(float),
+                                     int (*check_func)())
+  : m_showProgress(showprog), m_updateStatus(update_func),
+    m_checkAbort(check_func)
+{
+    if (m_updateStatus)
+    {
+        m_statusUpdateTime = 20;
+        m_updateStatus(0);
+    }
+    m_statusTime = MythDate::current().addSecs(m_statusUpdateTime);
+}
+
+/// Returns true if it is time for the next Report().
+bool TranscodeProgress::IsDue(void) const
+{
+    return IsActive() && MythDate::current() > m_statusTime;
+}
+
+/// Reports progress, returns false if the job was told to stop.
+bool TranscodeProgress::Report(float percent_done)
+{
+    if (m_updateStatus)
+        m_updateStatus(percent_done);
+    if (m_showProgress)
+        LOG(VB_GENERAL, LOG_INFO, QString("%1% complete")
+                .arg(percent_done, 0, 'f', 1));
+    if (m_checkAbort && m_checkAbort())
+        return false;
+
+    m_statusTime = MythDate::current().addSecs(m_statusUpdateTime);
+    return true;
+}
@@ -0,0 +1,32 @@
+#ifndef TRANSCODEPROGRESS_H
+#define TRANSCODEPROGRESS_H
+
+// Qt
+#include <QDateTime>
+
+/** \class TranscodeProgress
+ *  \brief Reports the progress of a transcode to the log and the job
+ *         queue, and checks if the job was told to stop.
+ *
+ *  Reports are made at most every 5 seconds, or every 20 when there is a
+ *  job to update.
+ */
+class TranscodeProgress
+{
+  public:
+    TranscodeProgress(bool showprog, void (*update_func)(float),
+                      int (*check_func)());
+
+    bool IsActive(void) const { return m_showProgress || m_updateStatus; }
+    bool IsDue(void) const;
+    bool Report(float percent_done);
+
+  private:
+    bool              m_showProgress     {false};
+    void            (*m_updateStatus)(float) {nullptr};
+    int             (*m_checkAbort)()    {nullptr};
+    QDateTime         m_statusTime;
+    int               m_statusUpdateTime {5};
+};
+
+#endif
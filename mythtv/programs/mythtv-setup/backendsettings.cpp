@@ -342,6 +342,20 @@ static HostCheckBoxSetting *DisableFirewireReset()
     return hc;
 }
 
+static HostSpinBoxSetting *MaxProcessRequestThreads()
+{
+    auto *hs = new HostSpinBoxSetting("MaxProcessRequestThreads", 5, 512, 1);
+    hs->setLabel(QObject::tr("Maximum request threads"));
+    hs->setHelpText(
+        QObject::tr(
+            "The most threads the backend starts to handle requests "
+            "from frontends and other clients at once. Further requests "
+            "wait for a free thread. Requests from slave backends "
+            "never wait."));
+    hs->setValue(64);
+    return hs;
+}
+
 static HostTextEditSetting *MiscStatusScript()
 {
     auto *he = new HostTextEditSetting("MiscStatusScript");
@@ -586,6 +600,31 @@ static HostSpinBoxSetting *JobQueueCheckFrequency()
     return gc;
 };
 
+static HostSpinBoxSetting *JobQueueCPUCores()
+{
+    auto *gc = new HostSpinBoxSetting("JobQueueCPUCores", 0, 64, 1);
+    gc->setLabel(QObject::tr("CPU cores available to jobs"));
+    gc->setHelpText(QObject::tr("New jobs will not be started while the "
+                    "jobs running on this backend are expected to use more "
+                    "than this many CPU cores. A transcode counts as two "
+                    "cores, other jobs as one. Set to 0 for no limit."));
+    gc->setValue(0);
+    return gc;
+};
+
+static HostSpinBoxSetting *JobQueueMaxIOMBps()
+{
+    auto *gc = new HostSpinBoxSetting("JobQueueMaxIOMBps", 0, 1000, 5);
+    gc->setLabel(QObject::tr("Storage bandwidth available (MB/s)"));
+    gc->setHelpText(QObject::tr("New jobs will not be started while "
+                    "recordings and jobs are using more than this much of "
+                    "the bandwidth of the disks holding this backend's "
+                    "storage groups, so that jobs do not slow down "
+                    "recordings. Set to 0 for no limit."));
+    gc->setValue(0);
+    return gc;
+};
+
 static HostComboBoxSetting *JobQueueCPU()
 {
     auto *gc = new HostComboBoxSetting("JobQueueCPU");
@@ -936,6 +975,7 @@ BackendSettings::BackendSettings()
     upnp->addChild(UPNPWmpSource());
     group2->addChild(upnp);
     group2->addChild(MiscStatusScript());
+    group2->addChild(MaxProcessRequestThreads());
     group2->addChild(DisableAutomaticBackup());
     group2->addChild(DisableFirewireReset());
     addChild(group2);
@@ -989,6 +1029,8 @@ BackendSettings::BackendSettings()
     group5->addChild(JobQueueWindowStart());
     group5->addChild(JobQueueWindowEnd());
     group5->addChild(JobQueueCPU());
+    group5->addChild(JobQueueCPUCores());
+    group5->addChild(JobQueueMaxIOMBps());
     group5->addChild(JobAllowMetadata());
     group5->addChild(JobAllowCommFlag());
     group5->addChild(JobAllowTranscode());
@@ -89,6 +89,50 @@ static int ScanVideos(const MythUtilCommandLineParser &/*cmdline*/)
     return GENERIC_EXIT_CONNECT_ERROR;
 }
 
+static int DatabaseProfile(const MythUtilCommandLineParser &cmdline)
+{
+    int count = 20;
+    if (cmdline.toBool("count"))
+        count = cmdline.toInt("count");
+
+    if (!gCoreContext->ConnectToMasterServer(false, false))
+    {
+        LOG(VB_GENERAL, LOG_ERR, "Cannot connect to master for the "
+            "database profile");
+        return GENERIC_EXIT_CONNECT_ERROR;
+    }
+
+    QStringList strlist("QUERY_TIMING_STATS");
+    strlist << "database" << QString::number(count);
+    if (!gCoreContext->SendReceiveStringList(strlist) || strlist.isEmpty() ||
+        strlist[0] == "ERROR" || (strlist.size() - 1) % 8 != 0)
+    {
+        LOG(VB_GENERAL, LOG_ERR, "Master backend did not return a database "
+            "profile");
+        return GENERIC_EXIT_NOT_OK;
+    }
+
+    cout << "Database profile since "
+         << strlist[0].toLocal8Bit().constData() << endl << endl
+         << "   Count   Total ms  p50 ms  p99 ms      Rows  Caller / Query"
+         << endl;
+
+    for (int i = 1; i + 7 < strlist.size(); i += 8)
+    {
+        QString line = QString("%1 %2 %3 %4 %5  %6")
+            .arg(strlist[i + 2], 8)
+            .arg(strlist[i + 3].toULongLong() / 1000.0, 10, 'f', 1)
+            .arg(strlist[i + 4].toULongLong() / 1000.0, 7, 'f', 1)
+            .arg(strlist[i + 5].toULongLong() / 1000.0, 7, 'f', 1)
+            .arg(strlist[i + 7], 9)
+            .arg(strlist[i + 1].isEmpty() ? QString("?") : strlist[i + 1]);
+        cout << line.toLocal8Bit().constData() << endl
+             << "          " << strlist[i].toLocal8Bit().constData() << endl;
+    }
+
+    return GENERIC_EXIT_OK;
+}
+
 static int ParseVideoFilename(const MythUtilCommandLineParser &cmdline)
 {
     QString filename = cmdline.toString("parsevideo");
@@ -112,6 +156,7 @@ void registerBackendUtils(UtilMap &utilMap)
     utilMap["scanvideos"]           = &ScanVideos;
     utilMap["systemevent"]          = &SendSystemEvent;
     utilMap["parsevideo"]           = &ParseVideoFilename;
+    utilMap["dbprofile"]            = &DatabaseProfile;
 }
 
 /* vim: set expandtab tabstop=4 shiftwidth=4: */
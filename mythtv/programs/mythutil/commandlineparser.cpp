@@ -125,6 +125,15 @@ void MythUtilCommandLineParser::LoadArguments(void)
                 "Diagnostic tool for testing filename formats against what "
                 "the Video Library name parser will detect them as.")
                 ->SetGroup("Backend")
+        << add("--dbprofile", "dbprofile", false,
+                "Print the queries that take the most database time on the "
+                "master backend.",
+                "This command will connect to the master backend and print "
+                "the query templates it has spent the most time executing, "
+                "with the function that ran them, how often they ran, their "
+                "median and 99th percentile times and the rows they "
+                "returned or changed.")
+                ->SetGroup("Backend")
 
         // jobutils.cpp
         << add("--queuejob", "queuejob", "",
@@ -232,6 +241,9 @@ void MythUtilCommandLineParser::LoadArguments(void)
         ->SetChildOf("notification");
 
     // musicmetautils.cpp
+    add("--fullscan", "fullscan", false, "(optional) Check every file, not only "
+        "those in directories that have changed", "")
+        ->SetChildOf("scanmusic");
     add("--songid", "songid", "", "ID of track to update", "")
         ->SetChildOf("updatemeta");
     add("--title", "title", "", "(optional) Title of track", "")
@@ -273,6 +285,10 @@ void MythUtilCommandLineParser::LoadArguments(void)
     add("--fixseektable", "fixseektable", false, "(optional) fix the seektable if missing for a recording", "")
         ->SetChildOf("checkrecordings");
 
+    // backendutils.cpp
+    add("--count", "count", 20, "(optional) number of queries to print, 0 for all", "")
+        ->SetChildOf("dbprofile");
+
     // eitutils.cpp
     add("--sourceid", "sourceid", -1, "(optional) specify sourceid of video source to operate on instead of all", "")
         ->SetChildOf("cleareit");
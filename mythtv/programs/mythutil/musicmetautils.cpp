@@ -178,7 +178,7 @@ static int ExtractImage(const MythUtilCommandLineParser &cmdline)
     return GENERIC_EXIT_OK;
 }
 
-static int ScanMusic(const MythUtilCommandLineParser &/*cmdline*/)
+static int ScanMusic(const MythUtilCommandLineParser &cmdline)
 {
     auto *fscan = new MusicFileScanner();
     QStringList dirList;
@@ -190,7 +190,7 @@ static int ScanMusic(const MythUtilCommandLineParser &/*cmdline*/)
         return GENERIC_EXIT_NOT_OK;
     }
 
-    fscan->SearchDirs(dirList);
+    fscan->SearchDirs(dirList, cmdline.toBool("fullscan"));
     delete fscan;
 
     return GENERIC_EXIT_OK;